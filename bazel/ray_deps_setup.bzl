@@ -192,6 +192,26 @@ def ray_deps_setup():
         sha256 = "aaee5dec23165ee10c189d8b40f19861e2c6929c015cee3d2b4e56d8a1bdc422",
     )
 
+    github_repository(
+        name = "lz4",
+        build_file = True,
+        tag = "v1.9.2",
+        remote = "https://github.com/lz4/lz4",
+        archive_suffix = ".tar.gz",
+        sha256 = "658ba6191fa44c92280d4aa2c271b0f4fbc0e34d249578dd05e50e76d0e5efcc",
+        strip_prefix = "lz4-1.9.2",
+    )
+
+    github_repository(
+        name = "zstd",
+        build_file = True,
+        tag = "v1.4.4",
+        remote = "https://github.com/facebook/zstd",
+        archive_suffix = ".tar.gz",
+        sha256 = "a364f5162c7d1a455cc915e8e3cf5f4bd8b75d09bc0f53965b0c9ca1383c52c8",
+        strip_prefix = "zstd-1.4.4",
+    )
+
     github_repository(
         name = "io_opencensus_cpp",
         commit = "3aa11f20dd610cb8d2f7c62e58d1e69196aadf11",
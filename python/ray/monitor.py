@@ -20,6 +20,69 @@ from ray.autoscaler.commands import teardown_cluster
 logger = logging.getLogger(__name__)
 
 
+class HeartbeatDecoder:
+    """Tracks the resources of a raylet by applying its heartbeats in order.
+
+    A heartbeat is either a snapshot with the labels and capacities of all
+    resources, or a delta that only holds the resources whose capacity changed
+    since the raylet's previous heartbeat. Deltas refer to resources by the
+    IDs that the raylet interned their labels as. A capacity of 0 in a delta
+    means that the resource was removed.
+    """
+
+    def __init__(self):
+        self.known = False
+        self.labels = {}
+        self.available_resources = {}
+        self.total_resources = {}
+        self.resource_load = {}
+
+    def apply(self, message):
+        """Apply a heartbeat.
+
+        Returns:
+            False if the heartbeat is a delta that can't be applied, because
+                no snapshot was applied yet or it refers to an unknown
+                resource ID. The resources are unknown until the next
+                snapshot.
+        """
+        if not message.is_delta:
+            self.labels = {
+                label_id.id: label_id.label
+                for label_id in message.resource_label_ids
+            }
+            self.available_resources = dict(
+                zip(message.resources_available_label,
+                    message.resources_available_capacity))
+            self.total_resources = dict(
+                zip(message.resources_total_label,
+                    message.resources_total_capacity))
+            self.resource_load = dict(
+                zip(message.resource_load_label,
+                    message.resource_load_capacity))
+            self.known = True
+            return True
+        if not self.known:
+            return False
+        for label_id in message.resource_label_ids:
+            self.labels[label_id.id] = label_id.label
+        for deltas, resources in [
+            (message.resources_available_delta, self.available_resources),
+            (message.resources_total_delta, self.total_resources),
+            (message.resource_load_delta, self.resource_load),
+        ]:
+            for delta in deltas:
+                if delta.id not in self.labels:
+                    self.known = False
+                    return False
+                label = self.labels[delta.id]
+                if delta.capacity == 0:
+                    resources.pop(label, None)
+                else:
+                    resources[label] = delta.capacity
+        return True
+
+
 class Monitor:
     """A monitor for Ray processes.
 
@@ -45,6 +108,8 @@ class Monitor:
         # Keep a mapping from raylet client ID to IP address to use
         # for updating the load metrics.
         self.raylet_id_to_ip_map = {}
+        # The resources of each raylet, as reported by its heartbeats.
+        self.heartbeat_decoders = {}
         self.load_metrics = LoadMetrics()
         if autoscaling_config:
             self.autoscaler = StandardAutoscaler(autoscaling_config,
@@ -107,20 +172,19 @@ class Monitor:
         message = ray.gcs_utils.HeartbeatBatchTableData.FromString(
             heartbeat_data)
         for heartbeat_message in message.batch:
-            resource_load = dict(
-                zip(heartbeat_message.resource_load_label,
-                    heartbeat_message.resource_load_capacity))
-            total_resources = dict(
-                zip(heartbeat_message.resources_total_label,
-                    heartbeat_message.resources_total_capacity))
-            available_resources = dict(
-                zip(heartbeat_message.resources_available_label,
-                    heartbeat_message.resources_available_capacity))
+            client_id = ray.utils.binary_to_hex(heartbeat_message.client_id)
+            decoder = self.heartbeat_decoders.setdefault(
+                client_id, HeartbeatDecoder())
+            if not decoder.apply(heartbeat_message):
+                # Wait for the next snapshot of this raylet's resources.
+                continue
+            resource_load = dict(decoder.resource_load)
+            total_resources = dict(decoder.total_resources)
+            available_resources = dict(decoder.available_resources)
             for resource in total_resources:
                 available_resources.setdefault(resource, 0.0)
 
             # Update the load metrics for this raylet.
-            client_id = ray.utils.binary_to_hex(heartbeat_message.client_id)
             ip = self.raylet_id_to_ip_map.get(client_id)
             if ip:
                 self.load_metrics.update(ip, total_resources,
@@ -287,6 +351,12 @@ class Monitor:
             if _append_port:
                 ip_address += ":" + str(raylet_info["NodeManagerPort"])
             self.raylet_id_to_ip_map[node_id] = ip_address
+        # Forget the resources of raylets that are gone.
+        self.heartbeat_decoders = {
+            client_id: decoder
+            for client_id, decoder in self.heartbeat_decoders.items()
+            if client_id in self.raylet_id_to_ip_map
+        }
 
     def _maybe_flush_gcs(self):
         """Experimental: issue a flush request to the GCS.
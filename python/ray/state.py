@@ -943,6 +943,9 @@ class GlobalState:
                 heartbeat_data = gcs_entries.entries[0]
                 message = gcs_utils.HeartbeatTableData.FromString(
                     heartbeat_data)
+                if message.is_delta:
+                    # Only snapshots hold all resources of a client.
+                    continue
                 # Calculate available resources for this client
                 num_resources = len(message.resources_available_label)
                 dynamic_resources = {}
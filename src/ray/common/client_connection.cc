@@ -17,8 +17,10 @@ std::shared_ptr<ServerConnection<T>> ServerConnection<T>::Create(
 }
 
 template <class T>
-ServerConnection<T>::ServerConnection(boost::asio::basic_stream_socket<T> &&socket)
+ServerConnection<T>::ServerConnection(boost::asio::basic_stream_socket<T> &&socket,
+                                      boost::asio::io_service *handler_service)
     : socket_(std::move(socket)),
+      handler_service_(handler_service),
       async_write_max_messages_(1),
       async_write_queue_(),
       async_write_in_flight_(false),
@@ -83,6 +85,15 @@ Status ServerConnection<T>::ReadBuffer(
 template <class T>
 ray::Status ServerConnection<T>::WriteMessage(int64_t type, int64_t length,
                                               const uint8_t *message) {
+  if (handler_service_ != nullptr) {
+    // Writing here would race with the async writes on the event loop of the socket.
+    WriteMessageAsync(type, length, message, [](const ray::Status &status) {
+      if (!status.ok()) {
+        RAY_LOG(WARNING) << "Failed to write message: " << status.ToString();
+      }
+    });
+    return ray::Status::OK();
+  }
   sync_writes_ += 1;
   bytes_written_ += length;
 
@@ -123,6 +134,22 @@ void ServerConnection<T>::WriteMessageAsync(
   }
 }
 
+template <class T>
+void ServerConnection<T>::Close() {
+  if (handler_service_ == nullptr) {
+    boost::system::error_code ec;
+    socket_.close(ec);
+    return;
+  }
+  // Close the socket on its event loop, so that it isn't closed under a pending read
+  // or write. The pending operations then complete with an error.
+  auto this_ptr = this->shared_from_this();
+  boost::asio::post(socket_.get_executor(), [this_ptr]() {
+    boost::system::error_code ec;
+    this_ptr->socket_.close(ec);
+  });
+}
+
 template <class T>
 void ServerConnection<T>::DoAsyncWrites() {
   // Make sure we were not writing to the socket.
@@ -168,35 +195,53 @@ void ServerConnection<T>::DoAsyncWrites() {
     return;
   }
   auto this_ptr = this->shared_from_this();
-  boost::asio::async_write(
-      ServerConnection<T>::socket_, message_buffers,
-      [this, this_ptr, num_messages, call_handlers](
-          const boost::system::error_code &error, size_t bytes_transferred) {
-        ray::Status status = boost_to_ray_status(error);
-        if (error.value() == boost::system::errc::errc_t::broken_pipe) {
-          RAY_LOG(ERROR) << "Broken Pipe happened during calling "
-                         << "ServerConnection<T>::DoAsyncWrites.";
-          // From now on, calling DoAsyncWrites will directly call the handler
-          // with this broken-pipe status.
-          async_write_broken_pipe_ = true;
-        } else if (!status.ok()) {
-          RAY_LOG(ERROR) << "Error encountered during calling "
-                         << "ServerConnection<T>::DoAsyncWrites, message: "
-                         << status.message()
-                         << ", error code: " << static_cast<int>(error.value());
-        }
-        call_handlers(status, num_messages);
-      });
+  auto on_write_done = [this, this_ptr, num_messages, call_handlers](
+                           const boost::system::error_code &error) {
+    ray::Status status = boost_to_ray_status(error);
+    if (error.value() == boost::system::errc::errc_t::broken_pipe) {
+      RAY_LOG(ERROR) << "Broken Pipe happened during calling "
+                     << "ServerConnection<T>::DoAsyncWrites.";
+      // From now on, calling DoAsyncWrites will directly call the handler
+      // with this broken-pipe status.
+      async_write_broken_pipe_ = true;
+    } else if (!status.ok()) {
+      RAY_LOG(ERROR) << "Error encountered during calling "
+                     << "ServerConnection<T>::DoAsyncWrites, message: "
+                     << status.message()
+                     << ", error code: " << static_cast<int>(error.value());
+    }
+    call_handlers(status, num_messages);
+  };
+  if (handler_service_ == nullptr) {
+    boost::asio::async_write(
+        socket_, message_buffers,
+        [on_write_done](const boost::system::error_code &error,
+                        size_t bytes_transferred) { on_write_done(error); });
+    return;
+  }
+  // Write on the event loop of the socket, and handle the result on the event loop
+  // of the handlers. The buffers stay valid, because the queued messages are only
+  // popped by the handlers.
+  boost::asio::post(socket_.get_executor(), [this, this_ptr, message_buffers,
+                                             on_write_done]() {
+    boost::asio::async_write(
+        socket_, message_buffers,
+        [this, this_ptr, on_write_done](const boost::system::error_code &error,
+                                        size_t bytes_transferred) {
+          handler_service_->post([on_write_done, error]() { on_write_done(error); });
+        });
+  });
 }
 
 template <class T>
 std::shared_ptr<ClientConnection<T>> ClientConnection<T>::Create(
     ClientHandler<T> &client_handler, MessageHandler<T> &message_handler,
     boost::asio::basic_stream_socket<T> &&socket, const std::string &debug_label,
-    const std::vector<std::string> &message_type_enum_names, int64_t error_message_type) {
-  std::shared_ptr<ClientConnection<T>> self(
-      new ClientConnection(message_handler, std::move(socket), debug_label,
-                           message_type_enum_names, error_message_type));
+    const std::vector<std::string> &message_type_enum_names, int64_t error_message_type,
+    boost::asio::io_service *handler_service) {
+  std::shared_ptr<ClientConnection<T>> self(new ClientConnection(
+      message_handler, std::move(socket), debug_label, message_type_enum_names,
+      error_message_type, handler_service));
   // Let our manager process our new connection.
   client_handler(*self);
   return self;
@@ -206,8 +251,9 @@ template <class T>
 ClientConnection<T>::ClientConnection(
     MessageHandler<T> &message_handler, boost::asio::basic_stream_socket<T> &&socket,
     const std::string &debug_label,
-    const std::vector<std::string> &message_type_enum_names, int64_t error_message_type)
-    : ServerConnection<T>(std::move(socket)),
+    const std::vector<std::string> &message_type_enum_names, int64_t error_message_type,
+    boost::asio::io_service *handler_service)
+    : ServerConnection<T>(std::move(socket), handler_service),
       registered_(false),
       message_handler_(message_handler),
       debug_label_(debug_label),
@@ -222,6 +268,18 @@ void ClientConnection<T>::Register() {
 
 template <class T>
 void ClientConnection<T>::ProcessMessages() {
+  if (ServerConnection<T>::handler_service_ == nullptr) {
+    ReadMessageHeader();
+    return;
+  }
+  // Read the message on the event loop of the socket.
+  auto this_ptr = shared_ClientConnection_from_this();
+  boost::asio::post(ServerConnection<T>::socket_.get_executor(),
+                    [this_ptr]() { this_ptr->ReadMessageHeader(); });
+}
+
+template <class T>
+void ClientConnection<T>::ReadMessageHeader() {
   // Wait for a message header from the client. The message header includes the
   // protocol version, the message type, and the length of the message.
   std::vector<boost::asio::mutable_buffer> header;
@@ -308,6 +366,19 @@ void ClientConnection<T>::ProcessMessage(const boost::system::error_code &error)
     read_type_ = error_message_type_;
   }
 
+  if (ServerConnection<T>::handler_service_ == nullptr) {
+    HandleMessage();
+    return;
+  }
+  // The next message is not read until the handler calls ProcessMessages, so the
+  // message buffer stays valid until then.
+  auto this_ptr = shared_ClientConnection_from_this();
+  ServerConnection<T>::handler_service_->post(
+      [this_ptr]() { this_ptr->HandleMessage(); });
+}
+
+template <class T>
+void ClientConnection<T>::HandleMessage() {
   int64_t start_ms = current_time_ms();
   message_handler_(shared_ClientConnection_from_this(), read_type_, read_message_.data());
   int64_t interval = current_time_ms() - start_ms;
@@ -30,7 +30,9 @@ class ServerConnection : public std::enable_shared_from_this<ServerConnection<T>
   static std::shared_ptr<ServerConnection<T>> Create(
       boost::asio::basic_stream_socket<T> &&socket);
 
-  /// Write a message to the client.
+  /// Write a message to the client. If the socket is read and written on its own
+  /// event loop, the message is queued behind the async writes instead, and write
+  /// errors are only logged.
   ///
   /// \param type The message type (e.g., a flatbuffer enum).
   /// \param length The size in bytes of the message.
@@ -59,17 +61,16 @@ class ServerConnection : public std::enable_shared_from_this<ServerConnection<T>
   /// \return Status.
   Status ReadBuffer(const std::vector<boost::asio::mutable_buffer> &buffer);
 
-  /// Shuts down socket for this connection.
-  void Close() {
-    boost::system::error_code ec;
-    socket_.close(ec);
-  }
+  /// Shuts down socket for this connection. If the socket is read and written on
+  /// its own event loop, it is closed on that event loop.
+  void Close();
 
   std::string DebugString() const;
 
  protected:
   /// A private constructor for a server connection.
-  ServerConnection(boost::asio::basic_stream_socket<T> &&socket);
+  ServerConnection(boost::asio::basic_stream_socket<T> &&socket,
+                   boost::asio::io_service *handler_service = nullptr);
 
   /// A message that is queued for writing asynchronously.
   struct AsyncWriteBuffer {
@@ -83,6 +84,10 @@ class ServerConnection : public std::enable_shared_from_this<ServerConnection<T>
   /// The socket connection to the server.
   boost::asio::basic_stream_socket<T> socket_;
 
+  /// The event loop to run handlers on, or nullptr to run them on the event
+  /// loop of the socket.
+  boost::asio::io_service *handler_service_;
+
   /// Max number of messages to write out at once.
   const int async_write_max_messages_;
 
@@ -142,12 +147,15 @@ class ClientConnection : public ServerConnection<T> {
   /// the type of client.
   /// \param message_type_enum_names A table of printable enum names for the
   /// message types received from this client, used for debug messages.
+  /// \param handler_service If not nullptr, the event loop to run the message
+  /// and write handlers on. The socket is then read and written on its own event
+  /// loop, which may run on another thread.
   /// \return std::shared_ptr<ClientConnection>.
   static std::shared_ptr<ClientConnection<T>> Create(
       ClientHandler<T> &new_client_handler, MessageHandler<T> &message_handler,
       boost::asio::basic_stream_socket<T> &&socket, const std::string &debug_label,
       const std::vector<std::string> &message_type_enum_names,
-      int64_t error_message_type);
+      int64_t error_message_type, boost::asio::io_service *handler_service = nullptr);
 
   std::shared_ptr<ClientConnection<T>> shared_ClientConnection_from_this() {
     return std::static_pointer_cast<ClientConnection<T>>(shared_from_this());
@@ -167,13 +175,17 @@ class ClientConnection : public ServerConnection<T> {
                    boost::asio::basic_stream_socket<T> &&socket,
                    const std::string &debug_label,
                    const std::vector<std::string> &message_type_enum_names,
-                   int64_t error_message_type);
+                   int64_t error_message_type, boost::asio::io_service *handler_service);
+  /// Start reading the next message header from the client.
+  void ReadMessageHeader();
   /// Process an error from the last operation, then process the  message
   /// header from the client.
   void ProcessMessageHeader(const boost::system::error_code &error);
   /// Process an error from reading the message header, then process the
   /// message from the client.
   void ProcessMessage(const boost::system::error_code &error);
+  /// Call the message handler on the message that was read.
+  void HandleMessage();
   /// Check if the ray cookie in a received message is correct. Note, if the cookie
   /// is wrong and the remote endpoint is known, raylet process will crash. If the remote
   /// endpoint is unknown, this method will only print a warning.
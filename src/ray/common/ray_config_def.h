@@ -44,11 +44,65 @@ RAY_CONFIG(bool, fair_queueing_enabled, true)
 /// enabled, objects in scope in the cluster will not be LRU evicted.
 RAY_CONFIG(bool, object_pinning_enabled, true)
 
+/// Whether to spill pinned objects to local disk when they fill up the object
+/// store, so that they can be evicted and later restored instead of being
+/// reconstructed. This only has an effect if object pinning is enabled.
+RAY_CONFIG(bool, object_spilling_enabled, false)
+
+/// The directory to spill objects to. If empty, objects are spilled to the
+/// session directory.
+RAY_CONFIG(std::string, object_spilling_directory, "")
+
+/// Pinned objects are spilled, least recently pinned first, once they take up
+/// more than this percentage of the object store memory.
+RAY_CONFIG(int64_t, object_spilling_threshold_percent, 80)
+
+/// The size of the blocks in which spilled objects are written and read.
+RAY_CONFIG(uint64_t, object_spilling_io_block_size, 4 * 1024 * 1024)
+
 /// Whether to enable the new scheduler. The new scheduler is designed
 /// only to work with  direct calls. Once direct calls afre becoming
 /// the default, this scheduler will also become the default.
 RAY_CONFIG(bool, new_scheduler_enabled, false)
 
+/// The maximum number of resource shapes, i.e., distinct placement resource
+/// demands, that the scheduling policy indexes the cluster's nodes by. Every node
+/// update is applied to each indexed shape, and the least recently used shape is
+/// dropped when a new one exceeds this number.
+RAY_CONFIG(uint64_t, max_indexed_resource_shapes, 64)
+
+/// Whether to place the tasks submitted to a raylet in batches. If enabled, the tasks
+/// submitted in the same iteration of the event loop are placed together, and the
+/// tasks placed on the same remote node are forwarded in a single request.
+RAY_CONFIG(bool, batch_placement_enabled, false)
+
+/// The maximum number of tasks to forward to a remote node in a single request.
+RAY_CONFIG(uint64_t, max_tasks_per_forward_batch, 1000)
+
+/// Whether the scheduling policy places a task on the node that holds the most
+/// bytes of its arguments, if that node has the resources for it, instead of
+/// spreading tasks by free resources.
+RAY_CONFIG(bool, locality_aware_scheduling_enabled, false)
+
+/// The minimum bytes of a task's arguments that a node must hold for the task to be
+/// placed there by locality.
+RAY_CONFIG(uint64_t, locality_aware_scheduling_min_bytes, 1024 * 1024)
+
+/// Whether a raylet with no ready tasks asks loaded peers to hand over ready tasks
+/// that fit its available resources.
+RAY_CONFIG(bool, work_stealing_enabled, false)
+
+/// The maximum number of tasks that a raylet steals from a peer in one request.
+RAY_CONFIG(uint64_t, work_stealing_max_tasks, 10)
+
+/// The minimum time in milliseconds between two requests to steal tasks.
+RAY_CONFIG(uint64_t, work_stealing_min_interval_ms, 10)
+
+/// The number of threads that read and write the connections of local clients. The
+/// messages are still handled on the main event loop of the raylet. If 0, the
+/// connections are read and written on the main event loop.
+RAY_CONFIG(uint64_t, raylet_client_io_threads, 0)
+
 // The max allowed size in bytes of a return object from direct actor calls.
 // Objects larger than this size will be spilled/promoted to plasma.
 RAY_CONFIG(int64_t, max_direct_call_object_size, 100 * 1024)
@@ -67,6 +121,21 @@ RAY_CONFIG(int64_t, initial_reconstruction_timeout_milliseconds, 10000)
 /// for direct task submission until it must be returned to the raylet.
 RAY_CONFIG(int64_t, worker_lease_timeout_milliseconds, 500)
 
+/// The maximum number of worker lease requests that a worker keeps in flight for
+/// one kind of task. Fewer requests are sent if fewer tasks of that kind are
+/// queued.
+RAY_CONFIG(int64_t, max_pending_lease_requests_per_scheduling_key, 10)
+
+/// The maximum number of tasks that a worker pushes to a leased worker without
+/// waiting for their replies. Higher values hide the round trip between short
+/// tasks, but spread the queued tasks over fewer workers.
+RAY_CONFIG(int64_t, max_tasks_in_flight_per_worker, 1)
+
+/// Whether a worker hands a leased worker to the queued tasks of another scheduling
+/// key with the same scheduling class before it returns the worker to the raylet.
+/// Such tasks only differ in their plasma dependencies.
+RAY_CONFIG(bool, worker_lease_sharing_enabled, false)
+
 /// The interval at which the workers will check if their raylet has gone down.
 /// When this happens, they will kill themselves.
 RAY_CONFIG(int64_t, raylet_death_check_interval_milliseconds, 1000)
@@ -167,6 +236,83 @@ RAY_CONFIG(int, object_manager_repeated_push_delay_ms, 60000)
 /// chunks exceeds the number of available sending threads.
 RAY_CONFIG(uint64_t, object_manager_default_chunk_size, 1000000)
 
+/// Whether to choose the chunk size of each object push from the object size and
+/// the bandwidth measured to the receiving node, rather than always using
+/// object_manager_default_chunk_size. Objects pulled in stripes from several
+/// nodes always use the default chunk size, so that the stripes line up.
+RAY_CONFIG(bool, object_manager_autotune_chunk_size, false)
+
+/// The smallest and largest chunk sizes chosen when autotuning the chunk size.
+RAY_CONFIG(uint64_t, object_manager_min_chunk_size, 256 * 1024)
+RAY_CONFIG(uint64_t, object_manager_max_chunk_size, 16 * 1024 * 1024)
+
+/// When autotuning the chunk size, chunks are sized to take about this long to
+/// transfer at the bandwidth measured to the receiving node.
+RAY_CONFIG(int64_t, object_manager_chunk_target_transfer_ms, 20)
+
+/// When autotuning the chunk size, objects are split into at most this many
+/// chunks, unless that exceeds object_manager_max_chunk_size.
+RAY_CONFIG(uint64_t, object_manager_max_chunks_per_object, 256)
+
+/// The initial number of object chunks that the object manager keeps in flight
+/// to a single remote object manager. The window then adapts to the observed
+/// round trip times of the chunks.
+RAY_CONFIG(int64_t, object_manager_push_initial_window_chunks, 4)
+
+/// The maximum number of object chunks that the object manager keeps in flight
+/// to a single remote object manager.
+RAY_CONFIG(int64_t, object_manager_push_max_window_chunks, 64)
+
+/// The maximum number of objects that the object manager pulls at once. Further
+/// pull requests are queued, and admitted by priority: task arguments first, then
+/// objects in ray.get, then objects in ray.wait, then prefetches. Pulls are also
+/// only admitted while the objects being pulled fit into the object store memory
+/// that isn't pinned. A value of 0 only bounds pulls by memory.
+RAY_CONFIG(int64_t, object_manager_max_active_pulls, 0)
+
+/// The maximum number of remote object managers that a single object is
+/// pulled from in parallel. If an object is available on several nodes, each
+/// of them is asked to push a disjoint stripe of the object's chunks. A value
+/// of 1 pulls every object from a single node.
+RAY_CONFIG(uint32_t, object_manager_max_pull_sources, 1)
+
+/// The maximum number of nodes an object manager sends the same object to at
+/// once. Further nodes pulling the object are redirected to one of those
+/// receivers, which relays the chunks as it receives them, so that an object
+/// pulled by many nodes is broadcast along a tree. A value of 0 disables this.
+RAY_CONFIG(uint32_t, object_manager_broadcast_fanout, 0)
+
+/// The codec used to compress object chunks sent to other nodes: "lz4", "zstd"
+/// or "none". A chunk is only compressed if the receiving node listed the codec
+/// in its pull requests.
+RAY_CONFIG(std::string, object_manager_compression_codec, "none")
+
+/// Object chunks smaller than this are sent uncompressed.
+RAY_CONFIG(uint64_t, object_manager_compression_min_chunk_size, 16 * 1024)
+
+/// Compressed object chunks larger than this percentage of their uncompressed
+/// size are sent uncompressed, since compression doesn't pay off for them.
+RAY_CONFIG(int64_t, object_manager_compression_max_ratio_percent, 90)
+
+/// Whether raylets send heartbeats as deltas that only hold the resources whose
+/// capacity changed since the previous heartbeat, referring to resources by
+/// interned IDs instead of labels.
+RAY_CONFIG(bool, delta_heartbeats_enabled, false)
+
+/// If delta heartbeats are enabled, every this many heartbeats is a full snapshot
+/// of the node's resources, which lets new listeners catch up.
+RAY_CONFIG(uint64_t, num_heartbeats_per_resource_snapshot, 20)
+
+/// The object directory sends the object locations added and removed on a node
+/// to the GCS in batches, once every this many milliseconds. Only the latest
+/// update of each location in a batch is sent. A value of 0 sends the updates
+/// on the next iteration of the event loop, which still batches bursts.
+RAY_CONFIG(int64_t, object_directory_update_batch_interval_ms, 0)
+
+/// A batch of object location updates is sent right away once it holds this
+/// many updates.
+RAY_CONFIG(uint64_t, object_directory_max_update_batch_size, 10000)
+
 /// Number of workers per Python worker process
 RAY_CONFIG(int, num_workers_per_process_python, 1)
 
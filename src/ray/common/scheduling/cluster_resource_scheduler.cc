@@ -1,5 +1,61 @@
 #include "cluster_resource_scheduler.h"
 
+#include <algorithm>
+#include <tuple>
+
+namespace {
+
+/// The number of violations that a hard constraint counts for, so that a node that
+/// violates a hard constraint has more violations than any node that doesn't.
+constexpr int64_t kHardViolation = static_cast<int64_t>(1) << 40;
+
+/// Add the violations of a resource request to the violation counts of the nodes,
+/// given the available quantity of the resource at each node. The loop has no
+/// branches so that the compiler can vectorize it.
+inline void CountViolations(const ResourceRequest &request, const int64_t *available,
+                            size_t num_nodes, int64_t *violations) {
+  const int64_t demand = request.demand;
+  const int64_t weight = request.soft ? 1 : kHardViolation;
+  for (size_t i = 0; i < num_nodes; i++) {
+    violations[i] += static_cast<int64_t>(available[i] < demand) * weight;
+  }
+}
+
+/// Add the same number of violations to all nodes.
+inline void AddViolations(int64_t weight, size_t num_nodes, int64_t *violations) {
+  for (size_t i = 0; i < num_nodes; i++) {
+    violations[i] += weight;
+  }
+}
+
+/// Return a key that is equal for task requests that ask for the same resources
+/// with the same placement hints.
+std::vector<int64_t> TaskRequestShape(const TaskRequest &task_req) {
+  std::vector<int64_t> shape;
+  for (const auto &request : task_req.predefined_resources) {
+    shape.push_back(request.demand);
+    shape.push_back(request.soft);
+  }
+  std::vector<std::tuple<int64_t, int64_t, bool>> custom_resources;
+  for (const auto &request : task_req.custom_resources) {
+    custom_resources.emplace_back(request.id, request.req.demand, request.req.soft);
+  }
+  std::sort(custom_resources.begin(), custom_resources.end());
+  shape.push_back(custom_resources.size());
+  for (const auto &request : custom_resources) {
+    shape.push_back(std::get<0>(request));
+    shape.push_back(std::get<1>(request));
+    shape.push_back(std::get<2>(request));
+  }
+  std::vector<int64_t> placement_hints(task_req.placement_hints.begin(),
+                                       task_req.placement_hints.end());
+  std::sort(placement_hints.begin(), placement_hints.end());
+  shape.insert(shape.end(), placement_hints.begin(), placement_hints.end());
+  return shape;
+}
+
+}  // namespace
+
 std::string NodeResources::DebugString() {
   std::stringstream buffer;
   buffer << "  node predefined resources {";
@@ -112,13 +168,88 @@ void ClusterResourceScheduler::AddOrUpdateNode(int64_t node_id,
   auto it = nodes_.find(node_id);
   if (it == nodes_.end()) {
     // This node is new, so add it to the map.
-    nodes_.emplace(node_id, node_resources);
+    it = nodes_.emplace(node_id, node_resources).first;
   } else {
     // This node exists, so update its resources.
     NodeResources &resources = it->second;
     SetPredefinedResources(node_resources, &resources);
     SetCustomResources(node_resources.custom_resources, &resources.custom_resources);
   }
+  UpdateNodeSlot(node_id, it->second);
+}
+
+void ClusterResourceScheduler::UpdateNodeSlot(int64_t node_id,
+                                              const NodeResources &resources) {
+  size_t slot;
+  auto it = node_slots_.find(node_id);
+  if (it == node_slots_.end()) {
+    slot = slot_node_ids_.size();
+    node_slots_.emplace(node_id, slot);
+    slot_node_ids_.push_back(node_id);
+    for (auto &available : predefined_available_) {
+      available.push_back(0);
+    }
+    slot_custom_ids_.emplace_back();
+  } else {
+    slot = it->second;
+  }
+
+  for (size_t i = 0; i < PredefinedResources_MAX; i++) {
+    predefined_available_[i][slot] = resources.capacities[i].available;
+  }
+  // Drop the custom resources that the node no longer has.
+  for (int64_t resource_id : slot_custom_ids_[slot]) {
+    if (resources.custom_resources.count(resource_id) == 0) {
+      auto column_it = custom_available_.find(resource_id);
+      column_it->second.erase(slot);
+      if (column_it->second.empty()) {
+        custom_available_.erase(column_it);
+      }
+    }
+  }
+  slot_custom_ids_[slot].clear();
+  for (const auto &resource : resources.custom_resources) {
+    custom_available_[resource.first][slot] = resource.second.available;
+    slot_custom_ids_[slot].push_back(resource.first);
+  }
+}
+
+void ClusterResourceScheduler::RemoveNodeSlot(int64_t node_id) {
+  auto it = node_slots_.find(node_id);
+  if (it == node_slots_.end()) {
+    return;
+  }
+  const size_t slot = it->second;
+  node_slots_.erase(it);
+  for (int64_t resource_id : slot_custom_ids_[slot]) {
+    auto column_it = custom_available_.find(resource_id);
+    column_it->second.erase(slot);
+    if (column_it->second.empty()) {
+      custom_available_.erase(column_it);
+    }
+  }
+
+  // Move the last node into the freed position to keep the arrays dense.
+  const size_t last_slot = slot_node_ids_.size() - 1;
+  if (slot != last_slot) {
+    const int64_t last_node_id = slot_node_ids_[last_slot];
+    slot_node_ids_[slot] = last_node_id;
+    node_slots_[last_node_id] = slot;
+    for (auto &available : predefined_available_) {
+      available[slot] = available[last_slot];
+    }
+    for (int64_t resource_id : slot_custom_ids_[last_slot]) {
+      auto &column = custom_available_[resource_id];
+      column[slot] = column[last_slot];
+      column.erase(last_slot);
+    }
+    slot_custom_ids_[slot] = std::move(slot_custom_ids_[last_slot]);
+  }
+  slot_node_ids_.pop_back();
+  for (auto &available : predefined_available_) {
+    available.pop_back();
+  }
+  slot_custom_ids_.pop_back();
 }
 
 bool ClusterResourceScheduler::RemoveNode(int64_t node_id) {
@@ -129,6 +260,7 @@ bool ClusterResourceScheduler::RemoveNode(int64_t node_id) {
   } else {
     it->second.custom_resources.clear();
     nodes_.erase(it);
+    RemoveNodeSlot(node_id);
     string_to_int_map_.Remove(node_id);
     return true;
   }
@@ -215,23 +347,49 @@ int64_t ClusterResourceScheduler::GetBestSchedulableNode(const TaskRequest &task
     }
   }
 
-  for (auto it = nodes_.begin(); it != nodes_.end(); ++it) {
-    // Return -1 if node not schedulable. otherwise return the number
-    // of soft constraint violations.
-    int64_t violations;
-
-    if ((violations = IsSchedulable(task_req, it->first, it->second)) == -1) {
-      continue;
+  // Count the violations of all nodes one constraint at a time. This gives the same
+  // counts as IsSchedulable, where a hard constraint violation counts for
+  // kHardViolation.
+  const size_t num_nodes = slot_node_ids_.size();
+  violations_.assign(num_nodes, 0);
+  int64_t *violations = violations_.data();
+  for (size_t i = 0; i < PredefinedResources_MAX; i++) {
+    CountViolations(task_req.predefined_resources[i], predefined_available_[i].data(),
+                    num_nodes, violations);
+  }
+  for (const auto &request : task_req.custom_resources) {
+    // Every node violates the constraint, except for the nodes that have enough of
+    // the resource.
+    const int64_t weight = request.req.soft ? 1 : kHardViolation;
+    AddViolations(weight, num_nodes, violations);
+    auto column_it = custom_available_.find(request.id);
+    if (column_it != custom_available_.end()) {
+      for (const auto &entry : column_it->second) {
+        if (entry.second >= request.req.demand) {
+          violations[entry.first] -= weight;
+        }
+      }
     }
-
-    // Update the node with the smallest number of soft constraints violated.
-    if (min_violations > violations) {
-      min_violations = violations;
-      best_node = it->first;
+  }
+  if (!task_req.placement_hints.empty()) {
+    // Nodes that are not in the placement hints violate a soft constraint.
+    AddViolations(1, num_nodes, violations);
+    for (int64_t node_id : task_req.placement_hints) {
+      auto slot_it = node_slots_.find(node_id);
+      if (slot_it != node_slots_.end()) {
+        violations[slot_it->second]--;
+      }
     }
-    if (violations == 0) {
-      *total_violations = 0;
-      return best_node;
+  }
+
+  // Find the node with the smallest number of soft constraints violated.
+  for (size_t slot = 0; slot < num_nodes; slot++) {
+    if (violations[slot] < min_violations && violations[slot] < kHardViolation) {
+      min_violations = violations[slot];
+      best_node = slot_node_ids_[slot];
+      if (min_violations == 0) {
+        break;
+      }
     }
   }
   *total_violations = min_violations;
@@ -252,6 +410,51 @@ std::string ClusterResourceScheduler::GetBestSchedulableNode(
   return string_to_int_map_.Get(node_id);
 }
 
+int64_t ClusterResourceScheduler::GetBestSchedulableNodes(
+    const std::vector<TaskRequest> &task_requests, std::vector<int64_t> *node_ids) {
+  // The node that the last request of each shape was assigned to, and its number of
+  // violations, or -1 if no node can schedule requests of that shape.
+  absl::flat_hash_map<std::vector<int64_t>, std::pair<int64_t, int64_t>> best_nodes;
+  int64_t num_scheduled = 0;
+  node_ids->assign(task_requests.size(), -1);
+
+  for (size_t i = 0; i < task_requests.size(); i++) {
+    const TaskRequest &task_req = task_requests[i];
+    auto inserted = best_nodes.emplace(TaskRequestShape(task_req),
+                                       std::make_pair(static_cast<int64_t>(-1), 0));
+    auto &best_node = inserted.first->second;
+    bool search = inserted.second;
+    if (!search) {
+      if (best_node.first == -1) {
+        // Resources are only taken during the batch, so a request that couldn't be
+        // scheduled earlier still can't be.
+        continue;
+      }
+      // The other nodes can only have lost resources since the last request of
+      // this shape, so the node it went to is still a best node if it doesn't
+      // violate more constraints than before.
+      auto it = nodes_.find(best_node.first);
+      search = it == nodes_.end() ||
+               IsSchedulable(task_req, it->first, it->second) != best_node.second;
+    }
+    if (search) {
+      best_node.first = GetBestSchedulableNode(task_req, &best_node.second);
+      if (best_node.first == -1) {
+        continue;
+      }
+    }
+
+    RAY_CHECK(SubtractNodeAvailableResources(best_node.first, task_req));
+    (*node_ids)[i] = best_node.first;
+    num_scheduled++;
+  }
+  return num_scheduled;
+}
+
+std::string ClusterResourceScheduler::GetNodeIdString(int64_t node_id) {
+  return string_to_int_map_.Get(node_id);
+}
+
 bool ClusterResourceScheduler::SubtractNodeAvailableResources(
     int64_t node_id, const TaskRequest &task_req) {
   auto it = nodes_.find(node_id);
@@ -279,6 +482,7 @@ bool ClusterResourceScheduler::SubtractNodeAvailableResources(
                    it->second.available - task_req.custom_resources[i].req.demand);
     }
   }
+  UpdateNodeSlot(node_id, resources);
   return true;
 }
 
@@ -310,6 +514,7 @@ bool ClusterResourceScheduler::AddNodeAvailableResources(int64_t node_id,
           it->second.available + task_req.custom_resources[i].req.demand;
     }
   }
+  UpdateNodeSlot(node_id, resources);
   return true;
 }
 
@@ -399,6 +604,31 @@ void ClusterResourceScheduler::ResourceMapToTaskRequest(
   task_request->custom_resources.resize(i);
 }
 
+void ClusterResourceScheduler::ResourceSetToTaskRequest(
+    const ray::ResourceSet &resource_set, TaskRequest *task_request) {
+  // The predefined resources, in order of their IDs in a resource set.
+  static const PredefinedResources predefined_resources[ray::kNumPredefinedResources] =
+      {CPU, GPU, TPU, MEM};
+
+  task_request->predefined_resources.assign(PredefinedResources_MAX, {0, false});
+  task_request->custom_resources.clear();
+  resource_set.ForEachResource(
+      [this, task_request](int64_t resource_id,
+                           ray::FractionalResourceQuantity quantity) {
+        if (resource_id < ray::kNumPredefinedResources) {
+          task_request->predefined_resources[predefined_resources[resource_id]].demand =
+              quantity.ToDouble();
+          return;
+        }
+        ResourceRequestWithId custom_resource;
+        custom_resource.id =
+            string_to_int_map_.Insert(ray::ResourceSet::GetResourceLabel(resource_id));
+        custom_resource.req.demand = quantity.ToDouble();
+        custom_resource.req.soft = false;
+        task_request->custom_resources.push_back(custom_resource);
+      });
+}
+
 void ClusterResourceScheduler::UpdateResourceCapacity(const std::string &client_id_string,
                                                       const std::string &resource_name,
                                                       int64_t resource_total) {
@@ -446,6 +676,7 @@ void ClusterResourceScheduler::UpdateResourceCapacity(const std::string &client_
     resource_capacity.total = resource_capacity.available = resource_total;
     it->second.custom_resources.emplace(resource_id, resource_capacity);
   }
+  UpdateNodeSlot(client_id, it->second);
 }
 
 void ClusterResourceScheduler::DeleteResource(const std::string &client_id_string,
@@ -476,6 +707,7 @@ void ClusterResourceScheduler::DeleteResource(const std::string &client_id_strin
       it->second.custom_resources.erase(itr);
     }
   }
+  UpdateNodeSlot(client_id, it->second);
 }
 
 std::string ClusterResourceScheduler::DebugString(void) {
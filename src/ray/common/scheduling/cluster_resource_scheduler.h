@@ -7,6 +7,7 @@
 #include "ray/common/task/scheduling_resources.h"
 #include "ray/util/logging.h"
 
+#include <array>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -76,6 +77,39 @@ class ClusterResourceScheduler {
   /// to integer representation. Used for improving map performance.
   StringIdMap string_to_int_map_;
 
+  /// The available resources of the nodes, laid out as one array per resource with
+  /// an entry per node, so that GetBestSchedulableNode checks a task request against
+  /// all nodes in a few tight loops that the compiler can vectorize. This mirrors
+  /// the available resources in nodes_.
+  ///
+  /// The ID of the node at each position of the arrays.
+  std::vector<int64_t> slot_node_ids_;
+  /// Map from node ID to the position of the node in the arrays.
+  absl::flat_hash_map<int64_t, size_t> node_slots_;
+  /// The available quantity of each predefined resource at each node.
+  std::array<std::vector<int64_t>, PredefinedResources_MAX> predefined_available_;
+  /// The available quantity of each custom resource at the nodes that have it. Most
+  /// custom resources are only on a few nodes, so these are kept sparse. The key is
+  /// the custom resource ID, and the inner key is the position of the node.
+  absl::flat_hash_map<int64_t, absl::flat_hash_map<size_t, int64_t>> custom_available_;
+  /// The IDs of the custom resources of the node at each position.
+  std::vector<std::vector<int64_t>> slot_custom_ids_;
+  /// The number of constraint violations of each node for the task request that is
+  /// being scheduled. Kept across calls to avoid reallocating it.
+  std::vector<int64_t> violations_;
+
+  /// Copy the available resources of a node into the arrays, adding the node if
+  /// it's new.
+  ///
+  /// \param node_id: ID of the node.
+  /// \param resources: The resources of the node.
+  void UpdateNodeSlot(int64_t node_id, const NodeResources &resources);
+
+  /// Remove a node from the arrays.
+  ///
+  /// \param node_id: ID of the node.
+  void RemoveNodeSlot(int64_t node_id);
+
   /// Set predefined resources.
   ///
   /// \param[in] new_resources: New predefined resources.
@@ -175,6 +209,26 @@ class ClusterResourceScheduler {
   std::string GetBestSchedulableNode(
       const std::unordered_map<std::string, double> &task_request, int64_t *violations);
 
+  ///  Find nodes for a batch of task requests, in order. The resources of each
+  ///  request are subtracted from the node it is assigned to, so that later
+  ///  requests in the batch see them as used. Identical requests are grouped, so
+  ///  that the cluster is searched about once per distinct request rather than once
+  ///  per task.
+  ///
+  ///  \param task_requests: Tasks to be scheduled.
+  ///  \param node_ids: Return the ID of the node assigned to each request, or -1 if
+  ///                   no node can schedule the request.
+  ///
+  ///  \return The number of requests that were assigned a node.
+  int64_t GetBestSchedulableNodes(const std::vector<TaskRequest> &task_requests,
+                                  std::vector<int64_t> *node_ids);
+
+  /// Return the ID in string format of the node with the given ID.
+  std::string GetNodeIdString(int64_t node_id);
+
+  /// Return the ID of the local node.
+  int64_t GetLocalNodeId() const { return local_node_id_; }
+
   /// Decrease the available resources of a node when a task request is
   /// scheduled on the given node.
   ///
@@ -213,6 +267,12 @@ class ClusterResourceScheduler {
       const std::unordered_map<std::string, double> &resource_map,
       TaskRequest *task_request);
 
+  /// Convert a resource set to a TaskRequest data structure. Unlike
+  /// ResourceMapToTaskRequest, this doesn't build a map of the resources, and only
+  /// looks up the labels of custom resources.
+  void ResourceSetToTaskRequest(const ray::ResourceSet &resource_set,
+                                TaskRequest *task_request);
+
   /// Convert a map of resources to a TaskRequest data structure.
   void ResourceMapToNodeResources(
       const std::unordered_map<std::string, double> &resource_map_total,
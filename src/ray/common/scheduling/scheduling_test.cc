@@ -1,13 +1,13 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#include <chrono>
 #include <string>
 
 #include "ray/common/scheduling/cluster_resource_scheduler.h"
 #include "ray/common/scheduling/scheduling_ids.h"
 
 #ifdef UNORDERED_VS_ABSL_MAPS_EVALUATION
-#include <chrono>
 #include "absl/container/flat_hash_map.h"
 #endif  // UNORDERED_VS_ABSL_MAPS_EVALUATION
 
@@ -140,6 +140,119 @@ bool nodeResourcesEqual(const NodeResources &nr1, const NodeResources &nr2) {
   return true;
 }
 
+/// Check that GetBestSchedulableNode finds a node with the fewest violations, as
+/// found by checking every node in turn with IsSchedulable, in a random cluster.
+void checkBestSchedulableNode(int num_nodes, int num_requests, bool print_throughput) {
+  const int num_custom_ids = 100;
+  NodeResources local_resources;
+  initNodeResources(local_resources, EmptyIntVector, EmptyIntVector, EmptyIntVector);
+  ClusterResourceScheduler cluster_resources(0, local_resources);
+  srand(1);
+
+  for (int i = 1; i <= num_nodes; i++) {
+    vector<int64_t> pred_capacities;
+    for (int k = 0; k < PredefinedResources_MAX; k++) {
+      pred_capacities.push_back(rand() % 3 == 0 ? 0 : rand() % 10);
+    }
+    vector<int64_t> cust_ids;
+    vector<int64_t> cust_capacities;
+    for (int k = 0; k < rand() % 3; k++) {
+      cust_ids.push_back(rand() % num_custom_ids);
+      cust_capacities.push_back(rand() % 10);
+    }
+    NodeResources node_resources;
+    initNodeResources(node_resources, pred_capacities, cust_ids, cust_capacities);
+    cluster_resources.AddOrUpdateNode(i, node_resources);
+  }
+  // Remove some nodes, so that the remaining ones move within the arrays.
+  for (int i = 1; i <= num_nodes; i += 97) {
+    cluster_resources.RemoveNode(i);
+  }
+
+  vector<TaskRequest> task_requests;
+  for (int i = 0; i < num_requests; i++) {
+    vector<int64_t> pred_demands = {rand() % 10, rand() % 10};
+    vector<bool> pred_soft = {false, rand() % 4 == 0};
+    vector<int64_t> cust_ids;
+    vector<int64_t> cust_demands;
+    vector<bool> cust_soft;
+    if (rand() % 2 == 0) {
+      cust_ids.push_back(rand() % num_custom_ids);
+      cust_demands.push_back(rand() % 5);
+      cust_soft.push_back(rand() % 2 == 0);
+    }
+    vector<int64_t> placement_hints;
+    if (rand() % 4 == 0) {
+      placement_hints.push_back(rand() % num_nodes + 1);
+    }
+    TaskRequest task_req;
+    initTaskRequest(task_req, pred_demands, pred_soft, cust_ids, cust_demands,
+                    cust_soft, placement_hints);
+    task_requests.push_back(task_req);
+  }
+
+  // Find the best node by checking every node in turn, as a baseline.
+  vector<int64_t> expected_violations;
+  auto t_start = std::chrono::high_resolution_clock::now();
+  for (const auto &task_req : task_requests) {
+    int64_t min_violations = INT_MAX;
+    for (int64_t node_id = 0; node_id <= num_nodes; node_id++) {
+      NodeResources resources;
+      if (cluster_resources.GetNodeResources(node_id, &resources)) {
+        int64_t violations =
+            cluster_resources.IsSchedulable(task_req, node_id, resources);
+        if (violations != -1 && violations < min_violations) {
+          min_violations = violations;
+        }
+      }
+    }
+    expected_violations.push_back(min_violations);
+  }
+  auto t_end = std::chrono::high_resolution_clock::now();
+  double baseline_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+
+  vector<int64_t> best_nodes;
+  vector<int64_t> total_violations(num_requests);
+  t_start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < num_requests; i++) {
+    best_nodes.push_back(
+        cluster_resources.GetBestSchedulableNode(task_requests[i], &total_violations[i]));
+  }
+  t_end = std::chrono::high_resolution_clock::now();
+  double duration_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+  if (print_throughput) {
+    cout << "Scheduled " << num_requests << " requests on " << num_nodes
+         << " nodes: per-node checks " << num_requests / baseline_ms * 1000
+         << " requests/s, GetBestSchedulableNode " << num_requests / duration_ms * 1000
+         << " requests/s" << endl;
+  }
+
+  for (int i = 0; i < num_requests; i++) {
+    if (expected_violations[i] == INT_MAX) {
+      ASSERT_EQ(best_nodes[i], -1);
+      continue;
+    }
+    ASSERT_EQ(total_violations[i], expected_violations[i]);
+    NodeResources resources;
+    ASSERT_TRUE(cluster_resources.GetNodeResources(best_nodes[i], &resources));
+    ASSERT_EQ(cluster_resources.IsSchedulable(task_requests[i], best_nodes[i], resources),
+              expected_violations[i]);
+  }
+
+  // The arrays follow the available resources as tasks are placed.
+  for (const auto &task_req : task_requests) {
+    int64_t violations;
+    int64_t node_id = cluster_resources.GetBestSchedulableNode(task_req, &violations);
+    if (node_id == -1) {
+      continue;
+    }
+    NodeResources resources;
+    ASSERT_TRUE(cluster_resources.GetNodeResources(node_id, &resources));
+    ASSERT_EQ(cluster_resources.IsSchedulable(task_req, node_id, resources), violations);
+    ASSERT_TRUE(cluster_resources.SubtractNodeAvailableResources(node_id, task_req));
+  }
+}
+
 namespace ray {
 
 class SchedulingTest : public ::testing::Test {
@@ -483,7 +596,119 @@ TEST_F(SchedulingTest, SchedulingTaskRequestTest) {
   }
 }
 
+TEST_F(SchedulingTest, SchedulingBestNodeTest) {
+  checkBestSchedulableNode(/*num_nodes=*/300, /*num_requests=*/300,
+                           /*print_throughput=*/false);
+}
+
+TEST_F(SchedulingTest, SchedulingBatchTest) {
+  NodeResources local_resources;
+  vector<int64_t> local_capacities = {4};
+  initNodeResources(local_resources, local_capacities, EmptyIntVector, EmptyIntVector);
+  ClusterResourceScheduler cluster_resources(0, local_resources);
+  {
+    NodeResources node_resources;
+    vector<int64_t> pred_capacities = {2, 0, 1};
+    initNodeResources(node_resources, pred_capacities, EmptyIntVector, EmptyIntVector);
+    cluster_resources.AddOrUpdateNode(1, node_resources);
+  }
+  {
+    NodeResources node_resources;
+    vector<int64_t> pred_capacities = {8};
+    vector<int64_t> cust_ids = {5};
+    vector<int64_t> cust_capacities = {2};
+    initNodeResources(node_resources, pred_capacities, cust_ids, cust_capacities);
+    cluster_resources.AddOrUpdateNode(2, node_resources);
+  }
+
+  vector<TaskRequest> task_requests;
+  auto add_requests = [&task_requests](int num_requests, vector<int64_t> pred_demands,
+                                       vector<int64_t> cust_ids,
+                                       vector<int64_t> cust_demands) {
+    vector<bool> pred_soft(pred_demands.size(), false);
+    vector<bool> cust_soft(cust_ids.size(), false);
+    for (int i = 0; i < num_requests; i++) {
+      TaskRequest task_req;
+      initTaskRequest(task_req, pred_demands, pred_soft, cust_ids, cust_demands,
+                      cust_soft, EmptyIntVector);
+      task_requests.push_back(task_req);
+    }
+  };
+  // 16 CPU tasks, of which 14 fit.
+  add_requests(16, {1}, {}, {});
+  // 3 GPU tasks, of which 1 fits.
+  add_requests(3, {0, 0, 1}, {}, {});
+  // 3 custom resource tasks, of which 2 fit.
+  add_requests(3, {}, {5}, {1});
+
+  vector<int64_t> node_ids;
+  ASSERT_EQ(cluster_resources.GetBestSchedulableNodes(task_requests, &node_ids), 17);
+  ASSERT_EQ(node_ids.size(), task_requests.size());
+  vector<int64_t> cpu_tasks_per_node(3, 0);
+  for (size_t i = 0; i < 16; i++) {
+    if (i < 14) {
+      ASSERT_NE(node_ids[i], -1);
+      cpu_tasks_per_node[node_ids[i]]++;
+    } else {
+      ASSERT_EQ(node_ids[i], -1);
+    }
+  }
+  // The local node is filled first.
+  ASSERT_EQ(cpu_tasks_per_node, vector<int64_t>({4, 2, 8}));
+  ASSERT_EQ(node_ids[16], 1);
+  ASSERT_EQ(node_ids[17], -1);
+  ASSERT_EQ(node_ids[18], -1);
+  ASSERT_EQ(node_ids[19], 2);
+  ASSERT_EQ(node_ids[20], 2);
+  ASSERT_EQ(node_ids[21], -1);
+
+  // The resources of the assigned requests were taken.
+  for (int64_t node_id = 0; node_id < 3; node_id++) {
+    NodeResources resources;
+    ASSERT_TRUE(cluster_resources.GetNodeResources(node_id, &resources));
+    ASSERT_EQ(resources.capacities[CPU].available, 0);
+  }
+}
+
+TEST_F(SchedulingTest, SchedulingResourceSetToTaskRequestTest) {
+  ClusterResourceScheduler cluster_resources("local", {{"CPU", 4}});
+  const std::unordered_map<std::string, double> resource_map = {
+      {"CPU", 2}, {"memory", 3}, {"GPU", 1}, {"custom1", 5}, {"custom2", 1}};
+
+  // The request is the same as the one converted from the map of the resources.
+  TaskRequest task_req, expected_task_req;
+  cluster_resources.ResourceSetToTaskRequest(ray::ResourceSet(resource_map), &task_req);
+  cluster_resources.ResourceMapToTaskRequest(resource_map, &expected_task_req);
+  ASSERT_EQ(task_req.predefined_resources.size(), PredefinedResources_MAX);
+  for (int i = 0; i < PredefinedResources_MAX; i++) {
+    ASSERT_EQ(task_req.predefined_resources[i].demand,
+              expected_task_req.predefined_resources[i].demand);
+  }
+  ASSERT_EQ(task_req.predefined_resources[MEM].demand, 3);
+  ASSERT_EQ(task_req.custom_resources.size(), 2);
+  for (const auto &expected_custom_resource : expected_task_req.custom_resources) {
+    bool found = false;
+    for (const auto &custom_resource : task_req.custom_resources) {
+      if (custom_resource.id == expected_custom_resource.id) {
+        ASSERT_EQ(custom_resource.req.demand, expected_custom_resource.req.demand);
+        found = true;
+      }
+    }
+    ASSERT_TRUE(found);
+  }
+
+  // A reused request is reset.
+  cluster_resources.ResourceSetToTaskRequest(ray::ResourceSet(), &task_req);
+  ASSERT_EQ(task_req.predefined_resources[CPU].demand, 0);
+  ASSERT_TRUE(task_req.custom_resources.empty());
+}
+
 #ifdef UNORDERED_VS_ABSL_MAPS_EVALUATION
+TEST_F(SchedulingTest, SchedulingBestNodeBenchmarkTest) {
+  checkBestSchedulableNode(/*num_nodes=*/10000, /*num_requests=*/2000,
+                           /*print_throughput=*/true);
+}
+
 TEST_F(SchedulingTest, SchedulingMapPerformanceTest) {
   size_t map_len = 1000000;
   unordered_map<int64_t, int64_t> umap_int_key;
@@ -1,8 +1,13 @@
 #include "scheduling_resources.h"
 
+#include <algorithm>
 #include <cmath>
+#include <deque>
+#include <limits>
 #include <sstream>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "ray/util/logging.h"
 
 namespace ray {
@@ -71,21 +76,107 @@ double FractionalResourceQuantity::ToDouble() const {
   return static_cast<double>(resource_quantity_) / kResourceConversionFactor;
 }
 
+namespace {
+
+/// \class ResourceLabelTable
+///
+/// Interns resource labels as dense integer resource IDs. The predefined resources
+/// have the IDs 0 to kNumPredefinedResources - 1, and custom resources get the next
+/// free ID when their label is first seen. The table is shared by all resource sets
+/// in the process and is never cleared, so that IDs stay valid.
+class ResourceLabelTable {
+ public:
+  ResourceLabelTable() {
+    for (const auto &label : {kCPU_ResourceLabel, kGPU_ResourceLabel, kTPU_ResourceLabel,
+                              kMemory_ResourceLabel}) {
+      ids_.emplace(label, labels_.size());
+      labels_.push_back(label);
+    }
+  }
+
+  /// Return the ID of a resource label, or -1 if the label was never interned.
+  int64_t Find(const std::string &label) const {
+    int64_t predefined_id = FindPredefined(label);
+    if (predefined_id >= 0) {
+      return predefined_id;
+    }
+    absl::ReaderMutexLock lock(&mutex_);
+    auto it = ids_.find(label);
+    return it == ids_.end() ? -1 : it->second;
+  }
+
+  /// Return the ID of a resource label, interning the label if it's new.
+  int64_t GetOrInsert(const std::string &label) {
+    int64_t id = Find(label);
+    if (id >= 0) {
+      return id;
+    }
+    absl::MutexLock lock(&mutex_);
+    auto it = ids_.emplace(label, labels_.size());
+    if (it.second) {
+      labels_.push_back(label);
+    }
+    return it.first->second;
+  }
+
+  /// Return the label of a resource ID.
+  const std::string &GetLabel(int64_t id) const {
+    absl::ReaderMutexLock lock(&mutex_);
+    // Deque elements don't move when the deque grows, so the reference stays valid.
+    return labels_[id];
+  }
+
+ private:
+  /// Return the ID of a predefined resource label, or -1 if the label isn't
+  /// predefined. This avoids hashing and locking for the common resources.
+  static int64_t FindPredefined(const std::string &label) {
+    if (label == kCPU_ResourceLabel) {
+      return 0;
+    } else if (label == kGPU_ResourceLabel) {
+      return 1;
+    } else if (label == kTPU_ResourceLabel) {
+      return 2;
+    } else if (label == kMemory_ResourceLabel) {
+      return 3;
+    }
+    return -1;
+  }
+
+  mutable absl::Mutex mutex_;
+  /// The IDs of the interned labels.
+  absl::flat_hash_map<std::string, int64_t> ids_ GUARDED_BY(mutex_);
+  /// The interned labels, indexed by ID.
+  std::deque<std::string> labels_ GUARDED_BY(mutex_);
+};
+
+ResourceLabelTable &GetResourceLabelTable() {
+  static ResourceLabelTable *table = new ResourceLabelTable();
+  return *table;
+}
+
+/// Compare a custom resource entry with a resource ID, for binary search.
+bool CustomResourceLess(const std::pair<int64_t, int64_t> &resource, int64_t id) {
+  return resource.first < id;
+}
+
+}  // namespace
+
 ResourceSet::ResourceSet() {}
 
 ResourceSet::ResourceSet(
-    const std::unordered_map<std::string, FractionalResourceQuantity> &resource_map)
-    : resource_capacity_(resource_map) {
+    const std::unordered_map<std::string, FractionalResourceQuantity> &resource_map) {
   for (auto const &resource_pair : resource_map) {
     RAY_CHECK(resource_pair.second > 0);
+    SetQuantity(GetResourceLabelTable().GetOrInsert(resource_pair.first),
+                resource_pair.second.resource_quantity_);
   }
 }
 
 ResourceSet::ResourceSet(const std::unordered_map<std::string, double> &resource_map) {
   for (auto const &resource_pair : resource_map) {
     RAY_CHECK(resource_pair.second > 0);
-    resource_capacity_[resource_pair.first] =
-        FractionalResourceQuantity(resource_pair.second);
+    SetQuantity(GetResourceLabelTable().GetOrInsert(resource_pair.first),
+                FractionalResourceQuantity(resource_pair.second).resource_quantity_);
   }
 }
 
@@ -94,36 +185,100 @@ ResourceSet::ResourceSet(const std::vector<std::string> &resource_labels,
   RAY_CHECK(resource_labels.size() == resource_capacity.size());
   for (size_t i = 0; i < resource_labels.size(); i++) {
     RAY_CHECK(resource_capacity[i] > 0);
-    resource_capacity_[resource_labels[i]] =
-        FractionalResourceQuantity(resource_capacity[i]);
+    SetQuantity(GetResourceLabelTable().GetOrInsert(resource_labels[i]),
+                FractionalResourceQuantity(resource_capacity[i]).resource_quantity_);
   }
 }
 
 ResourceSet::~ResourceSet() {}
 
-bool ResourceSet::operator==(const ResourceSet &rhs) const {
-  return (this->IsSubset(rhs) && rhs.IsSubset(*this));
+int64_t ResourceSet::GetQuantity(int64_t resource_id) const {
+  if (resource_id < kNumPredefinedResources) {
+    return predefined_capacity_[resource_id];
+  }
+  auto it = std::lower_bound(custom_capacity_.begin(), custom_capacity_.end(),
+                             resource_id, CustomResourceLess);
+  if (it == custom_capacity_.end() || it->first != resource_id) {
+    return 0;
+  }
+  return it->second;
 }
 
+void ResourceSet::SetQuantity(int64_t resource_id, int64_t quantity) {
+  if (resource_id < kNumPredefinedResources) {
+    predefined_capacity_[resource_id] = std::max<int64_t>(quantity, 0);
+    return;
+  }
+  auto it = std::lower_bound(custom_capacity_.begin(), custom_capacity_.end(),
+                             resource_id, CustomResourceLess);
+  bool found = it != custom_capacity_.end() && it->first == resource_id;
+  if (quantity <= 0) {
+    if (found) {
+      custom_capacity_.erase(it);
+    }
+  } else if (found) {
+    it->second = quantity;
+  } else {
+    custom_capacity_.emplace(it, resource_id, quantity);
+  }
+}
+
+bool ResourceSet::operator==(const ResourceSet &rhs) const { return IsEqual(rhs); }
+
 bool ResourceSet::IsEmpty() const {
-  // Check whether the capacity of each resource type is zero. Exit early if not.
-  return resource_capacity_.empty();
+  for (int i = 0; i < kNumPredefinedResources; i++) {
+    if (predefined_capacity_[i] != 0) {
+      return false;
+    }
+  }
+  return custom_capacity_.empty();
 }
 
 bool ResourceSet::IsSubset(const ResourceSet &other) const {
-  // Check to make sure all keys of this are in other.
-  for (const auto &resource_pair : resource_capacity_) {
-    const auto &resource_name = resource_pair.first;
-    const FractionalResourceQuantity &lhs_quantity = resource_pair.second;
-    const FractionalResourceQuantity &rhs_quantity = other.GetResource(resource_name);
-    if (lhs_quantity > rhs_quantity) {
-      // Resource found in rhs, but lhs capacity exceeds rhs capacity.
+  // Check the predefined resources without branching, so that the loop is vectorized.
+  bool exceeds = false;
+  for (int i = 0; i < kNumPredefinedResources; i++) {
+    exceeds |= predefined_capacity_[i] > other.predefined_capacity_[i];
+  }
+  if (exceeds) {
+    return false;
+  }
+  // Both custom resource lists are sorted by ID, so walk them in step.
+  auto other_it = other.custom_capacity_.begin();
+  for (const auto &resource : custom_capacity_) {
+    while (other_it != other.custom_capacity_.end() && other_it->first < resource.first) {
+      ++other_it;
+    }
+    if (other_it == other.custom_capacity_.end() || other_it->first != resource.first ||
+        resource.second > other_it->second) {
+      // Resource not found in rhs, or lhs capacity exceeds rhs capacity.
       return false;
     }
   }
   return true;
 }
 
+int64_t ResourceSet::NumCopiesIn(const ResourceSet &other) const {
+  int64_t num_copies = std::numeric_limits<int64_t>::max();
+  for (int i = 0; i < kNumPredefinedResources; i++) {
+    if (predefined_capacity_[i] > 0) {
+      num_copies =
+          std::min(num_copies, other.predefined_capacity_[i] / predefined_capacity_[i]);
+    }
+  }
+  auto other_it = other.custom_capacity_.begin();
+  for (const auto &resource : custom_capacity_) {
+    while (other_it != other.custom_capacity_.end() && other_it->first < resource.first) {
+      ++other_it;
+    }
+    if (other_it == other.custom_capacity_.end() || other_it->first != resource.first) {
+      return 0;
+    }
+    num_copies = std::min(num_copies, other_it->second / resource.second);
+  }
+  return num_copies;
+}
+
 /// Test whether this ResourceSet is a superset of the other ResourceSet
 bool ResourceSet::IsSuperset(const ResourceSet &other) const {
   return other.IsSubset(*this);
@@ -131,116 +286,119 @@ bool ResourceSet::IsSuperset(const ResourceSet &other) const {
 
 /// Test whether this ResourceSet is precisely equal to the other ResourceSet.
 bool ResourceSet::IsEqual(const ResourceSet &rhs) const {
-  return (this->IsSubset(rhs) && rhs.IsSubset(*this));
+  return std::equal(std::begin(predefined_capacity_), std::end(predefined_capacity_),
+                    std::begin(rhs.predefined_capacity_)) &&
+         custom_capacity_ == rhs.custom_capacity_;
 }
 
 void ResourceSet::AddOrUpdateResource(const std::string &resource_name,
                                       const FractionalResourceQuantity &capacity) {
   if (capacity > 0) {
-    resource_capacity_[resource_name] = capacity;
+    SetQuantity(GetResourceLabelTable().GetOrInsert(resource_name),
+                capacity.resource_quantity_);
   }
 }
 
 bool ResourceSet::DeleteResource(const std::string &resource_name) {
-  if (resource_capacity_.count(resource_name) == 1) {
-    resource_capacity_.erase(resource_name);
-    return true;
-  } else {
+  int64_t resource_id = GetResourceLabelTable().Find(resource_name);
+  if (resource_id < 0 || GetQuantity(resource_id) == 0) {
     return false;
   }
+  SetQuantity(resource_id, 0);
+  return true;
 }
 
 void ResourceSet::SubtractResources(const ResourceSet &other) {
   // Subtract the resources, make sure none goes below zero and delete any if new capacity
   // is zero.
-  for (const auto &resource_pair : other.GetResourceAmountMap()) {
-    const std::string &resource_label = resource_pair.first;
-    const FractionalResourceQuantity &resource_capacity = resource_pair.second;
-    if (resource_capacity_.count(resource_label) == 1) {
-      resource_capacity_[resource_label] -= resource_capacity;
-    }
-    if (resource_capacity_[resource_label] <= 0) {
-      resource_capacity_.erase(resource_label);
-    }
+  for (int i = 0; i < kNumPredefinedResources; i++) {
+    predefined_capacity_[i] =
+        std::max<int64_t>(predefined_capacity_[i] - other.predefined_capacity_[i], 0);
+  }
+  for (const auto &resource : other.custom_capacity_) {
+    SetQuantity(resource.first, GetQuantity(resource.first) - resource.second);
   }
 }
 
 void ResourceSet::SubtractResourcesStrict(const ResourceSet &other) {
   // Subtract the resources, make sure none goes below zero and delete any if new capacity
   // is zero.
-  for (const auto &resource_pair : other.GetResourceAmountMap()) {
-    const std::string &resource_label = resource_pair.first;
-    const FractionalResourceQuantity &resource_capacity = resource_pair.second;
-    RAY_CHECK(resource_capacity_.count(resource_label) == 1)
-        << "Attempt to acquire unknown resource: " << resource_label << " capacity "
-        << resource_capacity.ToDouble();
-    resource_capacity_[resource_label] -= resource_capacity;
-
-    // Ensure that quantity is positive. Note, we have to have the check before
-    // erasing the object to make sure that it doesn't get added back.
-    RAY_CHECK(resource_capacity_[resource_label] >= 0)
+  auto subtract = [this](int64_t resource_id, int64_t quantity) {
+    int64_t current = GetQuantity(resource_id);
+    RAY_CHECK(current > 0) << "Attempt to acquire unknown resource: "
+                           << GetResourceLabelTable().GetLabel(resource_id)
+                           << " capacity "
+                           << static_cast<double>(quantity) / kResourceConversionFactor;
+    // Ensure that quantity is positive.
+    RAY_CHECK(current >= quantity)
         << "Capacity of resource after subtraction is negative, "
-        << resource_capacity_[resource_label].ToDouble() << ".";
-
-    if (resource_capacity_[resource_label] == 0) {
-      resource_capacity_.erase(resource_label);
+        << static_cast<double>(current - quantity) / kResourceConversionFactor << ".";
+    SetQuantity(resource_id, current - quantity);
+  };
+  for (int i = 0; i < kNumPredefinedResources; i++) {
+    if (other.predefined_capacity_[i] > 0) {
+      subtract(i, other.predefined_capacity_[i]);
     }
   }
+  for (const auto &resource : other.custom_capacity_) {
+    subtract(resource.first, resource.second);
+  }
 }
 
 // Add a set of resources to the current set of resources subject to upper limits on
 // capacity from the total_resource set
 void ResourceSet::AddResourcesCapacityConstrained(const ResourceSet &other,
                                                   const ResourceSet &total_resources) {
-  const std::unordered_map<std::string, FractionalResourceQuantity> &total_resource_map =
-      total_resources.GetResourceAmountMap();
-  for (const auto &resource_pair : other.GetResourceAmountMap()) {
-    const std::string &to_add_resource_label = resource_pair.first;
-    const FractionalResourceQuantity &to_add_resource_capacity = resource_pair.second;
-    if (total_resource_map.count(to_add_resource_label) != 0) {
+  auto add = [this, &total_resources](int64_t resource_id, int64_t quantity) {
+    int64_t total_capacity = total_resources.GetQuantity(resource_id);
+    if (total_capacity > 0) {
       // If resource exists in total map, add to the local capacity map.
       // If the new capacity will be greater the total capacity, set the new capacity to
       // total capacity (capping to the total)
-      const FractionalResourceQuantity &total_capacity =
-          total_resource_map.at(to_add_resource_label);
-      resource_capacity_[to_add_resource_label] =
-          std::min(resource_capacity_[to_add_resource_label] + to_add_resource_capacity,
-                   total_capacity);
+      SetQuantity(resource_id,
+                  std::min(GetQuantity(resource_id) + quantity, total_capacity));
     } else {
       // Resource does not exist in the total map, it probably got deleted from the total.
       // Don't panic, do nothing and simply continue.
       RAY_LOG(DEBUG) << "[AddResourcesCapacityConstrained] Resource "
-                     << to_add_resource_label
+                     << GetResourceLabelTable().GetLabel(resource_id)
                      << " not found in the total resource map. It probably got deleted, "
                         "not adding back to resource_capacity_.";
     }
+  };
+  for (int i = 0; i < kNumPredefinedResources; i++) {
+    if (other.predefined_capacity_[i] > 0) {
+      add(i, other.predefined_capacity_[i]);
+    }
+  }
+  for (const auto &resource : other.custom_capacity_) {
+    add(resource.first, resource.second);
   }
 }
 
 // Perform an outer join.
 void ResourceSet::AddResources(const ResourceSet &other) {
-  for (const auto &resource_pair : other.GetResourceAmountMap()) {
-    const std::string &resource_label = resource_pair.first;
-    const FractionalResourceQuantity &resource_capacity = resource_pair.second;
-    resource_capacity_[resource_label] += resource_capacity;
+  for (int i = 0; i < kNumPredefinedResources; i++) {
+    predefined_capacity_[i] += other.predefined_capacity_[i];
+  }
+  for (const auto &resource : other.custom_capacity_) {
+    SetQuantity(resource.first, GetQuantity(resource.first) + resource.second);
   }
 }
 
 FractionalResourceQuantity ResourceSet::GetResource(
     const std::string &resource_name) const {
-  if (resource_capacity_.count(resource_name) == 0) {
-    return 0;
+  int64_t resource_id = GetResourceLabelTable().Find(resource_name);
+  FractionalResourceQuantity capacity;
+  if (resource_id >= 0) {
+    capacity.resource_quantity_ = GetQuantity(resource_id);
   }
-  const FractionalResourceQuantity &capacity = resource_capacity_.at(resource_name);
   return capacity;
 }
 
 const ResourceSet ResourceSet::GetNumCpus() const {
   ResourceSet cpu_resource_set;
-  const FractionalResourceQuantity cpu_quantity = GetResource(kCPU_ResourceLabel);
-  if (cpu_quantity > 0) {
-    cpu_resource_set.resource_capacity_[kCPU_ResourceLabel] = cpu_quantity;
-  }
+  cpu_resource_set.predefined_capacity_[0] = predefined_capacity_[0];
   return cpu_resource_set;
 }
 
@@ -253,45 +411,59 @@ const std::string format_resource(std::string resource_name, double quantity) {
 }
 
 const std::string ResourceSet::ToString() const {
-  if (resource_capacity_.size() == 0) {
+  if (IsEmpty()) {
     return "{}";
-  } else {
-    std::string return_string = "";
-
-    auto it = resource_capacity_.begin();
-
-    // Convert the first element to a string.
-    if (it != resource_capacity_.end()) {
-      double resource_amount = (it->second).ToDouble();
-      return_string +=
-          "{" + it->first + ": " + format_resource(it->first, resource_amount) + "}";
-      it++;
-    }
+  }
+  std::string return_string = "";
+  ForEachResource([&return_string](int64_t resource_id,
+                                   FractionalResourceQuantity quantity) {
+    const std::string &label = GetResourceLabel(resource_id);
+    // Separate the elements with a comma.
+    return_string += return_string.empty() ? "{" : ", {";
+    return_string += label + ": " + format_resource(label, quantity.ToDouble()) + "}";
+  });
+  return return_string;
+}
 
-    // Add the remaining elements to the string (along with a comma).
-    for (; it != resource_capacity_.end(); ++it) {
-      double resource_amount = (it->second).ToDouble();
-      return_string +=
-          ", {" + it->first + ": " + format_resource(it->first, resource_amount) + "}";
-    }
+FractionalResourceQuantity ResourceSet::GetResourceById(int64_t resource_id) const {
+  FractionalResourceQuantity capacity;
+  capacity.resource_quantity_ = GetQuantity(resource_id);
+  return capacity;
+}
 
-    return return_string;
-  }
+const std::string &ResourceSet::GetResourceLabel(int64_t resource_id) {
+  return GetResourceLabelTable().GetLabel(resource_id);
 }
 
 const std::unordered_map<std::string, double> ResourceSet::GetResourceMap() const {
   std::unordered_map<std::string, double> result;
-  for (const auto resource_pair : resource_capacity_) {
-    result[resource_pair.first] = resource_pair.second.ToDouble();
-  }
+  ForEachResource([&result](int64_t resource_id, FractionalResourceQuantity quantity) {
+    result.emplace(GetResourceLabel(resource_id), quantity.ToDouble());
+  });
   return result;
 };
 
-const std::unordered_map<std::string, FractionalResourceQuantity>
-    &ResourceSet::GetResourceAmountMap() const {
-  return resource_capacity_;
+std::unordered_map<std::string, FractionalResourceQuantity>
+ResourceSet::GetResourceAmountMap() const {
+  std::unordered_map<std::string, FractionalResourceQuantity> result;
+  ForEachResource([&result](int64_t resource_id, FractionalResourceQuantity quantity) {
+    result.emplace(GetResourceLabel(resource_id), quantity);
+  });
+  return result;
 };
 
+size_t ResourceSet::Hash() const {
+  size_t seed = custom_capacity_.size();
+  for (int i = 0; i < kNumPredefinedResources; i++) {
+    seed = seed * 31 + std::hash<int64_t>()(predefined_capacity_[i]);
+  }
+  for (const auto &resource : custom_capacity_) {
+    seed = seed * 31 + std::hash<int64_t>()(resource.first);
+    seed = seed * 31 + std::hash<int64_t>()(resource.second);
+  }
+  return seed;
+}
+
 /// ResourceIds class implementation
 
 ResourceIds::ResourceIds() {}
@@ -539,11 +711,11 @@ bool ResourceIds::IsWhole(double resource_quantity) const {
 ResourceIdSet::ResourceIdSet() {}
 
 ResourceIdSet::ResourceIdSet(const ResourceSet &resource_set) {
-  for (auto const &resource_pair : resource_set.GetResourceMap()) {
-    auto const &resource_name = resource_pair.first;
-    double resource_quantity = resource_pair.second;
-    available_resources_[resource_name] = ResourceIds(resource_quantity);
-  }
+  resource_set.ForEachResource(
+      [this](int64_t resource_id, FractionalResourceQuantity resource_quantity) {
+        available_resources_[ResourceSet::GetResourceLabel(resource_id)] =
+            ResourceIds(resource_quantity.ToDouble());
+      });
 }
 
 ResourceIdSet::ResourceIdSet(
@@ -551,36 +723,33 @@ ResourceIdSet::ResourceIdSet(
     : available_resources_(available_resources) {}
 
 bool ResourceIdSet::Contains(const ResourceSet &resource_set) const {
-  for (auto const &resource_pair : resource_set.GetResourceAmountMap()) {
-    auto const &resource_name = resource_pair.first;
-    const FractionalResourceQuantity &resource_quantity = resource_pair.second;
-
-    auto it = available_resources_.find(resource_name);
-    if (it == available_resources_.end()) {
-      return false;
-    }
-
-    if (!it->second.Contains(resource_quantity)) {
-      return false;
+  bool contains = true;
+  resource_set.ForEachResource([this, &contains](
+                                   int64_t resource_id,
+                                   FractionalResourceQuantity resource_quantity) {
+    if (!contains) {
+      return;
     }
-  }
-  return true;
+    auto it = available_resources_.find(ResourceSet::GetResourceLabel(resource_id));
+    contains = it != available_resources_.end() && it->second.Contains(resource_quantity);
+  });
+  return contains;
 }
 
 ResourceIdSet ResourceIdSet::Acquire(const ResourceSet &resource_set) {
   std::unordered_map<std::string, ResourceIds> acquired_resources;
 
-  for (auto const &resource_pair : resource_set.GetResourceAmountMap()) {
-    auto const &resource_name = resource_pair.first;
-    const FractionalResourceQuantity &resource_quantity = resource_pair.second;
-
+  resource_set.ForEachResource([this, &acquired_resources](
+                                   int64_t resource_id,
+                                   FractionalResourceQuantity resource_quantity) {
+    const std::string &resource_name = ResourceSet::GetResourceLabel(resource_id);
     auto it = available_resources_.find(resource_name);
     RAY_CHECK(it != available_resources_.end());
     acquired_resources[resource_name] = it->second.Acquire(resource_quantity);
     if (it->second.TotalQuantityIsZero()) {
       available_resources_.erase(it);
     }
-  }
+  });
   return ResourceIdSet(acquired_resources);
 }
 
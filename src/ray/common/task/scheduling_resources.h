@@ -20,6 +20,9 @@ const std::string kGPU_ResourceLabel = "GPU";
 const std::string kTPU_ResourceLabel = "TPU";
 const std::string kMemory_ResourceLabel = "memory";
 
+/// The number of predefined resources, i.e., CPU, GPU, TPU and memory.
+constexpr int kNumPredefinedResources = 4;
+
 /// \class FractionalResourceQuantity
 /// \brief Converts the resource quantities to an internal representation to
 /// avoid machine precision errors.
@@ -57,6 +60,8 @@ class FractionalResourceQuantity {
   double ToDouble() const;
 
  private:
+  friend class ResourceSet;
+
   /// The resource quantity represented as 1/kResourceConversionFactor-th of a
   /// unit.
   int64_t resource_quantity_;
@@ -65,6 +70,12 @@ class FractionalResourceQuantity {
 /// \class ResourceSet
 /// \brief Encapsulates and operates on a set of resources, including CPUs,
 /// GPUs, and custom labels.
+///
+/// Resource labels are interned as integer resource IDs that are shared by all
+/// resource sets in the process, so that comparing and combining resource sets
+/// doesn't hash any strings. The quantities of the predefined resources are kept
+/// in a fixed-size array, and those of custom resources in a vector sorted by
+/// resource ID.
 class ResourceSet {
  public:
   /// \brief empty ResourceSet constructor.
@@ -104,6 +115,13 @@ class ResourceSet {
   /// otherwise.
   bool IsSubset(const ResourceSet &other) const;
 
+  /// \brief Return how many copies of this ResourceSet fit in the other ResourceSet.
+  ///
+  /// \param other: The resource set to fit copies in.
+  /// \return The number of copies, which is 0 if this set isn't a subset of other, and
+  /// the maximum int64_t value if this set is empty.
+  int64_t NumCopiesIn(const ResourceSet &other) const;
+
   /// \brief Test if this ResourceSet is a superset of the other ResourceSet.
   ///
   /// \param other: The resource set we check being a superset of.
@@ -176,27 +194,77 @@ class ResourceSet {
   /// \return True if the resource capacity is zero. False otherwise.
   bool IsEmpty() const;
 
-  // TODO(atumanov): implement const_iterator class for the ResourceSet container.
+  /// Return the quantity of a resource by its resource ID.
+  ///
+  /// \param resource_id: The interned ID of the resource.
+  /// \return The quantity of the resource, zero if it does not exist in the set.
+  FractionalResourceQuantity GetResourceById(int64_t resource_id) const;
+
+  /// \brief Call a function on each resource in the set, in order of resource ID,
+  /// without building a map of the resources. Use this on hot paths instead of
+  /// GetResourceMap and GetResourceAmountMap.
+  ///
+  /// \param fn: Called with the resource ID (int64_t) and the quantity
+  /// (FractionalResourceQuantity) of each resource.
+  /// \return Void.
+  template <typename Fn>
+  void ForEachResource(Fn &&fn) const {
+    FractionalResourceQuantity quantity;
+    for (int i = 0; i < kNumPredefinedResources; i++) {
+      if (predefined_capacity_[i] > 0) {
+        quantity.resource_quantity_ = predefined_capacity_[i];
+        fn(static_cast<int64_t>(i), quantity);
+      }
+    }
+    for (const auto &resource : custom_capacity_) {
+      quantity.resource_quantity_ = resource.second;
+      fn(resource.first, quantity);
+    }
+  }
+
+  /// \brief Return the label of a resource ID.
+  ///
+  /// \param resource_id: An ID that a resource label was interned as.
+  /// \return The label.
+  static const std::string &GetResourceLabel(int64_t resource_id);
+
   // TODO(williamma12): Make sure that everywhere we use doubles we don't
   // convert it back to FractionalResourceQuantity.
   /// \brief Return a map of the resource and size in doubles. Note, size is in
   /// regular units and does not need to be multiplied by kResourceConversionFactor.
+  /// This builds a new map, so hot paths should use ForEachResource instead.
   ///
   /// \return map of resource in string to size in double.
   const std::unordered_map<std::string, double> GetResourceMap() const;
 
   /// \brief Return a map of the resource and size in FractionalResourceQuantity. Note,
-  /// size is in kResourceConversionFactor of a unit.
+  /// size is in kResourceConversionFactor of a unit. This builds a new map, so hot
+  /// paths should use ForEachResource instead.
   ///
   /// \return map of resource in string to size in FractionalResourceQuantity.
-  const std::unordered_map<std::string, FractionalResourceQuantity>
-      &GetResourceAmountMap() const;
+  std::unordered_map<std::string, FractionalResourceQuantity> GetResourceAmountMap()
+      const;
 
   const std::string ToString() const;
 
+  /// Return a hash of the resource set.
+  size_t Hash() const;
+
  private:
-  /// Resource capacity map.
-  std::unordered_map<std::string, FractionalResourceQuantity> resource_capacity_;
+  /// Return the quantity of a resource, or 0 if it isn't in the set.
+  int64_t GetQuantity(int64_t resource_id) const;
+
+  /// Set the quantity of a resource, removing it from the set if the quantity isn't
+  /// positive.
+  void SetQuantity(int64_t resource_id, int64_t quantity);
+
+  /// The quantities of the predefined resources, indexed by resource ID, in
+  /// 1/kResourceConversionFactor-th of a unit. A resource that isn't in the set has
+  /// a quantity of 0.
+  int64_t predefined_capacity_[kNumPredefinedResources] = {};
+  /// The resource IDs and quantities of the custom resources, sorted by resource ID.
+  /// Only resources with a positive quantity are stored.
+  std::vector<std::pair<int64_t, int64_t>> custom_capacity_;
 };
 
 /// \class ResourceIds
@@ -531,14 +599,7 @@ class SchedulingResources {
 namespace std {
 template <>
 struct hash<ray::ResourceSet> {
-  size_t operator()(ray::ResourceSet const &k) const {
-    size_t seed = k.GetResourceMap().size();
-    for (auto &elem : k.GetResourceMap()) {
-      seed ^= std::hash<std::string>()(elem.first);
-      seed ^= std::hash<double>()(elem.second);
-    }
-    return seed;
-  }
+  size_t operator()(ray::ResourceSet const &k) const { return k.Hash(); }
 };
 }  // namespace std
 
@@ -0,0 +1,178 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ray/common/task/scheduling_resources.h"
+#include "ray/util/logging.h"
+
+namespace ray {
+
+namespace {
+
+using ResourceMap = std::unordered_map<std::string, double>;
+
+/// IsSubset on string-keyed resource maps, as ResourceSet did it before resource
+/// labels were interned. Used as the baseline of the benchmark.
+bool IsSubsetOfMap(
+    const std::unordered_map<std::string, FractionalResourceQuantity> &lhs,
+    const std::unordered_map<std::string, FractionalResourceQuantity> &rhs) {
+  for (const auto &resource_pair : lhs) {
+    auto it = rhs.find(resource_pair.first);
+    FractionalResourceQuantity rhs_quantity = it == rhs.end() ? 0 : it->second;
+    if (resource_pair.second > rhs_quantity) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Check the resource demand of tasks against the available resources of the nodes, as
+/// the scheduling policy does, and compare the result with IsSubsetOfMap.
+void CheckIsSubsetAgainstMaps(int num_nodes, int num_rounds, bool log_timing) {
+  std::vector<ResourceSet> nodes;
+  std::vector<std::unordered_map<std::string, FractionalResourceQuantity>> node_maps;
+  for (int i = 0; i < num_nodes; i++) {
+    ResourceSet node(
+        ResourceMap{{"memory", 100}, {"node:10.0.0." + std::to_string(i), 1}});
+    node.AddOrUpdateResource("CPU", i % 16);
+    node.AddOrUpdateResource("GPU", i % 4);
+    if (i % 2 == 0) {
+      node.AddOrUpdateResource("custom", 4);
+    }
+    node_maps.push_back(node.GetResourceAmountMap());
+    nodes.push_back(std::move(node));
+  }
+  const std::vector<ResourceSet> demands = {
+      ResourceSet(ResourceMap{{"CPU", 1}}),
+      ResourceSet(ResourceMap{{"CPU", 8}, {"GPU", 2}}),
+      ResourceSet(ResourceMap{{"CPU", 1}, {"custom", 1}}),
+      ResourceSet(ResourceMap{{"CPU", 1}, {"node:10.0.0.7", 0.001}})};
+  std::vector<std::unordered_map<std::string, FractionalResourceQuantity>> demand_maps;
+  for (const auto &demand : demands) {
+    demand_maps.push_back(demand.GetResourceAmountMap());
+  }
+
+  int64_t num_feasible = 0;
+  int64_t num_feasible_baseline = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < num_rounds; round++) {
+    for (const auto &demand : demands) {
+      for (const auto &node : nodes) {
+        num_feasible += demand.IsSubset(node);
+      }
+    }
+  }
+  auto resource_set_time = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  for (int round = 0; round < num_rounds; round++) {
+    for (const auto &demand : demand_maps) {
+      for (const auto &node : node_maps) {
+        num_feasible_baseline += IsSubsetOfMap(demand, node);
+      }
+    }
+  }
+  auto baseline_time = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(num_feasible, num_feasible_baseline);
+  if (!log_timing) {
+    return;
+  }
+
+  const double num_checks = static_cast<double>(num_rounds) * demands.size() * num_nodes;
+  const double resource_set_ns =
+      std::chrono::duration<double, std::nano>(resource_set_time).count() / num_checks;
+  const double baseline_ns =
+      std::chrono::duration<double, std::nano>(baseline_time).count() / num_checks;
+  RAY_LOG(INFO) << "IsSubset over " << num_nodes << " nodes: " << resource_set_ns
+                << " ns per check, string-keyed maps: " << baseline_ns
+                << " ns per check.";
+}
+
+}  // namespace
+
+TEST(ResourceSetTest, TestPredefinedAndCustomResources) {
+  ResourceSet resources(ResourceMap{{"CPU", 4}, {"GPU", 1}, {"custom", 2}});
+  ASSERT_EQ(resources.GetResource("CPU").ToDouble(), 4);
+  ASSERT_EQ(resources.GetResource("custom").ToDouble(), 2);
+  ASSERT_EQ(resources.GetResource("TPU").ToDouble(), 0);
+  ASSERT_EQ(resources.GetResource("unknown").ToDouble(), 0);
+  ASSERT_EQ(resources.GetResourceMap(),
+            ResourceMap({{"CPU", 4}, {"GPU", 1}, {"custom", 2}}));
+  ASSERT_EQ(resources.GetNumCpus(), ResourceSet(ResourceMap{{"CPU", 4}}));
+
+  // Resources are visited in order of resource ID, so predefined resources come first.
+  std::vector<std::pair<std::string, double>> visited;
+  resources.ForEachResource(
+      [&visited](int64_t resource_id, FractionalResourceQuantity quantity) {
+        ASSERT_EQ(ResourceSet::GetResourceLabel(resource_id) == "CPU", resource_id == 0);
+        visited.emplace_back(ResourceSet::GetResourceLabel(resource_id),
+                             quantity.ToDouble());
+      });
+  ASSERT_EQ(visited, (std::vector<std::pair<std::string, double>>{
+                         {"CPU", 4}, {"GPU", 1}, {"custom", 2}}));
+  ASSERT_EQ(resources.GetResourceById(0).ToDouble(), 4);
+  ASSERT_EQ(resources.ToString(), "{CPU: 4.000000}, {GPU: 1.000000}, {custom: 2.000000}");
+
+  ASSERT_TRUE(ResourceSet(ResourceMap{{"CPU", 1}, {"custom", 2}}).IsSubset(resources));
+  ASSERT_FALSE(ResourceSet(ResourceMap{{"CPU", 5}}).IsSubset(resources));
+  ASSERT_FALSE(ResourceSet(ResourceMap{{"custom", 2.5}}).IsSubset(resources));
+  ASSERT_FALSE(ResourceSet(ResourceMap{{"other", 1}}).IsSubset(resources));
+  ASSERT_TRUE(ResourceSet().IsSubset(resources));
+  ASSERT_TRUE(resources.IsSuperset(ResourceSet(ResourceMap{{"GPU", 0.5}})));
+
+  // Updating a resource to a capacity of 0 leaves it unchanged.
+  resources.AddOrUpdateResource("custom", 0);
+  ASSERT_EQ(resources.GetResource("custom").ToDouble(), 2);
+  ASSERT_TRUE(resources.DeleteResource("custom"));
+  ASSERT_FALSE(resources.DeleteResource("custom"));
+  ASSERT_FALSE(resources.DeleteResource("TPU"));
+  ASSERT_EQ(resources, ResourceSet(ResourceMap{{"CPU", 4}, {"GPU", 1}}));
+  ASSERT_EQ(std::hash<ResourceSet>()(resources),
+            std::hash<ResourceSet>()(ResourceSet(ResourceMap{{"GPU", 1}, {"CPU", 4}})));
+  ASSERT_FALSE(resources.IsEmpty());
+  ASSERT_TRUE(ResourceSet().IsEmpty());
+}
+
+TEST(ResourceSetTest, TestAddAndSubtractResources) {
+  ResourceSet resources(ResourceMap{{"CPU", 4}, {"custom", 2}});
+  resources.AddResources(ResourceSet(ResourceMap{{"CPU", 1}, {"GPU", 1}, {"other", 1}}));
+  ASSERT_EQ(resources, ResourceSet(ResourceMap{
+                           {"CPU", 5}, {"GPU", 1}, {"custom", 2}, {"other", 1}}));
+
+  // Subtracting clamps at 0 and removes the resources that are used up.
+  resources.SubtractResources(
+      ResourceSet(ResourceMap{{"CPU", 6}, {"custom", 0.5}, {"new", 1}}));
+  ASSERT_EQ(resources,
+            ResourceSet(ResourceMap{{"GPU", 1}, {"custom", 1.5}, {"other", 1}}));
+  resources.SubtractResourcesStrict(
+      ResourceSet(ResourceMap{{"GPU", 1}, {"custom", 0.5}}));
+  ASSERT_EQ(resources, ResourceSet(ResourceMap{{"custom", 1}, {"other", 1}}));
+
+  // Adding is capped by the total, and skips resources that aren't in the total.
+  const ResourceSet total(ResourceMap{{"CPU", 2}, {"custom", 2}});
+  resources.AddResourcesCapacityConstrained(
+      ResourceSet(ResourceMap{{"CPU", 3}, {"custom", 0.5}, {"missing", 1}}), total);
+  ASSERT_EQ(resources,
+            ResourceSet(ResourceMap{{"CPU", 2}, {"custom", 1.5}, {"other", 1}}));
+}
+
+TEST(ResourceSetTest, TestIsSubsetMatchesMaps) {
+  CheckIsSubsetAgainstMaps(/*num_nodes=*/100, /*num_rounds=*/1, /*log_timing=*/false);
+}
+
+// Built with RAY_BENCHMARKS by the benchmark target, which runs only this test:
+// bazel run //:scheduling_resources_benchmark
+#ifdef RAY_BENCHMARKS
+TEST(ResourceSetTest, TestIsSubsetBenchmark) {
+  CheckIsSubsetAgainstMaps(/*num_nodes=*/1000, /*num_rounds=*/200, /*log_timing=*/true);
+}
+#endif  // RAY_BENCHMARKS
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -220,6 +220,10 @@ ObjectID TaskSpecification::ActorDummyObject() const {
 
 bool TaskSpecification::IsDirectCall() const { return message_->is_direct_call(); }
 
+int32_t TaskSpecification::Priority() const { return message_->priority(); }
+
+int64_t TaskSpecification::DeadlineMs() const { return message_->deadline_ms(); }
+
 bool TaskSpecification::IsDirectActorCreationCall() const {
   if (IsActorCreationTask()) {
     return message_->actor_creation_task_spec().is_direct_call();
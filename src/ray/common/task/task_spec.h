@@ -124,6 +124,14 @@ class TaskSpecification : public MessageWrapper<rpc::TaskSpec> {
 
   Language GetLanguage() const;
 
+  /// Return the priority of the task. Ready tasks with a higher priority are
+  /// dispatched first.
+  int32_t Priority() const;
+
+  /// Return the deadline of the task in milliseconds since the epoch, or 0 if the
+  /// task has no deadline.
+  int64_t DeadlineMs() const;
+
   /// Whether this task is a normal task.
   bool IsNormalTask() const;
 
@@ -232,7 +232,10 @@ CoreWorker::CoreWorker(const WorkerType worker_type, const Language language,
                 new raylet::RayletClient(std::move(grpc_client)));
           },
           memory_store_, task_manager_, local_raylet_id,
-          RayConfig::instance().worker_lease_timeout_milliseconds()));
+          RayConfig::instance().worker_lease_timeout_milliseconds(),
+          RayConfig::instance().max_pending_lease_requests_per_scheduling_key(),
+          RayConfig::instance().max_tasks_in_flight_per_worker(),
+          RayConfig::instance().worker_lease_sharing_enabled()));
   future_resolver_.reset(new FutureResolver(memory_store_, client_factory));
   // Unfortunately the raylet client has to be constructed after the receivers.
   if (direct_task_receiver_ != nullptr) {
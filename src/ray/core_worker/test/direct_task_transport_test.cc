@@ -1,5 +1,7 @@
 #include "ray/core_worker/transport/direct_task_transport.h"
 
+#include <chrono>
+
 #include "gtest/gtest.h"
 #include "ray/common/task/task_spec.h"
 #include "ray/common/task/task_util.h"
@@ -24,7 +26,8 @@ class MockWorkerClient : public rpc::CoreWorkerClientInterface {
     return Status::OK();
   }
 
-  bool ReplyPushTask(Status status = Status::OK(), bool exit = false) {
+  bool ReplyPushTask(Status status = Status::OK(), bool exit = false,
+                     bool not_executed = false) {
     if (callbacks.size() == 0) {
       return false;
     }
@@ -33,6 +36,9 @@ class MockWorkerClient : public rpc::CoreWorkerClientInterface {
     if (exit) {
       reply.set_worker_exiting(true);
     }
+    if (not_executed) {
+      reply.set_not_executed(true);
+    }
     callback(status, reply);
     callbacks.pop_front();
     return true;
@@ -68,6 +74,10 @@ class MockRayletClient : public WorkerLeaseInterface {
  public:
   ray::Status ReturnWorker(int worker_port, const WorkerID &worker_id,
                            bool disconnect_worker) override {
+    auto leased_it = leased_task_ids.find(worker_port);
+    if (leased_it != leased_task_ids.end()) {
+      leased_task_ids.erase(leased_it);
+    }
     if (disconnect_worker) {
       num_workers_disconnected++;
     } else {
@@ -80,13 +90,27 @@ class MockRayletClient : public WorkerLeaseInterface {
       const ray::TaskSpecification &resource_spec,
       const rpc::ClientCallback<rpc::RequestWorkerLeaseReply> &callback) override {
     num_workers_requested += 1;
+    // Like the raylet, drop a request for a task that is already queued or leased,
+    // without replying.
+    const TaskID task_id = resource_spec.TaskId();
+    bool queued = std::find(requested_task_ids.begin(), requested_task_ids.end(),
+                            task_id) != requested_task_ids.end();
+    for (const auto &leased : leased_task_ids) {
+      queued = queued || leased.second == task_id;
+    }
+    if (queued) {
+      num_requests_dropped += 1;
+      return Status::OK();
+    }
     callbacks.push_back(callback);
+    requested_task_ids.push_back(task_id);
     return Status::OK();
   }
 
-  // Trigger reply to RequestWorkerLease.
+  // Trigger reply to RequestWorkerLease. By default, the oldest pending request is
+  // replied to.
   bool GrantWorkerLease(const std::string &address, int port,
-                        const ClientID &retry_at_raylet_id) {
+                        const ClientID &retry_at_raylet_id, size_t request_index = 0) {
     rpc::RequestWorkerLeaseReply reply;
     if (!retry_at_raylet_id.IsNil()) {
       reply.mutable_retry_at_raylet_address()->set_ip_address(address);
@@ -97,12 +121,19 @@ class MockRayletClient : public WorkerLeaseInterface {
       reply.mutable_worker_address()->set_port(port);
       reply.mutable_worker_address()->set_raylet_id(retry_at_raylet_id.Binary());
     }
-    if (callbacks.size() == 0) {
+    if (callbacks.size() <= request_index) {
       return false;
     } else {
-      auto callback = callbacks.front();
+      auto callback_it = std::next(callbacks.begin(), request_index);
+      auto task_id_it = std::next(requested_task_ids.begin(), request_index);
+      auto callback = *callback_it;
+      auto task_id = *task_id_it;
+      callbacks.erase(callback_it);
+      requested_task_ids.erase(task_id_it);
+      if (retry_at_raylet_id.IsNil()) {
+        leased_task_ids.emplace(port, task_id);
+      }
       callback(Status::OK(), reply);
-      callbacks.pop_front();
       return true;
     }
   }
@@ -112,7 +143,12 @@ class MockRayletClient : public WorkerLeaseInterface {
   int num_workers_requested = 0;
   int num_workers_returned = 0;
   int num_workers_disconnected = 0;
+  int num_requests_dropped = 0;
   std::list<rpc::ClientCallback<rpc::RequestWorkerLeaseReply>> callbacks = {};
+  // The tasks of the pending lease requests, in the same order as the callbacks.
+  std::list<TaskID> requested_task_ids = {};
+  // The tasks of the granted leases, by worker port.
+  std::unordered_multimap<int, TaskID> leased_task_ids = {};
 };
 
 TEST(TestMemoryStore, TestPromoteToPlasma) {
@@ -244,12 +280,59 @@ TaskSpecification BuildTaskSpec(const std::unordered_map<std::string, double> &r
                                 const std::vector<std::string> &function_descriptor) {
   TaskSpecBuilder builder;
   rpc::Address empty_address;
-  builder.SetCommonTaskSpec(TaskID::Nil(), Language::PYTHON, function_descriptor,
+  builder.SetCommonTaskSpec(TaskID::ForFakeTask(), Language::PYTHON, function_descriptor,
                             JobID::Nil(), TaskID::Nil(), 0, TaskID::Nil(), empty_address,
                             1, true, resources, resources);
   return builder.Build();
 }
 
+// Run short tasks on one leased worker. Each round replies to all of the tasks in
+// flight to the worker, as if the worker ran them within one round trip.
+void RunPipelinedTasks(int num_tasks, bool log_timing) {
+  std::unordered_map<std::string, double> empty_resources;
+  std::vector<std::string> empty_descriptor;
+  std::vector<TaskSpecification> tasks;
+  for (int i = 0; i < num_tasks; i++) {
+    tasks.push_back(BuildTaskSpec(empty_resources, empty_descriptor));
+  }
+  for (int max_tasks_in_flight : {1, 8, 32}) {
+    rpc::Address address;
+    auto raylet_client = std::make_shared<MockRayletClient>();
+    auto worker_client = std::make_shared<MockWorkerClient>();
+    auto store = std::make_shared<CoreWorkerMemoryStore>();
+    auto factory = [&](const std::string &addr, int port) { return worker_client; };
+    auto task_finisher = std::make_shared<MockTaskFinisher>();
+    CoreWorkerDirectTaskSubmitter submitter(
+        address, raylet_client, factory, nullptr, store, task_finisher,
+        ClientID::Nil(), kLongTimeout, /*max_pending_lease_requests=*/1,
+        max_tasks_in_flight);
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &task : tasks) {
+      ASSERT_TRUE(submitter.SubmitTask(task).ok());
+    }
+    ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, ClientID::Nil()));
+    int num_round_trips = 0;
+    while (!worker_client->callbacks.empty()) {
+      size_t num_replies = worker_client->callbacks.size();
+      for (size_t i = 0; i < num_replies; i++) {
+        ASSERT_TRUE(worker_client->ReplyPushTask());
+      }
+      num_round_trips++;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(task_finisher->num_tasks_complete, num_tasks);
+    ASSERT_EQ(num_round_trips,
+              (num_tasks + max_tasks_in_flight - 1) / max_tasks_in_flight);
+    if (log_timing) {
+      RAY_LOG(INFO) << max_tasks_in_flight << " tasks in flight per worker: "
+                    << num_tasks / std::chrono::duration<double>(elapsed).count()
+                    << " tasks/s in the submitter, " << num_round_trips
+                    << " round trips for " << num_tasks << " tasks.";
+    }
+  }
+}
+
 TEST(DirectTaskTransportTest, TestSubmitOneTask) {
   rpc::Address address;
   auto raylet_client = std::make_shared<MockRayletClient>();
@@ -350,6 +433,218 @@ TEST(DirectTaskTransportTest, TestConcurrentWorkerLeases) {
   ASSERT_EQ(task_finisher->num_tasks_failed, 0);
 }
 
+TEST(DirectTaskTransportTest, TestParallelWorkerLeaseRequests) {
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto factory = [&](const std::string &addr, int port) { return worker_client; };
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  CoreWorkerDirectTaskSubmitter submitter(address, raylet_client, factory, nullptr, store,
+                                          task_finisher, ClientID::Nil(), kLongTimeout,
+                                          /*max_pending_lease_requests=*/3);
+  std::unordered_map<std::string, double> empty_resources;
+  std::vector<std::string> empty_descriptor;
+
+  // A lease request is sent for each queued task, up to 3 at a time.
+  for (int i = 0; i < 5; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildTaskSpec(empty_resources, empty_descriptor))
+                    .ok());
+  }
+  ASSERT_EQ(raylet_client->num_workers_requested, 3);
+
+  // Task 1 is pushed; another worker is requested for the 4 queued tasks.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, ClientID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_EQ(raylet_client->num_workers_requested, 4);
+
+  // Task 2 is pushed; another worker is requested for the 3 queued tasks.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1001, ClientID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 2);
+  ASSERT_EQ(raylet_client->num_workers_requested, 5);
+
+  // Tasks 3 to 5 are pushed; the pending requests cover the queued tasks.
+  for (int port = 1002; port < 1005; port++) {
+    ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", port, ClientID::Nil()));
+  }
+  ASSERT_EQ(worker_client->callbacks.size(), 5);
+  ASSERT_EQ(raylet_client->num_workers_requested, 5);
+  ASSERT_FALSE(raylet_client->GrantWorkerLease("localhost", 1005, ClientID::Nil()));
+
+  // All workers returned.
+  while (!worker_client->callbacks.empty()) {
+    ASSERT_TRUE(worker_client->ReplyPushTask());
+  }
+  ASSERT_EQ(raylet_client->num_workers_returned, 5);
+  ASSERT_EQ(raylet_client->num_workers_disconnected, 0);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 5);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+}
+
+TEST(DirectTaskTransportTest, TestLeaseRequestsCarryDistinctTasks) {
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto factory = [&](const std::string &addr, int port) { return worker_client; };
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  CoreWorkerDirectTaskSubmitter submitter(address, raylet_client, factory, nullptr, store,
+                                          task_finisher, ClientID::Nil(), kLongTimeout,
+                                          /*max_pending_lease_requests=*/3);
+  std::unordered_map<std::string, double> empty_resources;
+  std::vector<std::string> empty_descriptor;
+  std::vector<TaskID> task_ids;
+  for (int i = 0; i < 5; i++) {
+    auto task = BuildTaskSpec(empty_resources, empty_descriptor);
+    task_ids.push_back(task.TaskId());
+    ASSERT_TRUE(submitter.SubmitTask(task).ok());
+  }
+  ASSERT_EQ(raylet_client->requested_task_ids,
+            std::list<TaskID>({task_ids[0], task_ids[1], task_ids[2]}));
+
+  // The lease requested with the second task is granted first. That task runs on
+  // the worker, and the next request is sent with a task that the raylet doesn't
+  // already hold.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, ClientID::Nil(), 1));
+  ASSERT_EQ(worker_client->callbacks.size(), 1);
+  ASSERT_EQ(raylet_client->requested_task_ids,
+            std::list<TaskID>({task_ids[0], task_ids[2], task_ids[3]}));
+
+  // The same happens for the lease of the fourth task.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1001, ClientID::Nil(), 2));
+  ASSERT_EQ(worker_client->callbacks.size(), 2);
+  ASSERT_EQ(raylet_client->requested_task_ids,
+            std::list<TaskID>({task_ids[0], task_ids[2], task_ids[4]}));
+
+  // All lease requests are eventually replied to.
+  int port = 1002;
+  while (raylet_client->GrantWorkerLease("localhost", port++, ClientID::Nil())) {
+  }
+  while (!worker_client->callbacks.empty()) {
+    ASSERT_TRUE(worker_client->ReplyPushTask());
+  }
+  ASSERT_EQ(raylet_client->num_requests_dropped, 0);
+  ASSERT_EQ(raylet_client->num_workers_returned, 5);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 5);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+}
+
+TEST(DirectTaskTransportTest, TestPipelineTasksToWorker) {
+  rpc::Address address;
+  auto raylet_client = std::make_shared<MockRayletClient>();
+  auto worker_client = std::make_shared<MockWorkerClient>();
+  auto store = std::make_shared<CoreWorkerMemoryStore>();
+  auto factory = [&](const std::string &addr, int port) { return worker_client; };
+  auto task_finisher = std::make_shared<MockTaskFinisher>();
+  CoreWorkerDirectTaskSubmitter submitter(address, raylet_client, factory, nullptr, store,
+                                          task_finisher, ClientID::Nil(), kLongTimeout,
+                                          /*max_pending_lease_requests=*/1,
+                                          /*max_tasks_in_flight_per_worker=*/3);
+  std::unordered_map<std::string, double> empty_resources;
+  std::vector<std::string> empty_descriptor;
+  for (int i = 0; i < 5; i++) {
+    ASSERT_TRUE(submitter.SubmitTask(BuildTaskSpec(empty_resources, empty_descriptor))
+                    .ok());
+  }
+  ASSERT_EQ(raylet_client->num_workers_requested, 1);
+
+  // Tasks 1 to 3 are pushed to the first worker; worker 2 is requested.
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, ClientID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 3);
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+
+  // Tasks 4 and 5 are pushed as tasks 1 and 2 finish.
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(worker_client->callbacks.size(), 3);
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(worker_client->callbacks.size(), 3);
+
+  // Task 3 makes the worker exit, so tasks 4 and 5 are not executed there. They
+  // are queued again and pushed to worker 2.
+  ASSERT_TRUE(worker_client->ReplyPushTask(Status::OK(), /*exit=*/true));
+  ASSERT_TRUE(worker_client->ReplyPushTask(Status::OK(), /*exit=*/true,
+                                           /*not_executed=*/true));
+  ASSERT_TRUE(worker_client->ReplyPushTask(Status::OK(), /*exit=*/true,
+                                           /*not_executed=*/true));
+  ASSERT_EQ(task_finisher->num_tasks_complete, 3);
+  ASSERT_EQ(worker_client->callbacks.size(), 0);
+  ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1001, ClientID::Nil()));
+  ASSERT_EQ(worker_client->callbacks.size(), 2);
+  ASSERT_EQ(raylet_client->num_workers_requested, 2);
+
+  // Worker 2 is returned once both of its tasks are done.
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 0);
+  ASSERT_TRUE(worker_client->ReplyPushTask());
+  ASSERT_EQ(raylet_client->num_workers_returned, 1);
+  ASSERT_EQ(raylet_client->num_workers_disconnected, 0);
+  ASSERT_EQ(task_finisher->num_tasks_complete, 5);
+  ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+}
+
+TEST(DirectTaskTransportTest, TestPipelinedTaskRoundTrips) {
+  RunPipelinedTasks(/*num_tasks=*/100, /*log_timing=*/false);
+}
+
+// Built with RAY_BENCHMARKS by the benchmark target, which runs only this test:
+// bazel run //:direct_task_transport_benchmark
+#ifdef RAY_BENCHMARKS
+TEST(DirectTaskTransportTest, TestPipelinedTasksBenchmark) {
+  RunPipelinedTasks(/*num_tasks=*/10000, /*log_timing=*/true);
+}
+#endif  // RAY_BENCHMARKS
+
+TEST(DirectTaskTransportTest, TestShareWorkerLeaseAcrossDependencies) {
+  for (bool lease_sharing_enabled : {false, true}) {
+    rpc::Address address;
+    auto raylet_client = std::make_shared<MockRayletClient>();
+    auto worker_client = std::make_shared<MockWorkerClient>();
+    auto store = std::make_shared<CoreWorkerMemoryStore>();
+    auto factory = [&](const std::string &addr, int port) { return worker_client; };
+    auto task_finisher = std::make_shared<MockTaskFinisher>();
+    CoreWorkerDirectTaskSubmitter submitter(
+        address, raylet_client, factory, nullptr, store, task_finisher,
+        ClientID::Nil(), kLongTimeout, /*max_pending_lease_requests=*/1,
+        /*max_tasks_in_flight_per_worker=*/1, lease_sharing_enabled);
+    std::unordered_map<std::string, double> empty_resources;
+    std::vector<std::string> empty_descriptor;
+    // The tasks have the same scheduling class but different plasma dependencies.
+    TaskSpecification task1 = BuildTaskSpec(empty_resources, empty_descriptor);
+    task1.GetMutableMessage().add_args()->add_object_ids(ObjectID::FromRandom().Binary());
+    TaskSpecification task2 = BuildTaskSpec(empty_resources, empty_descriptor);
+    task2.GetMutableMessage().add_args()->add_object_ids(ObjectID::FromRandom().Binary());
+
+    ASSERT_TRUE(submitter.SubmitTask(task1).ok());
+    ASSERT_TRUE(submitter.SubmitTask(task2).ok());
+    ASSERT_EQ(raylet_client->num_workers_requested, 2);
+
+    // Task 1 is pushed.
+    ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1000, ClientID::Nil()));
+    ASSERT_EQ(worker_client->callbacks.size(), 1);
+
+    // Task 1 finishes. With lease sharing, task 2 is pushed to the same worker.
+    // Otherwise, the worker is returned.
+    ASSERT_TRUE(worker_client->ReplyPushTask());
+    if (lease_sharing_enabled) {
+      ASSERT_EQ(worker_client->callbacks.size(), 1);
+      ASSERT_EQ(raylet_client->num_workers_returned, 0);
+    } else {
+      ASSERT_EQ(worker_client->callbacks.size(), 0);
+      ASSERT_EQ(raylet_client->num_workers_returned, 1);
+    }
+
+    // The second lease is returned right away if task 2 is already running.
+    ASSERT_TRUE(raylet_client->GrantWorkerLease("localhost", 1001, ClientID::Nil()));
+    ASSERT_EQ(worker_client->callbacks.size(), 1);
+    ASSERT_EQ(raylet_client->num_workers_returned, 1);
+    ASSERT_TRUE(worker_client->ReplyPushTask());
+    ASSERT_EQ(raylet_client->num_workers_returned, 2);
+    ASSERT_EQ(raylet_client->num_workers_disconnected, 0);
+    ASSERT_EQ(task_finisher->num_tasks_complete, 2);
+    ASSERT_EQ(task_finisher->num_tasks_failed, 0);
+  }
+}
+
 TEST(DirectTaskTransportTest, TestReuseWorkerLease) {
   rpc::Address address;
   auto raylet_client = std::make_shared<MockRayletClient>();
@@ -242,7 +242,16 @@ void CoreWorkerDirectTaskReceiver::HandlePushTask(
                           resource_ids]() {
     // We have posted an exit task onto the main event loop,
     // so shouldn't bother executing any further work.
-    if (exiting_) return;
+    if (exiting_) {
+      if (!task_spec.IsActorTask()) {
+        // Normal tasks may be pipelined behind the task that made the worker
+        // exit, so tell the caller to submit them elsewhere.
+        reply->set_worker_exiting(true);
+        reply->set_not_executed(true);
+        send_reply_callback(Status::OK(), nullptr, nullptr);
+      }
+      return;
+    }
 
     auto num_returns = task_spec.NumReturns();
     if (task_spec.IsActorCreationTask() || task_spec.IsActorTask()) {
@@ -1,5 +1,7 @@
 #include "ray/core_worker/transport/direct_task_transport.h"
 
+#include <algorithm>
+
 #include "ray/core_worker/transport/dependency_resolver.h"
 #include "ray/core_worker/transport/direct_actor_transport.h"
 
@@ -15,16 +17,37 @@ Status CoreWorkerDirectTaskSubmitter::SubmitTask(TaskSpecification task_spec) {
     const SchedulingKey scheduling_key(
         task_spec.GetSchedulingClass(), task_spec.GetDependencies(),
         task_spec.IsActorCreationTask() ? task_spec.ActorCreationId() : ActorID::Nil());
-    auto it = task_queues_.find(scheduling_key);
-    if (it == task_queues_.end()) {
-      it = task_queues_.emplace(scheduling_key, std::deque<TaskSpecification>()).first;
-    }
-    it->second.push_back(task_spec);
+    GetOrCreateTaskQueue(scheduling_key).push_back(task_spec);
     RequestNewWorkerIfNeeded(scheduling_key);
   });
   return Status::OK();
 }
 
+std::deque<TaskSpecification> &CoreWorkerDirectTaskSubmitter::GetOrCreateTaskQueue(
+    const SchedulingKey &scheduling_key) {
+  auto it = task_queues_.find(scheduling_key);
+  if (it == task_queues_.end()) {
+    it = task_queues_.emplace(scheduling_key, std::deque<TaskSpecification>()).first;
+    if (std::get<2>(scheduling_key).IsNil()) {
+      queued_keys_by_class_[std::get<0>(scheduling_key)].insert(scheduling_key);
+    }
+  }
+  return it->second;
+}
+
+void CoreWorkerDirectTaskSubmitter::EraseTaskQueue(
+    absl::flat_hash_map<SchedulingKey, std::deque<TaskSpecification>>::iterator it) {
+  const SchedulingKey &scheduling_key = it->first;
+  auto keys_it = queued_keys_by_class_.find(std::get<0>(scheduling_key));
+  if (keys_it != queued_keys_by_class_.end()) {
+    keys_it->second.erase(scheduling_key);
+    if (keys_it->second.empty()) {
+      queued_keys_by_class_.erase(keys_it);
+    }
+  }
+  task_queues_.erase(it);
+}
+
 void CoreWorkerDirectTaskSubmitter::AddWorkerLeaseClient(
     const rpc::WorkerAddress &addr, std::shared_ptr<WorkerLeaseInterface> lease_client) {
   auto it = client_cache_.find(addr);
@@ -34,39 +57,77 @@ void CoreWorkerDirectTaskSubmitter::AddWorkerLeaseClient(
     RAY_LOG(INFO) << "Connected to " << addr.ip_address << ":" << addr.port;
   }
   int64_t expiration = current_time_ms() + lease_timeout_ms_;
-  worker_to_lease_client_.emplace(addr,
-                                  std::make_pair(std::move(lease_client), expiration));
+  worker_to_lease_client_.emplace(addr, LeaseEntry{std::move(lease_client), expiration});
 }
 
 void CoreWorkerDirectTaskSubmitter::OnWorkerIdle(
     const rpc::WorkerAddress &addr, const SchedulingKey &scheduling_key, bool was_error,
     const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> &assigned_resources) {
-  auto lease_entry = worker_to_lease_client_[addr];
+  auto lease_it = worker_to_lease_client_.find(addr);
+  RAY_CHECK(lease_it != worker_to_lease_client_.end());
+  auto &lease_entry = lease_it->second;
+  lease_entry.was_error = lease_entry.was_error || was_error;
   auto queue_entry = task_queues_.find(scheduling_key);
-  // Return the worker if there was an error executing the previous task,
-  // the previous task is an actor creation task,
-  // there are no more applicable queued tasks, or the lease is expired.
-  if (was_error || queue_entry == task_queues_.end() ||
-      current_time_ms() > lease_entry.second) {
-    auto status = lease_entry.first->ReturnWorker(addr.port, addr.worker_id, was_error);
-    if (!status.ok()) {
-      RAY_LOG(ERROR) << "Error returning worker to raylet: " << status.ToString();
-    }
-    worker_to_lease_client_.erase(addr);
-  } else {
+  // Keep up to the maximum number of tasks in flight to the worker, so that it
+  // doesn't sit idle for a round trip between tasks. No more tasks are pushed if
+  // a task failed on the worker or the lease is expired.
+  const bool lease_valid =
+      !lease_entry.was_error && current_time_ms() <= lease_entry.lease_expiration_time;
+  while (lease_valid && queue_entry != task_queues_.end() &&
+         lease_entry.tasks_in_flight < max_tasks_in_flight_per_worker_) {
     auto &client = *client_cache_[addr];
+    lease_entry.tasks_in_flight++;
     PushNormalTask(addr, client, scheduling_key, queue_entry->second.front(),
                    assigned_resources);
     queue_entry->second.pop_front();
     // Delete the queue if it's now empty. Note that the queue cannot already be empty
     // because this is the only place tasks are removed from it.
     if (queue_entry->second.empty()) {
-      task_queues_.erase(queue_entry);
+      EraseTaskQueue(queue_entry);
+      queue_entry = task_queues_.end();
     }
   }
+  if (lease_sharing_enabled_ && lease_valid && queue_entry == task_queues_.end() &&
+      lease_entry.tasks_in_flight < max_tasks_in_flight_per_worker_ &&
+      std::get<2>(scheduling_key).IsNil()) {
+    // Hand the worker to the tasks of another key with the same scheduling class,
+    // which only differ in their plasma dependencies, instead of returning it.
+    auto keys_it = queued_keys_by_class_.find(std::get<0>(scheduling_key));
+    if (keys_it != queued_keys_by_class_.end()) {
+      const SchedulingKey other_key = *keys_it->second.begin();
+      RAY_LOG(DEBUG) << "Sharing the lease of worker " << addr.worker_id
+                     << " with tasks of another scheduling key";
+      OnWorkerIdle(addr, other_key, /*was_error=*/false, assigned_resources);
+      return;
+    }
+  }
+  // Return the worker once its tasks are done if there was an error executing a
+  // task, there are no more applicable queued tasks, or the lease is expired.
+  if (lease_entry.tasks_in_flight == 0) {
+    auto status = lease_entry.lease_client->ReturnWorker(addr.port, addr.worker_id,
+                                                         lease_entry.was_error);
+    if (!status.ok()) {
+      RAY_LOG(ERROR) << "Error returning worker to raylet: " << status.ToString();
+    }
+    worker_to_lease_client_.erase(lease_it);
+  }
   RequestNewWorkerIfNeeded(scheduling_key);
 }
 
+void CoreWorkerDirectTaskSubmitter::OnTaskFinished(
+    const rpc::WorkerAddress &addr, const SchedulingKey &scheduling_key, bool was_error,
+    const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> &assigned_resources) {
+  auto lease_it = worker_to_lease_client_.find(addr);
+  if (lease_it == worker_to_lease_client_.end()) {
+    // The worker is exiting, so its lease is already gone.
+    RequestNewWorkerIfNeeded(scheduling_key);
+    return;
+  }
+  lease_it->second.tasks_in_flight--;
+  RAY_CHECK(lease_it->second.tasks_in_flight >= 0);
+  OnWorkerIdle(addr, scheduling_key, was_error, assigned_resources);
+}
+
 std::shared_ptr<WorkerLeaseInterface>
 CoreWorkerDirectTaskSubmitter::GetOrConnectLeaseClient(
     const rpc::Address *raylet_address) {
@@ -93,50 +154,101 @@ CoreWorkerDirectTaskSubmitter::GetOrConnectLeaseClient(
 
 void CoreWorkerDirectTaskSubmitter::RequestNewWorkerIfNeeded(
     const SchedulingKey &scheduling_key, const rpc::Address *raylet_address) {
-  if (pending_lease_requests_.find(scheduling_key) != pending_lease_requests_.end()) {
-    // There's already an outstanding lease request for this type of task.
-    return;
-  }
   auto it = task_queues_.find(scheduling_key);
   if (it == task_queues_.end()) {
     // We don't have any of this type of task to run.
     return;
   }
+  // Keep a lease request in flight for each queued task, so that a large batch of
+  // tasks doesn't acquire its workers one round trip at a time.
+  const int64_t max_pending_requests =
+      std::min(max_pending_lease_requests_per_scheduling_key_,
+               static_cast<int64_t>(it->second.size()));
+  auto pending_it = pending_lease_requests_.find(scheduling_key);
+  if (pending_it != pending_lease_requests_.end() &&
+      static_cast<int64_t>(pending_it->second.size()) >= max_pending_requests) {
+    // There are already enough outstanding lease requests for this type of task.
+    return;
+  }
 
   auto lease_client = GetOrConnectLeaseClient(raylet_address);
-  TaskSpecification &resource_spec = it->second.front();
-  TaskID task_id = resource_spec.TaskId();
-  auto status = lease_client->RequestWorkerLease(
-      resource_spec,
-      [this, lease_client, task_id, scheduling_key](
-          const Status &status, const rpc::RequestWorkerLeaseReply &reply) mutable {
-        absl::MutexLock lock(&mu_);
-        pending_lease_requests_.erase(scheduling_key);
-        if (status.ok()) {
-          if (!reply.worker_address().raylet_id().empty()) {
-            // We got a lease for a worker. Add the lease client state and try to
-            // assign work to the worker.
-            RAY_LOG(DEBUG) << "Lease granted " << task_id;
-            rpc::WorkerAddress addr = {
-                reply.worker_address().ip_address(), reply.worker_address().port(),
-                WorkerID::FromBinary(reply.worker_address().worker_id()),
-                ClientID::FromBinary(reply.worker_address().raylet_id())};
-            AddWorkerLeaseClient(addr, std::move(lease_client));
-            auto resources_copy = reply.resource_mapping();
-            OnWorkerIdle(addr, scheduling_key,
-                         /*error=*/false, resources_copy);
+  auto &pending_task_ids = pending_lease_requests_[scheduling_key];
+  Status send_status;
+  for (const auto &resource_spec : it->second) {
+    if (static_cast<int64_t>(pending_task_ids.size()) >= max_pending_requests) {
+      break;
+    }
+    TaskID task_id = resource_spec.TaskId();
+    if (!pending_task_ids.insert(task_id).second) {
+      // A lease request was already sent with this task.
+      continue;
+    }
+    send_status = lease_client->RequestWorkerLease(
+        resource_spec,
+        [this, lease_client, task_id, scheduling_key](
+            const Status &status, const rpc::RequestWorkerLeaseReply &reply) mutable {
+          absl::MutexLock lock(&mu_);
+          auto pending_it = pending_lease_requests_.find(scheduling_key);
+          RAY_CHECK(pending_it != pending_lease_requests_.end());
+          RAY_CHECK(pending_it->second.erase(task_id) > 0);
+          if (pending_it->second.empty()) {
+            pending_lease_requests_.erase(pending_it);
+          }
+          if (status.ok()) {
+            if (!reply.worker_address().raylet_id().empty()) {
+              // We got a lease for a worker. Add the lease client state and try to
+              // assign work to the worker.
+              RAY_LOG(DEBUG) << "Lease granted " << task_id;
+              rpc::WorkerAddress addr = {
+                  reply.worker_address().ip_address(), reply.worker_address().port(),
+                  WorkerID::FromBinary(reply.worker_address().worker_id()),
+                  ClientID::FromBinary(reply.worker_address().raylet_id())};
+              AddWorkerLeaseClient(addr, std::move(lease_client));
+              // The raylet holds on to the task of a granted lease until the worker
+              // is returned, so run that task first. Otherwise it could be sent
+              // with another lease request, which the raylet would drop.
+              MoveTaskToFront(scheduling_key, task_id);
+              auto resources_copy = reply.resource_mapping();
+              OnWorkerIdle(addr, scheduling_key,
+                           /*error=*/false, resources_copy);
+            } else {
+              // The raylet redirected us to a different raylet to retry at.
+              RequestNewWorkerIfNeeded(scheduling_key,
+                                       &reply.retry_at_raylet_address());
+            }
           } else {
-            // The raylet redirected us to a different raylet to retry at.
-            RequestNewWorkerIfNeeded(scheduling_key, &reply.retry_at_raylet_address());
+            RetryLeaseRequest(status, lease_client, scheduling_key);
           }
-        } else {
-          RetryLeaseRequest(status, lease_client, scheduling_key);
-        }
-      });
-  if (!status.ok()) {
-    RetryLeaseRequest(status, lease_client, scheduling_key);
+        });
+    if (!send_status.ok()) {
+      // The request was not sent, so its callback won't run.
+      pending_task_ids.erase(task_id);
+      break;
+    }
+  }
+  if (pending_task_ids.empty()) {
+    pending_lease_requests_.erase(scheduling_key);
+  }
+  if (!send_status.ok()) {
+    RetryLeaseRequest(send_status, lease_client, scheduling_key);
+  }
+}
+
+void CoreWorkerDirectTaskSubmitter::MoveTaskToFront(const SchedulingKey &scheduling_key,
+                                                    const TaskID &task_id) {
+  auto queue_it = task_queues_.find(scheduling_key);
+  if (queue_it == task_queues_.end()) {
+    return;
+  }
+  auto &queue = queue_it->second;
+  auto task_it = std::find_if(
+      queue.begin(), queue.end(),
+      [&task_id](const TaskSpecification &spec) { return spec.TaskId() == task_id; });
+  if (task_it != queue.end() && task_it != queue.begin()) {
+    TaskSpecification spec = std::move(*task_it);
+    queue.erase(task_it);
+    queue.push_front(std::move(spec));
   }
-  pending_lease_requests_.insert(scheduling_key);
 }
 
 void CoreWorkerDirectTaskSubmitter::RetryLeaseRequest(
@@ -176,8 +288,17 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
   request->set_intended_worker_id(addr.worker_id.Binary());
   auto status = client.PushNormalTask(
       std::move(request),
-      [this, task_id, is_actor, is_actor_creation, scheduling_key, addr,
+      [this, task_spec, task_id, is_actor, is_actor_creation, scheduling_key, addr,
        assigned_resources](Status status, const rpc::PushTaskReply &reply) {
+        if (status.ok() && reply.not_executed()) {
+          // The task was queued on the worker behind a task that made the worker
+          // exit. Submit it again on another worker.
+          absl::MutexLock lock(&mu_);
+          worker_to_lease_client_.erase(addr);
+          GetOrCreateTaskQueue(scheduling_key).push_front(task_spec);
+          RequestNewWorkerIfNeeded(scheduling_key);
+          return;
+        }
         if (reply.worker_exiting()) {
           // The worker is draining and will shutdown after it is done. Don't return
           // it to the Raylet since that will kill it early.
@@ -186,8 +307,8 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
         } else if (!status.ok() || !is_actor_creation) {
           // Successful actor creation leases the worker indefinitely from the raylet.
           absl::MutexLock lock(&mu_);
-          OnWorkerIdle(addr, scheduling_key,
-                       /*error=*/!status.ok(), assigned_resources);
+          OnTaskFinished(addr, scheduling_key,
+                         /*error=*/!status.ok(), assigned_resources);
         }
         if (!status.ok()) {
           // TODO: It'd be nice to differentiate here between process vs node
@@ -207,7 +328,7 @@ void CoreWorkerDirectTaskSubmitter::PushNormalTask(
     RAY_LOG(ERROR) << "Error pushing task to worker: " << status.ToString();
     {
       absl::MutexLock lock(&mu_);
-      OnWorkerIdle(addr, scheduling_key, /*error=*/true, assigned_resources);
+      OnTaskFinished(addr, scheduling_key, /*error=*/true, assigned_resources);
     }
     task_finisher_->PendingTaskFailed(
         task_id, is_actor ? rpc::ErrorType::ACTOR_DIED : rpc::ErrorType::WORKER_DIED,
@@ -4,6 +4,7 @@
 #include <google/protobuf/repeated_field.h>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/id.h"
 #include "ray/common/ray_object.h"
@@ -41,7 +42,10 @@ class CoreWorkerDirectTaskSubmitter {
                                 LeaseClientFactoryFn lease_client_factory,
                                 std::shared_ptr<CoreWorkerMemoryStore> store,
                                 std::shared_ptr<TaskFinisherInterface> task_finisher,
-                                ClientID local_raylet_id, int64_t lease_timeout_ms)
+                                ClientID local_raylet_id, int64_t lease_timeout_ms,
+                                int64_t max_pending_lease_requests_per_scheduling_key = 1,
+                                int64_t max_tasks_in_flight_per_worker = 1,
+                                bool lease_sharing_enabled = false)
       : rpc_address_(rpc_address),
         local_lease_client_(lease_client),
         client_factory_(client_factory),
@@ -49,7 +53,14 @@ class CoreWorkerDirectTaskSubmitter {
         resolver_(store, task_finisher),
         task_finisher_(task_finisher),
         local_raylet_id_(local_raylet_id),
-        lease_timeout_ms_(lease_timeout_ms) {}
+        lease_timeout_ms_(lease_timeout_ms),
+        max_pending_lease_requests_per_scheduling_key_(
+            max_pending_lease_requests_per_scheduling_key),
+        max_tasks_in_flight_per_worker_(max_tasks_in_flight_per_worker),
+        lease_sharing_enabled_(lease_sharing_enabled) {
+    RAY_CHECK(max_pending_lease_requests_per_scheduling_key_ > 0);
+    RAY_CHECK(max_tasks_in_flight_per_worker_ > 0);
+  }
 
   /// Schedule a task for direct submission to a worker.
   ///
@@ -57,9 +68,11 @@ class CoreWorkerDirectTaskSubmitter {
   Status SubmitTask(TaskSpecification task_spec);
 
  private:
-  /// Schedule more work onto an idle worker or return it back to the raylet if
-  /// no more tasks are queued for submission. If an error was encountered
-  /// processing the worker, we don't attempt to re-use the worker.
+  /// Schedule more work onto a worker that has room for more tasks in flight, or
+  /// return it back to the raylet once its tasks are done if no more tasks are
+  /// queued for submission. If lease sharing is enabled, tasks of other keys with
+  /// the same scheduling class are also scheduled onto the worker. If an error was
+  /// encountered processing the worker, we don't attempt to re-use the worker.
   ///
   /// \param[in] addr The address of the worker.
   /// \param[in] task_queue_key The scheduling class of the worker.
@@ -70,6 +83,27 @@ class CoreWorkerDirectTaskSubmitter {
       const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> &assigned_resources)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Get the queue of tasks of a scheduling key, creating it if needed.
+  std::deque<TaskSpecification> &GetOrCreateTaskQueue(const SchedulingKey &scheduling_key)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Delete an empty task queue.
+  void EraseTaskQueue(
+      absl::flat_hash_map<SchedulingKey, std::deque<TaskSpecification>>::iterator it)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Record that a task pushed to a worker has finished, and schedule more work
+  /// onto the worker if its lease is still held.
+  ///
+  /// \param[in] addr The address of the worker.
+  /// \param[in] task_queue_key The scheduling class of the worker.
+  /// \param[in] was_error Whether the task failed to be submitted.
+  /// \param[in] assigned_resources Resource ids previously assigned to the worker.
+  void OnTaskFinished(
+      const rpc::WorkerAddress &addr, const SchedulingKey &task_queue_key, bool was_error,
+      const google::protobuf::RepeatedPtrField<rpc::ResourceMapEntry> &assigned_resources)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   /// Retry a failed lease request.
   void RetryLeaseRequest(Status status,
                          std::shared_ptr<WorkerLeaseInterface> lease_client,
@@ -82,10 +116,15 @@ class CoreWorkerDirectTaskSubmitter {
   std::shared_ptr<WorkerLeaseInterface> GetOrConnectLeaseClient(
       const rpc::Address *raylet_address) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
-  /// Request a new worker from the raylet if no such requests are currently in
-  /// flight and there are tasks queued. If a raylet address is provided, then
-  /// the worker should be requested from the raylet at that address. Else, the
-  /// worker should be requested from the local raylet.
+  /// Move a queued task to the front of its queue, if it's queued.
+  void MoveTaskToFront(const SchedulingKey &task_queue_key, const TaskID &task_id)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Request new workers from the raylet until there is a request in flight for
+  /// each queued task, up to the maximum number of requests in flight. Each request
+  /// is sent with a different queued task. If a raylet
+  /// address is provided, then the workers should be requested from the raylet at
+  /// that address. Else, the workers should be requested from the local raylet.
   void RequestNewWorkerIfNeeded(const SchedulingKey &task_queue_key,
                                 const rpc::Address *raylet_address = nullptr)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -129,6 +168,16 @@ class CoreWorkerDirectTaskSubmitter {
   /// to the raylet.
   int64_t lease_timeout_ms_;
 
+  /// The maximum number of lease requests in flight for each scheduling key.
+  const int64_t max_pending_lease_requests_per_scheduling_key_;
+
+  /// The maximum number of tasks pushed to a leased worker that haven't replied.
+  const int64_t max_tasks_in_flight_per_worker_;
+
+  /// Whether an idle leased worker is handed to the queued tasks of another key
+  /// with the same scheduling class before it is returned to the raylet.
+  const bool lease_sharing_enabled_;
+
   /// The local raylet ID. Used to make sure that we use the local lease client
   /// if a remote raylet tells us to spill the task back to the local raylet.
   const ClientID local_raylet_id_;
@@ -140,20 +189,40 @@ class CoreWorkerDirectTaskSubmitter {
   absl::flat_hash_map<rpc::WorkerAddress, std::shared_ptr<rpc::CoreWorkerClientInterface>>
       client_cache_ GUARDED_BY(mu_);
 
-  /// Map from worker address to the lease client through which it should be
-  /// returned and its lease expiration time.
-  absl::flat_hash_map<rpc::WorkerAddress,
-                      std::pair<std::shared_ptr<WorkerLeaseInterface>, int64_t>>
-      worker_to_lease_client_ GUARDED_BY(mu_);
+  /// The lease state of a worker that we hold a lease on.
+  struct LeaseEntry {
+    /// The lease client through which the worker should be returned.
+    std::shared_ptr<WorkerLeaseInterface> lease_client;
+    /// The time at which the lease expires.
+    int64_t lease_expiration_time;
+    /// The number of tasks pushed to the worker that haven't replied yet.
+    int64_t tasks_in_flight = 0;
+    /// Whether a task failed on the worker, in which case it is not reused.
+    bool was_error = false;
+  };
+
+  /// Map from worker address to the lease state of the worker.
+  absl::flat_hash_map<rpc::WorkerAddress, LeaseEntry> worker_to_lease_client_
+      GUARDED_BY(mu_);
 
-  // Keeps track of pending worker lease requests to the raylet.
-  absl::flat_hash_set<SchedulingKey> pending_lease_requests_ GUARDED_BY(mu_);
+  // Keeps track of the pending worker lease requests to the raylet, by the ID of the
+  // task that each request was sent with. The raylet drops a lease request for a
+  // task that it has already queued, so each request must carry a different task.
+  // Invariant: if a key is in this map, it has at least one pending request.
+  absl::flat_hash_map<SchedulingKey, absl::flat_hash_set<TaskID>> pending_lease_requests_
+      GUARDED_BY(mu_);
 
   // Tasks that are queued for execution. We keep individual queues per
   // scheduling class to ensure fairness.
   // Invariant: if a queue is in this map, it has at least one task.
   absl::flat_hash_map<SchedulingKey, std::deque<TaskSpecification>> task_queues_
       GUARDED_BY(mu_);
+
+  // The keys of the task queues by their scheduling class, so that a leased worker
+  // can be shared with the tasks of another key. Actor creation tasks always get
+  // their own lease, so their keys are not indexed.
+  absl::flat_hash_map<SchedulingClass, absl::flat_hash_set<SchedulingKey>>
+      queued_keys_by_class_ GUARDED_BY(mu_);
 };
 
 };  // namespace ray
@@ -246,6 +246,19 @@ class TaskInfoAccessor {
   TaskInfoAccessor() = default;
 };
 
+/// An object location that is added to or removed from the GCS.
+struct ObjectLocationUpdate {
+  /// The ID of the object.
+  ObjectID object_id;
+  /// The location of the object.
+  ClientID node_id;
+  /// Whether the location is added, as opposed to removed.
+  bool is_add;
+  /// The size of the object in bytes. It's part of the location entry, so removing
+  /// a location must report the same size as adding it.
+  uint64_t object_size;
+};
+
 /// `ObjectInfoAccessor` is a sub-interface of `GcsClient`.
 /// This class includes all the methods that are related to accessing
 /// object information in the GCS.
@@ -280,6 +293,15 @@ class ObjectInfoAccessor {
   virtual Status AsyncRemoveLocation(const ObjectID &object_id, const ClientID &node_id,
                                      const StatusCallback &callback) = 0;
 
+  /// Add and remove locations of several objects in GCS asynchronously, with as
+  /// few requests as the backend allows.
+  ///
+  /// \param updates The location updates, which are applied in order.
+  /// \param callback Callback that will be called after all updates finished.
+  /// \return Status
+  virtual Status AsyncUpdateLocations(const std::vector<ObjectLocationUpdate> &updates,
+                                      const StatusCallback &callback) = 0;
+
   /// Subscribe to any update of an object's location.
   ///
   /// \param object_id The ID of the object to be subscribed to.
@@ -710,6 +710,31 @@ Status ServiceBasedObjectInfoAccessor::AsyncRemoveLocation(
   return Status::OK();
 }
 
+Status ServiceBasedObjectInfoAccessor::AsyncUpdateLocations(
+    const std::vector<ObjectLocationUpdate> &updates, const StatusCallback &callback) {
+  // The GCS service has no batched location RPC yet, so send the updates one by one.
+  if (updates.empty()) {
+    if (callback) {
+      callback(Status::OK());
+    }
+    return Status::OK();
+  }
+  auto num_pending = std::make_shared<size_t>(updates.size());
+  auto on_done = [num_pending, callback](Status status) {
+    if (--(*num_pending) == 0 && callback) {
+      callback(Status::OK());
+    }
+  };
+  for (const auto &update : updates) {
+    if (update.is_add) {
+      RAY_RETURN_NOT_OK(AsyncAddLocation(update.object_id, update.node_id, on_done));
+    } else {
+      RAY_RETURN_NOT_OK(AsyncRemoveLocation(update.object_id, update.node_id, on_done));
+    }
+  }
+  return Status::OK();
+}
+
 Status ServiceBasedObjectInfoAccessor::AsyncSubscribeToLocations(
     const ObjectID &object_id,
     const SubscribeCallback<ObjectID, ObjectChangeNotification> &subscribe,
@@ -239,6 +239,9 @@ class ServiceBasedObjectInfoAccessor : public ObjectInfoAccessor {
   Status AsyncRemoveLocation(const ObjectID &object_id, const ClientID &node_id,
                              const StatusCallback &callback) override;
 
+  Status AsyncUpdateLocations(const std::vector<ObjectLocationUpdate> &updates,
+                              const StatusCallback &callback) override;
+
   Status AsyncSubscribeToLocations(
       const ObjectID &object_id,
       const SubscribeCallback<ObjectID, ObjectChangeNotification> &subscribe,
@@ -381,6 +381,24 @@ Status RedisObjectInfoAccessor::AsyncRemoveLocation(const ObjectID &object_id,
   return object_table.Remove(JobID::Nil(), object_id, data_ptr, on_done);
 }
 
+Status RedisObjectInfoAccessor::AsyncUpdateLocations(
+    const std::vector<ObjectLocationUpdate> &updates, const StatusCallback &callback) {
+  std::vector<SetUpdate<ObjectID, ObjectTableData>> set_updates;
+  set_updates.reserve(updates.size());
+  for (const auto &update : updates) {
+    std::shared_ptr<ObjectTableData> data_ptr = std::make_shared<ObjectTableData>();
+    data_ptr->set_manager(update.node_id.Binary());
+    data_ptr->set_object_size(update.object_size);
+    set_updates.push_back(
+        {update.object_id,
+         update.is_add ? GcsChangeMode::APPEND_OR_ADD : GcsChangeMode::REMOVE,
+         std::move(data_ptr)});
+  }
+
+  ObjectTable &object_table = client_impl_->object_table();
+  return object_table.BatchUpdate(JobID::Nil(), set_updates, callback);
+}
+
 Status RedisObjectInfoAccessor::AsyncSubscribeToLocations(
     const ObjectID &object_id,
     const SubscribeCallback<ObjectID, ObjectChangeNotification> &subscribe,
@@ -537,6 +537,123 @@ int SetRemove_RedisCommand(RedisModuleCtx *ctx, RedisModuleString **argv, int ar
   return RedisModule_ReplyWithSimpleString(ctx, "OK");
 }
 
+/// Publish a batched notification on a channel.
+///
+/// \param channel The channel to publish to.
+/// \param notification The notification, whose `batch` holds the updates.
+/// \return OK if there is no error during the publish.
+Status PublishBatch(RedisModuleCtx *ctx, RedisModuleString *channel,
+                    const GcsEntry &notification) {
+  std::string str = notification.SerializeAsString();
+  auto data_buffer = RedisModule_CreateString(ctx, str.data(), str.size());
+  RedisModuleCallReply *reply =
+      RedisModule_Call(ctx, "PUBLISH", "ss", channel, data_buffer);
+  if (reply == NULL) {
+    return Status::RedisError("error during PUBLISH");
+  }
+  return Status::OK();
+}
+
+/// Add and remove entries of the sets stored at several keys. Publishes a single
+/// notification with all of the changed entries to the subscribers of the table,
+/// and a single notification with the changed entries of the keys each client
+/// requested notifications for to that client, if a pubsub channel is provided.
+///
+/// This is called from a client with the command:
+//
+///    RAY.SET_BATCH_UPDATE <table_prefix> <pubsub_channel> <id> <data>
+///
+/// \param table_prefix The prefix string for keys in these sets.
+/// \param pubsub_channel The pubsub channel name that notifications for these
+/// keys should be published to.
+/// \param id The ID of one of the keys, which is only used to shard the command.
+/// \param data A GcsEntry whose `batch` holds the updates, which are applied in
+/// order. Each update holds the ID of a key, whether to add or remove the entries,
+/// and the entries.
+/// \return OK if the updates succeed, or an error message string if an update
+/// fails.
+int SetBatchUpdate_RedisCommand(RedisModuleCtx *ctx, RedisModuleString **argv,
+                                int argc) {
+  if (argc != 5) {
+    return RedisModule_WrongArity(ctx);
+  }
+  RedisModuleString *prefix_str = argv[1];
+  RedisModuleString *pubsub_channel_str = argv[2];
+  RedisModuleString *data = argv[4];
+
+  TablePubsub pubsub_channel;
+  REPLY_AND_RETURN_IF_NOT_OK(ParseTablePubsub(&pubsub_channel, pubsub_channel_str));
+  size_t size;
+  const char *buf = RedisModule_StringPtrLen(data, &size);
+  GcsEntry batch;
+  REPLY_AND_RETURN_IF_FALSE(batch.ParseFromArray(buf, size),
+                            "ERR Failed to parse the batch.");
+
+  // The changed entries to publish to all subscribers of the table, and to the
+  // clients that requested notifications for their keys.
+  GcsEntry notification;
+  std::unordered_map<std::string, GcsEntry> client_notifications;
+  for (const auto &update : batch.batch()) {
+    bool is_add = update.change_mode() != GcsChangeMode::REMOVE;
+    RedisModuleString *id =
+        RedisModule_CreateString(ctx, update.id().data(), update.id().size());
+    RedisModuleString *key_string = PrefixedKeyString(ctx, prefix_str, id);
+    REPLY_AND_RETURN_IF_FALSE(key_string != nullptr, "ERR Invalid table prefix.");
+
+    GcsEntry changed;
+    changed.set_id(update.id());
+    changed.set_change_mode(update.change_mode());
+    for (const auto &entry : update.entries()) {
+      auto entry_str = RedisModule_CreateString(ctx, entry.data(), entry.size());
+      RedisModuleCallReply *reply =
+          RedisModule_Call(ctx, is_add ? "SADD" : "SREM", "ss", key_string, entry_str);
+      if (RedisModule_CallReplyType(reply) == REDISMODULE_REPLY_ERROR) {
+        // the SADD/SREM command failed
+        RedisModule_ReplyWithCallReply(ctx, reply);
+        return REDISMODULE_ERR;
+      }
+      if (RedisModule_CallReplyInteger(reply) > 0) {
+        changed.add_entries(entry);
+      }
+    }
+    if (changed.entries_size() == 0) {
+      continue;
+    }
+    if (!is_add) {
+      // try to delete the empty set.
+      RedisModuleKey *key;
+      REPLY_AND_RETURN_IF_NOT_OK(
+          OpenPrefixedKey(&key, ctx, prefix_str, id, REDISMODULE_WRITE));
+      if (RedisModule_ValueLength(key) == 0) {
+        REPLY_AND_RETURN_IF_FALSE(RedisModule_DeleteKey(key) == REDISMODULE_OK,
+                                  "ERR Failed to delete empty set.");
+      }
+    }
+    if (pubsub_channel == TablePubsub::NO_PUBLISH) {
+      continue;
+    }
+    std::string notification_key;
+    REPLY_AND_RETURN_IF_NOT_OK(
+        GetBroadcastKey(ctx, pubsub_channel_str, id, &notification_key));
+    auto it = notification_map.find(notification_key);
+    if (it != notification_map.end()) {
+      for (const std::string &client_channel : it->second) {
+        *client_notifications[client_channel].add_batch() = changed;
+      }
+    }
+    *notification.add_batch() = std::move(changed);
+  }
+
+  if (notification.batch_size() > 0) {
+    REPLY_AND_RETURN_IF_NOT_OK(PublishBatch(ctx, pubsub_channel_str, notification));
+    for (const auto &pair : client_notifications) {
+      auto channel = RedisModule_CreateString(ctx, pair.first.data(), pair.first.size());
+      REPLY_AND_RETURN_IF_NOT_OK(PublishBatch(ctx, channel, pair.second));
+    }
+  }
+  return RedisModule_ReplyWithSimpleString(ctx, "OK");
+}
+
 int Hash_DoPublish(RedisModuleCtx *ctx, RedisModuleString **argv) {
   RedisModuleString *pubsub_channel_str = argv[2];
   RedisModuleString *id = argv[3];
@@ -963,6 +1080,7 @@ AUTO_MEMORY(HashUpdate_RedisCommand);
 AUTO_MEMORY(TableAppend_RedisCommand);
 AUTO_MEMORY(SetAdd_RedisCommand);
 AUTO_MEMORY(SetRemove_RedisCommand);
+AUTO_MEMORY(SetBatchUpdate_RedisCommand);
 AUTO_MEMORY(TableLookup_RedisCommand);
 AUTO_MEMORY(TableRequestNotifications_RedisCommand);
 AUTO_MEMORY(TableDelete_RedisCommand);
@@ -1005,6 +1123,11 @@ int RedisModule_OnLoad(RedisModuleCtx *ctx, RedisModuleString **argv, int argc)
     return REDISMODULE_ERR;
   }
 
+  if (RedisModule_CreateCommand(ctx, "ray.set_batch_update", SetBatchUpdate_RedisCommand,
+                                "write pubsub", 0, 0, 0) == REDISMODULE_ERR) {
+    return REDISMODULE_ERR;
+  }
+
   if (RedisModule_CreateCommand(ctx, "ray.table_lookup", TableLookup_RedisCommand,
                                 "readonly", 0, 0, 0) == REDISMODULE_ERR) {
     return REDISMODULE_ERR;
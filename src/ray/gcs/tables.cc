@@ -153,14 +153,24 @@ Status Log<ID, Data>::Subscribe(const JobID &job_id, const ClientID &client_id,
         // Parse the notification.
         GcsEntry gcs_entry;
         gcs_entry.ParseFromString(data);
-        ID id = ID::FromBinary(gcs_entry.id());
-        std::vector<Data> results;
-        for (int64_t i = 0; i < gcs_entry.entries_size(); i++) {
-          Data result;
-          result.ParseFromString(gcs_entry.entries(i));
-          results.emplace_back(std::move(result));
+        auto notify = [this, &subscribe](const GcsEntry &entry) {
+          ID id = ID::FromBinary(entry.id());
+          std::vector<Data> results;
+          for (int64_t i = 0; i < entry.entries_size(); i++) {
+            Data result;
+            result.ParseFromString(entry.entries(i));
+            results.emplace_back(std::move(result));
+          }
+          subscribe(client_, id, entry.change_mode(), results);
+        };
+        if (gcs_entry.batch_size() > 0) {
+          // A batched notification holds the updates of several keys.
+          for (const auto &entry : gcs_entry.batch()) {
+            notify(entry);
+          }
+        } else {
+          notify(gcs_entry);
         }
-        subscribe(client_, id, gcs_entry.change_mode(), results);
       }
     }
   };
@@ -361,6 +371,53 @@ Status Set<ID, Data>::Remove(const JobID &job_id, const ID &id,
                                        prefix_, pubsub_channel_, std::move(callback));
 }
 
+template <typename ID, typename Data>
+Status Set<ID, Data>::BatchUpdate(const JobID &job_id,
+                                  const std::vector<SetUpdate<ID, Data>> &updates,
+                                  const StatusCallback &done) {
+  // Group the updates by shard. Each shard's command is sent with the ID of the
+  // shard's first key.
+  std::unordered_map<RedisContext *, std::pair<ID, GcsEntry>> shard_batches;
+  for (const auto &update : updates) {
+    if (update.change_mode == GcsChangeMode::REMOVE) {
+      num_removes_++;
+    } else {
+      num_adds_++;
+    }
+    auto context = GetRedisContext(update.id).get();
+    auto it = shard_batches.find(context);
+    if (it == shard_batches.end()) {
+      it = shard_batches.emplace(context, std::make_pair(update.id, GcsEntry())).first;
+    }
+    GcsEntry *entry = it->second.second.add_batch();
+    entry->set_id(update.id.Binary());
+    entry->set_change_mode(update.change_mode);
+    entry->add_entries(update.data->SerializeAsString());
+  }
+  if (shard_batches.empty()) {
+    if (done != nullptr) {
+      done(Status::OK());
+    }
+    return Status::OK();
+  }
+
+  auto num_pending = std::make_shared<size_t>(shard_batches.size());
+  auto callback = [num_pending, done](std::shared_ptr<CallbackReply> reply) {
+    if (--(*num_pending) == 0 && done != nullptr) {
+      done(Status::OK());
+    }
+  };
+  for (const auto &pair : shard_batches) {
+    num_batches_++;
+    std::string str = pair.second.second.SerializeAsString();
+    RAY_RETURN_NOT_OK(GetRedisContext(pair.second.first)
+                          ->RunAsync("RAY.SET_BATCH_UPDATE", pair.second.first,
+                                     str.data(), str.length(), prefix_,
+                                     pubsub_channel_, callback));
+  }
+  return Status::OK();
+}
+
 template <typename ID, typename Data>
 Status Set<ID, Data>::Subscribe(const JobID &job_id, const ClientID &client_id,
                                 const NotificationCallback &subscribe,
@@ -380,7 +437,7 @@ template <typename ID, typename Data>
 std::string Set<ID, Data>::DebugString() const {
   std::stringstream result;
   result << "num lookups: " << num_lookups_ << ", num adds: " << num_adds_
-         << ", num removes: " << num_removes_;
+         << ", num removes: " << num_removes_ << ", num batches: " << num_batches_;
   return result.str();
 }
 
@@ -413,6 +413,17 @@ class Table : private Log<ID, Data>,
   int64_t num_lookups_ = 0;
 };
 
+/// An entry that is added to or removed from the set at a key.
+template <typename ID, typename Data>
+struct SetUpdate {
+  /// The ID of the key.
+  ID id;
+  /// Whether the entry is added or removed.
+  GcsChangeMode change_mode;
+  /// The entry.
+  std::shared_ptr<Data> data;
+};
+
 template <typename ID, typename Data>
 class SetInterface {
  public:
@@ -472,6 +483,18 @@ class Set : private Log<ID, Data>,
   Status Remove(const JobID &job_id, const ID &id, const std::shared_ptr<Data> &data,
                 const WriteCallback &done);
 
+  /// Add and remove entries of several keys. The updates are sent with one command
+  /// per shard, and subscribers receive one notification per shard for all of the
+  /// keys they are subscribed to, instead of one per entry.
+  ///
+  /// \param job_id The ID of the job.
+  /// \param updates The updates, which are applied in order.
+  /// \param done Callback that is called once all updates have been written to the
+  /// GCS.
+  /// \return Status
+  Status BatchUpdate(const JobID &job_id, const std::vector<SetUpdate<ID, Data>> &updates,
+                     const StatusCallback &done);
+
   using NotificationCallback =
       std::function<void(RedisGcsClient *client, const ID &id,
                          const std::vector<ArrayNotification<Data>> &data)>;
@@ -505,6 +528,7 @@ class Set : private Log<ID, Data>,
 
   int64_t num_adds_ = 0;
   int64_t num_removes_ = 0;
+  int64_t num_batches_ = 0;
   using Log<ID, Data>::num_lookups_;
 };
 
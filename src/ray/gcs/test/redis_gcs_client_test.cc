@@ -658,6 +658,93 @@ class SetTestHelper {
     ASSERT_EQ(test->NumCallbacks(), object_ids.size() * 3 * 2);
   }
 
+  static void TestSetBatchUpdate(const JobID &job_id,
+                                 std::shared_ptr<gcs::RedisGcsClient> client) {
+    std::vector<ObjectID> object_ids;
+    for (int i = 0; i < 3; i++) {
+      object_ids.emplace_back(ObjectID::FromRandom());
+    }
+    std::vector<std::string> managers = {"abc", "def", "ghi"};
+    auto make_updates = [object_ids, managers](GcsChangeMode change_mode) {
+      std::vector<gcs::SetUpdate<ObjectID, ObjectTableData>> updates;
+      for (const auto &object_id : object_ids) {
+        for (const auto &manager : managers) {
+          auto data = std::make_shared<ObjectTableData>();
+          data->set_manager(manager);
+          // Update the same entry twice. Expect no notification for the second
+          // update, since it doesn't change the set.
+          for (int k = 0; k < 2; k++) {
+            updates.push_back({object_id, change_mode, data});
+          }
+        }
+      }
+      return updates;
+    };
+    const size_t num_updates = object_ids.size() * managers.size();
+    const size_t num_callbacks = num_updates * 2 + object_ids.size();
+
+    // Callback for a lookup once all entries are removed.
+    auto lookup_callback = [num_callbacks](gcs::RedisGcsClient *client,
+                                           const ObjectID &id,
+                                           const std::vector<ObjectTableData> &data) {
+      ASSERT_TRUE(data.empty());
+      test->IncrementNumCallbacks();
+      if (test->NumCallbacks() == num_callbacks) {
+        test->Stop();
+      }
+    };
+
+    // Callback for a notification. The batched notifications are delivered as one
+    // notification per changed entry.
+    auto num_adds = std::make_shared<size_t>(0);
+    auto num_removes = std::make_shared<size_t>(0);
+    auto notification_callback =
+        [job_id, object_ids, num_adds, num_removes, num_updates, lookup_callback](
+            gcs::RedisGcsClient *client, const ObjectID &id,
+            const std::vector<ObjectChangeNotification> &notifications) {
+          ASSERT_EQ(notifications.size(), 1);
+          ASSERT_EQ(notifications[0].GetData().size(), 1);
+          ASSERT_TRUE(std::find(object_ids.begin(), object_ids.end(), id) !=
+                      object_ids.end());
+          if (notifications[0].GetGcsChangeMode() == GcsChangeMode::APPEND_OR_ADD) {
+            (*num_adds)++;
+          } else {
+            (*num_removes)++;
+          }
+          test->IncrementNumCallbacks();
+          if (*num_adds == num_updates && *num_removes == num_updates) {
+            for (const auto &object_id : object_ids) {
+              RAY_CHECK_OK(
+                  client->object_table().Lookup(job_id, object_id, lookup_callback));
+            }
+          }
+        };
+
+    // Callback for subscription success. Add all entries in one batch, then remove
+    // them in another.
+    auto subscribe_callback = [job_id, make_updates](gcs::RedisGcsClient *client) {
+      RAY_CHECK_OK(client->object_table().BatchUpdate(
+          job_id, make_updates(GcsChangeMode::APPEND_OR_ADD),
+          [client, job_id, make_updates](Status status) {
+            RAY_CHECK_OK(status);
+            RAY_CHECK_OK(client->object_table().BatchUpdate(
+                job_id, make_updates(GcsChangeMode::REMOVE), nullptr));
+          }));
+    };
+
+    RAY_CHECK_OK(client->object_table().Subscribe(
+        job_id, ClientID::Nil(), notification_callback, subscribe_callback));
+
+    // Run the event loop. The loop will only stop once the entries are looked up
+    // after all notifications are received (or an assertion failure).
+    test->Start();
+    // Check that we received one notification for each change, and one lookup
+    // callback per key.
+    ASSERT_EQ(*num_adds, num_updates);
+    ASSERT_EQ(*num_removes, num_updates);
+    ASSERT_EQ(test->NumCallbacks(), num_callbacks);
+  }
+
   static void TestSetSubscribeId(const JobID &job_id,
                                  std::shared_ptr<gcs::RedisGcsClient> client) {
     // Add a set entry.
@@ -1142,6 +1229,11 @@ TEST_F(TestGcsWithAsio, TestSetSubscribeAll) {
   SetTestHelper::TestSetSubscribeAll(job_id_, client_);
 }
 
+TEST_F(TestGcsWithAsio, TestSetBatchUpdate) {
+  test = this;
+  SetTestHelper::TestSetBatchUpdate(job_id_, client_);
+}
+
 TEST_TASK_TABLE_MACRO(TestGcsWithAsio, TestTableSubscribeId);
 
 TEST_F(TestGcsWithAsio, TestLogSubscribeId) {
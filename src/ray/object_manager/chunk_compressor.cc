@@ -0,0 +1,192 @@
+#include "ray/object_manager/chunk_compressor.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include "absl/time/clock.h"
+#include "ray/stats/stats.h"
+#include "ray/util/logging.h"
+
+namespace {
+
+/// The zstd compression level. Low levels compress at several hundred MB/s, which
+/// keeps compression from becoming the bottleneck of a transfer.
+constexpr int kZstdCompressionLevel = 1;
+
+ray::rpc::CompressionCodec ParseCodec(const std::string &codec_name) {
+  if (codec_name == "lz4") {
+    return ray::rpc::COMPRESSION_LZ4;
+  } else if (codec_name == "zstd") {
+    return ray::rpc::COMPRESSION_ZSTD;
+  }
+  RAY_CHECK(codec_name.empty() || codec_name == "none")
+      << "Unknown object transfer compression codec " << codec_name;
+  return ray::rpc::COMPRESSION_NONE;
+}
+
+std::string CodecName(ray::rpc::CompressionCodec codec) {
+  switch (codec) {
+  case ray::rpc::COMPRESSION_LZ4:
+    return "lz4";
+  case ray::rpc::COMPRESSION_ZSTD:
+    return "zstd";
+  default:
+    return "none";
+  }
+}
+
+}  // namespace
+
+namespace ray {
+
+ChunkCompressor::ChunkCompressor(const std::string &codec_name, uint64_t min_chunk_size,
+                                 int64_t max_ratio_percent)
+    : codec_(ParseCodec(codec_name)),
+      min_chunk_size_(min_chunk_size),
+      max_ratio_percent_(max_ratio_percent) {}
+
+std::vector<rpc::CompressionCodec> ChunkCompressor::SupportedCodecs() {
+  return {rpc::COMPRESSION_LZ4, rpc::COMPRESSION_ZSTD};
+}
+
+rpc::CompressionCodec ChunkCompressor::Negotiate(
+    const std::vector<rpc::CompressionCodec> &accepted_codecs) const {
+  if (std::find(accepted_codecs.begin(), accepted_codecs.end(), codec_) ==
+      accepted_codecs.end()) {
+    return rpc::COMPRESSION_NONE;
+  }
+  return codec_;
+}
+
+rpc::CompressionCodec ChunkCompressor::Compress(rpc::CompressionCodec codec,
+                                                const uint8_t *data, uint64_t size,
+                                                std::string *compressed) {
+  if (codec == rpc::COMPRESSION_NONE || size < min_chunk_size_) {
+    return rpc::COMPRESSION_NONE;
+  }
+  int64_t start_time_ns = absl::GetCurrentTimeNanos();
+  int64_t compressed_size = 0;
+  switch (codec) {
+  case rpc::COMPRESSION_LZ4: {
+    RAY_CHECK(size <= LZ4_MAX_INPUT_SIZE);
+    compressed->resize(LZ4_compressBound(static_cast<int>(size)));
+    compressed_size = LZ4_compress_default(
+        reinterpret_cast<const char *>(data), &(*compressed)[0], static_cast<int>(size),
+        static_cast<int>(compressed->size()));
+    break;
+  }
+  case rpc::COMPRESSION_ZSTD: {
+    compressed->resize(ZSTD_compressBound(size));
+    size_t result = ZSTD_compress(&(*compressed)[0], compressed->size(), data, size,
+                                  kZstdCompressionLevel);
+    compressed_size = ZSTD_isError(result) ? 0 : static_cast<int64_t>(result);
+    break;
+  }
+  default:
+    RAY_LOG(FATAL) << "Unsupported compression codec " << codec;
+  }
+  int64_t elapsed_ns = absl::GetCurrentTimeNanos() - start_time_ns;
+
+  bool worthwhile =
+      compressed_size > 0 &&
+      compressed_size * 100 <= static_cast<int64_t>(size) * max_ratio_percent_;
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    auto &stats = stats_[codec];
+    stats.input_bytes += size;
+    stats.compress_time_ns += elapsed_ns;
+    if (worthwhile) {
+      stats.num_compressed++;
+      stats.uncompressed_bytes += size;
+      stats.compressed_bytes += compressed_size;
+    } else {
+      stats.num_skipped++;
+    }
+  }
+  if (!worthwhile) {
+    return rpc::COMPRESSION_NONE;
+  }
+  compressed->resize(compressed_size);
+  return codec;
+}
+
+Status ChunkCompressor::Decompress(rpc::CompressionCodec codec, const uint8_t *data,
+                                   uint64_t size, uint8_t *dest, uint64_t dest_size) {
+  int64_t start_time_ns = absl::GetCurrentTimeNanos();
+  bool ok = false;
+  switch (codec) {
+  case rpc::COMPRESSION_LZ4: {
+    int result = LZ4_decompress_safe(reinterpret_cast<const char *>(data),
+                                     reinterpret_cast<char *>(dest),
+                                     static_cast<int>(size), static_cast<int>(dest_size));
+    ok = result >= 0 && static_cast<uint64_t>(result) == dest_size;
+    break;
+  }
+  case rpc::COMPRESSION_ZSTD: {
+    size_t result = ZSTD_decompress(dest, dest_size, data, size);
+    ok = !ZSTD_isError(result) && result == dest_size;
+    break;
+  }
+  default:
+    return Status::Invalid("Unsupported compression codec " + CodecName(codec) + ".");
+  }
+  if (!ok) {
+    return Status::Invalid("Failed to decompress " + CodecName(codec) + " chunk.");
+  }
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  auto &stats = stats_[codec];
+  stats.decompressed_bytes += dest_size;
+  stats.decompress_time_ns += absl::GetCurrentTimeNanos() - start_time_ns;
+  return Status::OK();
+}
+
+void ChunkCompressor::RecordMetrics() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  for (const auto &pair : stats_) {
+    const std::string codec = CodecName(static_cast<rpc::CompressionCodec>(pair.first));
+    const auto &stats = pair.second;
+    stats::ObjectTransferCompressionStats().Record(
+        stats.num_compressed,
+        {{stats::CodecKey, codec}, {stats::ValueTypeKey, "num_compressed_chunks"}});
+    stats::ObjectTransferCompressionStats().Record(
+        stats.num_skipped,
+        {{stats::CodecKey, codec}, {stats::ValueTypeKey, "num_skipped_chunks"}});
+    if (stats.uncompressed_bytes > 0) {
+      stats::ObjectTransferCompressionStats().Record(
+          static_cast<double>(stats.compressed_bytes) / stats.uncompressed_bytes,
+          {{stats::CodecKey, codec}, {stats::ValueTypeKey, "compression_ratio"}});
+    }
+    if (stats.compress_time_ns > 0) {
+      // Bytes per nanosecond is GB/s.
+      stats::ObjectTransferCompressionStats().Record(
+          static_cast<double>(stats.input_bytes) / stats.compress_time_ns,
+          {{stats::CodecKey, codec}, {stats::ValueTypeKey, "compress_gbps"}});
+    }
+    if (stats.decompress_time_ns > 0) {
+      stats::ObjectTransferCompressionStats().Record(
+          static_cast<double>(stats.decompressed_bytes) / stats.decompress_time_ns,
+          {{stats::CodecKey, codec}, {stats::ValueTypeKey, "decompress_gbps"}});
+    }
+  }
+}
+
+std::string ChunkCompressor::DebugString() const {
+  std::stringstream result;
+  result << "ChunkCompressor:";
+  result << "\n- codec: " << CodecName(codec_);
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  for (const auto &pair : stats_) {
+    const auto &stats = pair.second;
+    result << "\n- " << CodecName(static_cast<rpc::CompressionCodec>(pair.first))
+           << ": compressed chunks: " << stats.num_compressed
+           << ", skipped chunks: " << stats.num_skipped
+           << ", compressed bytes: " << stats.compressed_bytes << "/"
+           << stats.uncompressed_bytes;
+  }
+  return result.str();
+}
+
+}  // namespace ray
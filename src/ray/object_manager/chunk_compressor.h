@@ -0,0 +1,112 @@
+#ifndef RAY_OBJECT_MANAGER_CHUNK_COMPRESSOR_H
+#define RAY_OBJECT_MANAGER_CHUNK_COMPRESSOR_H
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ray/common/status.h"
+#include "src/ray/protobuf/object_manager.pb.h"
+
+namespace ray {
+
+/// \class ChunkCompressor
+///
+/// Compresses object chunks sent to remote object managers, and decompresses the
+/// chunks received from them.
+///
+/// The codec is negotiated per remote object manager: each pull request lists the
+/// codecs that the requester can decompress, and chunks pushed to it are compressed
+/// with the configured codec only if it is among those. A chunk is sent uncompressed
+/// if it is smaller than the minimum size, or if compression doesn't shrink it by
+/// enough, so that incompressible data doesn't pay for decompression.
+///
+/// This class is thread-safe.
+class ChunkCompressor {
+ public:
+  /// Constructor.
+  ///
+  /// \param codec_name The codec to compress chunks with: "lz4", "zstd" or "none".
+  /// \param min_chunk_size Chunks smaller than this are never compressed.
+  /// \param max_ratio_percent Compressed chunks larger than this percentage of the
+  /// uncompressed size are sent uncompressed.
+  ChunkCompressor(const std::string &codec_name, uint64_t min_chunk_size,
+                  int64_t max_ratio_percent);
+
+  /// Return the codecs this object manager can decompress.
+  static std::vector<rpc::CompressionCodec> SupportedCodecs();
+
+  /// Choose the codec for chunks pushed to a remote object manager.
+  ///
+  /// \param accepted_codecs The codecs the remote object manager can decompress.
+  /// \return The configured codec if it is accepted, and COMPRESSION_NONE otherwise.
+  rpc::CompressionCodec Negotiate(
+      const std::vector<rpc::CompressionCodec> &accepted_codecs) const;
+
+  /// Compress a chunk.
+  ///
+  /// \param codec The codec negotiated with the receiver.
+  /// \param data The chunk data.
+  /// \param size The size of the chunk data.
+  /// \param[out] compressed The compressed chunk. Only set if compression is used.
+  /// \return The codec the chunk was compressed with, or COMPRESSION_NONE if it
+  /// should be sent uncompressed.
+  rpc::CompressionCodec Compress(rpc::CompressionCodec codec, const uint8_t *data,
+                                 uint64_t size, std::string *compressed);
+
+  /// Decompress a chunk.
+  ///
+  /// \param codec The codec the chunk was compressed with.
+  /// \param data The compressed chunk.
+  /// \param size The size of the compressed chunk.
+  /// \param[out] dest The buffer to decompress into.
+  /// \param dest_size The size of the uncompressed chunk.
+  /// \return Status::Invalid if the chunk is corrupt or the codec is unsupported.
+  Status Decompress(rpc::CompressionCodec codec, const uint8_t *data, uint64_t size,
+                    uint8_t *dest, uint64_t dest_size);
+
+  /// Record per-codec compression ratio and throughput metrics.
+  void RecordMetrics() const;
+
+  /// Returns debug string for class.
+  ///
+  /// \return string.
+  std::string DebugString() const;
+
+ private:
+  /// Compression statistics of a single codec.
+  struct CodecStats {
+    /// The number of chunks compressed.
+    int64_t num_compressed = 0;
+    /// The number of chunks sent uncompressed because they didn't shrink enough.
+    int64_t num_skipped = 0;
+    /// The uncompressed size of the compressed chunks.
+    int64_t uncompressed_bytes = 0;
+    /// The compressed size of the compressed chunks.
+    int64_t compressed_bytes = 0;
+    /// The size of all chunks compression was tried on, including skipped chunks.
+    int64_t input_bytes = 0;
+    /// The time spent compressing, including skipped chunks.
+    int64_t compress_time_ns = 0;
+    /// The uncompressed size of the decompressed chunks.
+    int64_t decompressed_bytes = 0;
+    /// The time spent decompressing.
+    int64_t decompress_time_ns = 0;
+  };
+
+  /// The codec to compress chunks with.
+  const rpc::CompressionCodec codec_;
+  /// Chunks smaller than this are never compressed.
+  const uint64_t min_chunk_size_;
+  /// Compressed chunks larger than this percentage of the uncompressed size are sent
+  /// uncompressed.
+  const int64_t max_ratio_percent_;
+  /// Statistics per codec, protected by stats_mutex_.
+  std::unordered_map<int, CodecStats> stats_;
+  mutable std::mutex stats_mutex_;
+};
+
+}  // namespace ray
+
+#endif  // RAY_OBJECT_MANAGER_CHUNK_COMPRESSOR_H
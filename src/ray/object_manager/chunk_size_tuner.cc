@@ -0,0 +1,99 @@
+#include "ray/object_manager/chunk_size_tuner.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "ray/util/logging.h"
+
+namespace {
+
+/// The weight of a new measurement in the moving average of the bandwidth.
+constexpr double kBandwidthSmoothing = 0.25;
+
+/// Chunk sizes are rounded to a multiple of the page size.
+constexpr uint64_t kChunkSizeAlignment = 4096;
+
+}  // namespace
+
+namespace ray {
+
+ChunkSizeTuner::ChunkSizeTuner(uint64_t default_chunk_size, uint64_t min_chunk_size,
+                               uint64_t max_chunk_size, int64_t target_chunk_time_us,
+                               uint64_t max_chunks_per_object)
+    : default_chunk_size_(default_chunk_size),
+      min_chunk_size_(std::max<uint64_t>(min_chunk_size, 1)),
+      max_chunk_size_(std::max(max_chunk_size, min_chunk_size_)),
+      target_chunk_time_us_(target_chunk_time_us),
+      max_chunks_per_object_(std::max<uint64_t>(max_chunks_per_object, 1)) {}
+
+void ChunkSizeTuner::RecordChunkSent(const ClientID &client_id, int64_t send_time_us) {
+  auto &peer = peers_[client_id];
+  if (peer.num_chunks_in_flight == 0) {
+    // The link was idle, so don't count the idle time.
+    peer.last_event_time_us = send_time_us;
+  }
+  peer.num_chunks_in_flight++;
+}
+
+void ChunkSizeTuner::RecordChunkAcked(const ClientID &client_id, uint64_t num_bytes,
+                                      int64_t ack_time_us, bool success) {
+  auto it = peers_.find(client_id);
+  if (it == peers_.end() || it->second.num_chunks_in_flight == 0) {
+    return;
+  }
+  auto &peer = it->second;
+  peer.num_chunks_in_flight--;
+  int64_t elapsed_us = ack_time_us - peer.last_event_time_us;
+  peer.last_event_time_us = ack_time_us;
+  if (!success || num_bytes == 0) {
+    return;
+  }
+  double sample = static_cast<double>(num_bytes) / std::max<int64_t>(elapsed_us, 1);
+  if (peer.bandwidth == 0) {
+    peer.bandwidth = sample;
+  } else {
+    peer.bandwidth += kBandwidthSmoothing * (sample - peer.bandwidth);
+  }
+}
+
+uint64_t ChunkSizeTuner::ChooseChunkSize(const ClientID &client_id,
+                                         uint64_t data_size) const {
+  uint64_t chunk_size = default_chunk_size_;
+  double bandwidth = GetBandwidth(client_id);
+  if (bandwidth > 0) {
+    chunk_size = static_cast<uint64_t>(bandwidth * target_chunk_time_us_);
+  }
+  chunk_size = std::min(std::max(chunk_size, min_chunk_size_), max_chunk_size_);
+  // Don't split large objects into so many chunks that per-chunk overhead dominates.
+  uint64_t min_for_object = (data_size + max_chunks_per_object_ - 1) /
+                            max_chunks_per_object_;
+  chunk_size = std::max(chunk_size, min_for_object);
+  chunk_size = (chunk_size + kChunkSizeAlignment - 1) / kChunkSizeAlignment *
+               kChunkSizeAlignment;
+  chunk_size = std::min(chunk_size, max_chunk_size_);
+  // An object that fits into a single chunk doesn't need a larger buffer.
+  if (data_size > 0 && chunk_size > data_size) {
+    chunk_size = data_size;
+  }
+  return std::max<uint64_t>(chunk_size, 1);
+}
+
+double ChunkSizeTuner::GetBandwidth(const ClientID &client_id) const {
+  auto it = peers_.find(client_id);
+  return it == peers_.end() ? 0 : it->second.bandwidth;
+}
+
+std::string ChunkSizeTuner::DebugString() const {
+  std::stringstream result;
+  result << "ChunkSizeTuner:";
+  result << "\n- chunk size range: " << min_chunk_size_ << "-" << max_chunk_size_;
+  for (const auto &pair : peers_) {
+    if (pair.second.bandwidth > 0) {
+      // Bytes per microsecond is MB/s.
+      result << "\n- " << pair.first << ": " << pair.second.bandwidth << " MB/s";
+    }
+  }
+  return result.str();
+}
+
+}  // namespace ray
@@ -0,0 +1,101 @@
+#ifndef RAY_OBJECT_MANAGER_CHUNK_SIZE_TUNER_H
+#define RAY_OBJECT_MANAGER_CHUNK_SIZE_TUNER_H
+
+#include <string>
+#include <unordered_map>
+
+#include "ray/common/id.h"
+
+namespace ray {
+
+/// \class ChunkSizeTuner
+///
+/// Chooses the chunk size of each object transfer from the size of the object and
+/// the bandwidth measured to the receiving object manager.
+///
+/// Small chunks keep per-chunk latency low on slow links and let small objects be
+/// transferred with several chunks in flight, while large chunks amortize the
+/// per-chunk RPC and plasma overhead on fast links. The tuner aims for chunks that
+/// take a fixed amount of time to transfer at the measured bandwidth, and grows them
+/// further so that no object is split into more than a bounded number of chunks.
+///
+/// This class is not thread-safe.
+class ChunkSizeTuner {
+ public:
+  /// Constructor.
+  ///
+  /// \param default_chunk_size The chunk size used for peers without measurements.
+  /// \param min_chunk_size The smallest chunk size to choose.
+  /// \param max_chunk_size The largest chunk size to choose.
+  /// \param target_chunk_time_us The time a single chunk should take to transfer.
+  /// \param max_chunks_per_object Objects are split into at most this many chunks,
+  /// unless that would exceed the maximum chunk size.
+  ChunkSizeTuner(uint64_t default_chunk_size, uint64_t min_chunk_size,
+                 uint64_t max_chunk_size, int64_t target_chunk_time_us,
+                 uint64_t max_chunks_per_object);
+
+  /// Record that a chunk was sent to a remote object manager.
+  ///
+  /// \param client_id The remote object manager the chunk was sent to.
+  /// \param send_time_us The time when the chunk was sent.
+  void RecordChunkSent(const ClientID &client_id, int64_t send_time_us);
+
+  /// Record the acknowledgement of a chunk sent to a remote object manager.
+  ///
+  /// While several chunks are in flight, each one waits behind the others, so its
+  /// round trip time says little about the bandwidth. The bandwidth is instead
+  /// measured as the bytes acknowledged over the time since the previous
+  /// acknowledgement, or since the first chunk was sent if none were in flight.
+  ///
+  /// \param client_id The remote object manager the chunk was sent to.
+  /// \param num_bytes The size of the chunk.
+  /// \param ack_time_us The time when the chunk was acknowledged.
+  /// \param success Whether the chunk was received.
+  void RecordChunkAcked(const ClientID &client_id, uint64_t num_bytes,
+                        int64_t ack_time_us, bool success);
+
+  /// Choose the chunk size for a transfer.
+  ///
+  /// \param client_id The remote object manager the object is sent to.
+  /// \param data_size The sum of the object size and metadata size.
+  /// \return The chunk size to split the object into.
+  uint64_t ChooseChunkSize(const ClientID &client_id, uint64_t data_size) const;
+
+  /// Return the measured bandwidth to a remote object manager in bytes per
+  /// microsecond, or 0 if nothing was measured yet.
+  double GetBandwidth(const ClientID &client_id) const;
+
+  /// Returns debug string for class.
+  ///
+  /// \return string.
+  std::string DebugString() const;
+
+ private:
+  /// The chunk size used for peers without measurements.
+  const uint64_t default_chunk_size_;
+  /// The smallest chunk size to choose.
+  const uint64_t min_chunk_size_;
+  /// The largest chunk size to choose.
+  const uint64_t max_chunk_size_;
+  /// The time a single chunk should take to transfer.
+  const int64_t target_chunk_time_us_;
+  /// Objects are split into at most this many chunks.
+  const uint64_t max_chunks_per_object_;
+  /// The measurements of a remote object manager.
+  struct PeerState {
+    /// The moving average of the bandwidth, in bytes per microsecond, or 0 if
+    /// nothing was measured yet.
+    double bandwidth = 0;
+    /// The number of chunks sent but not acknowledged yet.
+    int64_t num_chunks_in_flight = 0;
+    /// The time of the last acknowledgement, or of the first send after the link
+    /// was idle.
+    int64_t last_event_time_us = 0;
+  };
+  /// The measurements of each remote object manager.
+  std::unordered_map<ClientID, PeerState> peers_;
+};
+
+}  // namespace ray
+
+#endif  // RAY_OBJECT_MANAGER_CHUNK_SIZE_TUNER_H
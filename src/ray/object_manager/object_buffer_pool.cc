@@ -27,19 +27,19 @@ ObjectBufferPool::~ObjectBufferPool() {
   RAY_ARROW_CHECK_OK(store_client_.Disconnect());
 }
 
-uint64_t ObjectBufferPool::GetNumChunks(uint64_t data_size) {
-  return (data_size + default_chunk_size_ - 1) / default_chunk_size_;
+uint64_t ObjectBufferPool::GetNumChunks(uint64_t data_size, uint64_t chunk_size) {
+  return (data_size + chunk_size - 1) / chunk_size;
 }
 
-uint64_t ObjectBufferPool::GetBufferLength(uint64_t chunk_index, uint64_t data_size) {
-  return (chunk_index + 1) * default_chunk_size_ > data_size
-             ? data_size % default_chunk_size_
-             : default_chunk_size_;
+uint64_t ObjectBufferPool::GetBufferLength(uint64_t chunk_index, uint64_t data_size,
+                                           uint64_t chunk_size) {
+  return (chunk_index + 1) * chunk_size > data_size ? data_size % chunk_size
+                                                    : chunk_size;
 }
 
 std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> ObjectBufferPool::GetChunk(
     const ObjectID &object_id, uint64_t data_size, uint64_t metadata_size,
-    uint64_t chunk_index) {
+    uint64_t chunk_index, uint64_t chunk_size) {
   std::lock_guard<std::mutex> lock(pool_mutex_);
   if (get_buffer_state_.count(object_id) == 0) {
     plasma::ObjectBuffer object_buffer;
@@ -56,15 +56,19 @@ std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> ObjectBufferPool::Ge
     RAY_CHECK(data_size == static_cast<uint64_t>(object_buffer.data->size() +
                                                  object_buffer.metadata->size()));
     auto *data = const_cast<uint8_t *>(object_buffer.data->data());
-    uint64_t num_chunks = GetNumChunks(data_size);
-    get_buffer_state_.emplace(
-        std::piecewise_construct, std::forward_as_tuple(object_id),
-        std::forward_as_tuple(BuildChunks(object_id, data, data_size)));
-    RAY_CHECK(get_buffer_state_[object_id].chunk_info.size() == num_chunks);
+    get_buffer_state_.emplace(std::piecewise_construct, std::forward_as_tuple(object_id),
+                              std::forward_as_tuple(data, data_size));
   }
-  get_buffer_state_[object_id].references++;
-  return std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status>(
-      get_buffer_state_[object_id].chunk_info[chunk_index], ray::Status::OK());
+  auto &buffer_state = get_buffer_state_[object_id];
+  auto &chunks = buffer_state.chunk_info[chunk_size];
+  if (chunks.empty()) {
+    chunks =
+        BuildChunks(object_id, buffer_state.data, buffer_state.data_size, chunk_size);
+    RAY_CHECK(chunks.size() == GetNumChunks(data_size, chunk_size));
+  }
+  buffer_state.references++;
+  return std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status>(chunks[chunk_index],
+                                                                     ray::Status::OK());
 }
 
 void ObjectBufferPool::ReleaseGetChunk(const ObjectID &object_id, uint64_t chunk_index) {
@@ -85,7 +89,7 @@ void ObjectBufferPool::AbortGet(const ObjectID &object_id) {
 
 std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> ObjectBufferPool::CreateChunk(
     const ObjectID &object_id, uint64_t data_size, uint64_t metadata_size,
-    uint64_t chunk_index) {
+    uint64_t chunk_index, uint64_t chunk_size) {
   std::lock_guard<std::mutex> lock(pool_mutex_);
   if (create_buffer_state_.count(object_id) == 0) {
     const plasma::ObjectID plasma_id = object_id.ToPlasmaId();
@@ -104,15 +108,25 @@ std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> ObjectBufferPool::Cr
     }
     // Read object into store.
     uint8_t *mutable_data = data->mutable_data();
-    uint64_t num_chunks = GetNumChunks(data_size);
+    uint64_t num_chunks = GetNumChunks(data_size, chunk_size);
     create_buffer_state_.emplace(
         std::piecewise_construct, std::forward_as_tuple(object_id),
-        std::forward_as_tuple(BuildChunks(object_id, mutable_data, data_size)));
+        std::forward_as_tuple(BuildChunks(object_id, mutable_data, data_size, chunk_size),
+                              data_size, metadata_size, chunk_size));
     RAY_LOG(DEBUG) << "Created object " << object_id
                    << " in plasma store, number of chunks: " << num_chunks
                    << ", chunk index: " << chunk_index;
     RAY_CHECK(create_buffer_state_[object_id].chunk_info.size() == num_chunks);
   }
+  if (create_buffer_state_[object_id].chunk_size != chunk_size) {
+    // Another sender is pushing the same object in chunks of a different size. Pull
+    // requests carry the size in use, so senders asked to retry use the same one.
+    std::string message = "Object is received in chunks of " +
+                          std::to_string(create_buffer_state_[object_id].chunk_size) +
+                          " bytes.";
+    return std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status>(
+        errored_chunk_, ray::Status::IOError(message));
+  }
   if (create_buffer_state_[object_id].chunk_state[chunk_index] !=
       CreateChunkState::AVAILABLE) {
     // There can be only one reference to this chunk at any given time.
@@ -162,6 +176,49 @@ void ObjectBufferPool::SealChunk(const ObjectID &object_id, const uint64_t chunk
   }
 }
 
+bool ObjectBufferPool::GetCreateObjectSizes(const ObjectID &object_id,
+                                            uint64_t *data_size,
+                                            uint64_t *metadata_size,
+                                            uint64_t *chunk_size) const {
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  auto it = create_buffer_state_.find(object_id);
+  if (it == create_buffer_state_.end()) {
+    return false;
+  }
+  *data_size = it->second.data_size;
+  *metadata_size = it->second.metadata_size;
+  *chunk_size = it->second.chunk_size;
+  return true;
+}
+
+bool ObjectBufferPool::IsCreateChunkSealed(const ObjectID &object_id,
+                                           uint64_t chunk_index,
+                                           uint64_t chunk_size) const {
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  auto it = create_buffer_state_.find(object_id);
+  return it != create_buffer_state_.end() && it->second.chunk_size == chunk_size &&
+         chunk_index < it->second.chunk_state.size() &&
+         it->second.chunk_state[chunk_index] == CreateChunkState::SEALED;
+}
+
+bool ObjectBufferPool::CopySealedCreateChunk(const ObjectID &object_id,
+                                             uint64_t chunk_index, uint64_t chunk_size,
+                                             std::string *data) const {
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  auto it = create_buffer_state_.find(object_id);
+  if (it == create_buffer_state_.end() || it->second.chunk_size != chunk_size ||
+      chunk_index >= it->second.chunk_state.size() ||
+      it->second.chunk_state[chunk_index] != CreateChunkState::SEALED) {
+    return false;
+  }
+  // The buffer stays valid while the object is in create_buffer_state_, which
+  // the lock guarantees.
+  const ChunkInfo &chunk_info = it->second.chunk_info[chunk_index];
+  data->assign(reinterpret_cast<const char *>(chunk_info.data),
+               chunk_info.buffer_length);
+  return true;
+}
+
 void ObjectBufferPool::AbortCreate(const ObjectID &object_id) {
   const plasma::ObjectID plasma_id = object_id.ToPlasmaId();
   RAY_ARROW_CHECK_OK(store_client_.Release(plasma_id));
@@ -170,18 +227,18 @@ void ObjectBufferPool::AbortCreate(const ObjectID &object_id) {
 }
 
 std::vector<ObjectBufferPool::ChunkInfo> ObjectBufferPool::BuildChunks(
-    const ObjectID &object_id, uint8_t *data, uint64_t data_size) {
+    const ObjectID &object_id, uint8_t *data, uint64_t data_size, uint64_t chunk_size) {
   uint64_t space_remaining = data_size;
   std::vector<ChunkInfo> chunks;
   int64_t position = 0;
   while (space_remaining) {
     position = data_size - space_remaining;
-    if (space_remaining < default_chunk_size_) {
+    if (space_remaining < chunk_size) {
       chunks.emplace_back(chunks.size(), data + position, space_remaining);
       space_remaining = 0;
     } else {
-      chunks.emplace_back(chunks.size(), data + position, default_chunk_size_);
-      space_remaining -= default_chunk_size_;
+      chunks.emplace_back(chunks.size(), data + position, chunk_size);
+      space_remaining -= chunk_size;
     }
   }
   return chunks;
@@ -38,7 +38,7 @@ class ObjectBufferPool {
   ///
   /// \param store_socket_name The socket name of the store to which plasma clients
   /// connect.
-  /// \param chunk_size The chunk size into which objects are to be split.
+  /// \param chunk_size The chunk size into which objects are split by default.
   ObjectBufferPool(const std::string &store_socket_name, const uint64_t chunk_size);
 
   ~ObjectBufferPool();
@@ -46,18 +46,30 @@ class ObjectBufferPool {
   /// This object cannot be copied due to pool_mutex.
   RAY_DISALLOW_COPY_AND_ASSIGN(ObjectBufferPool);
 
+  /// Return the chunk size into which objects are split by default.
+  uint64_t GetDefaultChunkSize() const { return default_chunk_size_; }
+
   /// Computes the number of chunks needed to transfer an object and its metadata.
   ///
   /// \param data_size The size of the object + metadata.
+  /// \param chunk_size The chunk size into which the object is split.
   /// \return The number of chunks into which the object will be split.
-  uint64_t GetNumChunks(uint64_t data_size);
+  static uint64_t GetNumChunks(uint64_t data_size, uint64_t chunk_size);
+
+  /// Computes the number of chunks needed to transfer an object and its metadata,
+  /// using the default chunk size.
+  uint64_t GetNumChunks(uint64_t data_size) const {
+    return GetNumChunks(data_size, default_chunk_size_);
+  }
 
   /// Computes the buffer length of a chunk of an object.
   ///
   /// \param chunk_index The chunk index for which to obtain the buffer length.
   /// \param data_size The size of the object + metadata.
+  /// \param chunk_size The chunk size into which the object is split.
   /// \return The buffer length of the chunk at chunk_index.
-  uint64_t GetBufferLength(uint64_t chunk_index, uint64_t data_size);
+  static uint64_t GetBufferLength(uint64_t chunk_index, uint64_t data_size,
+                                  uint64_t chunk_size);
 
   /// Returns a chunk of an object at the given chunk_index. The object chunk serves
   /// as the data that is to be written to a connection as part of sending an object to
@@ -67,11 +79,13 @@ class ObjectBufferPool {
   /// \param data_size The sum of the object size and metadata size.
   /// \param metadata_size The size of the metadata.
   /// \param chunk_index The index of the chunk.
+  /// \param chunk_size The chunk size into which the object is split. Concurrent
+  /// gets of the same object may use different chunk sizes.
   /// \return A pair consisting of a ChunkInfo and status of invoking this method.
   /// An IOError status is returned if the Get call on the plasma store fails.
   std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> GetChunk(
       const ObjectID &object_id, uint64_t data_size, uint64_t metadata_size,
-      uint64_t chunk_index);
+      uint64_t chunk_index, uint64_t chunk_size);
 
   /// When a chunk is done being used as part of a get, this method releases the chunk.
   /// If all chunks of an object are released, the object buffer will be released.
@@ -92,13 +106,15 @@ class ObjectBufferPool {
   /// \param data_size The sum of the object size and metadata size.
   /// \param metadata_size The size of the metadata.
   /// \param chunk_index The index of the chunk.
+  /// \param chunk_size The chunk size into which the sender split the object.
   /// \return A pair consisting of ChunkInfo and status of invoking this method.
   /// An IOError status is returned if object creation on the store client fails,
-  /// or if create is invoked consecutively on the same chunk
-  /// (with no intermediate AbortCreateChunk).
+  /// if create is invoked consecutively on the same chunk
+  /// (with no intermediate AbortCreateChunk), or if the object is already being
+  /// created with a different chunk size.
   std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> CreateChunk(
       const ObjectID &object_id, uint64_t data_size, uint64_t metadata_size,
-      uint64_t chunk_index);
+      uint64_t chunk_index, uint64_t chunk_size);
 
   /// Abort the create operation associated with a chunk at chunk_index.
   /// This method will fail if it's invoked on a chunk_index on which
@@ -119,6 +135,40 @@ class ObjectBufferPool {
   /// \param chunk_index The index of the chunk.
   void SealChunk(const ObjectID &object_id, uint64_t chunk_index);
 
+  /// Get the sizes of an object that is currently being created, i.e., received
+  /// chunk by chunk.
+  ///
+  /// \param object_id The ObjectID.
+  /// \param[out] data_size The sum of the object size and metadata size.
+  /// \param[out] metadata_size The size of the metadata.
+  /// \param[out] chunk_size The chunk size the object is received in.
+  /// \return False if the object is not being created.
+  bool GetCreateObjectSizes(const ObjectID &object_id, uint64_t *data_size,
+                            uint64_t *metadata_size, uint64_t *chunk_size) const;
+
+  /// Check whether a chunk of an object that is currently being created has
+  /// already been written and sealed.
+  ///
+  /// \param object_id The ObjectID.
+  /// \param chunk_index The index of the chunk.
+  /// \param chunk_size The chunk size the chunk index refers to.
+  /// \return False if the object is not being created in chunks of this size or
+  /// the chunk is not sealed.
+  bool IsCreateChunkSealed(const ObjectID &object_id, uint64_t chunk_index,
+                           uint64_t chunk_size) const;
+
+  /// Copy a sealed chunk of an object that is currently being created. This allows
+  /// chunks to be relayed to other nodes before the whole object has been received.
+  ///
+  /// \param object_id The ObjectID.
+  /// \param chunk_index The index of the chunk.
+  /// \param chunk_size The chunk size the chunk index refers to.
+  /// \param[out] data The chunk data.
+  /// \return False if the object is not being created in chunks of this size or
+  /// the chunk is not sealed.
+  bool CopySealedCreateChunk(const ObjectID &object_id, uint64_t chunk_index,
+                             uint64_t chunk_size, std::string *data) const;
+
   /// Free a list of objects from object store.
   ///
   /// \param object_ids the The list of ObjectIDs to be deleted.
@@ -140,16 +190,21 @@ class ObjectBufferPool {
 
   /// Splits an object into ceil(data_size/chunk_size) chunks, which will
   /// either be read or written to in parallel.
-  std::vector<ChunkInfo> BuildChunks(const ObjectID &object_id, uint8_t *data,
-                                     uint64_t data_size);
+  static std::vector<ChunkInfo> BuildChunks(const ObjectID &object_id, uint8_t *data,
+                                            uint64_t data_size, uint64_t chunk_size);
 
   /// Holds the state of a get buffer.
   struct GetBufferState {
     GetBufferState() {}
-    GetBufferState(std::vector<ChunkInfo> chunk_info) : chunk_info(chunk_info) {}
-    /// A vector maintaining information about the chunks which comprise
-    /// an object.
-    std::vector<ChunkInfo> chunk_info;
+    GetBufferState(uint8_t *data, uint64_t data_size)
+        : data(data), data_size(data_size) {}
+    /// The start of the object's buffer.
+    uint8_t *data = nullptr;
+    /// The sum of the object size and metadata size.
+    uint64_t data_size = 0;
+    /// The chunks which comprise the object, for each chunk size the object is read
+    /// in. These are built on first use.
+    std::unordered_map<uint64_t, std::vector<ChunkInfo>> chunk_info;
     /// The number of references that currently rely on this buffer.
     /// Once this reaches 0, the buffer is released and this object is erased
     /// from get_buffer_state_.
@@ -162,10 +217,14 @@ class ObjectBufferPool {
   /// Holds the state of a create buffer.
   struct CreateBufferState {
     CreateBufferState() {}
-    CreateBufferState(std::vector<ChunkInfo> chunk_info)
+    CreateBufferState(std::vector<ChunkInfo> chunk_info, uint64_t data_size,
+                      uint64_t metadata_size, uint64_t chunk_size)
         : chunk_info(chunk_info),
           chunk_state(chunk_info.size(), CreateChunkState::AVAILABLE),
-          num_seals_remaining(chunk_info.size()) {}
+          num_seals_remaining(chunk_info.size()),
+          data_size(data_size),
+          metadata_size(metadata_size),
+          chunk_size(chunk_size) {}
     /// A vector maintaining information about the chunks which comprise
     /// an object.
     std::vector<ChunkInfo> chunk_info;
@@ -174,6 +233,12 @@ class ObjectBufferPool {
     std::vector<CreateChunkState> chunk_state;
     /// The number of chunks left to seal before the buffer is sealed.
     uint64_t num_seals_remaining;
+    /// The sum of the object size and metadata size.
+    uint64_t data_size;
+    /// The size of the metadata.
+    uint64_t metadata_size;
+    /// The chunk size into which the sender split the object.
+    uint64_t chunk_size;
   };
 
   /// Returned when GetChunk or CreateChunk fails.
@@ -1,10 +1,20 @@
 #include "ray/object_manager/object_directory.h"
 
+#include <algorithm>
+
+#include "ray/common/ray_config.h"
+
 namespace ray {
 
 ObjectDirectory::ObjectDirectory(boost::asio::io_service &io_service,
                                  std::shared_ptr<gcs::GcsClient> &gcs_client)
-    : io_service_(io_service), gcs_client_(gcs_client) {}
+    : io_service_(io_service),
+      gcs_client_(gcs_client),
+      update_batch_interval_(
+          RayConfig::instance().object_directory_update_batch_interval_ms()),
+      max_update_batch_size_(std::max<uint64_t>(
+          RayConfig::instance().object_directory_max_update_batch_size(), 1)),
+      flush_timer_(io_service) {}
 
 namespace {
 
@@ -14,11 +24,13 @@ using ray::rpc::ObjectTableData;
 
 /// Process a notification of the object table entries and store the result in
 /// node_ids. This assumes that node_ids already contains the result of the
-/// object table entries up to but not including this notification.
+/// object table entries up to but not including this notification. If object_size
+/// is not nullptr, the size of the object is stored there when an entry has it.
 void UpdateObjectLocations(bool is_added,
                            const std::vector<ObjectTableData> &location_updates,
                            std::shared_ptr<gcs::GcsClient> gcs_client,
-                           std::unordered_set<ClientID> *node_ids) {
+                           std::unordered_set<ClientID> *node_ids,
+                           uint64_t *object_size = nullptr) {
   // location_updates contains the updates of locations of the object.
   // with GcsChangeMode, we can determine whether the update mode is
   // addition or deletion.
@@ -26,6 +38,9 @@ void UpdateObjectLocations(bool is_added,
     ClientID node_id = ClientID::FromBinary(object_table_data.manager());
     if (is_added) {
       node_ids->insert(node_id);
+      if (object_size != nullptr && object_table_data.object_size() > 0) {
+        *object_size = object_table_data.object_size();
+      }
     } else {
       node_ids->erase(node_id);
     }
@@ -46,20 +61,68 @@ ray::Status ObjectDirectory::ReportObjectAdded(
     const ObjectID &object_id, const ClientID &client_id,
     const object_manager::protocol::ObjectInfoT &object_info) {
   RAY_LOG(DEBUG) << "Reporting object added to GCS " << object_id;
-  ray::Status status =
-      gcs_client_->Objects().AsyncAddLocation(object_id, client_id, nullptr);
-  return status;
+  AddLocationUpdate(object_id, client_id,
+                    object_info.data_size + object_info.metadata_size,
+                    /*is_add=*/true);
+  return ray::Status::OK();
 }
 
 ray::Status ObjectDirectory::ReportObjectRemoved(
     const ObjectID &object_id, const ClientID &client_id,
     const object_manager::protocol::ObjectInfoT &object_info) {
   RAY_LOG(DEBUG) << "Reporting object removed to GCS " << object_id;
-  ray::Status status =
-      gcs_client_->Objects().AsyncRemoveLocation(object_id, client_id, nullptr);
-  return status;
+  AddLocationUpdate(object_id, client_id,
+                    object_info.data_size + object_info.metadata_size,
+                    /*is_add=*/false);
+  return ray::Status::OK();
 };
 
+void ObjectDirectory::AddLocationUpdate(const ObjectID &object_id,
+                                        const ClientID &client_id, uint64_t object_size,
+                                        bool is_add) {
+  auto it = pending_update_index_.find(object_id);
+  if (it != pending_update_index_.end() &&
+      pending_updates_[it->second].node_id == client_id) {
+    // Only the latest update of a location needs to be sent.
+    pending_updates_[it->second].is_add = is_add;
+    pending_updates_[it->second].object_size = object_size;
+    return;
+  }
+  pending_update_index_[object_id] = pending_updates_.size();
+  pending_updates_.push_back({object_id, client_id, is_add, object_size});
+
+  if (pending_updates_.size() >= max_update_batch_size_) {
+    flush_timer_.cancel();
+    FlushLocationUpdates();
+  } else if (!flush_scheduled_) {
+    flush_scheduled_ = true;
+    flush_timer_.expires_from_now(update_batch_interval_);
+    flush_timer_.async_wait([this](const boost::system::error_code &error) {
+      if (error == boost::asio::error::operation_aborted) {
+        return;
+      }
+      FlushLocationUpdates();
+    });
+  }
+}
+
+void ObjectDirectory::FlushLocationUpdates() {
+  flush_scheduled_ = false;
+  if (pending_updates_.empty()) {
+    return;
+  }
+  std::vector<gcs::ObjectLocationUpdate> updates;
+  updates.swap(pending_updates_);
+  pending_update_index_.clear();
+  num_location_updates_ += updates.size();
+  num_location_batches_++;
+  auto status = gcs_client_->Objects().AsyncUpdateLocations(updates, nullptr);
+  if (!status.ok()) {
+    RAY_LOG(ERROR) << "Failed to report " << updates.size()
+                   << " object location updates to GCS: " << status.ToString();
+  }
+}
+
 void ObjectDirectory::LookupRemoteConnectionInfo(
     RemoteConnectionInfo &connection_info) const {
   auto node_info = gcs_client_->Nodes().Get(connection_info.client_id);
@@ -129,7 +192,8 @@ ray::Status ObjectDirectory::SubscribeObjectLocations(const UniqueID &callback_i
           // Update entries for this object.
           UpdateObjectLocations(object_notification.IsAdded(),
                                 object_notification.GetData(), gcs_client_,
-                                &it->second.current_object_locations);
+                                &it->second.current_object_locations,
+                                &it->second.object_size);
           // Copy the callbacks so that the callbacks can unsubscribe without interrupting
           // looping over the callbacks.
           auto callbacks = it->second.callbacks;
@@ -213,10 +277,25 @@ ray::Status ObjectDirectory::LookupLocations(const ObjectID &object_id,
   return status;
 }
 
+bool ObjectDirectory::GetCachedLocations(const ObjectID &object_id,
+                                         std::unordered_set<ClientID> *node_ids,
+                                         uint64_t *object_size) const {
+  auto it = listeners_.find(object_id);
+  if (it == listeners_.end() || !it->second.subscribed) {
+    return false;
+  }
+  *node_ids = it->second.current_object_locations;
+  *object_size = it->second.object_size;
+  return true;
+}
+
 std::string ObjectDirectory::DebugString() const {
   std::stringstream result;
   result << "ObjectDirectory:";
   result << "\n- num listeners: " << listeners_.size();
+  result << "\n- num pending location updates: " << pending_updates_.size();
+  result << "\n- num location updates sent: " << num_location_updates_;
+  result << "\n- num location update batches sent: " << num_location_batches_;
   return result.str();
 }
 
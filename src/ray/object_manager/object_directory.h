@@ -9,6 +9,8 @@
 
 #include "plasma/client.h"
 
+#include <boost/asio/deadline_timer.hpp>
+
 #include "ray/common/id.h"
 #include "ray/common/status.h"
 #include "ray/gcs/redis_gcs_client.h"
@@ -113,6 +115,17 @@ class ObjectDirectoryInterface {
       const ObjectID &object_id, const ClientID &client_id,
       const object_manager::protocol::ObjectInfoT &object_info) = 0;
 
+  /// Get the locations and size of an object from the locations cached for the
+  /// subscribed objects, without looking them up in the GCS.
+  ///
+  /// \param object_id The object's ObjectID.
+  /// \param node_ids The cached locations of the object are stored here.
+  /// \param object_size The size of the object is stored here, or 0 if it's unknown.
+  /// \return Whether the locations of the object are cached.
+  virtual bool GetCachedLocations(const ObjectID &object_id,
+                                  std::unordered_set<ClientID> *node_ids,
+                                  uint64_t *object_size) const = 0;
+
   /// Returns debug string for class.
   ///
   /// \return string.
@@ -155,6 +168,10 @@ class ObjectDirectory : public ObjectDirectoryInterface {
       const ObjectID &object_id, const ClientID &client_id,
       const object_manager::protocol::ObjectInfoT &object_info) override;
 
+  bool GetCachedLocations(const ObjectID &object_id,
+                          std::unordered_set<ClientID> *node_ids,
+                          uint64_t *object_size) const override;
+
   std::string DebugString() const override;
 
   /// ObjectDirectory should not be copied.
@@ -173,14 +190,43 @@ class ObjectDirectory : public ObjectDirectoryInterface {
     /// the current_object_locations is empty, then this means that the object
     /// does not exist on any nodes due to eviction or the object never getting created.
     bool subscribed;
+    /// The size of the object, or 0 if no location update reported it.
+    uint64_t object_size;
   };
 
+  /// Queue a location update to send to the GCS with the next batch.
+  ///
+  /// \param object_id The object whose location changed.
+  /// \param client_id The location that is added or removed.
+  /// \param object_size The size of the object.
+  /// \param is_add Whether the location is added.
+  void AddLocationUpdate(const ObjectID &object_id, const ClientID &client_id,
+                         uint64_t object_size, bool is_add);
+
+  /// Send the queued location updates to the GCS.
+  void FlushLocationUpdates();
+
   /// Reference to the event loop.
   boost::asio::io_service &io_service_;
   /// Reference to the gcs client.
   std::shared_ptr<gcs::GcsClient> gcs_client_;
   /// Info about subscribers to object locations.
   std::unordered_map<ObjectID, LocationListenerState> listeners_;
+  /// The time between batches of location updates.
+  const boost::posix_time::milliseconds update_batch_interval_;
+  /// The maximum number of location updates in a batch.
+  const size_t max_update_batch_size_;
+  /// The location updates that haven't been sent yet, in order.
+  std::vector<gcs::ObjectLocationUpdate> pending_updates_;
+  /// The index of the latest pending update of each object.
+  std::unordered_map<ObjectID, size_t> pending_update_index_;
+  /// The timer to send the next batch of location updates.
+  boost::asio::deadline_timer flush_timer_;
+  /// Whether the next batch of location updates is scheduled to be sent.
+  bool flush_scheduled_ = false;
+  /// The number of location updates and batches sent so far.
+  uint64_t num_location_updates_ = 0;
+  uint64_t num_location_batches_ = 0;
 };
 
 }  // namespace ray
@@ -18,6 +18,20 @@ ObjectManager::ObjectManager(asio::io_service &main_service, const ClientID &sel
       store_notification_(main_service, config_.store_socket_name),
       buffer_pool_(config_.store_socket_name, config_.object_chunk_size),
       rpc_work_(rpc_service_),
+      pull_queue_(RayConfig::instance().object_manager_max_active_pulls(),
+                  config_.object_chunk_size),
+      push_manager_(RayConfig::instance().object_manager_push_initial_window_chunks(),
+                    RayConfig::instance().object_manager_push_max_window_chunks()),
+      chunk_compressor_(
+          RayConfig::instance().object_manager_compression_codec(),
+          RayConfig::instance().object_manager_compression_min_chunk_size(),
+          RayConfig::instance().object_manager_compression_max_ratio_percent()),
+      chunk_size_tuner_(config_.object_chunk_size,
+                        RayConfig::instance().object_manager_min_chunk_size(),
+                        RayConfig::instance().object_manager_max_chunk_size(),
+                        RayConfig::instance().object_manager_chunk_target_transfer_ms() *
+                            1000,
+                        RayConfig::instance().object_manager_max_chunks_per_object()),
       gen_(std::chrono::high_resolution_clock::now().time_since_epoch().count()),
       object_manager_server_("ObjectManager", config_.object_manager_port,
                              config_.rpc_service_threads_number),
@@ -72,18 +86,63 @@ void ObjectManager::HandleObjectAdded(
   auto iter = unfulfilled_push_requests_.find(object_id);
   if (iter != unfulfilled_push_requests_.end()) {
     for (auto &pair : iter->second) {
-      auto &client_id = pair.first;
-      main_service_->post([this, object_id, client_id]() { Push(object_id, client_id); });
-      // When push timeout is set to -1, there will be an empty timer in pair.second.
-      if (pair.second != nullptr) {
-        pair.second->cancel();
+      const ClientID &client_id = pair.first;
+      for (auto &stripe_request : pair.second) {
+        // Replay the request with its stripe and chunk size, since the remote node
+        // rejects chunks of another size.
+        const uint32_t stripe_index = stripe_request.first.first;
+        const uint32_t num_stripes = stripe_request.first.second;
+        const uint64_t requested_chunk_size = stripe_request.second.requested_chunk_size;
+        main_service_->post([this, object_id, client_id, stripe_index, num_stripes,
+                             requested_chunk_size]() {
+          Push(object_id, client_id, stripe_index, num_stripes, requested_chunk_size);
+        });
+        // When push timeout is set to -1, the request has no timer.
+        if (stripe_request.second.timer != nullptr) {
+          stripe_request.second.timer->cancel();
+        }
       }
     }
     unfulfilled_push_requests_.erase(iter);
   }
 
+  // The remaining chunks of any relays of this object can now be read from the local
+  // object store.
+  auto relay_it = relays_.find(object_id);
+  if (relay_it != relays_.end()) {
+    std::vector<ClientID> client_ids;
+    for (const auto &pair : relay_it->second) {
+      client_ids.push_back(pair.first);
+    }
+    uint64_t data_size =
+        static_cast<uint64_t>(object_info.data_size + object_info.metadata_size);
+    uint64_t metadata_size = static_cast<uint64_t>(object_info.metadata_size);
+    for (const auto &client_id : client_ids) {
+      relay_it = relays_.find(object_id);
+      if (relay_it == relays_.end()) {
+        break;
+      }
+      auto it = relay_it->second.find(client_id);
+      if (it == relay_it->second.end()) {
+        continue;
+      }
+      if (!it->second.started) {
+        // No chunk was received, so the relay can use any chunk size.
+        StartRelayPush(object_id, client_id, data_size, metadata_size,
+                       buffer_pool_.GetDefaultChunkSize());
+      } else {
+        auto parked_chunks = std::move(it->second.parked_chunks);
+        it->second.parked_chunks.clear();
+        for (uint64_t chunk_index : parked_chunks) {
+          SendRelayChunk(object_id, client_id, chunk_index);
+        }
+      }
+    }
+  }
+
   // The object is local, so we no longer need to Pull it from a remote
   // manager. Cancel any outstanding Pull requests for this object.
+  pull_queue_.Complete(object_id, object_info.data_size + object_info.metadata_size);
   CancelPull(object_id);
 }
 
@@ -108,17 +167,63 @@ ray::Status ObjectManager::SubscribeObjDeleted(
   return ray::Status::OK();
 }
 
-ray::Status ObjectManager::Pull(const ObjectID &object_id) {
-  RAY_LOG(DEBUG) << "Pull on " << self_node_id_ << " of object " << object_id;
+void ObjectManager::SetSpilledObjectRestorer(
+    std::function<bool(const ObjectID &)> restorer) {
+  restore_spilled_object_ = std::move(restorer);
+}
+
+ray::Status ObjectManager::Pull(const ObjectID &object_id, PullPriority priority) {
+  RAY_LOG(DEBUG) << "Pull on " << self_node_id_ << " of object " << object_id
+                 << " with priority " << PullPriorityName(priority);
   // Check if object is already local.
   if (local_objects_.count(object_id) != 0) {
     RAY_LOG(ERROR) << object_id << " attempted to pull an object that's already local.";
     return ray::Status::OK();
   }
-  if (pull_requests_.find(object_id) != pull_requests_.end()) {
+  // Restoring an object from local disk is cheaper than fetching it from another node.
+  if (restore_spilled_object_ && restore_spilled_object_(object_id)) {
     return ray::Status::OK();
   }
+  // Queue the request, or raise its priority, which may let it be admitted.
+  pull_queue_.Add(object_id, priority);
+  AdmitPulls();
+  return ray::Status::OK();
+}
+
+void ObjectManager::SetPinnedObjectBytes(int64_t pinned_bytes) {
+  bool freed = pinned_bytes < pinned_object_bytes_;
+  pinned_object_bytes_ = pinned_bytes;
+  if (freed) {
+    // The unpinned memory may admit more pulls.
+    AdmitPulls();
+  }
+}
 
+void ObjectManager::AdmitPulls() {
+  int64_t available_bytes = -1;
+  if (config_.object_store_memory > 0) {
+    // Account for the objects being received with their actual sizes.
+    for (const auto &object_id : pull_queue_.GetUnsizedActivePulls()) {
+      uint64_t data_size = 0;
+      uint64_t metadata_size = 0;
+      uint64_t chunk_size = 0;
+      if (buffer_pool_.GetCreateObjectSizes(object_id, &data_size, &metadata_size,
+                                            &chunk_size)) {
+        pull_queue_.SetObjectSize(object_id, data_size);
+      }
+    }
+    // Local objects that aren't pinned are evicted to make room for the objects
+    // being pulled, so only the pinned ones take away from the memory for pulls.
+    available_bytes =
+        std::max<int64_t>(config_.object_store_memory - pinned_object_bytes_, 0);
+  }
+  for (const auto &object_id : pull_queue_.AdmitPulls(available_bytes)) {
+    RAY_CHECK_OK(StartPull(object_id));
+  }
+}
+
+ray::Status ObjectManager::StartPull(const ObjectID &object_id) {
+  RAY_CHECK(pull_requests_.count(object_id) == 0);
   pull_requests_.emplace(object_id, PullRequest());
   // Subscribe to object notifications. A notification will be received every
   // time the set of client IDs for the object changes. Notifications will also
@@ -180,37 +285,71 @@ void ObjectManager::TryPull(const ObjectID &object_id) {
     return;
   }
 
-  // Choose a random client to pull the object from.
-  // Generate a random index.
-  std::uniform_int_distribution<int> distribution(0, node_vector.size() - 1);
-  int node_index = distribution(gen_);
-  ClientID node_id = node_vector[node_index];
-  // If the object manager somehow ended up choosing itself, choose a different
-  // object manager.
-  if (node_id == self_node_id_) {
-    std::swap(node_vector[node_index], node_vector[node_vector.size() - 1]);
-    node_vector.pop_back();
-    RAY_LOG(ERROR) << "The object manager with ID " << self_node_id_
-                   << " is trying to pull object " << object_id
-                   << " but the object table suggests that this object manager "
-                   << "already has the object.";
-    node_id = node_vector[node_index % node_vector.size()];
-    RAY_CHECK(node_id != self_node_id_);
+  // Collect the remote clients to pull from, along with the stripe of the
+  // object's chunks to request from each. A stripe count of 0 requests the
+  // whole object.
+  std::vector<std::pair<ClientID, uint32_t>> sources;
+  uint32_t num_stripes = 0;
+  const uint32_t max_pull_sources =
+      RayConfig::instance().object_manager_max_pull_sources();
+  if (max_pull_sources > 1 && node_vector.size() > 1) {
+    std::vector<ClientID> remote_nodes;
+    for (const auto &node_id : node_vector) {
+      if (node_id != self_node_id_) {
+        remote_nodes.push_back(node_id);
+      }
+    }
+    if (remote_nodes.size() > 1) {
+      // Pull disjoint stripes of the object from a random subset of the clients
+      // that have it.
+      std::shuffle(remote_nodes.begin(), remote_nodes.end(), gen_);
+      num_stripes = std::min<uint32_t>(remote_nodes.size(), max_pull_sources);
+      for (uint32_t stripe_index = 0; stripe_index < num_stripes; stripe_index++) {
+        sources.emplace_back(remote_nodes[stripe_index], stripe_index);
+      }
+    }
   }
 
-  RAY_LOG(DEBUG) << "Sending pull request from " << self_node_id_ << " to " << node_id
-                 << " of object " << object_id;
+  if (sources.empty()) {
+    // Choose a random client to pull the object from.
+    // Generate a random index.
+    std::uniform_int_distribution<int> distribution(0, node_vector.size() - 1);
+    int node_index = distribution(gen_);
+    ClientID node_id = node_vector[node_index];
+    // If the object manager somehow ended up choosing itself, choose a different
+    // object manager.
+    if (node_id == self_node_id_) {
+      std::swap(node_vector[node_index], node_vector[node_vector.size() - 1]);
+      node_vector.pop_back();
+      RAY_LOG(ERROR) << "The object manager with ID " << self_node_id_
+                     << " is trying to pull object " << object_id
+                     << " but the object table suggests that this object manager "
+                     << "already has the object.";
+      node_id = node_vector[node_index % node_vector.size()];
+      RAY_CHECK(node_id != self_node_id_);
+    }
+    sources.emplace_back(node_id, 0);
+  }
 
-  auto rpc_client = GetRpcClient(node_id);
-  if (rpc_client) {
-    // Try pulling from the client.
-    rpc_service_.post([this, object_id, node_id, rpc_client]() {
-      SendPullRequest(object_id, node_id, rpc_client);
-    });
-  } else {
-    RAY_LOG(ERROR) << "Couldn't send pull request from " << self_node_id_ << " to "
-                   << node_id << " of object " << object_id
-                   << " , setup rpc connection failed.";
+  for (const auto &source : sources) {
+    const ClientID &node_id = source.first;
+    uint32_t stripe_index = source.second;
+    RAY_LOG(DEBUG) << "Sending pull request from " << self_node_id_ << " to " << node_id
+                   << " of object " << object_id << ", stripe " << stripe_index
+                   << " of " << num_stripes;
+
+    auto rpc_client = GetRpcClient(node_id);
+    if (rpc_client) {
+      // Try pulling from the client.
+      rpc_service_.post(
+          [this, object_id, node_id, rpc_client, stripe_index, num_stripes]() {
+            SendPullRequest(object_id, node_id, rpc_client, stripe_index, num_stripes);
+          });
+    } else {
+      RAY_LOG(ERROR) << "Couldn't send pull request from " << self_node_id_ << " to "
+                     << node_id << " of object " << object_id
+                     << " , setup rpc connection failed.";
+    }
   }
 
   // If there are more clients to try, try them in succession, with a timeout
@@ -249,10 +388,25 @@ void ObjectManager::TryPull(const ObjectID &object_id) {
 
 void ObjectManager::SendPullRequest(
     const ObjectID &object_id, const ClientID &client_id,
-    std::shared_ptr<rpc::ObjectManagerClient> rpc_client) {
+    std::shared_ptr<rpc::ObjectManagerClient> rpc_client, uint32_t stripe_index,
+    uint32_t num_stripes) {
   rpc::PullRequest pull_request;
   pull_request.set_object_id(object_id.Binary());
   pull_request.set_client_id(self_node_id_.Binary());
+  pull_request.set_stripe_index(stripe_index);
+  pull_request.set_num_stripes(num_stripes);
+  // If part of the object was already received, e.g., from a sender that failed,
+  // the rest must be sent in chunks of the same size.
+  uint64_t data_size = 0;
+  uint64_t metadata_size = 0;
+  uint64_t chunk_size = 0;
+  if (buffer_pool_.GetCreateObjectSizes(object_id, &data_size, &metadata_size,
+                                        &chunk_size)) {
+    pull_request.set_chunk_size(chunk_size);
+  }
+  for (auto codec : ChunkCompressor::SupportedCodecs()) {
+    pull_request.add_accepted_codecs(codec);
+  }
 
   rpc_client->Pull(pull_request, [object_id, client_id](const Status &status,
                                                         const rpc::PullReply &reply) {
@@ -263,14 +417,39 @@ void ObjectManager::SendPullRequest(
   });
 }
 
+void ObjectManager::ForwardPullRequest(
+    const ObjectID &object_id, const ClientID &requester_id, const ClientID &client_id,
+    rpc::CompressionCodec codec, std::shared_ptr<rpc::ObjectManagerClient> rpc_client) {
+  rpc::PullRequest pull_request;
+  pull_request.set_object_id(object_id.Binary());
+  pull_request.set_client_id(requester_id.Binary());
+  if (codec != rpc::COMPRESSION_NONE) {
+    pull_request.add_accepted_codecs(codec);
+  }
+
+  rpc_client->Pull(pull_request, [object_id, client_id](const Status &status,
+                                                        const rpc::PullReply &reply) {
+    if (!status.ok()) {
+      RAY_LOG(WARNING) << "Forward pull " << object_id << " request to client "
+                       << client_id << " failed due to" << status.message();
+    }
+  });
+}
+
 void ObjectManager::HandlePushTaskTimeout(const ObjectID &object_id,
-                                          const ClientID &client_id) {
+                                          const ClientID &client_id,
+                                          const std::pair<uint32_t, uint32_t> &stripe) {
   RAY_LOG(WARNING) << "Invalid Push request ObjectID: " << object_id
                    << " after waiting for " << config_.push_timeout_ms << " ms.";
   auto iter = unfulfilled_push_requests_.find(object_id);
   RAY_CHECK(iter != unfulfilled_push_requests_.end());
-  size_t num_erased = iter->second.erase(client_id);
+  auto client_iter = iter->second.find(client_id);
+  RAY_CHECK(client_iter != iter->second.end());
+  size_t num_erased = client_iter->second.erase(stripe);
   RAY_CHECK(num_erased == 1);
+  if (client_iter->second.empty()) {
+    iter->second.erase(client_iter);
+  }
   if (iter->second.size() == 0) {
     unfulfilled_push_requests_.erase(iter);
   }
@@ -325,63 +504,91 @@ void ObjectManager::HandleReceiveFinished(const ObjectID &object_id,
 }
 
 void ObjectManager::Push(const ObjectID &object_id, const ClientID &client_id) {
+  Push(object_id, client_id, /*stripe_index=*/0, /*num_stripes=*/1,
+       /*requested_chunk_size=*/0);
+}
+
+void ObjectManager::Push(const ObjectID &object_id, const ClientID &client_id,
+                         uint32_t stripe_index, uint32_t num_stripes,
+                         uint64_t requested_chunk_size) {
+  RAY_CHECK(stripe_index < num_stripes);
   RAY_LOG(DEBUG) << "Push on " << self_node_id_ << " to " << client_id << " of object "
-                 << object_id;
+                 << object_id << ", stripe " << stripe_index << " of " << num_stripes;
+  // A relay sends the chunks in the size it receives them, so it can't serve a
+  // requester that already has part of the object.
+  const bool broadcast = num_stripes == 1 && requested_chunk_size == 0 &&
+                         RayConfig::instance().object_manager_broadcast_fanout() > 0 &&
+                         config_.push_timeout_ms != 0;
   if (local_objects_.count(object_id) == 0) {
-    // Avoid setting duplicated timer for the same object and client pair.
-    auto &clients = unfulfilled_push_requests_[object_id];
-    if (clients.count(client_id) == 0) {
-      // If config_.push_timeout_ms < 0, we give an empty timer
-      // and the task will be kept infinitely.
-      auto timer = std::unique_ptr<boost::asio::deadline_timer>();
-      if (config_.push_timeout_ms == 0) {
-        // The Push request fails directly when config_.push_timeout_ms == 0.
-        RAY_LOG(WARNING) << "Invalid Push request ObjectID " << object_id
-                         << " due to direct timeout setting. ";
-      } else if (config_.push_timeout_ms > 0) {
-        // Put the task into a queue and wait for the notification of Object added.
-        timer.reset(new boost::asio::deadline_timer(*main_service_));
-        auto clean_push_period = boost::posix_time::milliseconds(config_.push_timeout_ms);
-        timer->expires_from_now(clean_push_period);
-        timer->async_wait(
-            [this, object_id, client_id](const boost::system::error_code &error) {
-              // Timer killing will receive the boost::asio::error::operation_aborted,
-              // we only handle the timeout event.
-              if (!error) {
-                HandlePushTaskTimeout(object_id, client_id);
-              }
-            });
-      }
-      if (config_.push_timeout_ms != 0) {
-        clients.emplace(client_id, std::move(timer));
-      }
+    // If this object manager is receiving the object itself, relay it (or forward
+    // the request further down the broadcast tree).
+    if (broadcast && (ForwardBroadcastPush(object_id, client_id) ||
+                      StartRelay(object_id, client_id))) {
+      return;
+    }
+    if (config_.push_timeout_ms == 0) {
+      // The Push request fails directly when config_.push_timeout_ms == 0.
+      RAY_LOG(WARNING) << "Invalid Push request ObjectID " << object_id
+                       << " due to direct timeout setting. ";
+      return;
+    }
+    // Avoid setting duplicated timer for the same object, client and stripe. A repeated
+    // request keeps the timer of the first one, but is replayed in its chunk size.
+    const auto stripe = std::make_pair(stripe_index, num_stripes);
+    auto inserted = unfulfilled_push_requests_[object_id][client_id].emplace(
+        stripe, UnfulfilledPushRequest());
+    auto &request = inserted.first->second;
+    request.requested_chunk_size = requested_chunk_size;
+    // If config_.push_timeout_ms < 0, we give an empty timer
+    // and the task will be kept infinitely.
+    if (inserted.second && config_.push_timeout_ms > 0) {
+      // Put the task into a queue and wait for the notification of Object added.
+      request.timer.reset(new boost::asio::deadline_timer(*main_service_));
+      auto clean_push_period = boost::posix_time::milliseconds(config_.push_timeout_ms);
+      request.timer->expires_from_now(clean_push_period);
+      request.timer->async_wait(
+          [this, object_id, client_id, stripe](const boost::system::error_code &error) {
+            // Timer killing will receive the boost::asio::error::operation_aborted,
+            // we only handle the timeout event.
+            if (!error) {
+              HandlePushTaskTimeout(object_id, client_id, stripe);
+            }
+          });
     }
     return;
   }
 
-  // If we haven't pushed this object to this same object manager yet, then push
-  // it. If we have, but it was a long time ago, then push it. If we have and it
-  // was recent, then don't do it again.
-  auto &recent_pushes = local_objects_[object_id].recent_pushes;
-  auto it = recent_pushes.find(client_id);
+  // If we haven't pushed this stripe of the object to this same object manager yet,
+  // then push it. If we have, but it was a long time ago, then push it. If we have
+  // and it was recent, then don't do it again. Other stripes of the object don't
+  // count, since the requester may be retrying a stripe that another sender failed
+  // to push.
+  auto &recent_pushes = local_objects_[object_id].recent_pushes[client_id];
+  const auto stripe = std::make_pair(stripe_index, num_stripes);
+  auto it = recent_pushes.find(stripe);
   if (it == recent_pushes.end()) {
     // We haven't pushed this specific object to this specific object manager
     // yet (or if we have then the object must have been evicted and recreated
     // locally).
-    recent_pushes[client_id] = absl::GetCurrentTimeNanos() / 1000000;
+    recent_pushes[stripe] = absl::GetCurrentTimeNanos() / 1000000;
   } else {
     int64_t current_time = absl::GetCurrentTimeNanos() / 1000000;
     if (current_time - it->second <=
         RayConfig::instance().object_manager_repeated_push_delay_ms()) {
       // We pushed this object to the object manager recently, so don't do it
       // again.
-      RAY_LOG(DEBUG) << "Object " << object_id << " recently pushed to " << client_id;
+      RAY_LOG(DEBUG) << "Object " << object_id << ", stripe " << stripe_index << " of "
+                     << num_stripes << " recently pushed to " << client_id;
       return;
     } else {
       it->second = current_time;
     }
   }
 
+  if (broadcast && ForwardBroadcastPush(object_id, client_id)) {
+    return;
+  }
+
   auto rpc_client = GetRpcClient(client_id);
   if (rpc_client) {
     const object_manager::protocol::ObjectInfoT &object_info =
@@ -389,23 +596,64 @@ void ObjectManager::Push(const ObjectID &object_id, const ClientID &client_id) {
     uint64_t data_size =
         static_cast<uint64_t>(object_info.data_size + object_info.metadata_size);
     uint64_t metadata_size = static_cast<uint64_t>(object_info.metadata_size);
-    uint64_t num_chunks = buffer_pool_.GetNumChunks(data_size);
+    // The requester chooses the chunk size if it already received part of the
+    // object. Stripes pushed by different object managers must split the object
+    // alike, so only whole-object pushes tune the chunk size.
+    uint64_t chunk_size = requested_chunk_size;
+    if (chunk_size == 0) {
+      chunk_size = buffer_pool_.GetDefaultChunkSize();
+      if (num_stripes == 1 &&
+          RayConfig::instance().object_manager_autotune_chunk_size()) {
+        chunk_size = chunk_size_tuner_.ChooseChunkSize(client_id, data_size);
+      }
+    }
+    uint64_t num_chunks = buffer_pool_.GetNumChunks(data_size, chunk_size);
+    // The chunks of this stripe are stripe_index, stripe_index + num_stripes, ...
+    uint64_t num_stripe_chunks =
+        num_chunks > stripe_index
+            ? (num_chunks - stripe_index + num_stripes - 1) / num_stripes
+            : 0;
 
     RAY_LOG(DEBUG) << "Sending object chunks of " << object_id << " to client "
-                   << client_id << ", number of chunks: " << num_chunks
-                   << ", total data size: " << data_size;
+                   << client_id << ", number of chunks: " << num_stripe_chunks
+                   << ", total data size: " << data_size
+                   << ", chunk size: " << chunk_size;
+    if (num_stripe_chunks == 0) {
+      return;
+    }
 
     UniqueID push_id = UniqueID::FromRandom();
-    for (uint64_t chunk_index = 0; chunk_index < num_chunks; ++chunk_index) {
-      rpc_service_.post([this, push_id, object_id, client_id, data_size, metadata_size,
-                         chunk_index, rpc_client]() {
-        auto st = SendObjectChunk(push_id, object_id, client_id, data_size, metadata_size,
-                                  chunk_index, rpc_client);
-        if (!st.ok()) {
-          RAY_LOG(WARNING) << "Send object " << object_id << " chunk failed due to "
-                           << st.message() << ", chunk index " << chunk_index;
-        }
-      });
+    // The push manager sends the chunks as the window of in-flight chunks to this
+    // client allows.
+    bool started = push_manager_.StartPush(
+        client_id, object_id, stripe_index, num_stripes, num_stripe_chunks,
+        [this, push_id, object_id, client_id, data_size, metadata_size, chunk_size,
+         rpc_client, stripe_index, num_stripes,
+         codec = GetRemoteCodec(client_id)](int64_t stripe_chunk_index) {
+          uint64_t chunk_index = stripe_index + stripe_chunk_index * num_stripes;
+          uint64_t num_bytes =
+              ObjectBufferPool::GetBufferLength(chunk_index, data_size, chunk_size);
+          int64_t start_time_us = absl::GetCurrentTimeNanos() / 1000;
+          chunk_size_tuner_.RecordChunkSent(client_id, start_time_us);
+          auto on_complete = [this, object_id, client_id, stripe_index, num_stripes,
+                              num_bytes, start_time_us](const Status &status) {
+            HandleChunkPushed(object_id, client_id, stripe_index, num_stripes,
+                              num_bytes, start_time_us, status);
+          };
+          rpc_service_.post([this, push_id, object_id, client_id, data_size,
+                             metadata_size, chunk_index, chunk_size, codec, rpc_client,
+                             on_complete]() {
+            auto st = SendObjectChunk(push_id, object_id, client_id, data_size,
+                                      metadata_size, chunk_index, chunk_size, codec,
+                                      rpc_client, on_complete);
+            if (!st.ok()) {
+              RAY_LOG(WARNING) << "Send object " << object_id << " chunk failed due to "
+                               << st.message() << ", chunk index " << chunk_index;
+            }
+          });
+        });
+    if (started && broadcast) {
+      broadcast_receivers_[object_id].push_back(client_id);
     }
   } else {
     // Push is best effort, so do nothing here.
@@ -414,10 +662,275 @@ void ObjectManager::Push(const ObjectID &object_id, const ClientID &client_id) {
   }
 }
 
+void ObjectManager::HandleChunkPushed(const ObjectID &object_id,
+                                      const ClientID &client_id, uint32_t stripe_index,
+                                      uint32_t num_stripes, uint64_t num_bytes,
+                                      int64_t start_time_us, const ray::Status &status) {
+  int64_t end_time_us = absl::GetCurrentTimeNanos() / 1000;
+  chunk_size_tuner_.RecordChunkAcked(client_id, num_bytes, end_time_us, status.ok());
+  bool push_done =
+      push_manager_.OnChunkComplete(client_id, object_id, stripe_index, num_stripes,
+                                    status.ok(), end_time_us - start_time_us);
+  if (push_done) {
+    HandlePushFinished(object_id, client_id, stripe_index, num_stripes, end_time_us);
+  }
+}
+
+void ObjectManager::HandlePushFinished(const ObjectID &object_id,
+                                       const ClientID &client_id, uint32_t stripe_index,
+                                       uint32_t num_stripes, int64_t end_time_us) {
+  // Count the delay between repeated pushes from when the push finished, since it
+  // may have waited behind other pushes to the same client.
+  auto it = local_objects_.find(object_id);
+  if (it != local_objects_.end()) {
+    it->second.recent_pushes[client_id][std::make_pair(stripe_index, num_stripes)] =
+        end_time_us / 1000;
+  }
+  if (num_stripes > 1) {
+    // Only pushes of the whole object are broadcast or relayed.
+    return;
+  }
+
+  auto receivers_it = broadcast_receivers_.find(object_id);
+  if (receivers_it != broadcast_receivers_.end()) {
+    auto &receivers = receivers_it->second;
+    receivers.erase(std::remove(receivers.begin(), receivers.end(), client_id),
+                    receivers.end());
+    if (receivers.empty()) {
+      broadcast_receivers_.erase(receivers_it);
+    }
+  }
+
+  auto relay_it = relays_.find(object_id);
+  if (relay_it != relays_.end() && relay_it->second.erase(client_id) > 0 &&
+      relay_it->second.empty()) {
+    relays_.erase(relay_it);
+    std::lock_guard<std::mutex> lock(relay_mutex_);
+    relayed_objects_.erase(object_id);
+  }
+}
+
+bool ObjectManager::ForwardBroadcastPush(const ObjectID &object_id,
+                                         const ClientID &client_id) {
+  auto it = broadcast_receivers_.find(object_id);
+  if (it == broadcast_receivers_.end() ||
+      it->second.size() < RayConfig::instance().object_manager_broadcast_fanout()) {
+    return false;
+  }
+  std::vector<ClientID> candidates;
+  for (const auto &receiver_id : it->second) {
+    if (receiver_id != client_id) {
+      candidates.push_back(receiver_id);
+    }
+  }
+  if (candidates.empty()) {
+    return false;
+  }
+  std::uniform_int_distribution<size_t> distribution(0, candidates.size() - 1);
+  ClientID relay_id = candidates[distribution(gen_)];
+  auto rpc_client = GetRpcClient(relay_id);
+  if (!rpc_client) {
+    return false;
+  }
+  RAY_LOG(DEBUG) << "Forwarding request from " << client_id << " for object "
+                 << object_id << " to " << relay_id;
+  rpc_service_.post([this, object_id, client_id, relay_id,
+                     codec = GetRemoteCodec(client_id), rpc_client]() {
+    ForwardPullRequest(object_id, client_id, relay_id, codec, rpc_client);
+  });
+  return true;
+}
+
+rpc::CompressionCodec ObjectManager::GetRemoteCodec(const ClientID &client_id) const {
+  auto it = remote_codecs_.find(client_id);
+  return it == remote_codecs_.end() ? rpc::COMPRESSION_NONE : it->second;
+}
+
+bool ObjectManager::StartRelay(const ObjectID &object_id, const ClientID &client_id) {
+  uint64_t data_size = 0;
+  uint64_t metadata_size = 0;
+  uint64_t chunk_size = 0;
+  bool receiving = buffer_pool_.GetCreateObjectSizes(object_id, &data_size,
+                                                     &metadata_size, &chunk_size);
+  if (!receiving && pull_requests_.count(object_id) == 0) {
+    return false;
+  }
+  auto &relays = relays_[object_id];
+  if (relays.count(client_id) > 0) {
+    // The object is already being relayed to this client.
+    return true;
+  }
+  auto rpc_client = GetRpcClient(client_id);
+  if (!rpc_client) {
+    if (relays.empty()) {
+      relays_.erase(object_id);
+    }
+    // Push is best effort, so do nothing here.
+    RAY_LOG(ERROR)
+        << "Failed to establish connection for Push with remote object manager.";
+    return true;
+  }
+  RAY_LOG(DEBUG) << "Relaying object " << object_id << " to " << client_id;
+  {
+    std::lock_guard<std::mutex> lock(relay_mutex_);
+    relayed_objects_.insert(object_id);
+  }
+  auto &relay = relays[client_id];
+  relay.rpc_client = rpc_client;
+  if (config_.push_timeout_ms > 0) {
+    relay.timeout_timer.reset(new boost::asio::deadline_timer(*main_service_));
+    relay.timeout_timer->expires_from_now(
+        boost::posix_time::milliseconds(config_.push_timeout_ms));
+    relay.timeout_timer->async_wait(
+        [this, object_id, client_id](const boost::system::error_code &error) {
+          if (!error) {
+            HandleRelayTimeout(object_id, client_id);
+          }
+        });
+  }
+  broadcast_receivers_[object_id].push_back(client_id);
+  // A chunk received between the check above and registering the relay has been
+  // counted in the sizes, or will trigger HandleRelayedChunkReceived.
+  if (receiving || buffer_pool_.GetCreateObjectSizes(object_id, &data_size,
+                                                     &metadata_size, &chunk_size)) {
+    StartRelayPush(object_id, client_id, data_size, metadata_size, chunk_size);
+  }
+  return true;
+}
+
+void ObjectManager::StartRelayPush(const ObjectID &object_id, const ClientID &client_id,
+                                   uint64_t data_size, uint64_t metadata_size,
+                                   uint64_t chunk_size) {
+  auto &relay = relays_[object_id][client_id];
+  RAY_CHECK(!relay.started);
+  relay.started = true;
+  relay.data_size = data_size;
+  relay.metadata_size = metadata_size;
+  relay.chunk_size = chunk_size;
+  uint64_t num_chunks = buffer_pool_.GetNumChunks(data_size, chunk_size);
+  if (num_chunks == 0) {
+    HandlePushFinished(object_id, client_id, /*stripe_index=*/0, /*num_stripes=*/1,
+                       absl::GetCurrentTimeNanos() / 1000);
+    return;
+  }
+  if (!push_manager_.StartPush(client_id, object_id, num_chunks,
+                               [this, object_id, client_id](int64_t chunk_index) {
+                                 SendRelayChunk(object_id, client_id, chunk_index);
+                               })) {
+    // The object is already being pushed to this client, which will clean up the
+    // broadcast state once it finishes.
+    auto relay_it = relays_.find(object_id);
+    relay_it->second.erase(client_id);
+    if (relay_it->second.empty()) {
+      relays_.erase(relay_it);
+      std::lock_guard<std::mutex> lock(relay_mutex_);
+      relayed_objects_.erase(object_id);
+    }
+  }
+}
+
+void ObjectManager::SendRelayChunk(const ObjectID &object_id, const ClientID &client_id,
+                                   uint64_t chunk_index) {
+  auto &relay = relays_[object_id][client_id];
+  if (local_objects_.count(object_id) == 0 &&
+      !buffer_pool_.IsCreateChunkSealed(object_id, chunk_index, relay.chunk_size)) {
+    relay.parked_chunks.insert(chunk_index);
+    return;
+  }
+  uint64_t num_bytes =
+      ObjectBufferPool::GetBufferLength(chunk_index, relay.data_size, relay.chunk_size);
+  int64_t start_time_us = absl::GetCurrentTimeNanos() / 1000;
+  chunk_size_tuner_.RecordChunkSent(client_id, start_time_us);
+  auto on_complete = [this, object_id, client_id, num_bytes,
+                      start_time_us](const Status &status) {
+    HandleChunkPushed(object_id, client_id, /*stripe_index=*/0, /*num_stripes=*/1,
+                      num_bytes, start_time_us, status);
+  };
+  rpc_service_.post([this, push_id = relay.push_id, object_id, client_id,
+                     data_size = relay.data_size, metadata_size = relay.metadata_size,
+                     chunk_index, chunk_size = relay.chunk_size,
+                     codec = GetRemoteCodec(client_id), rpc_client = relay.rpc_client,
+                     on_complete]() {
+    auto st = SendObjectChunk(push_id, object_id, client_id, data_size, metadata_size,
+                              chunk_index, chunk_size, codec, rpc_client, on_complete);
+    if (!st.ok()) {
+      RAY_LOG(WARNING) << "Relay object " << object_id << " chunk failed due to "
+                       << st.message() << ", chunk index " << chunk_index;
+    }
+  });
+}
+
+void ObjectManager::HandleRelayedChunkReceived(const ObjectID &object_id,
+                                               uint64_t chunk_index, uint64_t data_size,
+                                               uint64_t metadata_size,
+                                               uint64_t chunk_size) {
+  auto relay_it = relays_.find(object_id);
+  if (relay_it == relays_.end()) {
+    return;
+  }
+  std::vector<ClientID> client_ids;
+  for (const auto &pair : relay_it->second) {
+    client_ids.push_back(pair.first);
+  }
+  for (const auto &client_id : client_ids) {
+    // Starting a relay may finish it right away, so look it up again.
+    relay_it = relays_.find(object_id);
+    if (relay_it == relays_.end()) {
+      return;
+    }
+    auto it = relay_it->second.find(client_id);
+    if (it == relay_it->second.end()) {
+      continue;
+    }
+    if (!it->second.started) {
+      StartRelayPush(object_id, client_id, data_size, metadata_size, chunk_size);
+    } else if (it->second.parked_chunks.erase(chunk_index) > 0) {
+      SendRelayChunk(object_id, client_id, chunk_index);
+    }
+  }
+}
+
+void ObjectManager::HandleRelayTimeout(const ObjectID &object_id,
+                                       const ClientID &client_id) {
+  if (local_objects_.count(object_id) > 0) {
+    // The object arrived, so the remaining chunks are being sent.
+    return;
+  }
+  auto relay_it = relays_.find(object_id);
+  if (relay_it == relays_.end() || relay_it->second.count(client_id) == 0) {
+    // The relay finished just before the timer fired.
+    return;
+  }
+  auto &relay = relay_it->second[client_id];
+  RAY_LOG(WARNING) << "Relay of object " << object_id << " to " << client_id
+                   << " failed after waiting for " << config_.push_timeout_ms
+                   << " ms.";
+  int64_t end_time_us = absl::GetCurrentTimeNanos() / 1000;
+  if (!relay.started) {
+    HandlePushFinished(object_id, client_id, /*stripe_index=*/0, /*num_stripes=*/1,
+                       end_time_us);
+    return;
+  }
+  bool push_done = push_manager_.CancelPush(client_id, object_id);
+  // The parked chunks were never sent, so they fail right away. Chunks that were
+  // sent complete on their own.
+  auto parked_chunks = std::move(relay.parked_chunks);
+  relay.parked_chunks.clear();
+  for (size_t i = 0; i < parked_chunks.size(); i++) {
+    push_done = push_manager_.OnChunkComplete(client_id, object_id, false, 0);
+  }
+  if (push_done) {
+    HandlePushFinished(object_id, client_id, /*stripe_index=*/0, /*num_stripes=*/1,
+                       end_time_us);
+  }
+}
+
 ray::Status ObjectManager::SendObjectChunk(
     const UniqueID &push_id, const ObjectID &object_id, const ClientID &client_id,
     uint64_t data_size, uint64_t metadata_size, uint64_t chunk_index,
-    std::shared_ptr<rpc::ObjectManagerClient> rpc_client) {
+    uint64_t chunk_size, rpc::CompressionCodec codec,
+    std::shared_ptr<rpc::ObjectManagerClient> rpc_client,
+    const std::function<void(const Status &)> &on_complete) {
   double start_time = absl::GetCurrentTimeNanos() / 1e9;
   rpc::PushRequest push_request;
   // Set request header
@@ -427,26 +940,53 @@ ray::Status ObjectManager::SendObjectChunk(
   push_request.set_data_size(data_size);
   push_request.set_metadata_size(metadata_size);
   push_request.set_chunk_index(chunk_index);
+  push_request.set_chunk_size(chunk_size);
+
+  // Set the chunk data, compressed if the codec allows it.
+  auto set_data = [this, codec, &push_request](const uint8_t *data, uint64_t size) {
+    std::string compressed;
+    push_request.set_codec(chunk_compressor_.Compress(codec, data, size, &compressed));
+    if (push_request.codec() == rpc::COMPRESSION_NONE) {
+      push_request.set_data(data, size);
+    } else {
+      push_request.set_data(std::move(compressed));
+    }
+  };
 
-  // Get data
-  std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> chunk_status =
-      buffer_pool_.GetChunk(object_id, data_size, metadata_size, chunk_index);
-  ObjectBufferPool::ChunkInfo chunk_info = chunk_status.first;
+  // Get data. If the object is still being received (i.e., it is relayed), copy the
+  // chunk out of the unsealed object.
+  std::string relayed_data;
+  if (buffer_pool_.CopySealedCreateChunk(object_id, chunk_index, chunk_size,
+                                         &relayed_data)) {
+    if (codec == rpc::COMPRESSION_NONE) {
+      push_request.set_data(std::move(relayed_data));
+    } else {
+      set_data(reinterpret_cast<const uint8_t *>(relayed_data.data()),
+               relayed_data.size());
+    }
+  } else {
+    std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> chunk_status =
+        buffer_pool_.GetChunk(object_id, data_size, metadata_size, chunk_index,
+                              chunk_size);
+    ObjectBufferPool::ChunkInfo chunk_info = chunk_status.first;
+
+    // Fail on status not okay. The object is local, and there is
+    // no other anticipated error here.
+    ray::Status status = chunk_status.second;
+    if (!chunk_status.second.ok()) {
+      RAY_LOG(WARNING) << "Attempting to push object " << object_id
+                       << " which is not local. It may have been evicted.";
+      main_service_->post([on_complete, status]() { on_complete(status); });
+      RAY_RETURN_NOT_OK(status);
+    }
 
-  // Fail on status not okay. The object is local, and there is
-  // no other anticipated error here.
-  ray::Status status = chunk_status.second;
-  if (!chunk_status.second.ok()) {
-    RAY_LOG(WARNING) << "Attempting to push object " << object_id
-                     << " which is not local. It may have been evicted.";
-    RAY_RETURN_NOT_OK(status);
+    set_data(chunk_info.data, chunk_info.buffer_length);
+    buffer_pool_.ReleaseGetChunk(object_id, chunk_info.chunk_index);
   }
 
-  push_request.set_data(chunk_info.data, chunk_info.buffer_length);
-
   // record the time cost between send chunk and receive reply
   rpc::ClientCallback<rpc::PushReply> callback = [this, start_time, object_id, client_id,
-                                                  chunk_index](
+                                                  chunk_index, on_complete](
                                                      const Status &status,
                                                      const rpc::PushReply &reply) {
     // TODO: Just print warning here, should we try to resend this chunk?
@@ -457,15 +997,14 @@ ray::Status ObjectManager::SendObjectChunk(
     }
     double end_time = absl::GetCurrentTimeNanos() / 1e9;
     HandleSendFinished(object_id, client_id, chunk_index, start_time, end_time, status);
+    on_complete(status);
   };
   rpc_client->Push(push_request, callback);
-
-  // Do this regardless of whether it failed or succeeded.
-  buffer_pool_.ReleaseGetChunk(object_id, chunk_info.chunk_index);
   return Status::OK();
 }
 
 void ObjectManager::CancelPull(const ObjectID &object_id) {
+  pull_queue_.Remove(object_id);
   auto it = pull_requests_.find(object_id);
   if (it == pull_requests_.end()) {
     return;
@@ -474,6 +1013,7 @@ void ObjectManager::CancelPull(const ObjectID &object_id) {
   RAY_CHECK_OK(object_directory_->UnsubscribeObjectLocations(
       object_directory_pull_callback_id_, object_id));
   pull_requests_.erase(it);
+  AdmitPulls();
 }
 
 ray::Status ObjectManager::Wait(const std::vector<ObjectID> &object_ids,
@@ -665,20 +1205,31 @@ void ObjectManager::WaitComplete(const UniqueID &wait_id) {
 }
 
 /// Implementation of ObjectManagerServiceHandler
-void ObjectManager::HandlePush(const rpc::PushRequest &request, rpc::PushReply *reply,
+void ObjectManager::HandlePush(const grpc::ByteBuffer &request, grpc::ByteBuffer *reply,
                                rpc::SendReplyCallback send_reply_callback) {
-  ObjectID object_id = ObjectID::FromBinary(request.object_id());
-  ClientID client_id = ClientID::FromBinary(request.client_id());
+  rpc::PushRequestReader::SetEmptyReply(reply);
+  rpc::PushRequestReader reader(request);
+  rpc::PushRequest header;
+  auto status = reader.ReadHeader(&header);
+  if (!status.ok()) {
+    RAY_LOG(WARNING) << "Failed to parse push request: " << status.message();
+    send_reply_callback(status, nullptr, nullptr);
+    return;
+  }
+  ObjectID object_id = ObjectID::FromBinary(header.object_id());
+  ClientID client_id = ClientID::FromBinary(header.client_id());
 
   // Serialize.
-  uint64_t chunk_index = request.chunk_index();
-  uint64_t metadata_size = request.metadata_size();
-  uint64_t data_size = request.data_size();
-  const std::string &data = request.data();
+  uint64_t chunk_index = header.chunk_index();
+  uint64_t metadata_size = header.metadata_size();
+  uint64_t data_size = header.data_size();
+  // Senders that don't set the chunk size use the default one.
+  uint64_t chunk_size =
+      header.chunk_size() > 0 ? header.chunk_size() : buffer_pool_.GetDefaultChunkSize();
 
   double start_time = absl::GetCurrentTimeNanos() / 1e9;
-  auto status = ReceiveObjectChunk(client_id, object_id, data_size, metadata_size,
-                                   chunk_index, data);
+  status = ReceiveObjectChunk(client_id, object_id, data_size, metadata_size,
+                              chunk_index, chunk_size, header.codec(), reader);
   double end_time = absl::GetCurrentTimeNanos() / 1e9;
 
   HandleReceiveFinished(object_id, client_id, chunk_index, start_time, end_time, status);
@@ -688,21 +1239,54 @@ void ObjectManager::HandlePush(const rpc::PushRequest &request, rpc::PushReply *
 ray::Status ObjectManager::ReceiveObjectChunk(const ClientID &client_id,
                                               const ObjectID &object_id,
                                               uint64_t data_size, uint64_t metadata_size,
-                                              uint64_t chunk_index,
-                                              const std::string &data) {
+                                              uint64_t chunk_index, uint64_t chunk_size,
+                                              rpc::CompressionCodec codec,
+                                              rpc::PushRequestReader &reader) {
   RAY_LOG(DEBUG) << "ReceiveObjectChunk on " << self_node_id_ << " from " << client_id
                  << " of object " << object_id << " chunk index: " << chunk_index
-                 << ", chunk data size: " << data.size()
-                 << ", object size: " << data_size;
+                 << ", chunk data size: " << reader.PayloadSize()
+                 << ", object size: " << data_size << ", chunk size: " << chunk_size;
 
   std::pair<const ObjectBufferPool::ChunkInfo &, ray::Status> chunk_status =
-      buffer_pool_.CreateChunk(object_id, data_size, metadata_size, chunk_index);
+      buffer_pool_.CreateChunk(object_id, data_size, metadata_size, chunk_index,
+                               chunk_size);
   ray::Status status;
   ObjectBufferPool::ChunkInfo chunk_info = chunk_status.first;
   if (chunk_status.second.ok()) {
     // Avoid handling this chunk if it's already being handled by another process.
-    std::memcpy(chunk_info.data, data.data(), chunk_info.buffer_length);
-    buffer_pool_.SealChunk(object_id, chunk_index);
+    if (codec == rpc::COMPRESSION_NONE) {
+      // Copy the chunk data from the request straight into the plasma buffer.
+      status = reader.ReadPayload(chunk_info.data, chunk_info.buffer_length);
+    } else {
+      // The compressed data may span several gRPC slices, so gather it first.
+      std::string compressed(reader.PayloadSize(), '\0');
+      status = reader.ReadPayload(reinterpret_cast<uint8_t *>(&compressed[0]),
+                                  compressed.size());
+      if (status.ok()) {
+        status = chunk_compressor_.Decompress(
+            codec, reinterpret_cast<const uint8_t *>(compressed.data()),
+            compressed.size(), chunk_info.data, chunk_info.buffer_length);
+      }
+    }
+    if (status.ok()) {
+      buffer_pool_.SealChunk(object_id, chunk_index);
+      bool relayed;
+      {
+        std::lock_guard<std::mutex> lock(relay_mutex_);
+        relayed = relayed_objects_.count(object_id) > 0;
+      }
+      if (relayed) {
+        main_service_->post(
+            [this, object_id, chunk_index, data_size, metadata_size, chunk_size]() {
+              HandleRelayedChunkReceived(object_id, chunk_index, data_size,
+                                         metadata_size, chunk_size);
+            });
+      }
+    } else {
+      RAY_LOG(WARNING) << "ReceiveObjectChunk index " << chunk_index << " of object "
+                       << object_id << " failed: " << status.message();
+      buffer_pool_.AbortCreateChunk(object_id, chunk_index);
+    }
   } else {
     RAY_LOG(WARNING) << "ReceiveObjectChunk index " << chunk_index << " of object "
                      << object_id << " failed: " << chunk_status.second.message();
@@ -729,7 +1313,23 @@ void ObjectManager::HandlePull(const rpc::PullRequest &request, rpc::PullReply *
     profile_events_.emplace_back(profile_event);
   }
 
-  main_service_->post([this, object_id, client_id]() { Push(object_id, client_id); });
+  uint32_t num_stripes = request.num_stripes();
+  uint32_t stripe_index = request.stripe_index();
+  if (num_stripes == 0 || stripe_index >= num_stripes) {
+    // The whole object is requested.
+    num_stripes = 1;
+    stripe_index = 0;
+  }
+  uint64_t chunk_size = request.chunk_size();
+  std::vector<rpc::CompressionCodec> accepted_codecs;
+  for (int codec : request.accepted_codecs()) {
+    accepted_codecs.push_back(static_cast<rpc::CompressionCodec>(codec));
+  }
+  main_service_->post([this, object_id, client_id, stripe_index, num_stripes,
+                       chunk_size, accepted_codecs]() {
+    remote_codecs_[client_id] = chunk_compressor_.Negotiate(accepted_codecs);
+    Push(object_id, client_id, stripe_index, num_stripes, chunk_size);
+  });
   send_reply_callback(Status::OK(), nullptr, nullptr);
 }
 
@@ -804,6 +1404,17 @@ std::shared_ptr<rpc::ObjectManagerClient> ObjectManager::GetRpcClient(
   return it->second;
 }
 
+bool ObjectManager::GetLocalObjectSize(const ObjectID &object_id,
+                                       uint64_t *object_size) const {
+  auto it = local_objects_.find(object_id);
+  if (it == local_objects_.end()) {
+    return false;
+  }
+  const auto &object_info = it->second.object_info;
+  *object_size = object_info.data_size + object_info.metadata_size;
+  return true;
+}
+
 std::shared_ptr<rpc::ProfileTableData> ObjectManager::GetAndResetProfilingInfo() {
   auto profile_info = std::make_shared<rpc::ProfileTableData>();
   profile_info->set_component_type("object_manager");
@@ -827,6 +1438,13 @@ std::string ObjectManager::DebugString() const {
   result << "\n- num active wait requests: " << active_wait_requests_.size();
   result << "\n- num unfulfilled push requests: " << unfulfilled_push_requests_.size();
   result << "\n- num pull requests: " << pull_requests_.size();
+  result << "\n" << pull_queue_.DebugString();
+  result << "\n- num relayed objects: " << relays_.size();
+  result << "\n" << push_manager_.DebugString();
+  result << "\n" << chunk_compressor_.DebugString();
+  if (RayConfig::instance().object_manager_autotune_chunk_size()) {
+    result << "\n" << chunk_size_tuner_.DebugString();
+  }
   result << "\n- num buffered profile events: " << profile_events_.size();
   result << "\n" << object_directory_->DebugString();
   result << "\n" << store_notification_.DebugString();
@@ -851,8 +1469,24 @@ void ObjectManager::RecordMetrics() const {
       {{stats::ValueTypeKey, "num_unfulfilled_push_requests"}});
   stats::ObjectManagerStats().Record(pull_requests_.size(),
                                      {{stats::ValueTypeKey, "num_pull_requests"}});
+  for (int i = 0; i < kNumPullPriorities; i++) {
+    auto priority = static_cast<PullPriority>(i);
+    stats::ObjectManagerStats().Record(
+        pull_queue_.NumQueued(priority),
+        {{stats::ValueTypeKey, "num_queued_pulls_" + PullPriorityName(priority)}});
+  }
+  stats::ObjectManagerStats().Record(pull_queue_.ActiveBytes(),
+                                     {{stats::ValueTypeKey, "active_pull_bytes"}});
+  stats::ObjectManagerStats().Record(push_manager_.NumPushesInFlight(),
+                                     {{stats::ValueTypeKey, "num_pushes_in_flight"}});
+  stats::ObjectManagerStats().Record(
+      push_manager_.NumChunksInFlight(),
+      {{stats::ValueTypeKey, "num_push_chunks_in_flight"}});
+  stats::ObjectManagerStats().Record(relays_.size(),
+                                     {{stats::ValueTypeKey, "num_relayed_objects"}});
   stats::ObjectManagerStats().Record(profile_events_.size(),
                                      {{stats::ValueTypeKey, "num_profile_events"}});
+  chunk_compressor_.RecordMetrics();
 }
 
 }  // namespace ray
@@ -21,12 +21,17 @@
 #include "ray/common/ray_config.h"
 #include "ray/common/status.h"
 
+#include "ray/object_manager/chunk_compressor.h"
+#include "ray/object_manager/chunk_size_tuner.h"
 #include "ray/object_manager/format/object_manager_generated.h"
 #include "ray/object_manager/object_buffer_pool.h"
 #include "ray/object_manager/object_directory.h"
 #include "ray/object_manager/object_store_notification_manager.h"
+#include "ray/object_manager/pull_queue.h"
+#include "ray/object_manager/push_manager.h"
 #include "ray/rpc/object_manager/object_manager_client.h"
 #include "ray/rpc/object_manager/object_manager_server.h"
+#include "ray/rpc/object_manager/push_request_reader.h"
 
 namespace ray {
 
@@ -50,19 +55,26 @@ struct ObjectManagerConfig {
   /// Number of threads of rpc service
   /// Send and receive request in these threads
   int rpc_service_threads_number;
+  /// The capacity of the object store, in bytes. Pulls are only admitted while the
+  /// objects being pulled fit into the memory that isn't pinned. 0 if unknown, in
+  /// which case pulls are not bounded by memory.
+  int64_t object_store_memory = 0;
 };
 
 struct LocalObjectInfo {
   /// Information from the object store about the object.
   object_manager::protocol::ObjectInfoT object_info;
-  /// A map from the ID of a remote object manager to the timestamp of when
+  /// A map from the ID of a remote object manager to the timestamps of when
   /// the object was last pushed to that object manager (if a push took place).
-  std::unordered_map<ClientID, int64_t> recent_pushes;
+  /// Stripes of the object's chunks are pushed independently, so the timestamps are
+  /// kept per (stripe index, number of stripes); the whole object is stripe 0 of 1.
+  std::unordered_map<ClientID, std::map<std::pair<uint32_t, uint32_t>, int64_t>>
+      recent_pushes;
 };
 
 class ObjectManagerInterface {
  public:
-  virtual ray::Status Pull(const ObjectID &object_id) = 0;
+  virtual ray::Status Pull(const ObjectID &object_id, PullPriority priority) = 0;
   virtual void CancelPull(const ObjectID &object_id) = 0;
   virtual ~ObjectManagerInterface(){};
 };
@@ -78,10 +90,10 @@ class ObjectManager : public ObjectManagerInterface,
   /// Push request will contain the object which is specified by pull request
   /// the object will be transfered by a sequence of chunks.
   ///
-  /// \param request Push request including the object chunk data
+  /// \param request Serialized push request including the object chunk data
   /// \param reply Reply to the sender
   /// \param send_reply_callback Callback of the request
-  void HandlePush(const rpc::PushRequest &request, rpc::PushReply *reply,
+  void HandlePush(const grpc::ByteBuffer &request, grpc::ByteBuffer *reply,
                   rpc::SendReplyCallback send_reply_callback) override;
 
   /// Handle pull request from remote object manager
@@ -110,30 +122,61 @@ class ObjectManager : public ObjectManagerInterface,
   /// \param data_size Data size
   /// \param metadata_size Metadata size
   /// \param chunk_index Chunk index of this object chunk, start with 0
+  /// \param chunk_size Chunk size the object is split into for this push
+  /// \param codec Compression codec negotiated with the remote object manager
   /// \param rpc_client Rpc client used to send message to remote object manager
+  /// \param on_complete Callback invoked on the main thread once the chunk is
+  /// acknowledged or has failed
   ray::Status SendObjectChunk(const UniqueID &push_id, const ObjectID &object_id,
                               const ClientID &client_id, uint64_t data_size,
                               uint64_t metadata_size, uint64_t chunk_index,
-                              std::shared_ptr<rpc::ObjectManagerClient> rpc_client);
+                              uint64_t chunk_size, rpc::CompressionCodec codec,
+                              std::shared_ptr<rpc::ObjectManagerClient> rpc_client,
+                              const std::function<void(const Status &)> &on_complete);
 
   /// Receive object chunk from remote object manager, small object may contain one chunk
   ///
+  /// The chunk data is copied from the request buffer directly into the plasma buffer
+  /// of the chunk, without an intermediate copy. Compressed chunks are decompressed
+  /// into the plasma buffer instead.
+  ///
   /// \param client_id Client id of remote object manager which sends this chunk
   /// \param object_id Object id
   /// \param data_size Data size
   /// \param metadata_size Metadata size
   /// \param chunk_index Chunk index
-  /// \param data Chunk data
+  /// \param chunk_size Chunk size the sender split the object into
+  /// \param codec Compression codec of the chunk data
+  /// \param reader Reader of the push request, positioned at the chunk data
   ray::Status ReceiveObjectChunk(const ClientID &client_id, const ObjectID &object_id,
                                  uint64_t data_size, uint64_t metadata_size,
-                                 uint64_t chunk_index, const std::string &data);
+                                 uint64_t chunk_index, uint64_t chunk_size,
+                                 rpc::CompressionCodec codec,
+                                 rpc::PushRequestReader &reader);
 
   /// Send pull request
   ///
   /// \param object_id Object id
   /// \param client_id Remote server client id
+  /// \param rpc_client Rpc client used to send message to remote object manager
+  /// \param stripe_index The stripe of chunks to request, see `num_stripes`
+  /// \param num_stripes The number of clients the object is pulled from in parallel,
+  /// or 0 to request the whole object
   void SendPullRequest(const ObjectID &object_id, const ClientID &client_id,
-                       std::shared_ptr<rpc::ObjectManagerClient> rpc_client);
+                       std::shared_ptr<rpc::ObjectManagerClient> rpc_client,
+                       uint32_t stripe_index, uint32_t num_stripes);
+
+  /// Forward a pull request to another object manager, which then pushes the
+  /// object to the original requester instead of this object manager.
+  ///
+  /// \param object_id Object id
+  /// \param requester_id Client id of the object manager that requested the object
+  /// \param client_id Client id of the object manager the request is forwarded to
+  /// \param codec Compression codec negotiated with the requester
+  /// \param rpc_client Rpc client used to send message to `client_id`
+  void ForwardPullRequest(const ObjectID &object_id, const ClientID &requester_id,
+                          const ClientID &client_id, rpc::CompressionCodec codec,
+                          std::shared_ptr<rpc::ObjectManagerClient> rpc_client);
 
   /// Get the rpc client according to the client ID
   ///
@@ -173,20 +216,58 @@ class ObjectManager : public ObjectManagerInterface,
   /// \return Status of whether adding the subscription succeeded.
   ray::Status SubscribeObjDeleted(std::function<void(const ray::ObjectID &)> callback);
 
+  /// Set the handler that restores objects spilled to local disk. Pulls of objects
+  /// that it restores don't fetch them from other nodes.
+  ///
+  /// \param restorer The handler to call when an object is pulled. It returns
+  /// whether it is restoring the object.
+  void SetSpilledObjectRestorer(std::function<bool(const ObjectID &)> restorer);
+
+  /// Set the total size of the local objects that are pinned, and so can't be
+  /// evicted to make room for the objects being pulled.
+  ///
+  /// \param pinned_bytes The total size of the pinned objects, in bytes.
+  void SetPinnedObjectBytes(int64_t pinned_bytes);
+
   /// Consider pushing an object to a remote object manager. This object manager
   /// may choose to ignore the Push call (e.g., if Push is called twice in a row
   /// on the same object, the second one might be ignored).
   ///
+  /// If object_manager_broadcast_fanout is set, the object is sent to at most that
+  /// many object managers at once. Further requests are forwarded to one of the
+  /// receivers, which relays the object while it is still receiving it.
+  ///
   /// \param object_id The object's object id.
   /// \param client_id The remote node's client id.
   /// \return Void.
   void Push(const ObjectID &object_id, const ClientID &client_id);
 
+  /// Consider pushing one stripe of an object's chunks to a remote object manager,
+  /// i.e., the chunks whose index modulo num_stripes equals stripe_index. This is
+  /// used when a remote object manager pulls the object from several nodes at once.
+  /// If the object is not local yet, the same stripe is pushed in the requested chunk
+  /// size once it arrives.
+  ///
+  /// \param object_id The object's object id.
+  /// \param client_id The remote node's client id.
+  /// \param stripe_index The stripe of chunks to push.
+  /// \param num_stripes The number of stripes the object is split into.
+  /// \param requested_chunk_size The chunk size that the remote node receives the
+  /// object in, if it already received part of it, or 0 to choose one.
+  /// \return Void.
+  void Push(const ObjectID &object_id, const ClientID &client_id, uint32_t stripe_index,
+            uint32_t num_stripes, uint64_t requested_chunk_size);
+
   /// Pull an object from ClientID.
   ///
+  /// The request is queued, and the object is pulled once the requests of higher
+  /// priority have been admitted and it fits into the free object store memory.
+  /// Requesting an object again with a higher priority raises its priority.
+  ///
   /// \param object_id The object's object id.
+  /// \param priority The priority of the request.
   /// \return Status of whether the pull request successfully initiated.
-  ray::Status Pull(const ObjectID &object_id) override;
+  ray::Status Pull(const ObjectID &object_id, PullPriority priority) override;
 
   /// Try to Pull an object from one of its expected client locations. If there
   /// are more client locations to try after this attempt, then this method
@@ -195,6 +276,10 @@ class ObjectManager : public ObjectManagerInterface,
   /// the timeout, then no more Pull requests for this object will be sent
   /// to other node managers until TryPull is called again.
   ///
+  /// If several remote clients have the object and object_manager_max_pull_sources
+  /// allows it, each attempt pulls disjoint stripes of the object's chunks from
+  /// several of them in parallel.
+  ///
   /// \param object_id The object's object id.
   /// \return Void.
   void TryPull(const ObjectID &object_id);
@@ -231,6 +316,13 @@ class ObjectManager : public ObjectManagerInterface,
   ///                   or send it to all the object stores.
   void FreeObjects(const std::vector<ObjectID> &object_ids, bool local_only);
 
+  /// Get the size of an object in the local object store.
+  ///
+  /// \param object_id The ID of the object.
+  /// \param object_size The size of the object is stored here if it's local.
+  /// \return Whether the object is in the local object store.
+  bool GetLocalObjectSize(const ObjectID &object_id, uint64_t *object_size) const;
+
   /// Return profiling information and reset the profiling information.
   ///
   /// \return All profiling information that has accumulated since the last call
@@ -247,6 +339,7 @@ class ObjectManager : public ObjectManagerInterface,
 
  private:
   friend class TestObjectManager;
+  friend class TestObjectManagerTransfer;
 
   struct PullRequest {
     PullRequest() : retry_timer(nullptr), timer_set(false), client_locations() {}
@@ -255,6 +348,38 @@ class ObjectManager : public ObjectManagerInterface,
     std::vector<ClientID> client_locations;
   };
 
+  /// A push request that waits for the object to be local, which is replayed as it
+  /// was made once the object is added.
+  struct UnfulfilledPushRequest {
+    /// The chunk size that the remote node receives the object in, or 0 to choose one.
+    uint64_t requested_chunk_size = 0;
+    /// Fails the request after push_timeout_ms. Null if the request never times out.
+    std::unique_ptr<boost::asio::deadline_timer> timer;
+  };
+
+  /// The state of an object being relayed to a remote object manager while this
+  /// object manager is still receiving it.
+  struct RelayState {
+    /// Whether the chunks are being sent. This happens once the object's size is
+    /// known, i.e., once its first chunk has been received.
+    bool started = false;
+    /// The size of the object's data and metadata.
+    uint64_t data_size = 0;
+    /// The size of the object's metadata.
+    uint64_t metadata_size = 0;
+    /// The chunk size the object is relayed in, which is the size it is received in.
+    uint64_t chunk_size = 0;
+    /// The ID of the push to the remote object manager.
+    UniqueID push_id = UniqueID::FromRandom();
+    /// Rpc client used to send the chunks.
+    std::shared_ptr<rpc::ObjectManagerClient> rpc_client;
+    /// The chunks that the push manager scheduled, but that haven't been received
+    /// yet. They are sent as soon as they are.
+    std::unordered_set<uint64_t> parked_chunks;
+    /// Fires if the object doesn't arrive within push_timeout_ms.
+    std::unique_ptr<boost::asio::deadline_timer> timeout_timer;
+  };
+
   struct WaitState {
     WaitState(boost::asio::io_service &service, int64_t timeout_ms,
               const WaitCallback &callback)
@@ -312,6 +437,16 @@ class ObjectManager : public ObjectManagerInterface,
   void RunRpcService();
   void StopRpcService();
 
+  /// Start pulling the objects that the pull queue admits.
+  void AdmitPulls();
+
+  /// Start pulling an object that the pull queue admitted. This subscribes to the
+  /// object's locations, and tries to pull it from them as they are found.
+  ///
+  /// \param object_id The object to pull.
+  /// \return Status of whether the subscription to the object's locations succeeded.
+  ray::Status StartPull(const ObjectID &object_id);
+
   /// Handle an object being added to this node. This adds the object to the
   /// directory, pushes the object to other nodes if necessary, and cancels any
   /// outstanding Pull requests for the object.
@@ -353,7 +488,80 @@ class ObjectManager : public ObjectManagerInterface,
                              double end_time_us, ray::Status status);
 
   /// Handle Push task timeout.
-  void HandlePushTaskTimeout(const ObjectID &object_id, const ClientID &client_id);
+  ///
+  /// \param object_id The object that the push request waits for.
+  /// \param client_id The remote node's client id.
+  /// \param stripe The stripe of the request, as (stripe index, number of stripes).
+  /// \return Void.
+  void HandlePushTaskTimeout(const ObjectID &object_id, const ClientID &client_id,
+                             const std::pair<uint32_t, uint32_t> &stripe);
+
+  /// Handle completion of a chunk sent as part of a push. This lets the push manager
+  /// send the next chunks to the same client.
+  ///
+  /// \param object_id The ID of the object that was sent.
+  /// \param client_id The ID of the client that the chunk was sent to.
+  /// \param stripe_index The stripe of the object's chunks that was pushed.
+  /// \param num_stripes The number of stripes the object was split into.
+  /// \param num_bytes The size of the chunk.
+  /// \param start_time_us The time when the chunk was sent.
+  /// \param status The status of the send.
+  /// \return Void.
+  void HandleChunkPushed(const ObjectID &object_id, const ClientID &client_id,
+                         uint32_t stripe_index, uint32_t num_stripes,
+                         uint64_t num_bytes, int64_t start_time_us,
+                         const ray::Status &status);
+
+  /// Handle completion of all chunks of a push, including relayed pushes.
+  ///
+  /// \param object_id The ID of the object that was sent.
+  /// \param client_id The ID of the client that the object was sent to.
+  /// \param stripe_index The stripe of the object's chunks that was pushed.
+  /// \param num_stripes The number of stripes the object was split into.
+  /// \param end_time_us The time when the last chunk completed.
+  /// \return Void.
+  void HandlePushFinished(const ObjectID &object_id, const ClientID &client_id,
+                          uint32_t stripe_index, uint32_t num_stripes,
+                          int64_t end_time_us);
+
+  /// If this object manager is already sending an object to
+  /// object_manager_broadcast_fanout other object managers, forward a request for
+  /// the object to one of them instead. That receiver relays the object to the
+  /// requester, so that concurrent pulls of the same object form a tree.
+  ///
+  /// \param object_id The object that is requested.
+  /// \param client_id The client that requested the object.
+  /// \return True if the request was forwarded.
+  bool ForwardBroadcastPush(const ObjectID &object_id, const ClientID &client_id);
+
+  /// Relay an object that this object manager is still receiving to a remote object
+  /// manager. Chunks are forwarded as soon as they have been received, rather than
+  /// after the whole object has arrived.
+  ///
+  /// \param object_id The object that is requested.
+  /// \param client_id The client that requested the object.
+  /// \return False if the object is not being received, so it can't be relayed.
+  bool StartRelay(const ObjectID &object_id, const ClientID &client_id);
+
+  /// Get the compression codec negotiated with a remote object manager.
+  rpc::CompressionCodec GetRemoteCodec(const ClientID &client_id) const;
+
+  /// Start sending the chunks of a relay once the object's size is known.
+  void StartRelayPush(const ObjectID &object_id, const ClientID &client_id,
+                      uint64_t data_size, uint64_t metadata_size, uint64_t chunk_size);
+
+  /// Send a chunk of a relayed object, or park it until it has been received.
+  void SendRelayChunk(const ObjectID &object_id, const ClientID &client_id,
+                      uint64_t chunk_index);
+
+  /// Handle a chunk of a relayed object being received. This sends the chunk to all
+  /// clients the object is relayed to that are waiting for it.
+  void HandleRelayedChunkReceived(const ObjectID &object_id, uint64_t chunk_index,
+                                  uint64_t data_size, uint64_t metadata_size,
+                                  uint64_t chunk_size);
+
+  /// Give up on a relay whose object didn't arrive within push_timeout_ms.
+  void HandleRelayTimeout(const ObjectID &object_id, const ClientID &client_id);
 
   ClientID self_node_id_;
   const ObjectManagerConfig config_;
@@ -389,15 +597,59 @@ class ObjectManager : public ObjectManagerInterface,
 
   /// Maintains a map of push requests that have not been fulfilled due to an object not
   /// being local. Objects are removed from this map after push_timeout_ms have elapsed.
+  /// A remote object manager may request several stripes of an object, so the
+  /// requests are kept per (stripe index, number of stripes) of each client.
   std::unordered_map<
       ObjectID,
-      std::unordered_map<ClientID, std::unique_ptr<boost::asio::deadline_timer>>>
+      std::unordered_map<ClientID, std::map<std::pair<uint32_t, uint32_t>,
+                                            UnfulfilledPushRequest>>>
       unfulfilled_push_requests_;
 
   /// The objects that this object manager is currently trying to fetch from
   /// remote object managers.
   std::unordered_map<ObjectID, PullRequest> pull_requests_;
 
+  /// The requested objects, which are admitted to pull_requests_ by priority as
+  /// the object store memory that isn't pinned allows.
+  PullQueue pull_queue_;
+
+  /// The total size of the local objects that are pinned. The other local objects
+  /// can be evicted, so they don't hold back pulls.
+  int64_t pinned_object_bytes_ = 0;
+
+  /// Restores pulled objects that were spilled to local disk, if set.
+  std::function<bool(const ObjectID &)> restore_spilled_object_;
+
+  /// Schedules the chunks of the objects being pushed to remote object managers,
+  /// keeping a bounded window of chunks in flight per remote object manager.
+  PushManager push_manager_;
+
+  /// The clients that each object is currently being sent to, either from the local
+  /// object store or relayed. Only maintained if object_manager_broadcast_fanout is
+  /// set.
+  std::unordered_map<ObjectID, std::vector<ClientID>> broadcast_receivers_;
+
+  /// The objects being relayed to remote object managers while they are received.
+  std::unordered_map<ObjectID, std::unordered_map<ClientID, RelayState>> relays_;
+
+  /// The keys of relays_, read by rpc threads when receiving chunks.
+  std::unordered_set<ObjectID> relayed_objects_;
+
+  /// Mutex used to protect relayed_objects_.
+  std::mutex relay_mutex_;
+
+  /// Compresses the chunks sent to, and decompresses the chunks received from,
+  /// remote object managers.
+  ChunkCompressor chunk_compressor_;
+
+  /// The compression codec negotiated with each remote object manager, from the
+  /// codecs listed in its pull requests.
+  std::unordered_map<ClientID, rpc::CompressionCodec> remote_codecs_;
+
+  /// Chooses the chunk size of the objects pushed to remote object managers, if
+  /// object_manager_autotune_chunk_size is set.
+  ChunkSizeTuner chunk_size_tuner_;
+
   /// Profiling events that are to be batched together and added to the profile
   /// table in the GCS.
   std::vector<rpc::ProfileTableData::ProfileEvent> profile_events_;
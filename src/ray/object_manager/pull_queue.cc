@@ -0,0 +1,151 @@
+#include "ray/object_manager/pull_queue.h"
+
+#include <sstream>
+
+#include "ray/util/logging.h"
+
+namespace {
+
+/// The weight of a completed pull in the moving average of object sizes.
+constexpr double kSizeSmoothing = 0.1;
+
+}  // namespace
+
+namespace ray {
+
+std::string PullPriorityName(PullPriority priority) {
+  switch (priority) {
+  case PullPriority::TASK_ARGUMENT:
+    return "task_argument";
+  case PullPriority::GET:
+    return "get";
+  case PullPriority::WAIT:
+    return "wait";
+  case PullPriority::PREFETCH:
+    return "prefetch";
+  default:
+    RAY_LOG(FATAL) << "Unknown pull priority " << static_cast<int>(priority);
+    return "";
+  }
+}
+
+PullQueue::PullQueue(int64_t max_active_pulls, uint64_t initial_size_estimate)
+    : max_active_pulls_(max_active_pulls),
+      average_object_size_(static_cast<double>(initial_size_estimate)) {}
+
+bool PullQueue::Add(const ObjectID &object_id, PullPriority priority) {
+  auto it = pulls_.find(object_id);
+  if (it == pulls_.end()) {
+    PullEntry entry;
+    entry.priority = priority;
+    entry.sequence = next_sequence_++;
+    pulls_.emplace(object_id, entry);
+    queue_.emplace(std::make_pair(priority, entry.sequence), object_id);
+    num_queued_[static_cast<int>(priority)]++;
+    return true;
+  }
+  auto &entry = it->second;
+  if (priority < entry.priority) {
+    if (!entry.active) {
+      queue_.erase(std::make_pair(entry.priority, entry.sequence));
+      num_queued_[static_cast<int>(entry.priority)]--;
+      queue_.emplace(std::make_pair(priority, entry.sequence), object_id);
+      num_queued_[static_cast<int>(priority)]++;
+    }
+    entry.priority = priority;
+  }
+  return false;
+}
+
+bool PullQueue::Remove(const ObjectID &object_id) {
+  auto it = pulls_.find(object_id);
+  if (it == pulls_.end()) {
+    return false;
+  }
+  const auto &entry = it->second;
+  bool active = entry.active;
+  if (active) {
+    num_active_--;
+    if (entry.size == 0) {
+      unsized_active_.erase(object_id);
+    } else {
+      sized_active_bytes_ -= entry.size;
+    }
+  } else {
+    queue_.erase(std::make_pair(entry.priority, entry.sequence));
+    num_queued_[static_cast<int>(entry.priority)]--;
+  }
+  pulls_.erase(it);
+  return active;
+}
+
+void PullQueue::Complete(const ObjectID &object_id, uint64_t size) {
+  if (Remove(object_id)) {
+    average_object_size_ += kSizeSmoothing * (size - average_object_size_);
+  }
+}
+
+void PullQueue::SetObjectSize(const ObjectID &object_id, uint64_t size) {
+  auto it = pulls_.find(object_id);
+  if (it == pulls_.end() || !it->second.active || it->second.size != 0 || size == 0) {
+    return;
+  }
+  it->second.size = size;
+  unsized_active_.erase(object_id);
+  sized_active_bytes_ += size;
+}
+
+std::vector<ObjectID> PullQueue::AdmitPulls(int64_t available_bytes) {
+  std::vector<ObjectID> admitted;
+  while (!queue_.empty()) {
+    if (max_active_pulls_ > 0 && num_active_ >= max_active_pulls_) {
+      break;
+    }
+    if (available_bytes >= 0 && num_active_ > 0 &&
+        ActiveBytes() >= static_cast<uint64_t>(available_bytes)) {
+      break;
+    }
+    auto queue_it = queue_.begin();
+    const ObjectID object_id = queue_it->second;
+    auto &entry = pulls_[object_id];
+    num_queued_[static_cast<int>(entry.priority)]--;
+    queue_.erase(queue_it);
+    entry.active = true;
+    num_active_++;
+    unsized_active_.insert(object_id);
+    admitted.push_back(object_id);
+  }
+  return admitted;
+}
+
+bool PullQueue::IsActive(const ObjectID &object_id) const {
+  auto it = pulls_.find(object_id);
+  return it != pulls_.end() && it->second.active;
+}
+
+std::vector<ObjectID> PullQueue::GetUnsizedActivePulls() const {
+  return std::vector<ObjectID>(unsized_active_.begin(), unsized_active_.end());
+}
+
+int64_t PullQueue::NumQueued(PullPriority priority) const {
+  return num_queued_[static_cast<int>(priority)];
+}
+
+uint64_t PullQueue::ActiveBytes() const {
+  return sized_active_bytes_ +
+         static_cast<uint64_t>(unsized_active_.size() * average_object_size_);
+}
+
+std::string PullQueue::DebugString() const {
+  std::stringstream result;
+  result << "PullQueue:";
+  result << "\n- num active pulls: " << num_active_;
+  result << "\n- active pull bytes: " << ActiveBytes();
+  for (int i = 0; i < kNumPullPriorities; i++) {
+    result << "\n- num queued " << PullPriorityName(static_cast<PullPriority>(i))
+           << " pulls: " << num_queued_[i];
+  }
+  return result.str();
+}
+
+}  // namespace ray
@@ -0,0 +1,145 @@
+#ifndef RAY_OBJECT_MANAGER_PULL_QUEUE_H
+#define RAY_OBJECT_MANAGER_PULL_QUEUE_H
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ray/common/id.h"
+
+namespace ray {
+
+/// The priority of a pull request. Pulls with a lower value are admitted first.
+enum class PullPriority : int {
+  /// Arguments of tasks queued on this node.
+  TASK_ARGUMENT = 0,
+  /// Objects that a worker is blocked on in `ray.get`.
+  GET = 1,
+  /// Objects that a worker is waiting on in `ray.wait`.
+  WAIT = 2,
+  /// Objects fetched before anything blocks on them.
+  PREFETCH = 3,
+};
+
+/// The number of pull priorities.
+constexpr int kNumPullPriorities = 4;
+
+/// Return the name of a pull priority, e.g. for metrics.
+std::string PullPriorityName(PullPriority priority);
+
+/// \class PullQueue
+///
+/// Decides which of the objects requested from remote nodes are actively pulled.
+/// Requests are queued by priority, and admitted in priority order (FIFO within a
+/// priority) as long as the objects being pulled fit into the free object store
+/// memory. This keeps background pulls from evicting the objects that tasks need to
+/// run, and lets a task's arguments overtake prefetches when the store is full.
+///
+/// The size of an object is only known once its first chunk arrives. Until then, an
+/// active pull is accounted for with the average size of the pulls completed so far.
+/// A single pull is always admitted, even if it doesn't fit, so that objects larger
+/// than the free memory can still be pulled.
+///
+/// This class is not thread-safe.
+class PullQueue {
+ public:
+  /// Constructor.
+  ///
+  /// \param max_active_pulls The maximum number of pulls admitted at once, or 0 for
+  /// no limit.
+  /// \param initial_size_estimate The assumed size of objects while no pull has
+  /// completed yet.
+  PullQueue(int64_t max_active_pulls, uint64_t initial_size_estimate);
+
+  /// Queue a pull request, or raise the priority of a request that is already queued
+  /// or active. Lowering the priority of a request has no effect.
+  ///
+  /// \param object_id The object to pull.
+  /// \param priority The priority of the request.
+  /// \return True if the object was not requested before.
+  bool Add(const ObjectID &object_id, PullPriority priority);
+
+  /// Remove a queued or active pull request, e.g. because it was canceled or the
+  /// object arrived.
+  ///
+  /// \param object_id The object that was requested.
+  /// \return True if the pull was active.
+  bool Remove(const ObjectID &object_id);
+
+  /// Record that an active pull completed, and remove it.
+  ///
+  /// \param object_id The object that was pulled.
+  /// \param size The size of the object's data and metadata.
+  void Complete(const ObjectID &object_id, uint64_t size);
+
+  /// Set the size of an active pull, once it is known.
+  ///
+  /// \param object_id The object being pulled.
+  /// \param size The size of the object's data and metadata.
+  void SetObjectSize(const ObjectID &object_id, uint64_t size);
+
+  /// Admit queued pulls in priority order.
+  ///
+  /// \param available_bytes The free object store memory, not counting the objects
+  /// being pulled. Negative if unknown, in which case memory isn't a limit.
+  /// \return The objects to start pulling.
+  std::vector<ObjectID> AdmitPulls(int64_t available_bytes);
+
+  /// Return whether an object is being pulled, as opposed to being queued.
+  bool IsActive(const ObjectID &object_id) const;
+
+  /// Return the active pulls whose object size isn't known yet.
+  std::vector<ObjectID> GetUnsizedActivePulls() const;
+
+  /// Return the number of queued pulls with the given priority.
+  int64_t NumQueued(PullPriority priority) const;
+
+  /// Return the number of active pulls.
+  int64_t NumActive() const { return num_active_; }
+
+  /// Return the object store memory accounted for the active pulls, including
+  /// estimates for pulls whose object size isn't known yet.
+  uint64_t ActiveBytes() const;
+
+  /// Returns debug string for class.
+  ///
+  /// \return string.
+  std::string DebugString() const;
+
+ private:
+  struct PullEntry {
+    /// The priority of the request.
+    PullPriority priority;
+    /// The order in which the request was queued.
+    uint64_t sequence;
+    /// Whether the object is being pulled.
+    bool active = false;
+    /// The size of the object, or 0 if it isn't known yet.
+    uint64_t size = 0;
+  };
+
+  /// The maximum number of pulls admitted at once, or 0 for no limit.
+  const int64_t max_active_pulls_;
+  /// All queued and active requests.
+  std::unordered_map<ObjectID, PullEntry> pulls_;
+  /// The queued requests, ordered by priority and then by sequence number.
+  std::map<std::pair<PullPriority, uint64_t>, ObjectID> queue_;
+  /// The number of queued requests per priority.
+  int64_t num_queued_[kNumPullPriorities] = {};
+  /// The sequence number of the next request.
+  uint64_t next_sequence_ = 0;
+  /// The number of active pulls.
+  int64_t num_active_ = 0;
+  /// The active pulls whose object size isn't known yet.
+  std::unordered_set<ObjectID> unsized_active_;
+  /// The total size of the active pulls whose object size is known.
+  uint64_t sized_active_bytes_ = 0;
+  /// The moving average of the sizes of completed pulls.
+  double average_object_size_;
+};
+
+}  // namespace ray
+
+#endif  // RAY_OBJECT_MANAGER_PULL_QUEUE_H
@@ -0,0 +1,168 @@
+#include "ray/object_manager/push_manager.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "ray/util/logging.h"
+
+namespace {
+
+/// If fewer than this many of a destination's chunks are estimated to be queued
+/// behind each other, the window grows.
+constexpr double kMinQueuedChunks = 1.0;
+/// If more than this many of a destination's chunks are estimated to be queued
+/// behind each other, the window shrinks.
+constexpr double kMaxQueuedChunks = 3.0;
+
+}  // namespace
+
+namespace ray {
+
+PushManager::PushManager(int64_t initial_window, int64_t max_window)
+    : initial_window_(std::max<int64_t>(initial_window, 1)),
+      max_window_(std::max<int64_t>(max_window, initial_window_)) {}
+
+bool PushManager::StartPush(const ClientID &dest_id, const ObjectID &object_id,
+                            int64_t num_chunks, const SendChunkCallback &send_chunk) {
+  return StartPush(dest_id, object_id, /*stripe_index=*/0, /*num_stripes=*/1,
+                   num_chunks, send_chunk);
+}
+
+bool PushManager::StartPush(const ClientID &dest_id, const ObjectID &object_id,
+                            uint32_t stripe_index, uint32_t num_stripes,
+                            int64_t num_chunks, const SendChunkCallback &send_chunk) {
+  RAY_CHECK(num_chunks > 0);
+  RAY_CHECK(stripe_index < num_stripes);
+  auto it = destinations_.find(dest_id);
+  if (it == destinations_.end()) {
+    it = destinations_.emplace(dest_id, DestinationState(initial_window_)).first;
+  }
+  auto &dest = it->second;
+  const PushKey key{object_id, stripe_index, num_stripes};
+  if (!dest.pushes.emplace(key, PushState{num_chunks, 0, 0, send_chunk}).second) {
+    RAY_LOG(DEBUG) << "Object " << object_id << ", stripe " << stripe_index << " of "
+                   << num_stripes << " is already being pushed to " << dest_id;
+    return false;
+  }
+  dest.send_order.push_back(key);
+  num_chunks_remaining_ += num_chunks;
+  num_pushes_in_flight_++;
+  SendChunks(dest);
+  return true;
+}
+
+bool PushManager::OnChunkComplete(const ClientID &dest_id, const ObjectID &object_id,
+                                  bool success, int64_t rtt_us) {
+  return OnChunkComplete(dest_id, object_id, /*stripe_index=*/0, /*num_stripes=*/1,
+                         success, rtt_us);
+}
+
+bool PushManager::OnChunkComplete(const ClientID &dest_id, const ObjectID &object_id,
+                                  uint32_t stripe_index, uint32_t num_stripes,
+                                  bool success, int64_t rtt_us) {
+  auto dest_it = destinations_.find(dest_id);
+  RAY_CHECK(dest_it != destinations_.end());
+  auto &dest = dest_it->second;
+  auto push_it = dest.pushes.find(PushKey{object_id, stripe_index, num_stripes});
+  RAY_CHECK(push_it != dest.pushes.end());
+  auto &push = push_it->second;
+  RAY_CHECK(push.num_chunks_in_flight > 0);
+
+  push.num_chunks_in_flight--;
+  dest.num_chunks_in_flight--;
+  num_chunks_in_flight_--;
+  UpdateWindow(dest, success, rtt_us);
+
+  bool push_done =
+      push.next_chunk_index == push.num_chunks && push.num_chunks_in_flight == 0;
+  if (push_done) {
+    dest.pushes.erase(push_it);
+    num_pushes_in_flight_--;
+  }
+  SendChunks(dest);
+  return push_done;
+}
+
+bool PushManager::CancelPush(const ClientID &dest_id, const ObjectID &object_id) {
+  auto dest_it = destinations_.find(dest_id);
+  if (dest_it == destinations_.end()) {
+    return false;
+  }
+  auto &dest = dest_it->second;
+  const PushKey key{object_id, /*stripe_index=*/0, /*num_stripes=*/1};
+  auto push_it = dest.pushes.find(key);
+  if (push_it == dest.pushes.end()) {
+    return false;
+  }
+  auto &push = push_it->second;
+  num_chunks_remaining_ -= push.num_chunks - push.next_chunk_index;
+  push.num_chunks = push.next_chunk_index;
+  auto order_it = std::find(dest.send_order.begin(), dest.send_order.end(), key);
+  if (order_it != dest.send_order.end()) {
+    dest.send_order.erase(order_it);
+  }
+  if (push.num_chunks_in_flight == 0) {
+    dest.pushes.erase(push_it);
+    num_pushes_in_flight_--;
+    return true;
+  }
+  return false;
+}
+
+double PushManager::GetWindow(const ClientID &dest_id) const {
+  auto it = destinations_.find(dest_id);
+  return it == destinations_.end() ? initial_window_ : it->second.window;
+}
+
+void PushManager::UpdateWindow(DestinationState &dest, bool success, int64_t rtt_us) {
+  if (!success) {
+    dest.window = std::max(1.0, dest.window / 2);
+    return;
+  }
+  rtt_us = std::max<int64_t>(rtt_us, 1);
+  if (dest.min_rtt_us == 0 || rtt_us < dest.min_rtt_us) {
+    dest.min_rtt_us = rtt_us;
+  }
+  // The number of chunks that are queued rather than being transferred, estimated
+  // from the difference between the expected and the actual throughput.
+  double queued_chunks =
+      dest.window * (1.0 - static_cast<double>(dest.min_rtt_us) / rtt_us);
+  // Adjust by one chunk per window's worth of acknowledgements, i.e., roughly
+  // once per round trip.
+  if (queued_chunks < kMinQueuedChunks) {
+    dest.window = std::min(max_window_, dest.window + 1.0 / dest.window);
+  } else if (queued_chunks > kMaxQueuedChunks) {
+    dest.window = std::max(1.0, dest.window - 1.0 / dest.window);
+  }
+}
+
+void PushManager::SendChunks(DestinationState &dest) {
+  while (dest.num_chunks_in_flight < static_cast<int64_t>(dest.window) &&
+         !dest.send_order.empty()) {
+    const PushKey key = dest.send_order.front();
+    dest.send_order.pop_front();
+    auto &push = dest.pushes.at(key);
+    int64_t chunk_index = push.next_chunk_index++;
+    if (push.next_chunk_index < push.num_chunks) {
+      // Round-robin between the pushes to this destination.
+      dest.send_order.push_back(key);
+    }
+    push.num_chunks_in_flight++;
+    dest.num_chunks_in_flight++;
+    num_chunks_in_flight_++;
+    num_chunks_remaining_--;
+    push.send_chunk(chunk_index);
+  }
+}
+
+std::string PushManager::DebugString() const {
+  std::stringstream result;
+  result << "PushManager:";
+  result << "\n- num destinations: " << destinations_.size();
+  result << "\n- num pushes in flight: " << num_pushes_in_flight_;
+  result << "\n- num chunks in flight: " << num_chunks_in_flight_;
+  result << "\n- num chunks remaining: " << num_chunks_remaining_;
+  return result.str();
+}
+
+}  // namespace ray
@@ -0,0 +1,187 @@
+#ifndef RAY_OBJECT_MANAGER_PUSH_MANAGER_H
+#define RAY_OBJECT_MANAGER_PUSH_MANAGER_H
+
+#include <deque>
+#include <functional>
+#include <unordered_map>
+
+#include "ray/common/id.h"
+
+namespace ray {
+
+/// \class PushManager
+///
+/// Schedules the chunks of outgoing object pushes. For each destination, at most a
+/// window of chunks is in flight at any time, and the next chunk is only sent once
+/// a previous one has been acknowledged. Pushes to the same destination share its
+/// window round-robin, so a large push cannot starve a small one.
+///
+/// The window of each destination adapts to the round trip times observed for its
+/// chunks, similar to TCP Vegas: while chunk RTTs stay close to the smallest RTT seen
+/// for that destination, the link is not saturated and the window grows; once chunks
+/// start queueing up (RTTs grow), the window shrinks. Failed chunks halve the window.
+///
+/// This class is not thread-safe; all methods must be called from the same thread.
+class PushManager {
+ public:
+  /// Callback that sends one chunk of an object. Once the chunk has been acknowledged
+  /// by the destination (or has failed), `OnChunkComplete` must be called.
+  using SendChunkCallback = std::function<void(int64_t chunk_index)>;
+
+  /// Constructor.
+  ///
+  /// \param initial_window The window, in chunks, of a newly seen destination.
+  /// \param max_window The maximum window, in chunks, of any destination.
+  PushManager(int64_t initial_window, int64_t max_window);
+
+  /// Start pushing an object to a destination. The chunks are sent through the given
+  /// callback as the destination's window allows.
+  ///
+  /// \param dest_id The node to push to.
+  /// \param object_id The object to push.
+  /// \param num_chunks The number of chunks of the object.
+  /// \param send_chunk The callback used to send a chunk.
+  /// \return False if the same object is already being pushed to the destination, in
+  /// which case this call is ignored.
+  bool StartPush(const ClientID &dest_id, const ObjectID &object_id, int64_t num_chunks,
+                 const SendChunkCallback &send_chunk);
+
+  /// Start pushing one stripe of an object's chunks to a destination, i.e., the
+  /// chunks whose index modulo num_stripes equals stripe_index. Pushes of different
+  /// stripes of an object are independent of each other; a push of the whole object
+  /// is stripe 0 of 1.
+  ///
+  /// \param dest_id The node to push to.
+  /// \param object_id The object to push.
+  /// \param stripe_index The stripe of the object's chunks to push.
+  /// \param num_stripes The number of stripes the object is split into.
+  /// \param num_chunks The number of chunks of the stripe. The callback is passed the
+  /// index of a chunk within the stripe.
+  /// \param send_chunk The callback used to send a chunk.
+  /// \return False if the same stripe is already being pushed to the destination, in
+  /// which case this call is ignored.
+  bool StartPush(const ClientID &dest_id, const ObjectID &object_id,
+                 uint32_t stripe_index, uint32_t num_stripes, int64_t num_chunks,
+                 const SendChunkCallback &send_chunk);
+
+  /// Handle completion of a chunk that was sent through `SendChunkCallback`. This
+  /// adjusts the window of the destination and sends more chunks if it allows.
+  ///
+  /// \param dest_id The node the chunk was sent to.
+  /// \param object_id The object the chunk belongs to.
+  /// \param success Whether the chunk was successfully received.
+  /// \param rtt_us The time between sending the chunk and its acknowledgement.
+  /// \return True if this was the last outstanding chunk of the push.
+  bool OnChunkComplete(const ClientID &dest_id, const ObjectID &object_id, bool success,
+                       int64_t rtt_us);
+
+  /// Handle completion of a chunk of a stripe push, see `OnChunkComplete` above.
+  ///
+  /// \param dest_id The node the chunk was sent to.
+  /// \param object_id The object the chunk belongs to.
+  /// \param stripe_index The stripe the chunk belongs to.
+  /// \param num_stripes The number of stripes the object is split into.
+  /// \param success Whether the chunk was successfully received.
+  /// \param rtt_us The time between sending the chunk and its acknowledgement.
+  /// \return True if this was the last outstanding chunk of the stripe's push.
+  bool OnChunkComplete(const ClientID &dest_id, const ObjectID &object_id,
+                       uint32_t stripe_index, uint32_t num_stripes, bool success,
+                       int64_t rtt_us);
+
+  /// Stop sending the remaining chunks of a push of a whole object. Chunks that were
+  /// already sent must still be completed through `OnChunkComplete`, and the push
+  /// finishes once they are.
+  ///
+  /// \param dest_id The node the object is pushed to.
+  /// \param object_id The object being pushed.
+  /// \return True if the push finished, i.e., it had no chunks in flight.
+  bool CancelPush(const ClientID &dest_id, const ObjectID &object_id);
+
+  /// Return the current window, in chunks, for a destination.
+  double GetWindow(const ClientID &dest_id) const;
+
+  /// Return the number of chunks sent but not yet acknowledged, across destinations.
+  int64_t NumChunksInFlight() const { return num_chunks_in_flight_; }
+
+  /// Return the number of chunks not sent yet, across destinations.
+  int64_t NumChunksRemaining() const { return num_chunks_remaining_; }
+
+  /// Return the number of pushes in progress, across destinations.
+  int64_t NumPushesInFlight() const { return num_pushes_in_flight_; }
+
+  /// Returns debug string for class.
+  ///
+  /// \return string.
+  std::string DebugString() const;
+
+ private:
+  /// Identifies a push to a destination: the object, and the stripe of its chunks.
+  struct PushKey {
+    ObjectID object_id;
+    uint32_t stripe_index;
+    uint32_t num_stripes;
+
+    bool operator==(const PushKey &rhs) const {
+      return object_id == rhs.object_id && stripe_index == rhs.stripe_index &&
+             num_stripes == rhs.num_stripes;
+    }
+  };
+
+  struct PushKeyHash {
+    size_t operator()(const PushKey &key) const {
+      return key.object_id.Hash() ^ (static_cast<size_t>(key.stripe_index) << 32) ^
+             key.num_stripes;
+    }
+  };
+
+  /// The state of a single object push.
+  struct PushState {
+    /// The number of chunks of the object.
+    int64_t num_chunks;
+    /// The index of the next chunk to send.
+    int64_t next_chunk_index;
+    /// The number of chunks that have been sent but not acknowledged.
+    int64_t num_chunks_in_flight;
+    /// The callback used to send a chunk.
+    SendChunkCallback send_chunk;
+  };
+
+  /// The state of all pushes to a single destination.
+  struct DestinationState {
+    explicit DestinationState(double window) : window(window) {}
+    /// The maximum number of chunks in flight to this destination.
+    double window;
+    /// The smallest chunk round trip time seen for this destination, or 0 if none.
+    int64_t min_rtt_us = 0;
+    /// The number of chunks that have been sent but not acknowledged.
+    int64_t num_chunks_in_flight = 0;
+    /// The pushes to this destination.
+    std::unordered_map<PushKey, PushState, PushKeyHash> pushes;
+    /// The pushes that still have chunks to send, in round-robin order.
+    std::deque<PushKey> send_order;
+  };
+
+  /// Adjust the window of a destination after a chunk completed.
+  void UpdateWindow(DestinationState &dest, bool success, int64_t rtt_us);
+
+  /// Send as many chunks to a destination as its window allows.
+  void SendChunks(DestinationState &dest);
+
+  /// The window of a newly seen destination.
+  const double initial_window_;
+  /// The maximum window of any destination.
+  const double max_window_;
+  /// The state of each destination. Destinations are kept after their pushes finish
+  /// so that the learned window carries over to the next push.
+  std::unordered_map<ClientID, DestinationState> destinations_;
+  /// The total number of chunks in flight.
+  int64_t num_chunks_in_flight_ = 0;
+  /// The total number of chunks not sent yet.
+  int64_t num_chunks_remaining_ = 0;
+  /// The total number of pushes in progress.
+  int64_t num_pushes_in_flight_ = 0;
+};
+
+}  // namespace ray
+
+#endif  // RAY_OBJECT_MANAGER_PUSH_MANAGER_H
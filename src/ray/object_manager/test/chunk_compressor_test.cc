@@ -0,0 +1,98 @@
+#include <random>
+
+#include "gtest/gtest.h"
+
+#include "ray/object_manager/chunk_compressor.h"
+
+namespace ray {
+
+class ChunkCompressorTest : public ::testing::TestWithParam<std::string> {
+ public:
+  ChunkCompressorTest()
+      : compressor_(GetParam(), /*min_chunk_size=*/1024, /*max_ratio_percent=*/90) {}
+
+  rpc::CompressionCodec Codec() const {
+    return compressor_.Negotiate(ChunkCompressor::SupportedCodecs());
+  }
+
+  /// Data that compresses well, like a sparse array.
+  static std::vector<uint8_t> SparseData(size_t size) {
+    std::vector<uint8_t> data(size, 0);
+    for (size_t i = 0; i < size; i += 64) {
+      data[i] = static_cast<uint8_t>(i / 64);
+    }
+    return data;
+  }
+
+  /// Data that doesn't compress.
+  static std::vector<uint8_t> RandomData(size_t size) {
+    std::mt19937 gen(0);
+    std::vector<uint8_t> data(size);
+    for (auto &byte : data) {
+      byte = static_cast<uint8_t>(gen());
+    }
+    return data;
+  }
+
+ protected:
+  ChunkCompressor compressor_;
+};
+
+TEST_P(ChunkCompressorTest, TestRoundTrip) {
+  auto data = SparseData(64 * 1024);
+  std::string compressed;
+  auto codec = compressor_.Compress(Codec(), data.data(), data.size(), &compressed);
+  ASSERT_EQ(codec, Codec());
+  ASSERT_NE(codec, rpc::COMPRESSION_NONE);
+  ASSERT_LT(compressed.size(), data.size() / 2);
+
+  std::vector<uint8_t> decompressed(data.size());
+  ASSERT_TRUE(compressor_
+                  .Decompress(codec, reinterpret_cast<const uint8_t *>(compressed.data()),
+                              compressed.size(), decompressed.data(), decompressed.size())
+                  .ok());
+  ASSERT_EQ(decompressed, data);
+}
+
+TEST_P(ChunkCompressorTest, TestSkipIncompressibleChunks) {
+  std::string compressed;
+  // Random data doesn't shrink enough.
+  auto data = RandomData(64 * 1024);
+  ASSERT_EQ(compressor_.Compress(Codec(), data.data(), data.size(), &compressed),
+            rpc::COMPRESSION_NONE);
+  // Small chunks aren't worth compressing.
+  data = SparseData(512);
+  ASSERT_EQ(compressor_.Compress(Codec(), data.data(), data.size(), &compressed),
+            rpc::COMPRESSION_NONE);
+}
+
+TEST_P(ChunkCompressorTest, TestNegotiate) {
+  // Remote object managers that didn't list the codec get uncompressed chunks.
+  ASSERT_EQ(compressor_.Negotiate({}), rpc::COMPRESSION_NONE);
+  auto data = SparseData(64 * 1024);
+  std::string compressed;
+  ASSERT_EQ(compressor_.Compress(compressor_.Negotiate({}), data.data(), data.size(),
+                                 &compressed),
+            rpc::COMPRESSION_NONE);
+}
+
+TEST_P(ChunkCompressorTest, TestCorruptChunk) {
+  auto data = SparseData(64 * 1024);
+  std::string compressed;
+  auto codec = compressor_.Compress(Codec(), data.data(), data.size(), &compressed);
+  compressed.resize(compressed.size() / 2);
+  std::vector<uint8_t> decompressed(data.size());
+  ASSERT_TRUE(compressor_
+                  .Decompress(codec, reinterpret_cast<const uint8_t *>(compressed.data()),
+                              compressed.size(), decompressed.data(), decompressed.size())
+                  .IsInvalid());
+}
+
+INSTANTIATE_TEST_CASE_P(Codecs, ChunkCompressorTest, ::testing::Values("lz4", "zstd"));
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+
+#include "ray/object_manager/chunk_size_tuner.h"
+
+namespace ray {
+
+class ChunkSizeTunerTest : public ::testing::Test {
+ public:
+  ChunkSizeTunerTest()
+      : tuner_(/*default_chunk_size=*/1 << 20, /*min_chunk_size=*/256 << 10,
+               /*max_chunk_size=*/16 << 20, /*target_chunk_time_us=*/10000,
+               /*max_chunks_per_object=*/64),
+        client_id_(ClientID::FromRandom()) {}
+
+  /// Record a chunk that was alone in flight.
+  void RecordChunk(const ClientID &client_id, uint64_t num_bytes, int64_t rtt_us) {
+    tuner_.RecordChunkSent(client_id, now_us_);
+    now_us_ += rtt_us;
+    tuner_.RecordChunkAcked(client_id, num_bytes, now_us_, /*success=*/true);
+  }
+
+ protected:
+  ChunkSizeTuner tuner_;
+  ClientID client_id_;
+  int64_t now_us_ = 0;
+};
+
+TEST_F(ChunkSizeTunerTest, TestDefaultWithoutMeasurements) {
+  ASSERT_EQ(tuner_.GetBandwidth(client_id_), 0);
+  ASSERT_EQ(tuner_.ChooseChunkSize(client_id_, 32 << 20), 1 << 20);
+  // Objects that fit into a single chunk are sent in one chunk of their size.
+  ASSERT_EQ(tuner_.ChooseChunkSize(client_id_, 1000), 1000);
+}
+
+TEST_F(ChunkSizeTunerTest, TestFollowsBandwidth) {
+  // 1000 bytes/us is 1 GB/s, so a 10ms chunk is 10 MB.
+  RecordChunk(client_id_, 1000 * 1000, 1000);
+  ASSERT_EQ(tuner_.GetBandwidth(client_id_), 1000);
+  uint64_t fast = tuner_.ChooseChunkSize(client_id_, 1ULL << 30);
+  ASSERT_GE(fast, 10 * 1000 * 1000);
+  ASSERT_LE(fast, 16 << 20);
+  ASSERT_EQ(fast % 4096, 0);
+
+  // A slow link converges to the minimum chunk size.
+  ClientID slow_client = ClientID::FromRandom();
+  RecordChunk(slow_client, 1000, 1000);
+  ASSERT_EQ(tuner_.ChooseChunkSize(slow_client, 4 << 20), 256 << 10);
+
+  // Later measurements move the average.
+  for (int i = 0; i < 50; i++) {
+    RecordChunk(client_id_, 1000, 1000);
+  }
+  ASSERT_LT(tuner_.GetBandwidth(client_id_), 2);
+}
+
+TEST_F(ChunkSizeTunerTest, TestBoundsChunksPerObject) {
+  ClientID slow_client = ClientID::FromRandom();
+  RecordChunk(slow_client, 1000, 1000);
+  // 1 GB in at most 64 chunks needs 16 MB chunks despite the slow link.
+  ASSERT_EQ(tuner_.ChooseChunkSize(slow_client, 1ULL << 30), 16 << 20);
+  // The maximum chunk size still wins over the chunk count.
+  ASSERT_EQ(tuner_.ChooseChunkSize(slow_client, 4ULL << 30), 16 << 20);
+}
+
+TEST_F(ChunkSizeTunerTest, TestPipelinedChunks) {
+  // 20 chunks of 1000 bytes are sent at once over a link of 4 bytes/us with a
+  // latency of 750us. Each chunk waits behind the ones before it, but the
+  // acknowledgements arrive at the rate of the link.
+  for (int i = 0; i < 20; i++) {
+    tuner_.RecordChunkSent(client_id_, 0);
+  }
+  for (int i = 0; i < 20; i++) {
+    tuner_.RecordChunkAcked(client_id_, 1000, 1000 + 250 * i, /*success=*/true);
+  }
+  ASSERT_GT(tuner_.GetBandwidth(client_id_), 3.9);
+  ASSERT_LE(tuner_.GetBandwidth(client_id_), 4);
+
+  // Failed chunks and idle time between sends don't count.
+  tuner_.RecordChunkSent(client_id_, 100000);
+  tuner_.RecordChunkAcked(client_id_, 1000, 100250, /*success=*/false);
+  tuner_.RecordChunkSent(client_id_, 200000);
+  tuner_.RecordChunkAcked(client_id_, 1000, 200250, /*success=*/true);
+  ASSERT_GT(tuner_.GetBandwidth(client_id_), 3.9);
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,374 @@
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <unordered_set>
+
+#include "gflags/gflags.h"
+
+#include "ray/common/ray_config.h"
+#include "ray/common/status.h"
+#include "ray/object_manager/object_manager.h"
+
+DEFINE_string(store_executable, "", "The path of the plasma store executable.");
+DEFINE_int32(redis_port, 6379, "The port of the redis server with the ray module.");
+DEFINE_int32(num_nodes, 2,
+             "The number of object managers. Objects are created on the first one "
+             "and pulled by all others.");
+DEFINE_string(object_sizes, "10000,1000000,16000000",
+              "Comma-separated list of object sizes, in bytes.");
+DEFINE_string(chunk_sizes, "65536,1000000,5000000",
+              "Comma-separated list of object chunk sizes, in bytes.");
+DEFINE_string(concurrency, "1,4,16",
+              "Comma-separated list of the numbers of pulls that each receiving node "
+              "keeps in flight.");
+DEFINE_string(rpc_threads, "1,4",
+              "Comma-separated list of the numbers of rpc service threads per object "
+              "manager.");
+DEFINE_int64(bytes_per_run, 256 * 1000 * 1000,
+             "The number of bytes each receiving node pulls per measurement.");
+DEFINE_int32(max_objects_per_run, 1000,
+             "The maximum number of objects each receiving node pulls per measurement.");
+DEFINE_int64(store_memory, 1000 * 1000 * 1000,
+             "The capacity of each plasma store, in bytes.");
+DEFINE_string(config_list, "",
+              "Comma-separated list of RayConfig names and values to benchmark the "
+              "transfers with, e.g. object_manager_compression_codec,lz4.");
+
+namespace ray {
+
+using rpc::GcsNodeInfo;
+
+int64_t current_time_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/// Return the CPU time used by all threads of this process, in seconds.
+double process_cpu_seconds() {
+  struct rusage usage;
+  RAY_CHECK(getrusage(RUSAGE_SELF, &usage) == 0);
+  auto seconds = [](const timeval &time) { return time.tv_sec + time.tv_usec / 1e6; };
+  return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+std::vector<int64_t> ParseList(const std::string &list) {
+  std::vector<int64_t> values;
+  std::istringstream stream(list);
+  std::string value;
+  while (std::getline(stream, value, ',')) {
+    values.push_back(std::stoll(value));
+  }
+  return values;
+}
+
+/// Return the given percentile of a list of values.
+int64_t Percentile(std::vector<int64_t> values, double percentile) {
+  RAY_CHECK(!values.empty());
+  size_t index = std::min(values.size() - 1,
+                          static_cast<size_t>(percentile / 100 * values.size()));
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+static inline void flushall_redis(void) {
+  redisContext *context = redisConnect("127.0.0.1", FLAGS_redis_port);
+  freeReplyObject(redisCommand(context, "FLUSHALL"));
+  redisFree(context);
+}
+
+/// The measurements of one run of the benchmark.
+struct TransferResult {
+  /// The number of objects pulled by each receiving node.
+  size_t num_objects;
+  /// The bytes received by all receiving nodes per second, in GB/s.
+  double throughput_gb_per_s;
+  /// The latency of a pull, from the request until the object is local.
+  double p50_latency_ms;
+  double p99_latency_ms;
+  /// The CPU time of the object managers per GB received, in seconds. This doesn't
+  /// include the plasma stores, which run in separate processes.
+  double cpu_seconds_per_gb;
+};
+
+/// A set of object managers in this process, each with its own plasma store, that
+/// transfer objects over loopback. Objects are created on the first node and
+/// pulled by all others.
+class BenchmarkCluster {
+ public:
+  BenchmarkCluster(int num_nodes, uint64_t chunk_size, int rpc_threads)
+      : num_nodes_(num_nodes) {
+    RAY_CHECK(num_nodes_ >= 2);
+    flushall_redis();
+    gcs::GcsClientOptions client_options("127.0.0.1", FLAGS_redis_port,
+                                         /*password*/ "", /*is_test_client=*/true);
+    for (int i = 0; i < num_nodes_; i++) {
+      store_sockets_.push_back(StartStore(UniqueID::FromRandom().Hex()));
+      auto gcs_client = std::make_shared<gcs::RedisGcsClient>(client_options);
+      RAY_CHECK_OK(gcs_client->Connect(main_service_));
+      gcs_clients_.push_back(gcs_client);
+
+      ObjectManagerConfig config;
+      config.store_socket_name = store_sockets_.back();
+      config.pull_timeout_ms = 1000;
+      config.object_chunk_size = chunk_size;
+      config.push_timeout_ms = 10000;
+      config.object_manager_port = 0;
+      config.rpc_service_threads_number = rpc_threads;
+      config.object_store_memory = FLAGS_store_memory;
+      node_ids_.push_back(ClientID::FromRandom());
+      object_managers_.emplace_back(new ObjectManager(
+          main_service_, node_ids_.back(), config,
+          std::make_shared<ObjectDirectory>(main_service_, gcs_clients_.back())));
+      RAY_CHECK_OK(RegisterNode(i));
+
+      store_clients_.emplace_back(new plasma::PlasmaClient());
+      RAY_ARROW_CHECK_OK(store_clients_.back()->Connect(store_sockets_.back()));
+      RAY_CHECK_OK(object_managers_.back()->SubscribeObjAdded(
+          [this, i](const object_manager::protocol::ObjectInfoT &object_info) {
+            HandleObjectAdded(i, ObjectID::FromBinary(object_info.object_id));
+          }));
+    }
+    WaitForNodes();
+  }
+
+  ~BenchmarkCluster() {
+    for (int i = 0; i < num_nodes_; i++) {
+      RAY_ARROW_CHECK_OK(store_clients_[i]->Disconnect());
+      RAY_CHECK_OK(gcs_clients_[i]->Nodes().UnregisterSelf());
+      gcs_clients_[i]->Disconnect();
+    }
+    object_managers_.clear();
+    for (const auto &store_socket : store_sockets_) {
+      StopStore(store_socket);
+    }
+  }
+
+  /// Pull objects of the given size from the first node to all others, keeping
+  /// `concurrency` pulls in flight on each receiving node.
+  TransferResult Run(uint64_t object_size, int concurrency) {
+    size_t num_objects = std::max<int64_t>(FLAGS_bytes_per_run / object_size, 1);
+    num_objects = std::min<size_t>(num_objects, FLAGS_max_objects_per_run);
+    num_objects = std::max<size_t>(num_objects, concurrency);
+    objects_.clear();
+    for (size_t i = 0; i < num_objects; i++) {
+      objects_.push_back(CreateObject(object_size));
+    }
+    concurrency_ = concurrency;
+    receivers_.assign(num_nodes_, ReceiverState());
+    latencies_us_.clear();
+    num_pending_ = num_objects * (num_nodes_ - 1);
+
+    main_service_.reset();
+    main_service_.post([this]() {
+      for (int i = 1; i < num_nodes_; i++) {
+        PullNext(i);
+      }
+    });
+    double start_cpu_seconds = process_cpu_seconds();
+    int64_t start_time_us = current_time_us();
+    main_service_.run();
+    int64_t elapsed_us = std::max<int64_t>(current_time_us() - start_time_us, 1);
+    double cpu_seconds = process_cpu_seconds() - start_cpu_seconds;
+
+    double total_gb =
+        static_cast<double>(object_size) * num_objects * (num_nodes_ - 1) / 1e9;
+    TransferResult result;
+    result.num_objects = num_objects;
+    result.throughput_gb_per_s = total_gb / (elapsed_us / 1e6);
+    result.p50_latency_ms = Percentile(latencies_us_, 50) / 1e3;
+    result.p99_latency_ms = Percentile(latencies_us_, 99) / 1e3;
+    result.cpu_seconds_per_gb = cpu_seconds / total_gb;
+    DeleteObjects();
+    return result;
+  }
+
+ private:
+  /// The pulls of a receiving node.
+  struct ReceiverState {
+    /// The index of the next object to pull.
+    size_t next_object = 0;
+    /// The start times of the pulls in flight.
+    std::unordered_map<ObjectID, int64_t> pull_start_times_us;
+  };
+
+  std::string StartStore(const std::string &id) {
+    std::string store_id = "/tmp/store" + id;
+    std::string store_pid = store_id + ".pid";
+    std::string plasma_command = FLAGS_store_executable + " -m " +
+                                 std::to_string(FLAGS_store_memory) + " -s " + store_id +
+                                 " 1> /dev/null 2> /dev/null &" + " echo $! > " +
+                                 store_pid;
+    RAY_LOG(DEBUG) << plasma_command;
+    int ec = system(plasma_command.c_str());
+    RAY_CHECK(ec == 0);
+    sleep(1);
+    return store_id;
+  }
+
+  void StopStore(const std::string &store_id) {
+    std::string store_pid = store_id + ".pid";
+    std::string kill_1 = "kill -9 `cat " + store_pid + "`";
+    RAY_CHECK(system(kill_1.c_str()) == 0);
+  }
+
+  ray::Status RegisterNode(int index) {
+    auto object_manager_port = object_managers_[index]->GetServerPort();
+    GcsNodeInfo node_info;
+    node_info.set_node_id(node_ids_[index].Binary());
+    node_info.set_node_manager_address("127.0.0.1");
+    node_info.set_node_manager_port(object_manager_port);
+    node_info.set_object_manager_port(object_manager_port);
+    return gcs_clients_[index]->Nodes().RegisterSelf(node_info);
+  }
+
+  /// Run the event loop until every node knows about all others.
+  void WaitForNodes() {
+    auto nodes_seen = std::make_shared<std::vector<std::unordered_set<ClientID>>>(
+        num_nodes_);
+    for (int i = 0; i < num_nodes_; i++) {
+      RAY_CHECK_OK(gcs_clients_[i]->Nodes().AsyncSubscribeToNodeChange(
+          [this, i, nodes_seen](const ClientID &node_id, const GcsNodeInfo &data) {
+            if (std::find(node_ids_.begin(), node_ids_.end(), node_id) ==
+                node_ids_.end()) {
+              return;
+            }
+            (*nodes_seen)[i].insert(node_id);
+            for (const auto &seen : *nodes_seen) {
+              if (seen.size() < node_ids_.size()) {
+                return;
+              }
+            }
+            main_service_.stop();
+          },
+          nullptr));
+    }
+    main_service_.run();
+  }
+
+  /// Create an object on the first node, filled with random data so that the
+  /// transfer can't be compressed away.
+  ObjectID CreateObject(uint64_t size) {
+    ObjectID object_id = ObjectID::FromRandom();
+    uint8_t metadata[] = {5};
+    std::shared_ptr<Buffer> data;
+    RAY_ARROW_CHECK_OK(store_clients_[0]->Create(object_id.ToPlasmaId(), size,
+                                                 metadata, sizeof(metadata), &data));
+    uint8_t *buffer = data->mutable_data();
+    for (uint64_t offset = 0; offset < size; offset += sizeof(uint64_t)) {
+      uint64_t value = random_();
+      std::memcpy(buffer + offset, &value,
+                  std::min<uint64_t>(sizeof(value), size - offset));
+    }
+    RAY_ARROW_CHECK_OK(store_clients_[0]->Seal(object_id.ToPlasmaId()));
+    RAY_ARROW_CHECK_OK(store_clients_[0]->Release(object_id.ToPlasmaId()));
+    return object_id;
+  }
+
+  void DeleteObjects() {
+    std::vector<plasma::ObjectID> plasma_ids;
+    for (const auto &object_id : objects_) {
+      plasma_ids.push_back(object_id.ToPlasmaId());
+    }
+    for (const auto &store_client : store_clients_) {
+      RAY_ARROW_CHECK_OK(store_client->Delete(plasma_ids));
+    }
+    objects_.clear();
+  }
+
+  /// Start pulls on a receiving node until `concurrency_` are in flight.
+  void PullNext(int node) {
+    auto &receiver = receivers_[node];
+    while (receiver.pull_start_times_us.size() < static_cast<size_t>(concurrency_) &&
+           receiver.next_object < objects_.size()) {
+      const ObjectID &object_id = objects_[receiver.next_object++];
+      receiver.pull_start_times_us[object_id] = current_time_us();
+      RAY_CHECK_OK(object_managers_[node]->Pull(object_id, PullPriority::GET));
+    }
+  }
+
+  void HandleObjectAdded(int node, const ObjectID &object_id) {
+    if (node == 0) {
+      return;
+    }
+    auto &receiver = receivers_[node];
+    auto it = receiver.pull_start_times_us.find(object_id);
+    if (it == receiver.pull_start_times_us.end()) {
+      return;
+    }
+    latencies_us_.push_back(current_time_us() - it->second);
+    receiver.pull_start_times_us.erase(it);
+    if (--num_pending_ == 0) {
+      main_service_.stop();
+      return;
+    }
+    PullNext(node);
+  }
+
+  const int num_nodes_;
+  boost::asio::io_service main_service_;
+  std::vector<std::string> store_sockets_;
+  std::vector<ClientID> node_ids_;
+  std::vector<std::shared_ptr<gcs::GcsClient>> gcs_clients_;
+  std::vector<std::unique_ptr<ObjectManager>> object_managers_;
+  std::vector<std::unique_ptr<plasma::PlasmaClient>> store_clients_;
+  /// Fixed seed, so that runs transfer the same data.
+  std::mt19937_64 random_{42};
+  /// The state of the current run.
+  std::vector<ObjectID> objects_;
+  int concurrency_ = 0;
+  std::vector<ReceiverState> receivers_;
+  std::vector<int64_t> latencies_us_;
+  size_t num_pending_ = 0;
+};
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  RAY_CHECK(!FLAGS_store_executable.empty()) << "--store_executable is required";
+
+  std::unordered_map<std::string, std::string> config;
+  std::istringstream config_string(FLAGS_config_list);
+  std::string config_name;
+  std::string config_value;
+  while (std::getline(config_string, config_name, ',')) {
+    RAY_CHECK(std::getline(config_string, config_value, ','));
+    config[config_name] = config_value;
+  }
+  RayConfig::instance().initialize(config);
+
+  std::cout << std::left << std::setw(12) << "rpc_threads" << std::setw(12)
+            << "chunk_size" << std::setw(12) << "object_size" << std::setw(13)
+            << "concurrency" << std::setw(10) << "objects" << std::setw(10) << "GB/s"
+            << std::setw(12) << "p50_ms" << std::setw(12) << "p99_ms"
+            << "cpu_s_per_GB" << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  for (int64_t rpc_threads : ray::ParseList(FLAGS_rpc_threads)) {
+    for (int64_t chunk_size : ray::ParseList(FLAGS_chunk_sizes)) {
+      // Start new object managers for each configuration, since the chunk size and
+      // the number of rpc threads are fixed when they are created.
+      ray::BenchmarkCluster cluster(FLAGS_num_nodes, chunk_size, rpc_threads);
+      for (int64_t object_size : ray::ParseList(FLAGS_object_sizes)) {
+        for (int64_t concurrency : ray::ParseList(FLAGS_concurrency)) {
+          auto result = cluster.Run(object_size, concurrency);
+          std::cout << std::setw(12) << rpc_threads << std::setw(12) << chunk_size
+                    << std::setw(12) << object_size << std::setw(13) << concurrency
+                    << std::setw(10) << result.num_objects << std::setw(10)
+                    << result.throughput_gb_per_s << std::setw(12)
+                    << result.p50_latency_ms << std::setw(12) << result.p99_latency_ms
+                    << result.cpu_seconds_per_gb << std::endl;
+        }
+      }
+    }
+  }
+  gflags::ShutDownCommandLineFlags();
+  return 0;
+}
@@ -0,0 +1,434 @@
+#include <unistd.h>
+
+#include <cstring>
+#include <functional>
+#include <unordered_set>
+
+#include "gtest/gtest.h"
+
+#include "ray/common/ray_config.h"
+#include "ray/common/status.h"
+#include "ray/object_manager/object_manager.h"
+
+namespace {
+std::string store_executable;
+}  // namespace
+
+namespace ray {
+
+using rpc::GcsNodeInfo;
+
+static inline void flushall_redis(void) {
+  redisContext *context = redisConnect("127.0.0.1", 6379);
+  freeReplyObject(redisCommand(context, "FLUSHALL"));
+  redisFree(context);
+}
+
+/// Tests of object transfers between several object managers in this process, each
+/// with its own plasma store.
+class TestObjectManagerTransfer : public ::testing::Test {
+ public:
+  TestObjectManagerTransfer()
+      : max_pull_sources_(RayConfig::instance().object_manager_max_pull_sources()),
+        broadcast_fanout_(RayConfig::instance().object_manager_broadcast_fanout()) {}
+
+  void TearDown() {
+    RayConfig::instance().initialize(
+        {{"object_manager_max_pull_sources", std::to_string(max_pull_sources_)},
+         {"object_manager_broadcast_fanout", std::to_string(broadcast_fanout_)}});
+    for (size_t i = 0; i < object_managers_.size(); i++) {
+      RAY_ARROW_CHECK_OK(store_clients_[i]->Disconnect());
+      RAY_CHECK_OK(gcs_clients_[i]->Nodes().UnregisterSelf());
+      gcs_clients_[i]->Disconnect();
+    }
+    object_managers_.clear();
+    for (const auto &store_socket : store_sockets_) {
+      StopStore(store_socket);
+    }
+  }
+
+ protected:
+  /// Start the object managers, and run the event loop until they all know about
+  /// each other.
+  void StartNodes(int num_nodes) {
+    flushall_redis();
+    gcs::GcsClientOptions client_options("127.0.0.1", 6379, /*password*/ "",
+                                         /*is_test_client=*/true);
+    for (int i = 0; i < num_nodes; i++) {
+      store_sockets_.push_back(StartStore(UniqueID::FromRandom().Hex()));
+      std::shared_ptr<gcs::GcsClient> gcs_client =
+          std::make_shared<gcs::RedisGcsClient>(client_options);
+      RAY_CHECK_OK(gcs_client->Connect(main_service_));
+      gcs_clients_.push_back(gcs_client);
+
+      ObjectManagerConfig config;
+      config.store_socket_name = store_sockets_.back();
+      config.pull_timeout_ms = 100;
+      config.object_chunk_size = kChunkSize;
+      config.push_timeout_ms = 1000;
+      config.object_manager_port = 0;
+      config.rpc_service_threads_number = 2;
+      node_ids_.push_back(ClientID::FromRandom());
+      object_managers_.emplace_back(new ObjectManager(
+          main_service_, node_ids_.back(), config,
+          std::make_shared<ObjectDirectory>(main_service_, gcs_client)));
+      RAY_CHECK_OK(RegisterNode(i));
+
+      store_clients_.emplace_back(new plasma::PlasmaClient());
+      RAY_ARROW_CHECK_OK(store_clients_.back()->Connect(store_sockets_.back()));
+      added_objects_.emplace_back();
+      RAY_CHECK_OK(object_managers_.back()->SubscribeObjAdded(
+          [this, i](const object_manager::protocol::ObjectInfoT &object_info) {
+            added_objects_[i].insert(ObjectID::FromBinary(object_info.object_id));
+          }));
+    }
+    auto nodes_seen = std::make_shared<std::vector<std::unordered_set<ClientID>>>(
+        num_nodes);
+    for (int i = 0; i < num_nodes; i++) {
+      RAY_CHECK_OK(gcs_clients_[i]->Nodes().AsyncSubscribeToNodeChange(
+          [this, i, nodes_seen](const ClientID &node_id, const GcsNodeInfo &data) {
+            if (std::find(node_ids_.begin(), node_ids_.end(), node_id) !=
+                node_ids_.end()) {
+              (*nodes_seen)[i].insert(node_id);
+            }
+          },
+          nullptr));
+    }
+    ASSERT_TRUE(RunUntil([this, nodes_seen]() {
+      for (const auto &seen : *nodes_seen) {
+        if (seen.size() < node_ids_.size()) {
+          return false;
+        }
+      }
+      return true;
+    }));
+  }
+
+  /// Run the event loop until the condition holds or the timeout expires.
+  ///
+  /// \return Whether the condition holds.
+  bool RunUntil(const std::function<bool()> &condition, int64_t timeout_ms = 10000) {
+    boost::asio::deadline_timer timer(main_service_);
+    int64_t remaining_ms = timeout_ms;
+    std::function<void()> check = [&]() {
+      if (condition() || remaining_ms <= 0) {
+        main_service_.stop();
+        return;
+      }
+      remaining_ms -= 10;
+      timer.expires_from_now(boost::posix_time::milliseconds(10));
+      timer.async_wait([&](const boost::system::error_code &error) { check(); });
+    };
+    main_service_.reset();
+    main_service_.post(check);
+    main_service_.run();
+    return condition();
+  }
+
+  /// Create an object on a node. The data is derived from the object ID, so the same
+  /// object created on several nodes has the same data.
+  void CreateObject(int node, const ObjectID &object_id, uint64_t size) {
+    uint8_t metadata[] = {5};
+    std::shared_ptr<Buffer> data;
+    RAY_ARROW_CHECK_OK(store_clients_[node]->Create(object_id.ToPlasmaId(), size,
+                                                    metadata, sizeof(metadata), &data));
+    auto expected = ExpectedData(object_id, size);
+    std::memcpy(data->mutable_data(), expected.data(), size);
+    RAY_ARROW_CHECK_OK(store_clients_[node]->Seal(object_id.ToPlasmaId()));
+    RAY_ARROW_CHECK_OK(store_clients_[node]->Release(object_id.ToPlasmaId()));
+  }
+
+  /// Return the data of an object created by CreateObject.
+  std::vector<uint8_t> ExpectedData(const ObjectID &object_id, uint64_t size) {
+    std::vector<uint8_t> data(size);
+    for (uint64_t i = 0; i < size; i++) {
+      data[i] = static_cast<uint8_t>(object_id.Hash() + i * 131);
+    }
+    return data;
+  }
+
+  /// Whether a node has an object with the data created by CreateObject.
+  bool HasExpectedData(int node, const ObjectID &object_id, uint64_t size) {
+    std::vector<plasma::ObjectBuffer> results;
+    RAY_ARROW_CHECK_OK(
+        store_clients_[node]->Get({object_id.ToPlasmaId()}, /*timeout_ms=*/0, &results));
+    if (results.size() != 1 || results[0].data == nullptr) {
+      return false;
+    }
+    auto expected = ExpectedData(object_id, size);
+    bool matches = static_cast<uint64_t>(results[0].data->size()) == size &&
+                   std::memcmp(results[0].data->data(), expected.data(), size) == 0;
+    RAY_ARROW_CHECK_OK(store_clients_[node]->Release(object_id.ToPlasmaId()));
+    return matches;
+  }
+
+  /// Run the event loop until the object directory lists an object on the given
+  /// number of nodes.
+  bool WaitForLocations(const ObjectID &object_id, size_t num_locations) {
+    auto num_found = std::make_shared<size_t>(0);
+    return RunUntil([this, object_id, num_locations, num_found]() {
+      RAY_CHECK_OK(object_managers_[0]->object_directory_->LookupLocations(
+          object_id, [num_found](const ObjectID &object_id,
+                                 const std::unordered_set<ClientID> &node_ids) {
+            *num_found = node_ids.size();
+          }));
+      return *num_found >= num_locations;
+    });
+  }
+
+  /// Push a stripe of an object from one node to another, as the sender does when the
+  /// receiver requests it.
+  void PushStripe(int from, int to, const ObjectID &object_id, uint32_t stripe_index,
+                  uint32_t num_stripes, uint64_t requested_chunk_size = 0) {
+    object_managers_[from]->Push(object_id, node_ids_[to], stripe_index, num_stripes,
+                                 requested_chunk_size);
+  }
+
+  /// Whether a node pushed a stripe of an object to another node.
+  bool PushedStripe(int from, int to, const ObjectID &object_id, uint32_t stripe_index,
+                    uint32_t num_stripes) {
+    const auto &local_objects = object_managers_[from]->local_objects_;
+    auto it = local_objects.find(object_id);
+    if (it == local_objects.end()) {
+      return false;
+    }
+    auto pushes_it = it->second.recent_pushes.find(node_ids_[to]);
+    return pushes_it != it->second.recent_pushes.end() &&
+           pushes_it->second.count(std::make_pair(stripe_index, num_stripes)) > 0;
+  }
+
+  /// Receive the first chunk of an object on a node, as if its sender failed after
+  /// that chunk.
+  void ReceiveFirstChunk(int node, const ObjectID &object_id, uint64_t size,
+                         uint64_t chunk_size) {
+    const uint64_t metadata_size = 1;
+    auto &buffer_pool = object_managers_[node]->buffer_pool_;
+    auto chunk = buffer_pool.CreateChunk(object_id, size + metadata_size, metadata_size,
+                                         0, chunk_size);
+    ASSERT_TRUE(chunk.second.ok());
+    ASSERT_EQ(chunk.first.buffer_length, chunk_size);
+    auto expected = ExpectedData(object_id, size);
+    std::memcpy(chunk.first.data, expected.data(), chunk.first.buffer_length);
+    buffer_pool.SealChunk(object_id, 0);
+  }
+
+  /// Whether a node is relaying an object to other nodes.
+  bool IsRelaying(int node, const ObjectID &object_id) {
+    auto &object_manager = *object_managers_[node];
+    std::lock_guard<std::mutex> lock(object_manager.relay_mutex_);
+    return object_manager.relays_.count(object_id) > 0 ||
+           object_manager.relayed_objects_.count(object_id) > 0;
+  }
+
+  /// The clients that a node is relaying an object to.
+  size_t NumRelayClients(int node, const ObjectID &object_id) {
+    const auto &relays = object_managers_[node]->relays_;
+    auto it = relays.find(object_id);
+    return it == relays.end() ? 0 : it->second.size();
+  }
+
+  /// Whether a node holds no buffers of objects being sent or received.
+  bool BufferPoolIsEmpty(int node) {
+    const std::string debug_string = object_managers_[node]->buffer_pool_.DebugString();
+    return debug_string.find("get buffer state map size: 0") != std::string::npos &&
+           debug_string.find("create buffer state map size: 0") != std::string::npos;
+  }
+
+  /// The number of pushes a node is sending.
+  int64_t NumPushesInFlight(int node) {
+    return object_managers_[node]->push_manager_.NumPushesInFlight();
+  }
+
+  ObjectManager &GetObjectManager(int node) { return *object_managers_[node]; }
+
+  /// The chunk size that the object managers split objects into by default.
+  static constexpr uint64_t kChunkSize = 1000;
+
+  boost::asio::io_service main_service_;
+  std::vector<ClientID> node_ids_;
+  std::vector<std::unordered_set<ObjectID>> added_objects_;
+
+ private:
+  std::string StartStore(const std::string &id) {
+    std::string store_id = "/tmp/store" + id;
+    std::string store_pid = store_id + ".pid";
+    std::string plasma_command = store_executable + " -m 100000000 -s " + store_id +
+                                 " 1> /dev/null 2> /dev/null &" + " echo $! > " +
+                                 store_pid;
+    RAY_LOG(DEBUG) << plasma_command;
+    int ec = system(plasma_command.c_str());
+    RAY_CHECK(ec == 0);
+    sleep(1);
+    return store_id;
+  }
+
+  void StopStore(const std::string &store_id) {
+    std::string store_pid = store_id + ".pid";
+    std::string kill_1 = "kill -9 `cat " + store_pid + "`";
+    ASSERT_TRUE(!system(kill_1.c_str()));
+  }
+
+  ray::Status RegisterNode(int index) {
+    auto object_manager_port = object_managers_[index]->GetServerPort();
+    GcsNodeInfo node_info;
+    node_info.set_node_id(node_ids_[index].Binary());
+    node_info.set_node_manager_address("127.0.0.1");
+    node_info.set_node_manager_port(object_manager_port);
+    node_info.set_object_manager_port(object_manager_port);
+    return gcs_clients_[index]->Nodes().RegisterSelf(node_info);
+  }
+
+  const uint32_t max_pull_sources_;
+  const uint32_t broadcast_fanout_;
+  std::vector<std::string> store_sockets_;
+  std::vector<std::shared_ptr<gcs::GcsClient>> gcs_clients_;
+  std::vector<std::unique_ptr<ObjectManager>> object_managers_;
+  std::vector<std::unique_ptr<plasma::PlasmaClient>> store_clients_;
+};
+
+constexpr uint64_t TestObjectManagerTransfer::kChunkSize;
+
+TEST_F(TestObjectManagerTransfer, TestPullResumesInChunkSizeOfEarlierSender) {
+  StartNodes(3);
+  const uint64_t object_size = 10 * kChunkSize;
+  const ObjectID object_id = ObjectID::FromRandom();
+  CreateObject(0, object_id, object_size);
+  CreateObject(1, object_id, object_size);
+
+  // Node 2 received the first chunk of the object from a sender that used twice the
+  // default chunk size, and then failed.
+  ReceiveFirstChunk(2, object_id, object_size, 2 * kChunkSize);
+
+  // The pull asks another node for the rest in the same chunk size.
+  RAY_CHECK_OK(GetObjectManager(2).Pull(object_id, PullPriority::GET));
+  ASSERT_TRUE(
+      RunUntil([this, object_id]() { return added_objects_[2].count(object_id) > 0; }));
+  ASSERT_TRUE(HasExpectedData(2, object_id, object_size));
+}
+
+TEST_F(TestObjectManagerTransfer, TestStripedPull) {
+  RayConfig::instance().initialize({{"object_manager_max_pull_sources", "2"}});
+  StartNodes(3);
+  const uint64_t object_size = 10 * kChunkSize + 1;
+  const ObjectID object_id = ObjectID::FromRandom();
+  CreateObject(0, object_id, object_size);
+  CreateObject(1, object_id, object_size);
+  ASSERT_TRUE(WaitForLocations(object_id, 2));
+
+  // Node 2 pulls one stripe of the chunks from each of the other nodes.
+  RAY_CHECK_OK(GetObjectManager(2).Pull(object_id, PullPriority::GET));
+  ASSERT_TRUE(
+      RunUntil([this, object_id]() { return added_objects_[2].count(object_id) > 0; }));
+  ASSERT_TRUE(HasExpectedData(2, object_id, object_size));
+  ASSERT_TRUE(PushedStripe(0, 2, object_id, 0, 2) || PushedStripe(1, 2, object_id, 0, 2));
+  ASSERT_TRUE(PushedStripe(0, 2, object_id, 1, 2) || PushedStripe(1, 2, object_id, 1, 2));
+}
+
+TEST_F(TestObjectManagerTransfer, TestStripeRetriedFromAnotherSender) {
+  StartNodes(2);
+  const uint64_t object_size = 10 * kChunkSize + 1;
+  const ObjectID object_id = ObjectID::FromRandom();
+  CreateObject(0, object_id, object_size);
+  ASSERT_TRUE(
+      RunUntil([this, object_id]() { return added_objects_[0].count(object_id) > 0; }));
+
+  // Node 1 pulled stripe 0 of the object from node 0, and stripe 1 from a node that
+  // failed. It retries stripe 1 from node 0, which already pushed stripe 0 to it.
+  PushStripe(0, 1, object_id, 0, 2);
+  PushStripe(0, 1, object_id, 1, 2);
+  ASSERT_TRUE(
+      RunUntil([this, object_id]() { return added_objects_[1].count(object_id) > 0; }));
+  ASSERT_TRUE(HasExpectedData(1, object_id, object_size));
+
+  // A stripe that was pushed recently is not pushed again.
+  ASSERT_TRUE(RunUntil([this]() { return NumPushesInFlight(0) == 0; }));
+  PushStripe(0, 1, object_id, 1, 2);
+  ASSERT_EQ(NumPushesInFlight(0), 0);
+}
+
+TEST_F(TestObjectManagerTransfer, TestPushRequestsReplayedWhenObjectAdded) {
+  StartNodes(2);
+  const uint64_t object_size = 10 * kChunkSize + 1;
+  const ObjectID object_id = ObjectID::FromRandom();
+
+  // Node 1 received the first chunk of the object in twice the default chunk size. It
+  // asks node 0 for both stripes of the object in that size before node 0 has it.
+  ReceiveFirstChunk(1, object_id, object_size, 2 * kChunkSize);
+  PushStripe(0, 1, object_id, 0, 2, /*requested_chunk_size=*/2 * kChunkSize);
+  PushStripe(0, 1, object_id, 1, 2, /*requested_chunk_size=*/2 * kChunkSize);
+  ASSERT_EQ(NumPushesInFlight(0), 0);
+
+  // Both requests are replayed as they were made once node 0 has the object.
+  CreateObject(0, object_id, object_size);
+  ASSERT_TRUE(
+      RunUntil([this, object_id]() { return added_objects_[1].count(object_id) > 0; }));
+  ASSERT_TRUE(HasExpectedData(1, object_id, object_size));
+  ASSERT_TRUE(PushedStripe(0, 1, object_id, 0, 2));
+  ASSERT_TRUE(PushedStripe(0, 1, object_id, 1, 2));
+}
+
+TEST_F(TestObjectManagerTransfer, TestRelayFanOut) {
+  RayConfig::instance().initialize({{"object_manager_broadcast_fanout", "1"}});
+  StartNodes(4);
+  const uint64_t object_size = 20 * kChunkSize + 1;
+  const ObjectID object_id = ObjectID::FromRandom();
+  CreateObject(0, object_id, object_size);
+
+  // Node 1 is receiving the object when nodes 2 and 3 ask it for the object, e.g.
+  // because node 0 forwarded their requests. It relays the chunks it has.
+  ReceiveFirstChunk(1, object_id, object_size, kChunkSize);
+  PushStripe(1, 2, object_id, 0, 1);
+  PushStripe(1, 3, object_id, 0, 1);
+  ASSERT_EQ(NumRelayClients(1, object_id), 2);
+
+  // The rest of the chunks are relayed as node 1 receives them.
+  RAY_CHECK_OK(GetObjectManager(1).Pull(object_id, PullPriority::GET));
+  ASSERT_TRUE(RunUntil([this, object_id]() {
+    return added_objects_[1].count(object_id) > 0 &&
+           added_objects_[2].count(object_id) > 0 &&
+           added_objects_[3].count(object_id) > 0;
+  }));
+  for (int node = 1; node < 4; node++) {
+    ASSERT_TRUE(HasExpectedData(node, object_id, object_size));
+  }
+
+  // Once the relays finish, node 1 releases the chunks it read for them.
+  ASSERT_TRUE(RunUntil([this, object_id]() {
+    return !IsRelaying(1, object_id) && NumPushesInFlight(1) == 0 &&
+           BufferPoolIsEmpty(1);
+  }));
+}
+
+TEST_F(TestObjectManagerTransfer, TestRelayFailsMidBroadcast) {
+  RayConfig::instance().initialize({{"object_manager_broadcast_fanout", "1"}});
+  StartNodes(3);
+  const uint64_t object_size = 20 * kChunkSize + 1;
+  const ObjectID object_id = ObjectID::FromRandom();
+  CreateObject(0, object_id, object_size);
+
+  // Node 1 starts relaying the object to node 2, but never receives more than the
+  // first chunk, as if its own sender failed.
+  ReceiveFirstChunk(1, object_id, object_size, kChunkSize);
+  PushStripe(1, 2, object_id, 0, 1);
+  ASSERT_TRUE(IsRelaying(1, object_id));
+
+  // Node 2 gets the object from node 0 instead.
+  RAY_CHECK_OK(GetObjectManager(2).Pull(object_id, PullPriority::GET));
+  ASSERT_TRUE(
+      RunUntil([this, object_id]() { return added_objects_[2].count(object_id) > 0; }));
+  ASSERT_TRUE(HasExpectedData(2, object_id, object_size));
+
+  // Node 1 gives up the relay after the push timeout, and fails its parked chunks.
+  ASSERT_TRUE(RunUntil([this, object_id]() {
+    return !IsRelaying(1, object_id) && NumPushesInFlight(1) == 0;
+  }));
+  ASSERT_EQ(added_objects_[1].count(object_id), 0);
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  store_executable = std::string(argv[1]);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+
+#include "ray/object_manager/pull_queue.h"
+
+namespace ray {
+
+class PullQueueTest : public ::testing::Test {
+ public:
+  PullQueueTest()
+      : queue_(/*max_active_pulls=*/0, /*initial_size_estimate=*/100) {}
+
+ protected:
+  PullQueue queue_;
+};
+
+TEST_F(PullQueueTest, TestAdmitInPriorityOrder) {
+  ObjectID prefetch = ObjectID::FromRandom();
+  ObjectID wait = ObjectID::FromRandom();
+  ObjectID get = ObjectID::FromRandom();
+  ObjectID argument = ObjectID::FromRandom();
+  ASSERT_TRUE(queue_.Add(prefetch, PullPriority::PREFETCH));
+  ASSERT_TRUE(queue_.Add(wait, PullPriority::WAIT));
+  ASSERT_TRUE(queue_.Add(get, PullPriority::GET));
+  ASSERT_TRUE(queue_.Add(argument, PullPriority::TASK_ARGUMENT));
+  ASSERT_EQ(queue_.NumQueued(PullPriority::PREFETCH), 1);
+
+  // Memory isn't a limit, so everything is admitted, highest priority first.
+  auto admitted = queue_.AdmitPulls(-1);
+  ASSERT_EQ(admitted, std::vector<ObjectID>({argument, get, wait, prefetch}));
+  ASSERT_EQ(queue_.NumActive(), 4);
+  ASSERT_EQ(queue_.NumQueued(PullPriority::PREFETCH), 0);
+  ASSERT_TRUE(queue_.AdmitPulls(-1).empty());
+}
+
+TEST_F(PullQueueTest, TestRaisePriority) {
+  ObjectID first = ObjectID::FromRandom();
+  ObjectID second = ObjectID::FromRandom();
+  ASSERT_TRUE(queue_.Add(first, PullPriority::GET));
+  ASSERT_TRUE(queue_.Add(second, PullPriority::PREFETCH));
+  // A prefetched object that a task now needs overtakes other requests.
+  ASSERT_FALSE(queue_.Add(second, PullPriority::TASK_ARGUMENT));
+  // Lowering the priority has no effect.
+  ASSERT_FALSE(queue_.Add(first, PullPriority::PREFETCH));
+  ASSERT_EQ(queue_.NumQueued(PullPriority::TASK_ARGUMENT), 1);
+  ASSERT_EQ(queue_.NumQueued(PullPriority::GET), 1);
+  ASSERT_EQ(queue_.NumQueued(PullPriority::PREFETCH), 0);
+  ASSERT_EQ(queue_.AdmitPulls(-1), std::vector<ObjectID>({second, first}));
+}
+
+TEST_F(PullQueueTest, TestMemoryBound) {
+  std::vector<ObjectID> object_ids;
+  for (int i = 0; i < 5; i++) {
+    object_ids.push_back(ObjectID::FromRandom());
+    queue_.Add(object_ids.back(), PullPriority::GET);
+  }
+  // Unsized pulls count as 100 bytes each.
+  ASSERT_EQ(queue_.AdmitPulls(250).size(), 3);
+  ASSERT_EQ(queue_.ActiveBytes(), 300);
+  ASSERT_TRUE(queue_.AdmitPulls(250).empty());
+
+  // Once sizes are known, they replace the estimate.
+  queue_.SetObjectSize(object_ids[0], 50);
+  queue_.SetObjectSize(object_ids[1], 50);
+  ASSERT_EQ(queue_.GetUnsizedActivePulls(), std::vector<ObjectID>({object_ids[2]}));
+  ASSERT_EQ(queue_.ActiveBytes(), 200);
+  ASSERT_EQ(queue_.AdmitPulls(250), std::vector<ObjectID>({object_ids[3]}));
+
+  // Completing pulls frees up memory for the rest.
+  queue_.Complete(object_ids[0], 50);
+  queue_.Complete(object_ids[1], 50);
+  ASSERT_FALSE(queue_.IsActive(object_ids[0]));
+  ASSERT_EQ(queue_.AdmitPulls(250), std::vector<ObjectID>({object_ids[4]}));
+}
+
+TEST_F(PullQueueTest, TestAdmitOneLargePull) {
+  ObjectID object_id = ObjectID::FromRandom();
+  queue_.Add(object_id, PullPriority::GET);
+  // An object larger than the free memory is still pulled on its own.
+  ASSERT_EQ(queue_.AdmitPulls(0), std::vector<ObjectID>({object_id}));
+  queue_.Add(ObjectID::FromRandom(), PullPriority::TASK_ARGUMENT);
+  ASSERT_TRUE(queue_.AdmitPulls(0).empty());
+  // Canceling the active pull lets the next one in.
+  ASSERT_TRUE(queue_.Remove(object_id));
+  ASSERT_EQ(queue_.AdmitPulls(0).size(), 1);
+}
+
+TEST(PullQueueLimitTest, TestMaxActivePulls) {
+  PullQueue queue(/*max_active_pulls=*/2, /*initial_size_estimate=*/100);
+  for (int i = 0; i < 3; i++) {
+    queue.Add(ObjectID::FromRandom(), PullPriority::PREFETCH);
+  }
+  ASSERT_EQ(queue.AdmitPulls(-1).size(), 2);
+  ASSERT_EQ(queue.NumQueued(PullPriority::PREFETCH), 1);
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
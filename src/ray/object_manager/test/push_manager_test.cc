@@ -0,0 +1,139 @@
+#include "gtest/gtest.h"
+
+#include "ray/object_manager/push_manager.h"
+
+namespace ray {
+
+class PushManagerTest : public ::testing::Test {
+ public:
+  PushManagerTest() : push_manager_(/*initial_window=*/2, /*max_window=*/4) {}
+
+  PushManager::SendChunkCallback Record(const ObjectID &object_id) {
+    return [this, object_id](int64_t chunk_index) {
+      sent_.emplace_back(object_id, chunk_index);
+    };
+  }
+
+ protected:
+  PushManager push_manager_;
+  std::vector<std::pair<ObjectID, int64_t>> sent_;
+};
+
+TEST_F(PushManagerTest, TestWindowLimitsChunksInFlight) {
+  ClientID client_id = ClientID::FromRandom();
+  ObjectID object_id = ObjectID::FromRandom();
+  ASSERT_TRUE(push_manager_.StartPush(client_id, object_id, 5, Record(object_id)));
+  // Only a window's worth of chunks is sent up front.
+  ASSERT_EQ(sent_.size(), 2);
+  ASSERT_EQ(push_manager_.NumChunksInFlight(), 2);
+  ASSERT_EQ(push_manager_.NumChunksRemaining(), 3);
+  // A duplicate push is ignored.
+  ASSERT_FALSE(push_manager_.StartPush(client_id, object_id, 5, Record(object_id)));
+
+  // Each acknowledgement lets the next chunk go out.
+  int64_t num_acked = 0;
+  bool push_done = false;
+  while (!push_done) {
+    push_done = push_manager_.OnChunkComplete(client_id, object_id, true, 100);
+    num_acked++;
+  }
+  ASSERT_EQ(num_acked, 5);
+  ASSERT_EQ(sent_.size(), 5);
+  for (int64_t i = 0; i < 5; i++) {
+    ASSERT_EQ(sent_[i].second, i);
+  }
+  ASSERT_EQ(push_manager_.NumChunksInFlight(), 0);
+  ASSERT_EQ(push_manager_.NumPushesInFlight(), 0);
+}
+
+TEST_F(PushManagerTest, TestRoundRobinBetweenPushes) {
+  ClientID client_id = ClientID::FromRandom();
+  ObjectID large_object = ObjectID::FromRandom();
+  ObjectID small_object = ObjectID::FromRandom();
+  ASSERT_TRUE(
+      push_manager_.StartPush(client_id, large_object, 100, Record(large_object)));
+  ASSERT_TRUE(push_manager_.StartPush(client_id, small_object, 1, Record(small_object)));
+  // The window is full with chunks of the large object.
+  ASSERT_EQ(sent_.size(), 2);
+  ASSERT_EQ(sent_.back().first, large_object);
+  // The small push takes its turn instead of waiting for the rest of the large one.
+  ASSERT_FALSE(push_manager_.OnChunkComplete(client_id, large_object, true, 100));
+  ASSERT_FALSE(push_manager_.OnChunkComplete(client_id, large_object, true, 100));
+  ASSERT_EQ(sent_.size(), 4);
+  ASSERT_EQ(sent_.back().first, small_object);
+  ASSERT_TRUE(push_manager_.OnChunkComplete(client_id, small_object, true, 100));
+  ASSERT_EQ(push_manager_.NumPushesInFlight(), 1);
+}
+
+TEST_F(PushManagerTest, TestWindowAdaptsToRoundTripTime) {
+  ClientID client_id = ClientID::FromRandom();
+  ObjectID object_id = ObjectID::FromRandom();
+  ASSERT_TRUE(push_manager_.StartPush(client_id, object_id, 1000, Record(object_id)));
+  // Steady round trip times grow the window up to the maximum.
+  for (int i = 0; i < 20; i++) {
+    push_manager_.OnChunkComplete(client_id, object_id, true, 100);
+  }
+  ASSERT_EQ(push_manager_.GetWindow(client_id), 4);
+  ASSERT_EQ(push_manager_.NumChunksInFlight(), 4);
+  // Growing round trip times mean that chunks queue up, so the window shrinks.
+  for (int i = 0; i < 20; i++) {
+    push_manager_.OnChunkComplete(client_id, object_id, true, 1000);
+  }
+  ASSERT_LT(push_manager_.GetWindow(client_id), 4);
+  // A failure halves the window.
+  double window = push_manager_.GetWindow(client_id);
+  push_manager_.OnChunkComplete(client_id, object_id, false, 1000);
+  ASSERT_EQ(push_manager_.GetWindow(client_id), std::max(1.0, window / 2));
+}
+
+TEST_F(PushManagerTest, TestCancelPush) {
+  ClientID client_id = ClientID::FromRandom();
+  ObjectID object_id = ObjectID::FromRandom();
+  ASSERT_TRUE(push_manager_.StartPush(client_id, object_id, 10, Record(object_id)));
+  ASSERT_FALSE(push_manager_.CancelPush(client_id, object_id));
+  ASSERT_EQ(push_manager_.NumChunksRemaining(), 0);
+  // No more chunks are sent, and the push finishes with the chunks in flight.
+  ASSERT_FALSE(push_manager_.OnChunkComplete(client_id, object_id, true, 100));
+  ASSERT_EQ(sent_.size(), 2);
+  ASSERT_TRUE(push_manager_.OnChunkComplete(client_id, object_id, true, 100));
+  ASSERT_EQ(push_manager_.NumPushesInFlight(), 0);
+  // The object can be pushed again afterwards.
+  ASSERT_TRUE(push_manager_.StartPush(client_id, object_id, 10, Record(object_id)));
+}
+
+TEST_F(PushManagerTest, TestIndependentWindowsPerClient) {
+  ClientID client_1 = ClientID::FromRandom();
+  ClientID client_2 = ClientID::FromRandom();
+  ObjectID object_id = ObjectID::FromRandom();
+  ASSERT_TRUE(push_manager_.StartPush(client_1, object_id, 10, Record(object_id)));
+  ASSERT_TRUE(push_manager_.StartPush(client_2, object_id, 10, Record(object_id)));
+  ASSERT_EQ(push_manager_.NumChunksInFlight(), 4);
+  ASSERT_EQ(push_manager_.NumPushesInFlight(), 2);
+}
+
+TEST_F(PushManagerTest, TestStripesArePushedIndependently) {
+  ClientID client_id = ClientID::FromRandom();
+  ObjectID object_id = ObjectID::FromRandom();
+  ASSERT_TRUE(push_manager_.StartPush(client_id, object_id, 0, 2, 1, Record(object_id)));
+  // Another stripe of the object, e.g. one retried after its sender failed, is pushed
+  // alongside the first.
+  ASSERT_TRUE(push_manager_.StartPush(client_id, object_id, 1, 2, 1, Record(object_id)));
+  ASSERT_FALSE(push_manager_.StartPush(client_id, object_id, 1, 2, 1, Record(object_id)));
+  // So is a stripe of a different striping of the object.
+  ASSERT_TRUE(push_manager_.StartPush(client_id, object_id, 0, 3, 1, Record(object_id)));
+  ASSERT_EQ(push_manager_.NumPushesInFlight(), 3);
+  ASSERT_EQ(push_manager_.NumChunksInFlight(), 2);
+
+  ASSERT_TRUE(push_manager_.OnChunkComplete(client_id, object_id, 1, 2, true, 100));
+  ASSERT_TRUE(push_manager_.OnChunkComplete(client_id, object_id, 0, 2, true, 100));
+  ASSERT_TRUE(push_manager_.OnChunkComplete(client_id, object_id, 0, 3, true, 100));
+  ASSERT_EQ(push_manager_.NumPushesInFlight(), 0);
+  ASSERT_EQ(sent_.size(), 3u);
+}
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
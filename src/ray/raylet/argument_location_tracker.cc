@@ -0,0 +1,92 @@
+#include "ray/raylet/argument_location_tracker.h"
+
+#include "ray/util/logging.h"
+
+namespace ray {
+
+namespace raylet {
+
+bool ArgumentLocationTracker::HoldTask(const Task &task,
+                                       const std::unordered_set<ObjectID> &object_ids,
+                                       std::vector<ObjectID> *new_object_ids) {
+  RAY_CHECK(!object_ids.empty());
+  const TaskID task_id = task.GetTaskSpecification().TaskId();
+  if (!held_tasks_.emplace(task_id, std::make_pair(task, object_ids)).second) {
+    return false;
+  }
+  for (const auto &object_id : object_ids) {
+    auto inserted = subscriptions_.emplace(object_id, std::unordered_set<TaskID>());
+    if (inserted.second) {
+      new_object_ids->push_back(object_id);
+    }
+    inserted.first->second.insert(task_id);
+  }
+  return true;
+}
+
+std::vector<Task> ArgumentLocationTracker::HandleLocationsKnown(
+    const ObjectID &object_id) {
+  std::vector<Task> released_tasks;
+  auto it = subscriptions_.find(object_id);
+  if (it == subscriptions_.end()) {
+    return released_tasks;
+  }
+  // Later updates of the locations are not waited for.
+  std::unordered_set<TaskID> task_ids = std::move(it->second);
+  it->second.clear();
+  for (const auto &task_id : task_ids) {
+    auto task_it = held_tasks_.find(task_id);
+    RAY_CHECK(task_it != held_tasks_.end());
+    auto &pending_object_ids = task_it->second.second;
+    RAY_CHECK(pending_object_ids.erase(object_id) == 1);
+    if (pending_object_ids.empty()) {
+      released_tasks.push_back(std::move(task_it->second.first));
+      held_tasks_.erase(task_it);
+    }
+  }
+  return released_tasks;
+}
+
+std::vector<Task> ArgumentLocationTracker::RemoveTasksForJob(const JobID &job_id) {
+  std::vector<TaskID> task_ids;
+  for (const auto &held_task : held_tasks_) {
+    if (held_task.second.first.GetTaskSpecification().JobId() == job_id) {
+      task_ids.push_back(held_task.first);
+    }
+  }
+  std::vector<Task> removed_tasks;
+  for (const auto &task_id : task_ids) {
+    removed_tasks.push_back(RemoveTask(task_id));
+  }
+  return removed_tasks;
+}
+
+std::vector<ObjectID> ArgumentLocationTracker::PopUnusedSubscriptions() {
+  std::vector<ObjectID> object_ids;
+  for (auto it = subscriptions_.begin(); it != subscriptions_.end();) {
+    if (it->second.empty()) {
+      object_ids.push_back(it->first);
+      it = subscriptions_.erase(it);
+    } else {
+      it++;
+    }
+  }
+  return object_ids;
+}
+
+Task ArgumentLocationTracker::RemoveTask(const TaskID &task_id) {
+  auto task_it = held_tasks_.find(task_id);
+  RAY_CHECK(task_it != held_tasks_.end());
+  for (const auto &object_id : task_it->second.second) {
+    auto it = subscriptions_.find(object_id);
+    RAY_CHECK(it != subscriptions_.end());
+    it->second.erase(task_id);
+  }
+  Task task = std::move(task_it->second.first);
+  held_tasks_.erase(task_it);
+  return task;
+}
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -0,0 +1,82 @@
+#ifndef RAY_RAYLET_ARGUMENT_LOCATION_TRACKER_H
+#define RAY_RAYLET_ARGUMENT_LOCATION_TRACKER_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ray/common/id.h"
+#include "ray/common/task/task.h"
+
+namespace ray {
+
+namespace raylet {
+
+/// \class ArgumentLocationTracker
+///
+/// Holds the tasks that are placed by the locality of their arguments until the
+/// locations of their arguments are known, and tracks the arguments whose locations
+/// are subscribed to for that. The subscriptions are kept once no held task waits
+/// for them, since the locations are needed to place the released tasks, until they
+/// are popped by `PopUnusedSubscriptions`.
+class ArgumentLocationTracker {
+ public:
+  /// Hold a task until the locations of the given arguments are known. A task that
+  /// is already held is left as it is.
+  ///
+  /// \param task The task to hold.
+  /// \param object_ids The arguments whose locations the task waits for. Must not be
+  /// empty.
+  /// \param[out] new_object_ids The arguments that weren't subscribed to yet, which
+  /// the caller must subscribe to.
+  /// \return Whether the task was held. False if it was already held.
+  bool HoldTask(const Task &task, const std::unordered_set<ObjectID> &object_ids,
+                std::vector<ObjectID> *new_object_ids);
+
+  /// Handle a notification of the locations of an argument.
+  ///
+  /// \param object_id The ID of the argument.
+  /// \return The held tasks that no longer wait for any locations. They are no
+  /// longer held.
+  std::vector<Task> HandleLocationsKnown(const ObjectID &object_id);
+
+  /// Stop holding the tasks of a job.
+  ///
+  /// \param job_id The ID of the job.
+  /// \return The tasks that were held.
+  std::vector<Task> RemoveTasksForJob(const JobID &job_id);
+
+  /// Return whether a task is held.
+  bool HasTask(const TaskID &task_id) const { return held_tasks_.count(task_id) > 0; }
+
+  /// Remove the subscriptions that no held task waits for.
+  ///
+  /// \return The arguments that the caller must unsubscribe from.
+  std::vector<ObjectID> PopUnusedSubscriptions();
+
+  /// Return the number of held tasks.
+  size_t NumHeldTasks() const { return held_tasks_.size(); }
+
+  /// Return the number of arguments whose locations are subscribed to.
+  size_t NumSubscriptions() const { return subscriptions_.size(); }
+
+ private:
+  /// Stop holding a task, and remove it from the subscriptions it waits for.
+  ///
+  /// \param task_id The ID of the task.
+  /// \return The task.
+  Task RemoveTask(const TaskID &task_id);
+
+  /// The held tasks, along with the arguments that each still waits for.
+  std::unordered_map<TaskID, std::pair<Task, std::unordered_set<ObjectID>>>
+      held_tasks_;
+  /// The arguments whose locations are subscribed to, mapped to the held tasks that
+  /// wait for their first notification.
+  std::unordered_map<ObjectID, std::unordered_set<TaskID>> subscriptions_;
+};
+
+}  // namespace raylet
+
+}  // namespace ray
+
+#endif  // RAY_RAYLET_ARGUMENT_LOCATION_TRACKER_H
@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+
+#include "ray/common/task/task_util.h"
+#include "ray/raylet/argument_location_tracker.h"
+
+namespace ray {
+
+namespace raylet {
+
+static inline Task ExampleTask(const JobID &job_id) {
+  TaskSpecBuilder builder;
+  rpc::Address address;
+  builder.SetCommonTaskSpec(TaskID::ForFakeTask(), Language::PYTHON, {"", "", ""},
+                            job_id, TaskID::ForFakeTask(), 0, TaskID::ForFakeTask(),
+                            address, 0, false, {}, {});
+  rpc::TaskExecutionSpec execution_spec_message;
+  return Task(builder.Build(), TaskExecutionSpecification(execution_spec_message));
+}
+
+static inline std::vector<TaskID> GetTaskIds(const std::vector<Task> &tasks) {
+  std::vector<TaskID> task_ids;
+  for (const auto &task : tasks) {
+    task_ids.push_back(task.GetTaskSpecification().TaskId());
+  }
+  return task_ids;
+}
+
+TEST(ArgumentLocationTrackerTest, TestHoldTaskUntilLocationsKnown) {
+  ArgumentLocationTracker tracker;
+  const ObjectID object_id1 = ObjectID::FromRandom();
+  const ObjectID object_id2 = ObjectID::FromRandom();
+  const Task task1 = ExampleTask(JobID::FromInt(1));
+  const Task task2 = ExampleTask(JobID::FromInt(1));
+  const TaskID task_id1 = task1.GetTaskSpecification().TaskId();
+  const TaskID task_id2 = task2.GetTaskSpecification().TaskId();
+
+  std::vector<ObjectID> new_object_ids;
+  ASSERT_TRUE(tracker.HoldTask(task1, {object_id1, object_id2}, &new_object_ids));
+  ASSERT_EQ(new_object_ids.size(), 2);
+  new_object_ids.clear();
+  ASSERT_TRUE(tracker.HoldTask(task2, {object_id1}, &new_object_ids));
+  ASSERT_TRUE(new_object_ids.empty());
+  ASSERT_TRUE(tracker.HasTask(task_id1));
+  ASSERT_EQ(tracker.NumHeldTasks(), 2);
+  ASSERT_EQ(tracker.NumSubscriptions(), 2);
+
+  // Task 1 waits for both arguments.
+  ASSERT_EQ(GetTaskIds(tracker.HandleLocationsKnown(object_id1)),
+            std::vector<TaskID>{task_id2});
+  ASSERT_TRUE(tracker.HandleLocationsKnown(object_id1).empty());
+  ASSERT_EQ(GetTaskIds(tracker.HandleLocationsKnown(object_id2)),
+            std::vector<TaskID>{task_id1});
+  ASSERT_FALSE(tracker.HasTask(task_id1));
+
+  // The subscriptions are kept until they are popped.
+  ASSERT_EQ(tracker.NumSubscriptions(), 2);
+  ASSERT_EQ(tracker.PopUnusedSubscriptions().size(), 2);
+  ASSERT_EQ(tracker.NumSubscriptions(), 0);
+}
+
+TEST(ArgumentLocationTrackerTest, TestDuplicateHoldIsIgnored) {
+  ArgumentLocationTracker tracker;
+  const ObjectID object_id1 = ObjectID::FromRandom();
+  const ObjectID object_id2 = ObjectID::FromRandom();
+  const Task task = ExampleTask(JobID::FromInt(1));
+  const TaskID task_id = task.GetTaskSpecification().TaskId();
+
+  std::vector<ObjectID> new_object_ids;
+  ASSERT_TRUE(tracker.HoldTask(task, {object_id1, object_id2}, &new_object_ids));
+  // The task is submitted again while it's held, waiting for one more argument.
+  new_object_ids.clear();
+  ASSERT_FALSE(tracker.HoldTask(task, {object_id1, ObjectID::FromRandom()},
+                                &new_object_ids));
+  ASSERT_TRUE(new_object_ids.empty());
+  ASSERT_EQ(tracker.NumHeldTasks(), 1);
+  ASSERT_EQ(tracker.NumSubscriptions(), 2);
+
+  // The task is released once, after both of its original arguments.
+  ASSERT_TRUE(tracker.HandleLocationsKnown(object_id1).empty());
+  ASSERT_TRUE(tracker.HasTask(task_id));
+  ASSERT_EQ(GetTaskIds(tracker.HandleLocationsKnown(object_id2)),
+            std::vector<TaskID>{task_id});
+  ASSERT_TRUE(tracker.HandleLocationsKnown(object_id1).empty());
+  ASSERT_TRUE(tracker.HandleLocationsKnown(object_id2).empty());
+  ASSERT_EQ(tracker.NumHeldTasks(), 0);
+}
+
+TEST(ArgumentLocationTrackerTest, TestRemoveTasksForJob) {
+  ArgumentLocationTracker tracker;
+  const ObjectID object_id1 = ObjectID::FromRandom();
+  const ObjectID object_id2 = ObjectID::FromRandom();
+  const Task task1 = ExampleTask(JobID::FromInt(1));
+  const Task task2 = ExampleTask(JobID::FromInt(2));
+  const TaskID task_id1 = task1.GetTaskSpecification().TaskId();
+  const TaskID task_id2 = task2.GetTaskSpecification().TaskId();
+
+  std::vector<ObjectID> new_object_ids;
+  ASSERT_TRUE(tracker.HoldTask(task1, {object_id1, object_id2}, &new_object_ids));
+  ASSERT_TRUE(tracker.HoldTask(task2, {object_id1}, &new_object_ids));
+  ASSERT_EQ(GetTaskIds(tracker.RemoveTasksForJob(JobID::FromInt(1))),
+            std::vector<TaskID>{task_id1});
+  ASSERT_FALSE(tracker.HasTask(task_id1));
+
+  // The argument that only the removed task waited for is no longer used.
+  ASSERT_EQ(tracker.PopUnusedSubscriptions(), std::vector<ObjectID>{object_id2});
+  ASSERT_EQ(GetTaskIds(tracker.HandleLocationsKnown(object_id1)),
+            std::vector<TaskID>{task_id2});
+
+  // A removed task can be held again.
+  new_object_ids.clear();
+  ASSERT_TRUE(tracker.HoldTask(task1, {object_id1, object_id2}, &new_object_ids));
+  ASSERT_EQ(new_object_ids, std::vector<ObjectID>{object_id2});
+  ASSERT_TRUE(tracker.HandleLocationsKnown(object_id1).empty());
+  ASSERT_EQ(GetTaskIds(tracker.HandleLocationsKnown(object_id2)),
+            std::vector<TaskID>{task_id1});
+}
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,6 @@
 #include <list>
 #include <memory>
+#include <thread>
 
 #include <boost/asio.hpp>
 #include <boost/asio/error.hpp>
@@ -158,6 +159,131 @@ TEST_F(ClientConnectionTest, CallbackWithSharedRefDoesNotLeakConnection) {
   io_service_.run();
 }
 
+TEST_F(ClientConnectionTest, HandleMessagesOnSeparateEventLoop) {
+  const uint8_t arr[5] = {1, 2, 3, 4, 5};
+  int num_messages = 0;
+  int num_writes = 0;
+  const std::thread::id main_thread_id = std::this_thread::get_id();
+
+  // Read and write the sockets on another thread, and handle the messages and
+  // the write completions on this one.
+  boost::asio::io_service client_service;
+  local_stream_protocol::socket in(client_service);
+  local_stream_protocol::socket out(client_service);
+  boost::asio::local::connect_pair(in, out);
+  std::unique_ptr<boost::asio::io_service::work> client_work(
+      new boost::asio::io_service::work(client_service));
+  std::thread client_thread([&client_service]() { client_service.run(); });
+  boost::asio::io_service::work main_work(io_service_);
+
+  ClientHandler<local_stream_protocol> client_handler =
+      [](LocalClientConnection &client) {};
+  MessageHandler<local_stream_protocol> noop_handler =
+      [](std::shared_ptr<LocalClientConnection> client, int64_t message_type,
+         const uint8_t *message) {};
+  auto stop_if_done = [this, &num_messages, &num_writes]() {
+    if (num_messages == 2 && num_writes == 2) {
+      io_service_.stop();
+    }
+  };
+  MessageHandler<local_stream_protocol> message_handler =
+      [&](std::shared_ptr<LocalClientConnection> client, int64_t message_type,
+          const uint8_t *message) {
+        ASSERT_EQ(std::this_thread::get_id(), main_thread_id);
+        ASSERT_TRUE(!std::memcmp(arr, message, 5));
+        num_messages += 1;
+        if (num_messages < 2) {
+          client->ProcessMessages();
+        }
+        stop_if_done();
+      };
+  std::function<void(const ray::Status &)> callback = [&](const ray::Status &status) {
+    RAY_CHECK_OK(status);
+    ASSERT_EQ(std::this_thread::get_id(), main_thread_id);
+    num_writes += 1;
+    stop_if_done();
+  };
+
+  auto writer =
+      LocalClientConnection::Create(client_handler, noop_handler, std::move(in), "writer",
+                                    {}, error_message_type_, &io_service_);
+  auto reader =
+      LocalClientConnection::Create(client_handler, message_handler, std::move(out),
+                                    "reader", {}, error_message_type_, &io_service_);
+  writer->WriteMessageAsync(0, 5, arr, callback);
+  writer->WriteMessageAsync(0, 5, arr, callback);
+  reader->ProcessMessages();
+  io_service_.run();
+  ASSERT_EQ(num_messages, 2);
+  ASSERT_EQ(num_writes, 2);
+
+  client_work.reset();
+  client_service.stop();
+  client_thread.join();
+}
+
+TEST_F(ClientConnectionTest, WriteAndCloseOnSeparateEventLoop) {
+  const uint8_t arr1[5] = {1, 2, 3, 4, 5};
+  const uint8_t arr2[5] = {6, 7, 8, 9, 10};
+  const uint8_t arr3[5] = {11, 12, 13, 14, 15};
+  const std::vector<const uint8_t *> expected = {arr1, arr2, arr3};
+  int num_messages = 0;
+  int num_disconnects = 0;
+
+  boost::asio::io_service client_service;
+  local_stream_protocol::socket in(client_service);
+  local_stream_protocol::socket out(client_service);
+  boost::asio::local::connect_pair(in, out);
+  std::unique_ptr<boost::asio::io_service::work> client_work(
+      new boost::asio::io_service::work(client_service));
+  std::thread client_thread([&client_service]() { client_service.run(); });
+  boost::asio::io_service::work main_work(io_service_);
+
+  ClientHandler<local_stream_protocol> client_handler =
+      [](LocalClientConnection &client) {};
+  MessageHandler<local_stream_protocol> noop_handler =
+      [](std::shared_ptr<LocalClientConnection> client, int64_t message_type,
+         const uint8_t *message) {};
+  // Sync and async writes from the handler thread arrive whole and in order, and
+  // closing the connection while a read is pending disconnects the client.
+  MessageHandler<local_stream_protocol> message_handler =
+      [&](std::shared_ptr<LocalClientConnection> client, int64_t message_type,
+          const uint8_t *message) {
+        if (message_type == error_message_type_) {
+          num_disconnects += 1;
+          io_service_.stop();
+          return;
+        }
+        ASSERT_TRUE(!std::memcmp(expected[num_messages], message, 5));
+        num_messages += 1;
+        client->ProcessMessages();
+        if (num_messages == 3) {
+          client->Close();
+        }
+      };
+  std::function<void(const ray::Status &)> callback = [](const ray::Status &status) {
+    RAY_CHECK_OK(status);
+  };
+
+  auto writer =
+      LocalClientConnection::Create(client_handler, noop_handler, std::move(in), "writer",
+                                    {}, error_message_type_, &io_service_);
+  auto reader =
+      LocalClientConnection::Create(client_handler, message_handler, std::move(out),
+                                    "reader", {}, error_message_type_, &io_service_);
+  reader->ProcessMessages();
+  writer->WriteMessageAsync(0, 5, arr1, callback);
+  RAY_CHECK_OK(writer->WriteMessage(0, 5, arr2));
+  writer->WriteMessageAsync(0, 5, arr3, callback);
+  io_service_.run();
+  ASSERT_EQ(num_messages, 3);
+  ASSERT_EQ(num_disconnects, 1);
+
+  client_work.reset();
+  client_service.stop();
+  client_thread.join();
+}
+
 TEST_F(ClientConnectionTest, ProcessBadMessage) {
   const uint8_t arr[5] = {1, 2, 3, 4, 5};
   int num_messages = 0;
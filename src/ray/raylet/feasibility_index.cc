@@ -0,0 +1,212 @@
+#include "ray/raylet/feasibility_index.h"
+
+#include <algorithm>
+
+#include "ray/util/logging.h"
+
+namespace {
+
+/// The maximum weight of a node, so that the sum of the weights can't overflow.
+constexpr int64_t kMaxNodeWeight = 1 << 20;
+
+/// The minimum number of slots of the weight trees.
+constexpr size_t kMinNumSlots = 16;
+
+}  // namespace
+
+namespace ray {
+
+namespace raylet {
+
+void FeasibilityIndex::WeightTree::Resize(size_t num_slots) {
+  weights_.resize(num_slots, 0);
+  // Rebuild the tree in O(num_slots).
+  tree_.assign(num_slots + 1, 0);
+  total_ = 0;
+  for (size_t i = 1; i <= num_slots; i++) {
+    tree_[i] += weights_[i - 1];
+    total_ += weights_[i - 1];
+    size_t parent = i + (i & (~i + 1));
+    if (parent <= num_slots) {
+      tree_[parent] += tree_[i];
+    }
+  }
+}
+
+void FeasibilityIndex::WeightTree::Set(size_t slot, int64_t weight) {
+  RAY_CHECK(slot < weights_.size());
+  int64_t delta = weight - weights_[slot];
+  if (delta == 0) {
+    return;
+  }
+  weights_[slot] = weight;
+  total_ += delta;
+  for (size_t i = slot + 1; i < tree_.size(); i += i & (~i + 1)) {
+    tree_[i] += delta;
+  }
+}
+
+int64_t FeasibilityIndex::WeightTree::Sample(std::mt19937_64 &gen) const {
+  if (total_ == 0) {
+    return -1;
+  }
+  std::uniform_int_distribution<int64_t> distribution(0, total_ - 1);
+  int64_t remaining = distribution(gen);
+  // Find the first slot whose prefix sum exceeds the sampled value.
+  size_t position = 0;
+  size_t step = 1;
+  while (step * 2 < tree_.size()) {
+    step *= 2;
+  }
+  for (; step > 0; step /= 2) {
+    if (position + step < tree_.size() && tree_[position + step] <= remaining) {
+      position += step;
+      remaining -= tree_[position];
+    }
+  }
+  return position;
+}
+
+FeasibilityIndex::FeasibilityIndex(size_t max_shapes)
+    : max_shapes_(std::max<size_t>(max_shapes, 1)) {}
+
+void FeasibilityIndex::UpdateNode(const ClientID &node_id,
+                                  const SchedulingResources &resources) {
+  auto it = nodes_.find(node_id);
+  if (it == nodes_.end()) {
+    if (free_slots_.empty()) {
+      // Double the number of slots.
+      size_t num_slots = slot_nodes_.size();
+      size_t new_num_slots = std::max(kMinNumSlots, num_slots * 2);
+      slot_nodes_.resize(new_num_slots, ClientID::Nil());
+      for (size_t slot = new_num_slots; slot > num_slots; slot--) {
+        free_slots_.push_back(slot - 1);
+      }
+      for (auto &shape_pair : shapes_) {
+        shape_pair.second.available.Resize(new_num_slots);
+        shape_pair.second.feasible.Resize(new_num_slots);
+      }
+    }
+    Node node;
+    node.slot = free_slots_.back();
+    node.dirty = false;
+    free_slots_.pop_back();
+    slot_nodes_[node.slot] = node_id;
+    it = nodes_.emplace(node_id, std::move(node)).first;
+  }
+  Node &node = it->second;
+  node.free_resources = resources.GetAvailableResources();
+  // We have to subtract the current "load" because we set the current "load"
+  // to be the resources used by tasks that are in the
+  // `SchedulingQueue::ready_queue_` in NodeManager::HandleWorkerAvailable's
+  // call to SchedulingQueue::GetResourceLoad.
+  node.free_resources.SubtractResources(resources.GetLoadResources());
+  node.total_resources = resources.GetTotalResources();
+  if (!node.dirty) {
+    node.dirty = true;
+    dirty_nodes_.push_back(node_id);
+  }
+}
+
+void FeasibilityIndex::AddLoad(const ClientID &node_id, const ResourceSet &load) {
+  auto it = nodes_.find(node_id);
+  if (it == nodes_.end()) {
+    return;
+  }
+  Node &node = it->second;
+  node.free_resources.SubtractResources(load);
+  if (!node.dirty) {
+    node.dirty = true;
+    dirty_nodes_.push_back(node_id);
+  }
+}
+
+void FeasibilityIndex::RemoveNode(const ClientID &node_id) {
+  auto it = nodes_.find(node_id);
+  if (it == nodes_.end()) {
+    return;
+  }
+  const size_t slot = it->second.slot;
+  for (auto &shape_pair : shapes_) {
+    shape_pair.second.available.Set(slot, 0);
+    shape_pair.second.feasible.Set(slot, 0);
+  }
+  slot_nodes_[slot] = ClientID::Nil();
+  free_slots_.push_back(slot);
+  nodes_.erase(it);
+}
+
+ClientID FeasibilityIndex::PickAvailableNode(const ResourceSet &demand,
+                                             std::mt19937_64 &gen) {
+  FlushDirtyNodes();
+  int64_t slot = GetShape(demand).available.Sample(gen);
+  return slot < 0 ? ClientID::Nil() : slot_nodes_[slot];
+}
+
+ClientID FeasibilityIndex::PickFeasibleNode(const ResourceSet &demand,
+                                            std::mt19937_64 &gen) {
+  FlushDirtyNodes();
+  int64_t slot = GetShape(demand).feasible.Sample(gen);
+  return slot < 0 ? ClientID::Nil() : slot_nodes_[slot];
+}
+
+bool FeasibilityIndex::IsAvailable(const ClientID &node_id,
+                                   const ResourceSet &demand) const {
+  auto it = nodes_.find(node_id);
+  return it != nodes_.end() && demand.IsSubset(it->second.free_resources);
+}
+
+FeasibilityIndex::Shape &FeasibilityIndex::GetShape(const ResourceSet &demand) {
+  num_picks_++;
+  auto it = shapes_.find(demand);
+  if (it != shapes_.end()) {
+    it->second.last_pick = num_picks_;
+    return it->second;
+  }
+  if (shapes_.size() >= max_shapes_) {
+    // Drop the least recently picked shape.
+    auto oldest = std::min_element(
+        shapes_.begin(), shapes_.end(),
+        [](const std::pair<const ResourceSet, Shape> &lhs,
+           const std::pair<const ResourceSet, Shape> &rhs) {
+          return lhs.second.last_pick < rhs.second.last_pick;
+        });
+    RAY_LOG(DEBUG) << "Dropping resource shape " << oldest->first.ToString()
+                   << " from the feasibility index";
+    shapes_.erase(oldest);
+  }
+  Shape &shape = shapes_[demand];
+  shape.last_pick = num_picks_;
+  shape.available.Resize(slot_nodes_.size());
+  shape.feasible.Resize(slot_nodes_.size());
+  for (const auto &node_pair : nodes_) {
+    UpdateWeights(demand, node_pair.second, &shape);
+  }
+  return shape;
+}
+
+void FeasibilityIndex::UpdateWeights(const ResourceSet &demand, const Node &node,
+                                     Shape *shape) const {
+  shape->available.Set(node.slot, std::min(demand.NumCopiesIn(node.free_resources),
+                                           kMaxNodeWeight));
+  shape->feasible.Set(node.slot, demand.IsSubset(node.total_resources) ? 1 : 0);
+}
+
+void FeasibilityIndex::FlushDirtyNodes() {
+  for (const auto &node_id : dirty_nodes_) {
+    auto it = nodes_.find(node_id);
+    if (it == nodes_.end()) {
+      // The node was removed.
+      continue;
+    }
+    it->second.dirty = false;
+    for (auto &shape_pair : shapes_) {
+      UpdateWeights(shape_pair.first, it->second, &shape_pair.second);
+    }
+  }
+  dirty_nodes_.clear();
+}
+
+}  // namespace raylet
+
+}  // namespace ray
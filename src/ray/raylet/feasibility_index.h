@@ -0,0 +1,157 @@
+#ifndef RAY_RAYLET_FEASIBILITY_INDEX_H
+#define RAY_RAYLET_FEASIBILITY_INDEX_H
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "ray/common/id.h"
+#include "ray/common/task/scheduling_resources.h"
+
+namespace ray {
+
+namespace raylet {
+
+/// \class FeasibilityIndex
+///
+/// Indexes the nodes of the cluster by the resource shapes, i.e., the placement
+/// resource demands, of the tasks being scheduled, so that a node that fits a task
+/// can be picked without scanning the cluster. For each shape that was picked for
+/// recently, the index keeps the weight of every node in a Fenwick tree, which is
+/// the number of copies of the shape that fit in the node's free resources, i.e.,
+/// its available resources minus its load. Updates of a node are applied to all
+/// shapes lazily, before the next pick, so that several heartbeats of a node between
+/// two picks cost a single update.
+class FeasibilityIndex {
+ public:
+  /// Create a feasibility index.
+  ///
+  /// \param max_shapes The maximum number of shapes to index. When a new shape
+  /// exceeds it, the least recently picked shape is dropped.
+  explicit FeasibilityIndex(size_t max_shapes);
+
+  /// Add a node or update its resources.
+  ///
+  /// \param node_id The ID of the node.
+  /// \param resources The resources of the node.
+  void UpdateNode(const ClientID &node_id, const SchedulingResources &resources);
+
+  /// Add to the load of a node, e.g., after placing a task on it, without waiting
+  /// for the node's resources to be updated.
+  ///
+  /// \param node_id The ID of the node.
+  /// \param load The resources to add to the load.
+  void AddLoad(const ClientID &node_id, const ResourceSet &load);
+
+  /// Remove a node.
+  ///
+  /// \param node_id The ID of the node.
+  void RemoveNode(const ClientID &node_id);
+
+  /// Pick a node whose free resources fit a resource demand, at random weighted by
+  /// how many copies of the demand fit.
+  ///
+  /// \param demand The resource demand.
+  /// \param gen The random number generator.
+  /// \return The ID of the node, or nil if no node fits the demand.
+  ClientID PickAvailableNode(const ResourceSet &demand, std::mt19937_64 &gen);
+
+  /// Pick a node whose total resources fit a resource demand, uniformly at random.
+  ///
+  /// \param demand The resource demand.
+  /// \param gen The random number generator.
+  /// \return The ID of the node, or nil if no node fits the demand.
+  ClientID PickFeasibleNode(const ResourceSet &demand, std::mt19937_64 &gen);
+
+  /// Return whether the free resources of a node fit a resource demand.
+  ///
+  /// \param node_id The ID of the node.
+  /// \param demand The resource demand.
+  /// \return Whether the node is indexed and fits the demand.
+  bool IsAvailable(const ClientID &node_id, const ResourceSet &demand) const;
+
+  /// Return the number of indexed nodes.
+  size_t NumNodes() const { return nodes_.size(); }
+
+  /// Return whether a node is indexed.
+  bool HasNode(const ClientID &node_id) const { return nodes_.count(node_id) > 0; }
+
+  /// Return the number of indexed shapes.
+  size_t NumShapes() const { return shapes_.size(); }
+
+ private:
+  /// A Fenwick tree of node weights, indexed by node slot, that samples slots with
+  /// probability proportional to their weight in O(log(num_slots)).
+  class WeightTree {
+   public:
+    /// Resize the tree to a number of slots. New slots have a weight of 0.
+    void Resize(size_t num_slots);
+
+    /// Set the weight of a slot.
+    void Set(size_t slot, int64_t weight);
+
+    /// Sample a slot with a positive weight, or return -1 if all weights are 0.
+    int64_t Sample(std::mt19937_64 &gen) const;
+
+   private:
+    /// The weight of each slot.
+    std::vector<int64_t> weights_;
+    /// The Fenwick tree over the weights, 1-indexed.
+    std::vector<int64_t> tree_;
+    /// The sum of the weights.
+    int64_t total_ = 0;
+  };
+
+  /// The indexed state of a node.
+  struct Node {
+    /// The slot of the node in the weight trees.
+    size_t slot;
+    /// The available resources of the node minus its load.
+    ResourceSet free_resources;
+    /// The total resources of the node.
+    ResourceSet total_resources;
+    /// Whether the node was updated since the weights were last computed.
+    bool dirty;
+  };
+
+  /// The indexed state of a resource shape.
+  struct Shape {
+    /// The weight of each node by how many copies of the shape fit in its free
+    /// resources.
+    WeightTree available;
+    /// The weight of each node by whether the shape fits in its total resources.
+    WeightTree feasible;
+    /// The pick count at the last pick for the shape.
+    uint64_t last_pick;
+  };
+
+  /// Return the shape of a resource demand, indexing it if it's new.
+  Shape &GetShape(const ResourceSet &demand);
+
+  /// Compute the weights of a node for a shape.
+  void UpdateWeights(const ResourceSet &demand, const Node &node, Shape *shape) const;
+
+  /// Recompute the weights of the nodes that were updated since the last pick.
+  void FlushDirtyNodes();
+
+  /// The maximum number of shapes to index.
+  const size_t max_shapes_;
+  /// The indexed nodes.
+  std::unordered_map<ClientID, Node> nodes_;
+  /// The node in each slot, or nil if the slot is free.
+  std::vector<ClientID> slot_nodes_;
+  /// The free slots.
+  std::vector<size_t> free_slots_;
+  /// The nodes that were updated since the last pick.
+  std::vector<ClientID> dirty_nodes_;
+  /// The indexed shapes.
+  std::unordered_map<ResourceSet, Shape> shapes_;
+  /// The number of picks so far.
+  uint64_t num_picks_ = 0;
+};
+
+}  // namespace raylet
+
+}  // namespace ray
+
+#endif  // RAY_RAYLET_FEASIBILITY_INDEX_H
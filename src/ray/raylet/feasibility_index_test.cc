@@ -0,0 +1,179 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <unordered_map>
+
+#include "ray/raylet/feasibility_index.h"
+
+namespace ray {
+
+namespace raylet {
+
+using ResourceMap = std::unordered_map<std::string, double>;
+
+class FeasibilityIndexTest : public ::testing::Test {
+ public:
+  FeasibilityIndexTest() : index_(/*max_shapes=*/2), gen_(0) {}
+
+  /// Pick nodes many times and count how often each node is picked.
+  std::unordered_map<ClientID, int> CountPicks(const ResourceSet &demand,
+                                               bool available, int num_picks) {
+    std::unordered_map<ClientID, int> counts;
+    for (int i = 0; i < num_picks; i++) {
+      ClientID node_id = available ? index_.PickAvailableNode(demand, gen_)
+                                   : index_.PickFeasibleNode(demand, gen_);
+      counts[node_id]++;
+    }
+    return counts;
+  }
+
+  /// Place tasks that require one CPU each until every CPU of the cluster is used,
+  /// updating the load of each picked node as the scheduling policy does.
+  void FillCluster(int num_nodes, int num_cpus, bool log_timing) {
+    FeasibilityIndex index(/*max_shapes=*/64);
+    std::unordered_map<ClientID, SchedulingResources> cluster_resources;
+    for (int i = 0; i < num_nodes; i++) {
+      const ClientID node_id = ClientID::FromRandom();
+      cluster_resources[node_id] = SchedulingResources(
+          ResourceSet(ResourceMap{{"CPU", static_cast<double>(num_cpus)},
+                                  {"memory", 100},
+                                  {"node:10.0." + std::to_string(i), 1}}));
+      index.UpdateNode(node_id, cluster_resources[node_id]);
+    }
+    const ResourceSet demand(ResourceMap{{"CPU", 1}});
+    const int num_tasks = num_nodes * num_cpus;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_tasks; i++) {
+      const ClientID node_id = index.PickAvailableNode(demand, gen_);
+      ASSERT_FALSE(node_id.IsNil());
+      SchedulingResources &resources = cluster_resources[node_id];
+      ResourceSet new_load(resources.GetLoadResources());
+      new_load.AddResources(demand);
+      resources.SetLoadResources(std::move(new_load));
+      index.UpdateNode(node_id, resources);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_TRUE(index.PickAvailableNode(demand, gen_).IsNil());
+    for (const auto &node_resources : cluster_resources) {
+      ASSERT_EQ(node_resources.second.GetLoadResources().GetResource("CPU").ToDouble(),
+                num_cpus);
+    }
+    if (log_timing) {
+      RAY_LOG(INFO) << "Placed " << num_tasks << " tasks on " << num_nodes
+                    << " nodes in "
+                    << std::chrono::duration<double, std::milli>(elapsed).count()
+                    << " ms";
+    }
+  }
+
+ protected:
+  FeasibilityIndex index_;
+  std::mt19937_64 gen_;
+};
+
+TEST_F(FeasibilityIndexTest, TestPickWeightedByFreeResources) {
+  const ClientID node1 = ClientID::FromRandom();
+  const ClientID node2 = ClientID::FromRandom();
+  const ClientID node3 = ClientID::FromRandom();
+  index_.UpdateNode(node1, SchedulingResources(ResourceSet(ResourceMap{{"CPU", 1}})));
+  index_.UpdateNode(node2, SchedulingResources(ResourceSet(ResourceMap{{"CPU", 3}})));
+  index_.UpdateNode(node3, SchedulingResources(ResourceSet(ResourceMap{{"GPU", 1}})));
+
+  // Nodes are picked in proportion to how many copies of the demand fit.
+  const ResourceSet demand(ResourceMap{{"CPU", 1}});
+  auto counts = CountPicks(demand, /*available=*/true, 4000);
+  ASSERT_EQ(counts.size(), 2);
+  ASSERT_GT(counts[node2], 2 * counts[node1]);
+  ASSERT_GT(counts[node1], 500);
+
+  // The load of a node is subtracted from its available resources.
+  SchedulingResources loaded(ResourceSet(ResourceMap{{"CPU", 3}}));
+  loaded.SetLoadResources(ResourceSet(ResourceMap{{"CPU", 3}}));
+  index_.UpdateNode(node2, loaded);
+  counts = CountPicks(demand, /*available=*/true, 100);
+  ASSERT_EQ(counts.size(), 1);
+  ASSERT_EQ(counts[node1], 100);
+
+  // Nodes whose total resources fit the demand are picked uniformly.
+  counts = CountPicks(demand, /*available=*/false, 4000);
+  ASSERT_EQ(counts.size(), 2);
+  ASSERT_GT(counts[node1], 1500);
+  ASSERT_GT(counts[node2], 1500);
+
+  // No node fits the demand.
+  const ResourceSet large_demand(ResourceMap{{"CPU", 4}});
+  ASSERT_TRUE(index_.PickAvailableNode(large_demand, gen_).IsNil());
+  ASSERT_TRUE(index_.PickFeasibleNode(large_demand, gen_).IsNil());
+}
+
+TEST_F(FeasibilityIndexTest, TestAddAndRemoveNodes) {
+  const ResourceSet demand(ResourceMap{{"CPU", 1}});
+  std::vector<ClientID> node_ids;
+  for (int i = 0; i < 100; i++) {
+    node_ids.push_back(ClientID::FromRandom());
+    index_.UpdateNode(node_ids.back(),
+                      SchedulingResources(ResourceSet(ResourceMap{{"CPU", 1}})));
+  }
+  ASSERT_EQ(index_.NumNodes(), 100);
+  ASSERT_EQ(CountPicks(demand, /*available=*/true, 10000).size(), 100);
+
+  // Removed nodes are never picked, and their slots are reused.
+  for (int i = 0; i < 99; i++) {
+    index_.RemoveNode(node_ids[i]);
+  }
+  auto counts = CountPicks(demand, /*available=*/true, 100);
+  ASSERT_EQ(counts.size(), 1);
+  ASSERT_EQ(counts[node_ids[99]], 100);
+  const ClientID new_node = ClientID::FromRandom();
+  index_.UpdateNode(new_node, SchedulingResources(ResourceSet(ResourceMap{{"CPU", 1}})));
+  ASSERT_EQ(CountPicks(demand, /*available=*/true, 1000).size(), 2);
+  index_.RemoveNode(new_node);
+  index_.RemoveNode(node_ids[99]);
+  ASSERT_TRUE(index_.PickAvailableNode(demand, gen_).IsNil());
+  ASSERT_EQ(index_.NumNodes(), 0);
+}
+
+TEST_F(FeasibilityIndexTest, TestShapeEviction) {
+  const ClientID node_id = ClientID::FromRandom();
+  const ResourceSet total(ResourceMap{{"CPU", 4}, {"GPU", 1}});
+  index_.UpdateNode(node_id, SchedulingResources(total));
+  const ResourceSet cpu_demand(ResourceMap{{"CPU", 1}});
+  const ResourceSet gpu_demand(ResourceMap{{"GPU", 1}});
+  const ResourceSet empty_demand;
+  ASSERT_EQ(index_.PickAvailableNode(cpu_demand, gen_), node_id);
+  ASSERT_EQ(index_.PickAvailableNode(gpu_demand, gen_), node_id);
+  ASSERT_EQ(index_.PickAvailableNode(cpu_demand, gen_), node_id);
+  ASSERT_EQ(index_.NumShapes(), 2);
+  // The least recently picked shape is dropped for a new one.
+  ASSERT_EQ(index_.PickAvailableNode(empty_demand, gen_), node_id);
+  ASSERT_EQ(index_.NumShapes(), 2);
+
+  // Updates apply to shapes that are indexed again later.
+  SchedulingResources resources(total);
+  resources.Acquire(ResourceSet(ResourceMap{{"GPU", 1}}));
+  index_.UpdateNode(node_id, resources);
+  ASSERT_TRUE(index_.PickAvailableNode(gpu_demand, gen_).IsNil());
+  ASSERT_EQ(index_.PickFeasibleNode(gpu_demand, gen_), node_id);
+}
+
+TEST_F(FeasibilityIndexTest, TestPickFillsCluster) {
+  FillCluster(/*num_nodes=*/50, /*num_cpus=*/8, /*log_timing=*/false);
+}
+
+// Built with RAY_BENCHMARKS by the benchmark target, which runs only this test:
+// bazel run //:feasibility_index_benchmark
+#ifdef RAY_BENCHMARKS
+TEST_F(FeasibilityIndexTest, TestPickBenchmark) {
+  FillCluster(/*num_nodes=*/5000, /*num_cpus=*/20, /*log_timing=*/true);
+}
+#endif  // RAY_BENCHMARKS
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,239 @@
+#include "ray/raylet/heartbeat_delta.h"
+
+#include <algorithm>
+
+#include "ray/common/id.h"
+#include "ray/util/logging.h"
+
+namespace ray {
+
+namespace raylet {
+
+namespace {
+
+/// Build a set of resources from the labels and capacities of a snapshot.
+ResourceMap ToResourceMap(const google::protobuf::RepeatedPtrField<std::string> &labels,
+                          const google::protobuf::RepeatedField<double> &capacities) {
+  RAY_CHECK(labels.size() == capacities.size());
+  ResourceMap resources;
+  for (int i = 0; i < labels.size(); i++) {
+    resources[labels[i]] = capacities[i];
+  }
+  return resources;
+}
+
+/// Merge the deltas of a later heartbeat into those of an earlier one.
+void MergeDeltas(const google::protobuf::RepeatedPtrField<rpc::ResourceDelta> &later,
+                 google::protobuf::RepeatedPtrField<rpc::ResourceDelta> *earlier) {
+  std::unordered_map<uint32_t, rpc::ResourceDelta *> earlier_by_id;
+  for (auto &delta : *earlier) {
+    earlier_by_id[delta.id()] = &delta;
+  }
+  for (const auto &delta : later) {
+    auto it = earlier_by_id.find(delta.id());
+    if (it != earlier_by_id.end()) {
+      it->second->set_capacity(delta.capacity());
+    } else {
+      earlier->Add()->CopyFrom(delta);
+    }
+  }
+}
+
+}  // namespace
+
+HeartbeatEncoder::HeartbeatEncoder(uint64_t num_heartbeats_per_snapshot)
+    : num_heartbeats_per_snapshot_(std::max<uint64_t>(num_heartbeats_per_snapshot, 1)) {}
+
+void HeartbeatEncoder::Encode(const ResourceSet &available, const ResourceSet &total,
+                              const ResourceSet &load, HeartbeatTableData *heartbeat) {
+  bool snapshot = num_heartbeats_ % num_heartbeats_per_snapshot_ == 0;
+  num_heartbeats_++;
+  if (snapshot) {
+    available.ForEachResource(
+        [this, heartbeat](int64_t resource_id, FractionalResourceQuantity capacity) {
+          GetResourceId(resource_id, nullptr);
+          heartbeat->add_resources_available_label(
+              ResourceSet::GetResourceLabel(resource_id));
+          heartbeat->add_resources_available_capacity(capacity.ToDouble());
+        });
+    total.ForEachResource(
+        [this, heartbeat](int64_t resource_id, FractionalResourceQuantity capacity) {
+          GetResourceId(resource_id, nullptr);
+          heartbeat->add_resources_total_label(
+              ResourceSet::GetResourceLabel(resource_id));
+          heartbeat->add_resources_total_capacity(capacity.ToDouble());
+        });
+    load.ForEachResource(
+        [this, heartbeat](int64_t resource_id, FractionalResourceQuantity capacity) {
+          GetResourceId(resource_id, nullptr);
+          heartbeat->add_resource_load_label(
+              ResourceSet::GetResourceLabel(resource_id));
+          heartbeat->add_resource_load_capacity(capacity.ToDouble());
+        });
+    for (int64_t resource_id : sent_resource_ids_) {
+      auto label_id = heartbeat->add_resource_label_ids();
+      label_id->set_label(ResourceSet::GetResourceLabel(resource_id));
+      label_id->set_id(resource_id);
+    }
+  } else {
+    heartbeat->set_is_delta(true);
+    AddChanges(available_, available, heartbeat,
+               heartbeat->mutable_resources_available_delta());
+    AddChanges(total_, total, heartbeat, heartbeat->mutable_resources_total_delta());
+    AddChanges(load_, load, heartbeat, heartbeat->mutable_resource_load_delta());
+  }
+  available_ = available;
+  total_ = total;
+  load_ = load;
+}
+
+void HeartbeatEncoder::Encode(const ResourceMap &available, const ResourceMap &total,
+                              const ResourceMap &load, HeartbeatTableData *heartbeat) {
+  Encode(ResourceSet(available), ResourceSet(total), ResourceSet(load), heartbeat);
+}
+
+uint32_t HeartbeatEncoder::GetResourceId(int64_t resource_id,
+                                         HeartbeatTableData *heartbeat) {
+  if (static_cast<size_t>(resource_id) >= sent_labels_.size()) {
+    sent_labels_.resize(resource_id + 1, false);
+  }
+  if (!sent_labels_[resource_id]) {
+    sent_labels_[resource_id] = true;
+    sent_resource_ids_.push_back(resource_id);
+    if (heartbeat != nullptr) {
+      auto label_id = heartbeat->add_resource_label_ids();
+      label_id->set_label(ResourceSet::GetResourceLabel(resource_id));
+      label_id->set_id(resource_id);
+    }
+  }
+  return resource_id;
+}
+
+void HeartbeatEncoder::AddChanges(
+    const ResourceSet &previous, const ResourceSet &current,
+    HeartbeatTableData *heartbeat,
+    google::protobuf::RepeatedPtrField<rpc::ResourceDelta> *deltas) {
+  current.ForEachResource([this, &previous, heartbeat, deltas](
+                              int64_t resource_id, FractionalResourceQuantity capacity) {
+    if (previous.GetResourceById(resource_id) != capacity) {
+      auto delta = deltas->Add();
+      delta->set_id(GetResourceId(resource_id, heartbeat));
+      delta->set_capacity(capacity.ToDouble());
+    }
+  });
+  previous.ForEachResource([this, &current, heartbeat, deltas](
+                               int64_t resource_id, FractionalResourceQuantity capacity) {
+    if (current.GetResourceById(resource_id) == 0) {
+      auto delta = deltas->Add();
+      delta->set_id(GetResourceId(resource_id, heartbeat));
+      delta->set_capacity(0);
+    }
+  });
+}
+
+bool HeartbeatDecoder::Apply(const HeartbeatTableData &heartbeat) {
+  if (!heartbeat.is_delta()) {
+    resource_labels_.clear();
+    for (const auto &label_id : heartbeat.resource_label_ids()) {
+      resource_labels_[label_id.id()] = label_id.label();
+    }
+    available_ = ToResourceMap(heartbeat.resources_available_label(),
+                               heartbeat.resources_available_capacity());
+    total_ = ToResourceMap(heartbeat.resources_total_label(),
+                           heartbeat.resources_total_capacity());
+    load_ = ToResourceMap(heartbeat.resource_load_label(),
+                          heartbeat.resource_load_capacity());
+    known_ = true;
+    return true;
+  }
+  if (!known_) {
+    return false;
+  }
+  for (const auto &label_id : heartbeat.resource_label_ids()) {
+    resource_labels_[label_id.id()] = label_id.label();
+  }
+  known_ = ApplyDeltas(heartbeat.resources_available_delta(), &available_) &&
+           ApplyDeltas(heartbeat.resources_total_delta(), &total_) &&
+           ApplyDeltas(heartbeat.resource_load_delta(), &load_);
+  return known_;
+}
+
+bool HeartbeatDecoder::ApplyDeltas(
+    const google::protobuf::RepeatedPtrField<rpc::ResourceDelta> &deltas,
+    ResourceMap *resources) const {
+  for (const auto &delta : deltas) {
+    auto it = resource_labels_.find(delta.id());
+    if (it == resource_labels_.end()) {
+      return false;
+    }
+    if (delta.capacity() == 0) {
+      resources->erase(it->second);
+    } else {
+      (*resources)[it->second] = delta.capacity();
+    }
+  }
+  return true;
+}
+
+void HeartbeatDecoder::FillSnapshot(HeartbeatTableData *heartbeat) const {
+  heartbeat->set_is_delta(false);
+  heartbeat->clear_resources_available_delta();
+  heartbeat->clear_resources_total_delta();
+  heartbeat->clear_resource_load_delta();
+  heartbeat->clear_resources_available_label();
+  heartbeat->clear_resources_available_capacity();
+  for (const auto &resource_pair : available_) {
+    heartbeat->add_resources_available_label(resource_pair.first);
+    heartbeat->add_resources_available_capacity(resource_pair.second);
+  }
+  heartbeat->clear_resources_total_label();
+  heartbeat->clear_resources_total_capacity();
+  for (const auto &resource_pair : total_) {
+    heartbeat->add_resources_total_label(resource_pair.first);
+    heartbeat->add_resources_total_capacity(resource_pair.second);
+  }
+  heartbeat->clear_resource_load_label();
+  heartbeat->clear_resource_load_capacity();
+  for (const auto &resource_pair : load_) {
+    heartbeat->add_resource_load_label(resource_pair.first);
+    heartbeat->add_resource_load_capacity(resource_pair.second);
+  }
+  heartbeat->clear_resource_label_ids();
+  for (const auto &label_pair : resource_labels_) {
+    auto label_id = heartbeat->add_resource_label_ids();
+    label_id->set_label(label_pair.second);
+    label_id->set_id(label_pair.first);
+  }
+}
+
+void MergeHeartbeat(const HeartbeatTableData &heartbeat, HeartbeatTableData *buffered) {
+  if (!heartbeat.is_delta()) {
+    *buffered = heartbeat;
+    return;
+  }
+  if (buffered->is_delta()) {
+    buffered->mutable_resource_label_ids()->MergeFrom(heartbeat.resource_label_ids());
+    MergeDeltas(heartbeat.resources_available_delta(),
+                buffered->mutable_resources_available_delta());
+    MergeDeltas(heartbeat.resources_total_delta(),
+                buffered->mutable_resources_total_delta());
+    MergeDeltas(heartbeat.resource_load_delta(), buffered->mutable_resource_load_delta());
+  } else {
+    // Apply the delta to the buffered snapshot.
+    HeartbeatDecoder decoder;
+    RAY_CHECK(decoder.Apply(*buffered));
+    if (decoder.Apply(heartbeat)) {
+      decoder.FillSnapshot(buffered);
+    } else {
+      RAY_LOG(WARNING) << "Failed to apply a heartbeat delta of node "
+                       << ClientID::FromBinary(heartbeat.client_id())
+                       << ", its resources are unknown until its next snapshot.";
+      *buffered = heartbeat;
+    }
+  }
+  buffered->mutable_active_object_id()->CopyFrom(heartbeat.active_object_id());
+}
+
+}  // namespace raylet
+
+}  // namespace ray
@@ -0,0 +1,131 @@
+#ifndef RAY_RAYLET_HEARTBEAT_DELTA_H
+#define RAY_RAYLET_HEARTBEAT_DELTA_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ray/common/task/scheduling_resources.h"
+#include "ray/protobuf/gcs.pb.h"
+
+namespace ray {
+
+namespace raylet {
+
+using rpc::HeartbeatTableData;
+
+/// The resources of a node, by resource label.
+using ResourceMap = std::unordered_map<std::string, double>;
+
+/// \class HeartbeatEncoder
+///
+/// Encodes the resources of a node into its heartbeats. Every
+/// `num_heartbeats_per_snapshot`-th heartbeat, starting with the first one, is a full
+/// snapshot with the labels and capacities of all resources. The heartbeats in
+/// between are deltas that only hold the resources whose capacity changed since the
+/// previous heartbeat. Deltas refer to resources by the small integer IDs that
+/// ResourceSet interns resource labels as, instead of by label. A heartbeat lists the
+/// IDs of the labels it introduces, and snapshots list all of them, so that receivers
+/// that start listening between two snapshots catch up with the next one.
+class HeartbeatEncoder {
+ public:
+  /// Create an encoder.
+  ///
+  /// \param num_heartbeats_per_snapshot The number of heartbeats per full snapshot.
+  /// If this is 1, every heartbeat is a snapshot.
+  explicit HeartbeatEncoder(uint64_t num_heartbeats_per_snapshot);
+
+  /// Encode the current resources of the node into a heartbeat.
+  ///
+  /// \param available The available resources.
+  /// \param total The total resources.
+  /// \param load The resource load.
+  /// \param[out] heartbeat The heartbeat to fill in.
+  void Encode(const ResourceSet &available, const ResourceSet &total,
+              const ResourceSet &load, HeartbeatTableData *heartbeat);
+
+  /// Encode the current resources of the node, given by resource label, into a
+  /// heartbeat.
+  void Encode(const ResourceMap &available, const ResourceMap &total,
+              const ResourceMap &load, HeartbeatTableData *heartbeat);
+
+ private:
+  /// Return the ID of a resource. The labels of resources that weren't sent before
+  /// are added to the heartbeat, if it isn't null.
+  uint32_t GetResourceId(int64_t resource_id, HeartbeatTableData *heartbeat);
+
+  /// Add the resources whose capacity changed to a delta. Removed resources are
+  /// added with a capacity of 0.
+  void AddChanges(const ResourceSet &previous, const ResourceSet &current,
+                  HeartbeatTableData *heartbeat,
+                  google::protobuf::RepeatedPtrField<rpc::ResourceDelta> *deltas);
+
+  /// The number of heartbeats per full snapshot.
+  const uint64_t num_heartbeats_per_snapshot_;
+  /// The number of heartbeats encoded so far.
+  uint64_t num_heartbeats_ = 0;
+  /// Whether the label of each resource ID was sent, indexed by resource ID.
+  std::vector<bool> sent_labels_;
+  /// The IDs of the resources whose labels were sent, in the order they were sent.
+  std::vector<int64_t> sent_resource_ids_;
+  /// The resources sent in the previous heartbeat.
+  ResourceSet available_;
+  ResourceSet total_;
+  ResourceSet load_;
+};
+
+/// \class HeartbeatDecoder
+///
+/// Tracks the resources of a remote node by applying its heartbeats, which may be
+/// snapshots or deltas, in order.
+class HeartbeatDecoder {
+ public:
+  /// Apply a heartbeat of the node.
+  ///
+  /// \param heartbeat The heartbeat.
+  /// \return False if the heartbeat is a delta that can't be applied, because no
+  /// snapshot was applied yet or it refers to a resource ID that is unknown. The
+  /// resources are unknown until the next snapshot is applied.
+  bool Apply(const HeartbeatTableData &heartbeat);
+
+  /// Fill in a heartbeat with a snapshot of the node's resources.
+  ///
+  /// \param[out] heartbeat The heartbeat to fill in. Its resource fields are replaced.
+  void FillSnapshot(HeartbeatTableData *heartbeat) const;
+
+  const ResourceMap &GetAvailableResources() const { return available_; }
+  const ResourceMap &GetTotalResources() const { return total_; }
+  const ResourceMap &GetLoadResources() const { return load_; }
+
+ private:
+  /// Apply the changed capacities of a delta to a set of resources.
+  ///
+  /// \return False if a resource ID is unknown.
+  bool ApplyDeltas(const google::protobuf::RepeatedPtrField<rpc::ResourceDelta> &deltas,
+                   ResourceMap *resources) const;
+
+  /// Whether the resources are known, i.e., a snapshot was applied and all deltas
+  /// since could be applied.
+  bool known_ = false;
+  /// The labels of the resource IDs that the node interned.
+  std::unordered_map<uint32_t, std::string> resource_labels_;
+  /// The resources of the node.
+  ResourceMap available_;
+  ResourceMap total_;
+  ResourceMap load_;
+};
+
+/// Merge a heartbeat of a node into an earlier heartbeat of the same node that
+/// wasn't sent on yet, so that the merged heartbeat has the same effect on
+/// receivers as both of them.
+///
+/// \param heartbeat The later heartbeat.
+/// \param[in,out] buffered The earlier heartbeat, which is replaced by the merged
+/// one.
+void MergeHeartbeat(const HeartbeatTableData &heartbeat, HeartbeatTableData *buffered);
+
+}  // namespace raylet
+
+}  // namespace ray
+
+#endif  // RAY_RAYLET_HEARTBEAT_DELTA_H
@@ -0,0 +1,135 @@
+#include "gtest/gtest.h"
+
+#include "ray/raylet/heartbeat_delta.h"
+
+namespace ray {
+
+namespace raylet {
+
+class HeartbeatDeltaTest : public ::testing::Test {
+ public:
+  HeartbeatDeltaTest() : encoder_(/*num_heartbeats_per_snapshot=*/3) {}
+
+  HeartbeatTableData Encode(const ResourceMap &available, const ResourceMap &total,
+                            const ResourceMap &load) {
+    HeartbeatTableData heartbeat;
+    encoder_.Encode(available, total, load, &heartbeat);
+    return heartbeat;
+  }
+
+ protected:
+  HeartbeatEncoder encoder_;
+};
+
+TEST_F(HeartbeatDeltaTest, TestSnapshotsAndDeltas) {
+  const ResourceMap total = {{"CPU", 4}, {"GPU", 1}};
+  HeartbeatDecoder decoder;
+
+  // The first heartbeat is a snapshot.
+  auto heartbeat = Encode(total, total, {});
+  ASSERT_FALSE(heartbeat.is_delta());
+  ASSERT_EQ(heartbeat.resources_available_label_size(), 2);
+  ASSERT_EQ(heartbeat.resource_label_ids_size(), 2);
+  ASSERT_TRUE(decoder.Apply(heartbeat));
+  ASSERT_EQ(decoder.GetAvailableResources(), total);
+  ASSERT_EQ(decoder.GetTotalResources(), total);
+
+  // A delta only holds the resources that changed, without labels.
+  ResourceMap available = {{"CPU", 2}, {"GPU", 1}};
+  ResourceMap load = {{"CPU", 1}};
+  heartbeat = Encode(available, total, load);
+  ASSERT_TRUE(heartbeat.is_delta());
+  ASSERT_EQ(heartbeat.resources_available_label_size(), 0);
+  ASSERT_EQ(heartbeat.resource_label_ids_size(), 0);
+  ASSERT_EQ(heartbeat.resources_available_delta_size(), 1);
+  ASSERT_EQ(heartbeat.resources_total_delta_size(), 0);
+  ASSERT_EQ(heartbeat.resource_load_delta_size(), 1);
+  ASSERT_TRUE(decoder.Apply(heartbeat));
+  ASSERT_EQ(decoder.GetAvailableResources(), available);
+  ASSERT_EQ(decoder.GetLoadResources(), load);
+
+  // A delta introduces the labels of new resources, and removes resources with a
+  // capacity of 0.
+  available = {{"CPU", 2}, {"custom", 1}};
+  heartbeat = Encode(available, total, {});
+  ASSERT_TRUE(heartbeat.is_delta());
+  ASSERT_EQ(heartbeat.resource_label_ids_size(), 1);
+  ASSERT_EQ(heartbeat.resource_label_ids(0).label(), "custom");
+  ASSERT_EQ(heartbeat.resources_available_delta_size(), 2);
+  ASSERT_TRUE(decoder.Apply(heartbeat));
+  ASSERT_EQ(decoder.GetAvailableResources(), available);
+  ASSERT_TRUE(decoder.GetLoadResources().empty());
+
+  // Every third heartbeat is a snapshot again.
+  heartbeat = Encode(available, total, {});
+  ASSERT_FALSE(heartbeat.is_delta());
+  ASSERT_EQ(heartbeat.resource_label_ids_size(), 3);
+  ASSERT_TRUE(decoder.Apply(heartbeat));
+  ASSERT_EQ(decoder.GetAvailableResources(), available);
+}
+
+TEST_F(HeartbeatDeltaTest, TestDeltaBeforeSnapshot) {
+  const ResourceMap total = {{"CPU", 4}};
+  Encode(total, total, {});
+  auto delta = Encode({{"CPU", 3}}, total, {});
+
+  // A receiver that missed the snapshot ignores deltas until the next snapshot.
+  HeartbeatDecoder decoder;
+  ASSERT_FALSE(decoder.Apply(delta));
+  ASSERT_FALSE(decoder.Apply(Encode({{"CPU", 2}}, total, {})));
+  ASSERT_TRUE(decoder.Apply(Encode({{"CPU", 1}}, total, {})));
+  ASSERT_EQ(decoder.GetAvailableResources(), ResourceMap({{"CPU", 1}}));
+
+  // A delta that refers to an unknown resource ID makes the resources unknown.
+  delta.clear_resources_available_delta();
+  auto resource_delta = delta.add_resources_available_delta();
+  resource_delta->set_id(100);
+  resource_delta->set_capacity(1);
+  ASSERT_FALSE(decoder.Apply(delta));
+  ASSERT_FALSE(decoder.Apply(Encode({{"CPU", 2}}, total, {})));
+}
+
+TEST_F(HeartbeatDeltaTest, TestMergeHeartbeats) {
+  const ResourceMap total = {{"CPU", 4}, {"GPU", 1}};
+  auto snapshot = Encode(total, total, {});
+  auto delta1 = Encode({{"CPU", 2}, {"GPU", 1}}, total, {{"CPU", 1}});
+  auto delta2 = Encode({{"CPU", 3}, {"custom", 1}}, total, {});
+  const ResourceMap available = {{"CPU", 3}, {"custom", 1}};
+
+  // Merging deltas into a snapshot gives a snapshot of the latest resources.
+  HeartbeatTableData merged = snapshot;
+  MergeHeartbeat(delta1, &merged);
+  MergeHeartbeat(delta2, &merged);
+  ASSERT_FALSE(merged.is_delta());
+  HeartbeatDecoder decoder;
+  ASSERT_TRUE(decoder.Apply(merged));
+  ASSERT_EQ(decoder.GetAvailableResources(), available);
+  ASSERT_EQ(decoder.GetTotalResources(), total);
+  ASSERT_TRUE(decoder.GetLoadResources().empty());
+
+  // Merging deltas gives a delta with the same effect as both of them.
+  merged = delta1;
+  MergeHeartbeat(delta2, &merged);
+  ASSERT_TRUE(merged.is_delta());
+  ASSERT_EQ(merged.resources_available_delta_size(), 3);
+  HeartbeatDecoder delta_decoder;
+  ASSERT_TRUE(delta_decoder.Apply(snapshot));
+  ASSERT_TRUE(delta_decoder.Apply(merged));
+  ASSERT_EQ(delta_decoder.GetAvailableResources(), available);
+  ASSERT_TRUE(delta_decoder.GetLoadResources().empty());
+
+  // A snapshot replaces the merged heartbeat.
+  auto next_snapshot = Encode(available, total, {});
+  MergeHeartbeat(next_snapshot, &merged);
+  ASSERT_FALSE(merged.is_delta());
+  ASSERT_EQ(merged.resources_available_delta_size(), 0);
+}
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,278 @@
+#include "ray/raylet/local_object_spiller.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "absl/time/clock.h"
+#include "ray/stats/stats.h"
+#include "ray/util/logging.h"
+
+namespace {
+
+/// Identifies the files written by the spiller ("RAYSPILL").
+constexpr uint64_t kSpillFileMagic = 0x4c4c495053594152;
+
+/// The version of the spill file format.
+constexpr uint32_t kSpillFileVersion = 1;
+
+/// The header at the start of each spill file.
+struct SpillFileHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t data_size;
+  uint64_t metadata_size;
+};
+
+int64_t CurrentTimeUs() { return absl::GetCurrentTimeNanos() / 1000; }
+
+/// Return the throughput in MB/s, i.e., bytes per microsecond.
+double Throughput(uint64_t num_bytes, int64_t time_us) {
+  return time_us > 0 ? static_cast<double>(num_bytes) / time_us : 0;
+}
+
+}  // namespace
+
+namespace ray {
+
+namespace raylet {
+
+LocalObjectSpiller::LocalObjectSpiller(boost::asio::io_service &main_service,
+                                       const std::string &spill_dir,
+                                       uint64_t io_block_size)
+    : main_service_(main_service),
+      spill_dir_(spill_dir),
+      io_block_size_(std::max<uint64_t>(io_block_size, 1)),
+      io_work_(io_service_) {
+  if (mkdir(spill_dir_.c_str(), 0700) != 0) {
+    RAY_CHECK(errno == EEXIST) << "Failed to create the object spilling directory "
+                               << spill_dir_ << ": " << std::strerror(errno);
+  }
+  io_thread_ = std::thread([this]() { io_service_.run(); });
+}
+
+LocalObjectSpiller::~LocalObjectSpiller() {
+  for (const auto &pair : spilled_objects_) {
+    const std::string path = GetSpillPath(pair.first);
+    io_service_.post([path]() { std::remove(path.c_str()); });
+  }
+  // Let the pending I/O finish before stopping the thread.
+  io_service_.post([this]() { io_service_.stop(); });
+  io_thread_.join();
+}
+
+std::string LocalObjectSpiller::GetSpillPath(const ObjectID &object_id) const {
+  return spill_dir_ + "/" + object_id.Hex();
+}
+
+void LocalObjectSpiller::SpillObject(const ObjectID &object_id, const uint8_t *data,
+                                     uint64_t data_size, const uint8_t *metadata,
+                                     uint64_t metadata_size,
+                                     std::function<void(const ray::Status &)> callback) {
+  auto it = spilled_objects_.find(object_id);
+  if (it != spilled_objects_.end()) {
+    if (it->second.spilled) {
+      callback(Status::OK());
+      return;
+    }
+    // The object is being written. The I/O thread runs this handler after the
+    // write, so it can report the write's result.
+    io_service_.post([this, object_id, callback]() mutable {
+      main_service_.post([this, object_id, callback = std::move(callback)]() {
+        auto it = spilled_objects_.find(object_id);
+        if (it != spilled_objects_.end() && it->second.spilled) {
+          callback(Status::OK());
+        } else {
+          callback(Status::IOError("Failed to spill object " + object_id.Hex()));
+        }
+      });
+    });
+    return;
+  }
+
+  SpilledObject &spilled_object = spilled_objects_[object_id];
+  spilled_object.data_size = data_size;
+  spilled_object.metadata.assign(reinterpret_cast<const char *>(metadata),
+                                 metadata_size);
+  const std::string path = GetSpillPath(object_id);
+  io_service_.post([this, object_id, path, data, data_size, metadata, metadata_size,
+                    callback]() mutable {
+    int64_t start_time_us = CurrentTimeUs();
+    auto status = WriteObject(path, data, data_size, metadata, metadata_size);
+    int64_t write_time_us = CurrentTimeUs() - start_time_us;
+    if (!status.ok()) {
+      std::remove(path.c_str());
+    }
+    // Move the callback so that it's destroyed on the main thread, along with any
+    // buffers it holds.
+    main_service_.post([this, object_id, data_size, metadata_size, status,
+                        write_time_us, callback = std::move(callback)]() {
+      auto it = spilled_objects_.find(object_id);
+      if (status.ok()) {
+        num_objects_spilled_++;
+        bytes_written_ += data_size + metadata_size;
+        write_time_us_ += write_time_us;
+        // The object may have been deleted while it was written.
+        if (it != spilled_objects_.end()) {
+          it->second.spilled = true;
+          spilled_bytes_ += data_size + metadata_size;
+        }
+      } else {
+        RAY_LOG(WARNING) << "Failed to spill object " << object_id << ": "
+                         << status.ToString();
+        if (it != spilled_objects_.end()) {
+          spilled_objects_.erase(it);
+        }
+      }
+      callback(status);
+    });
+  });
+}
+
+bool LocalObjectSpiller::GetSpilledObject(const ObjectID &object_id, uint64_t *data_size,
+                                          std::string *metadata) const {
+  auto it = spilled_objects_.find(object_id);
+  if (it == spilled_objects_.end() || !it->second.spilled) {
+    return false;
+  }
+  *data_size = it->second.data_size;
+  *metadata = it->second.metadata;
+  return true;
+}
+
+void LocalObjectSpiller::RestoreObject(
+    const ObjectID &object_id, uint8_t *data,
+    std::function<void(const ray::Status &)> callback) {
+  auto it = spilled_objects_.find(object_id);
+  RAY_CHECK(it != spilled_objects_.end() && it->second.spilled)
+      << "Object " << object_id << " is not spilled";
+  const std::string path = GetSpillPath(object_id);
+  const uint64_t data_size = it->second.data_size;
+  const uint64_t metadata_size = it->second.metadata.size();
+  io_service_.post([this, object_id, path, data, data_size, metadata_size,
+                    callback]() mutable {
+    int64_t start_time_us = CurrentTimeUs();
+    auto status = ReadObject(path, data, data_size, metadata_size);
+    int64_t read_time_us = CurrentTimeUs() - start_time_us;
+    main_service_.post([this, object_id, data_size, status, read_time_us,
+                        callback = std::move(callback)]() {
+      if (status.ok()) {
+        num_objects_restored_++;
+        bytes_read_ += data_size;
+        read_time_us_ += read_time_us;
+      } else {
+        RAY_LOG(WARNING) << "Failed to restore object " << object_id << ": "
+                         << status.ToString();
+        DeleteSpilledObject(object_id);
+      }
+      callback(status);
+    });
+  });
+}
+
+void LocalObjectSpiller::DeleteSpilledObject(const ObjectID &object_id) {
+  auto it = spilled_objects_.find(object_id);
+  if (it == spilled_objects_.end()) {
+    return;
+  }
+  if (it->second.spilled) {
+    spilled_bytes_ -= it->second.data_size + it->second.metadata.size();
+  }
+  spilled_objects_.erase(it);
+  const std::string path = GetSpillPath(object_id);
+  io_service_.post([path]() { std::remove(path.c_str()); });
+}
+
+ray::Status LocalObjectSpiller::WriteObject(const std::string &path, const uint8_t *data,
+                                            uint64_t data_size, const uint8_t *metadata,
+                                            uint64_t metadata_size) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return Status::IOError("Failed to open " + path + ": " + std::strerror(errno));
+  }
+  SpillFileHeader header = {kSpillFileMagic, kSpillFileVersion, 0, data_size,
+                            metadata_size};
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(metadata), metadata_size);
+  for (uint64_t offset = 0; offset < data_size && file; offset += io_block_size_) {
+    file.write(reinterpret_cast<const char *>(data + offset),
+               std::min(io_block_size_, data_size - offset));
+  }
+  file.close();
+  if (!file) {
+    return Status::IOError("Failed to write " + path + ": " + std::strerror(errno));
+  }
+  return Status::OK();
+}
+
+ray::Status LocalObjectSpiller::ReadObject(const std::string &path, uint8_t *data,
+                                           uint64_t data_size,
+                                           uint64_t metadata_size) const {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return Status::IOError("Failed to open " + path + ": " + std::strerror(errno));
+  }
+  SpillFileHeader header;
+  if (!file.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+    return Status::IOError("Failed to read the header of " + path);
+  }
+  if (header.magic != kSpillFileMagic || header.version != kSpillFileVersion ||
+      header.data_size != data_size || header.metadata_size != metadata_size) {
+    return Status::IOError("Unexpected header in " + path);
+  }
+  file.seekg(metadata_size, std::ios::cur);
+  for (uint64_t offset = 0; offset < data_size && file; offset += io_block_size_) {
+    file.read(reinterpret_cast<char *>(data + offset),
+              std::min(io_block_size_, data_size - offset));
+  }
+  if (!file) {
+    return Status::IOError("Failed to read " + path);
+  }
+  return Status::OK();
+}
+
+std::string LocalObjectSpiller::DebugString() const {
+  std::stringstream result;
+  result << "LocalObjectSpiller:";
+  result << "\n- spill directory: " << spill_dir_;
+  result << "\n- num objects on disk: " << spilled_objects_.size();
+  result << "\n- bytes on disk: " << spilled_bytes_;
+  result << "\n- num objects spilled: " << num_objects_spilled_;
+  result << "\n- num objects restored: " << num_objects_restored_;
+  result << "\n- spill throughput: " << Throughput(bytes_written_, write_time_us_)
+         << " MB/s";
+  result << "\n- restore throughput: " << Throughput(bytes_read_, read_time_us_)
+         << " MB/s";
+  return result.str();
+}
+
+void LocalObjectSpiller::RecordMetrics() const {
+  stats::ObjectSpillingStats().Record(spilled_objects_.size(),
+                                      {{stats::ValueTypeKey, "num_objects_on_disk"}});
+  stats::ObjectSpillingStats().Record(spilled_bytes_,
+                                      {{stats::ValueTypeKey, "bytes_on_disk"}});
+  stats::ObjectSpillingStats().Record(num_objects_spilled_,
+                                      {{stats::ValueTypeKey, "num_objects_spilled"}});
+  stats::ObjectSpillingStats().Record(num_objects_restored_,
+                                      {{stats::ValueTypeKey, "num_objects_restored"}});
+  stats::ObjectSpillingStats().Record(bytes_written_,
+                                      {{stats::ValueTypeKey, "bytes_spilled"}});
+  stats::ObjectSpillingStats().Record(bytes_read_,
+                                      {{stats::ValueTypeKey, "bytes_restored"}});
+  stats::ObjectSpillingStats().Record(
+      Throughput(bytes_written_, write_time_us_),
+      {{stats::ValueTypeKey, "spill_throughput_mb_per_s"}});
+  stats::ObjectSpillingStats().Record(
+      Throughput(bytes_read_, read_time_us_),
+      {{stats::ValueTypeKey, "restore_throughput_mb_per_s"}});
+}
+
+}  // namespace raylet
+
+}  // namespace ray
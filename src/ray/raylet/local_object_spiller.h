@@ -0,0 +1,148 @@
+#ifndef RAY_RAYLET_LOCAL_OBJECT_SPILLER_H
+#define RAY_RAYLET_LOCAL_OBJECT_SPILLER_H
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <boost/asio.hpp>
+
+#include "ray/common/id.h"
+#include "ray/common/status.h"
+
+namespace ray {
+
+namespace raylet {
+
+/// \class LocalObjectSpiller
+///
+/// Writes objects to files on local disk and reads them back, so that pinned objects
+/// can be evicted from the object store when it fills up, and restored later instead
+/// of being reconstructed.
+///
+/// Each object is stored in its own file, which starts with a fixed-size header
+/// (magic number, format version, data size and metadata size), followed by the
+/// metadata and the data. The object is streamed to and from the file in blocks,
+/// directly between the object store's memory and the file.
+///
+/// All file I/O is done on a dedicated thread, in the order in which it was
+/// requested, so a restore or delete of an object never overtakes its spill. The
+/// public methods must be called from the thread running the main event loop, and
+/// the callbacks are invoked and destroyed on that thread.
+class LocalObjectSpiller {
+ public:
+  /// Create the spiller.
+  ///
+  /// \param main_service The event loop to invoke the callbacks on.
+  /// \param spill_dir The directory to store the objects in. It is created if it
+  /// doesn't exist.
+  /// \param io_block_size The size of the blocks in which files are written and read.
+  LocalObjectSpiller(boost::asio::io_service &main_service, const std::string &spill_dir,
+                     uint64_t io_block_size);
+
+  /// Stop the I/O thread and remove the spilled objects.
+  ~LocalObjectSpiller();
+
+  /// Write an object to disk. The buffers must stay valid until the callback is
+  /// invoked. Spilling an object that is already spilled succeeds right away.
+  ///
+  /// \param object_id The object to spill.
+  /// \param data The object's data.
+  /// \param data_size The size of the object's data.
+  /// \param metadata The object's metadata.
+  /// \param metadata_size The size of the object's metadata.
+  /// \param callback The callback to invoke once the object is on disk, or writing
+  /// it failed.
+  void SpillObject(const ObjectID &object_id, const uint8_t *data, uint64_t data_size,
+                   const uint8_t *metadata, uint64_t metadata_size,
+                   std::function<void(const ray::Status &)> callback);
+
+  /// Look up an object whose spill has completed.
+  ///
+  /// \param object_id The object to look up.
+  /// \param[out] data_size The size of the object's data.
+  /// \param[out] metadata The object's metadata.
+  /// \return Whether the object can be restored.
+  bool GetSpilledObject(const ObjectID &object_id, uint64_t *data_size,
+                        std::string *metadata) const;
+
+  /// Read the data of a spilled object from disk. The buffer must hold the size
+  /// returned by `GetSpilledObject`, and stay valid until the callback is invoked.
+  /// If reading the object fails, it is forgotten, since its file is corrupt.
+  ///
+  /// \param object_id The object to restore.
+  /// \param data The buffer to read the object's data into.
+  /// \param callback The callback to invoke once the data is read, or reading it
+  /// failed.
+  void RestoreObject(const ObjectID &object_id, uint8_t *data,
+                     std::function<void(const ray::Status &)> callback);
+
+  /// Remove a spilled object from disk, e.g. because it went out of scope. A spill
+  /// of the object that is in progress still invokes its callback.
+  ///
+  /// \param object_id The object to remove.
+  void DeleteSpilledObject(const ObjectID &object_id);
+
+  /// Returns debug string for class.
+  ///
+  /// \return string.
+  std::string DebugString() const;
+
+  /// Record metrics.
+  void RecordMetrics() const;
+
+ private:
+  /// A spilled object.
+  struct SpilledObject {
+    /// Whether the object is completely written to disk.
+    bool spilled = false;
+    /// The size of the object's data.
+    uint64_t data_size;
+    /// The object's metadata.
+    std::string metadata;
+  };
+
+  /// Return the path of the file that an object is spilled to.
+  std::string GetSpillPath(const ObjectID &object_id) const;
+
+  /// Write an object to a file. Runs on the I/O thread.
+  ray::Status WriteObject(const std::string &path, const uint8_t *data,
+                          uint64_t data_size, const uint8_t *metadata,
+                          uint64_t metadata_size) const;
+
+  /// Read the data of an object from a file. Runs on the I/O thread.
+  ray::Status ReadObject(const std::string &path, uint8_t *data, uint64_t data_size,
+                         uint64_t metadata_size) const;
+
+  /// The event loop to invoke the callbacks on.
+  boost::asio::io_service &main_service_;
+  /// The directory to store the objects in.
+  const std::string spill_dir_;
+  /// The size of the blocks in which files are written and read.
+  const uint64_t io_block_size_;
+  /// The event loop of the I/O thread.
+  boost::asio::io_service io_service_;
+  /// Keeps the I/O thread running while there is no I/O to do.
+  boost::asio::io_service::work io_work_;
+  /// The thread that does the file I/O.
+  std::thread io_thread_;
+  /// The objects that are being spilled or are spilled.
+  std::unordered_map<ObjectID, SpilledObject> spilled_objects_;
+  /// The total size of the objects on disk.
+  uint64_t spilled_bytes_ = 0;
+  /// The number of objects spilled and restored so far.
+  uint64_t num_objects_spilled_ = 0;
+  uint64_t num_objects_restored_ = 0;
+  /// The number of bytes written and read so far, and the time it took.
+  uint64_t bytes_written_ = 0;
+  int64_t write_time_us_ = 0;
+  uint64_t bytes_read_ = 0;
+  int64_t read_time_us_ = 0;
+};
+
+}  // namespace raylet
+
+}  // namespace ray
+
+#endif  // RAY_RAYLET_LOCAL_OBJECT_SPILLER_H
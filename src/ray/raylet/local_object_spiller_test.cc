@@ -0,0 +1,165 @@
+#include <stdlib.h>
+
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+#include "ray/raylet/local_object_spiller.h"
+
+namespace ray {
+
+namespace raylet {
+
+class LocalObjectSpillerTest : public ::testing::Test {
+ public:
+  LocalObjectSpillerTest()
+      : main_work_(main_service_),
+        spill_dir_(MakeSpillDir()),
+        spiller_(main_service_, spill_dir_, /*io_block_size=*/1000) {}
+
+  static std::string MakeSpillDir() {
+    char dir[] = "/tmp/local_object_spiller_test_XXXXXX";
+    RAY_CHECK(mkdtemp(dir) != nullptr);
+    return dir;
+  }
+
+  static std::vector<uint8_t> MakeData(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++) {
+      data[i] = static_cast<uint8_t>(i * 7);
+    }
+    return data;
+  }
+
+  /// Run the main event loop until a callback reports its status.
+  Status WaitForCallback(const std::shared_ptr<Status> &status) {
+    while (status->IsUnknownError()) {
+      main_service_.run_one();
+    }
+    return *status;
+  }
+
+  std::function<void(const Status &)> SetStatus(const std::shared_ptr<Status> &status) {
+    return [status](const Status &result) { *status = result; };
+  }
+
+  static std::shared_ptr<Status> NewStatus() {
+    return std::make_shared<Status>(Status::UnknownError(""));
+  }
+
+  bool FileExists(const ObjectID &object_id) {
+    return std::ifstream(spill_dir_ + "/" + object_id.Hex()).good();
+  }
+
+ protected:
+  boost::asio::io_service main_service_;
+  /// Keeps `run_one` waiting for the callbacks posted by the I/O thread.
+  boost::asio::io_service::work main_work_;
+  std::string spill_dir_;
+  LocalObjectSpiller spiller_;
+};
+
+TEST_F(LocalObjectSpillerTest, TestSpillAndRestore) {
+  ObjectID object_id = ObjectID::FromRandom();
+  // The data spans several I/O blocks.
+  auto data = MakeData(4321);
+  std::string metadata = "meta";
+  auto status = NewStatus();
+  spiller_.SpillObject(object_id, data.data(), data.size(),
+                       reinterpret_cast<const uint8_t *>(metadata.data()),
+                       metadata.size(), SetStatus(status));
+  uint64_t data_size;
+  std::string restored_metadata;
+  // The object can't be restored before it is written.
+  ASSERT_FALSE(spiller_.GetSpilledObject(object_id, &data_size, &restored_metadata));
+  ASSERT_TRUE(WaitForCallback(status).ok());
+  ASSERT_TRUE(FileExists(object_id));
+
+  ASSERT_TRUE(spiller_.GetSpilledObject(object_id, &data_size, &restored_metadata));
+  ASSERT_EQ(data_size, data.size());
+  ASSERT_EQ(restored_metadata, metadata);
+  std::vector<uint8_t> restored(data_size);
+  status = NewStatus();
+  spiller_.RestoreObject(object_id, restored.data(), SetStatus(status));
+  ASSERT_TRUE(WaitForCallback(status).ok());
+  ASSERT_EQ(restored, data);
+
+  // Spilling the object again doesn't write it again.
+  status = NewStatus();
+  spiller_.SpillObject(object_id, data.data(), data.size(), nullptr, 0,
+                       SetStatus(status));
+  ASSERT_TRUE(status->ok());
+}
+
+TEST_F(LocalObjectSpillerTest, TestSpillTwiceConcurrently) {
+  ObjectID object_id = ObjectID::FromRandom();
+  auto data = MakeData(100);
+  auto status1 = NewStatus();
+  auto status2 = NewStatus();
+  spiller_.SpillObject(object_id, data.data(), data.size(), nullptr, 0,
+                       SetStatus(status1));
+  spiller_.SpillObject(object_id, data.data(), data.size(), nullptr, 0,
+                       SetStatus(status2));
+  ASSERT_TRUE(WaitForCallback(status1).ok());
+  ASSERT_TRUE(WaitForCallback(status2).ok());
+}
+
+TEST_F(LocalObjectSpillerTest, TestDelete) {
+  ObjectID object_id = ObjectID::FromRandom();
+  auto data = MakeData(100);
+  auto status = NewStatus();
+  spiller_.SpillObject(object_id, data.data(), data.size(), nullptr, 0,
+                       SetStatus(status));
+  ASSERT_TRUE(WaitForCallback(status).ok());
+  spiller_.DeleteSpilledObject(object_id);
+  uint64_t data_size;
+  std::string metadata;
+  ASSERT_FALSE(spiller_.GetSpilledObject(object_id, &data_size, &metadata));
+
+  // Deleting an object while it is written removes its file once the write is done.
+  ObjectID other_id = ObjectID::FromRandom();
+  status = NewStatus();
+  spiller_.SpillObject(other_id, data.data(), data.size(), nullptr, 0,
+                       SetStatus(status));
+  spiller_.DeleteSpilledObject(other_id);
+  ASSERT_TRUE(WaitForCallback(status).ok());
+  ASSERT_FALSE(spiller_.GetSpilledObject(other_id, &data_size, &metadata));
+
+  // The files are removed on the I/O thread, after the spills and restores before
+  // them. Wait for one more spill to make sure they are gone.
+  status = NewStatus();
+  spiller_.SpillObject(ObjectID::FromRandom(), data.data(), data.size(), nullptr, 0,
+                       SetStatus(status));
+  ASSERT_TRUE(WaitForCallback(status).ok());
+  ASSERT_FALSE(FileExists(object_id));
+  ASSERT_FALSE(FileExists(other_id));
+}
+
+TEST_F(LocalObjectSpillerTest, TestCorruptFile) {
+  ObjectID object_id = ObjectID::FromRandom();
+  auto data = MakeData(100);
+  auto status = NewStatus();
+  spiller_.SpillObject(object_id, data.data(), data.size(), nullptr, 0,
+                       SetStatus(status));
+  ASSERT_TRUE(WaitForCallback(status).ok());
+  // Truncate the file.
+  std::ofstream(spill_dir_ + "/" + object_id.Hex(), std::ios::trunc).close();
+
+  std::vector<uint8_t> restored(data.size());
+  status = NewStatus();
+  spiller_.RestoreObject(object_id, restored.data(), SetStatus(status));
+  ASSERT_TRUE(WaitForCallback(status).IsIOError());
+  // The object is forgotten, so that it is recovered some other way.
+  uint64_t data_size;
+  std::string metadata;
+  ASSERT_FALSE(spiller_.GetSpilledObject(object_id, &data_size, &metadata));
+}
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
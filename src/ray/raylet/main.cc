@@ -128,6 +128,17 @@ int main(int argc, char *argv[]) {
       RayConfig::instance().fair_queueing_enabled();
   node_manager_config.object_pinning_enabled =
       RayConfig::instance().object_pinning_enabled();
+  node_manager_config.object_spilling_enabled =
+      RayConfig::instance().object_spilling_enabled();
+  node_manager_config.object_spilling_directory =
+      RayConfig::instance().object_spilling_directory();
+  if (node_manager_config.object_spilling_directory.empty()) {
+    node_manager_config.object_spilling_directory = session_dir + "/spilled_objects";
+  }
+  // Memory resources are given in units of 50 MiB.
+  node_manager_config.object_store_memory = static_cast<int64_t>(
+      node_manager_config.resource_config.GetResource("object_store_memory").ToDouble() *
+      50 * 1024 * 1024);
   node_manager_config.max_lineage_size = RayConfig::instance().max_lineage_size();
   node_manager_config.store_socket_name = store_socket_name;
   node_manager_config.temp_dir = temp_dir;
@@ -147,6 +158,7 @@ int main(int argc, char *argv[]) {
       std::min(std::max(2, num_cpus / 4), 8);
   object_manager_config.object_chunk_size =
       RayConfig::instance().object_manager_default_chunk_size();
+  object_manager_config.object_store_memory = node_manager_config.object_store_memory;
 
   RAY_LOG(DEBUG) << "Starting object manager with configuration: \n"
                  << "rpc_service_threads_number = "
@@ -3,6 +3,7 @@
 #include "ray/common/ray_config.h"
 #include "ray/common/status.h"
 #include "ray/gcs/pb_util.h"
+#include "ray/raylet/heartbeat_delta.h"
 #include "ray/util/util.h"
 
 namespace ray {
@@ -27,7 +28,13 @@ Monitor::Monitor(boost::asio::io_service &io_service,
 void Monitor::HandleHeartbeat(const ClientID &node_id,
                               const HeartbeatTableData &heartbeat_data) {
   heartbeats_[node_id] = num_heartbeats_timeout_;
-  heartbeat_buffer_[node_id] = heartbeat_data;
+  auto it = heartbeat_buffer_.find(node_id);
+  if (it == heartbeat_buffer_.end()) {
+    heartbeat_buffer_.emplace(node_id, heartbeat_data);
+  } else {
+    // Heartbeats may be deltas, so merge them instead of only sending the last one.
+    MergeHeartbeat(heartbeat_data, &it->second);
+  }
 }
 
 void Monitor::Start() {
@@ -6,6 +6,7 @@
 
 #include "ray/common/buffer.h"
 #include "ray/common/common_protocol.h"
+#include "ray/common/grpc_util.h"
 #include "ray/common/id.h"
 #include "ray/common/status.h"
 #include "ray/gcs/pb_util.h"
@@ -83,7 +84,6 @@ NodeManager::NodeManager(boost::asio::io_service &io_service,
       heartbeat_timer_(io_service),
       heartbeat_period_(std::chrono::milliseconds(config.heartbeat_period_ms)),
       debug_dump_period_(config.debug_dump_period_ms),
-      fair_queueing_enabled_(config.fair_queueing_enabled),
       object_pinning_enabled_(config.object_pinning_enabled),
       temp_dir_(config.temp_dir),
       object_manager_profile_timer_(io_service),
@@ -91,7 +91,16 @@ NodeManager::NodeManager(boost::asio::io_service &io_service,
       local_available_resources_(config.resource_config),
       worker_pool_(config.num_initial_workers, config.maximum_startup_concurrency,
                    gcs_client_, config.worker_commands),
-      scheduling_policy_(local_queues_),
+      local_queues_(config.fair_queueing_enabled),
+      scheduling_policy_(
+          local_queues_,
+          RayConfig::instance().locality_aware_scheduling_enabled()
+              ? ArgumentLocalityFunction(
+                    [this](const TaskSpecification &spec,
+                           std::unordered_map<ClientID, uint64_t> *bytes_by_node) {
+                      GetArgumentLocality(spec, bytes_by_node);
+                    })
+              : nullptr),
       reconstruction_policy_(
           io_service_,
           [this](const TaskID &task_id, const ObjectID &required_object_id) {
@@ -108,8 +117,16 @@ NodeManager::NodeManager(boost::asio::io_service &io_service,
       node_manager_server_("NodeManager", config.node_manager_port),
       node_manager_service_(io_service, *this),
       client_call_manager_(io_service),
-      new_scheduler_enabled_(RayConfig::instance().new_scheduler_enabled()) {
+      new_scheduler_enabled_(RayConfig::instance().new_scheduler_enabled()),
+      batch_placement_enabled_(RayConfig::instance().batch_placement_enabled()),
+      locality_aware_scheduling_enabled_(
+          RayConfig::instance().locality_aware_scheduling_enabled()),
+      work_stealing_enabled_(RayConfig::instance().work_stealing_enabled()) {
   RAY_CHECK(heartbeat_period_.count() > 0);
+  if (RayConfig::instance().delta_heartbeats_enabled()) {
+    heartbeat_encoder_.reset(new HeartbeatEncoder(
+        RayConfig::instance().num_heartbeats_per_resource_snapshot()));
+  }
   // Initialize the resource map with own cluster resource configuration.
   cluster_resource_map_.emplace(self_node_id_,
                                 SchedulingResources(config.resource_config));
@@ -131,6 +148,17 @@ NodeManager::NodeManager(boost::asio::io_service &io_service,
   }
 
   RAY_ARROW_CHECK_OK(store_client_.Connect(config.store_socket_name.c_str()));
+  if (config.object_spilling_enabled && object_pinning_enabled_ &&
+      config.object_store_memory > 0) {
+    object_spiller_.reset(
+        new LocalObjectSpiller(io_service_, config.object_spilling_directory,
+                               RayConfig::instance().object_spilling_io_block_size()));
+    spill_threshold_bytes_ = config.object_store_memory *
+                             RayConfig::instance().object_spilling_threshold_percent() /
+                             100;
+    object_manager_.SetSpilledObjectRestorer(
+        [this](const ObjectID &object_id) { return RestoreSpilledObject(object_id); });
+  }
   // Run the node manger rpc server.
   node_manager_server_.RegisterService(node_manager_service_);
   node_manager_server_.Run();
@@ -268,6 +296,9 @@ void NodeManager::HandleJobFinished(const JobID &job_id, const JobTableData &job
   // NOTE(swang): SchedulingQueue::RemoveTasks modifies its argument so we must
   // call it last.
   local_queues_.RemoveTasks(tasks_to_remove);
+  // Tasks held until the locations of their arguments are known are not queued yet.
+  // Their subscriptions are dropped when the placeable tasks are next placed.
+  argument_location_tracker_.RemoveTasksForJob(job_id);
 }
 
 void NodeManager::Heartbeat() {
@@ -282,22 +313,32 @@ void NodeManager::Heartbeat() {
   auto heartbeat_data = std::make_shared<HeartbeatTableData>();
   SchedulingResources &local_resources = cluster_resource_map_[self_node_id_];
   heartbeat_data->set_client_id(self_node_id_.Binary());
-  // TODO(atumanov): modify the heartbeat table protocol to use the ResourceSet directly.
-  // TODO(atumanov): implement a ResourceSet const_iterator.
-  for (const auto &resource_pair :
-       local_resources.GetAvailableResources().GetResourceMap()) {
-    heartbeat_data->add_resources_available_label(resource_pair.first);
-    heartbeat_data->add_resources_available_capacity(resource_pair.second);
-  }
-  for (const auto &resource_pair : local_resources.GetTotalResources().GetResourceMap()) {
-    heartbeat_data->add_resources_total_label(resource_pair.first);
-    heartbeat_data->add_resources_total_capacity(resource_pair.second);
-  }
-
   local_resources.SetLoadResources(local_queues_.GetResourceLoad());
-  for (const auto &resource_pair : local_resources.GetLoadResources().GetResourceMap()) {
-    heartbeat_data->add_resource_load_label(resource_pair.first);
-    heartbeat_data->add_resource_load_capacity(resource_pair.second);
+  if (heartbeat_encoder_ != nullptr) {
+    heartbeat_encoder_->Encode(local_resources.GetAvailableResources(),
+                               local_resources.GetTotalResources(),
+                               local_resources.GetLoadResources(), heartbeat_data.get());
+  } else {
+    // TODO(atumanov): modify the heartbeat table protocol to use the ResourceSet
+    // directly.
+    local_resources.GetAvailableResources().ForEachResource(
+        [&heartbeat_data](int64_t resource_id, FractionalResourceQuantity capacity) {
+          heartbeat_data->add_resources_available_label(
+              ResourceSet::GetResourceLabel(resource_id));
+          heartbeat_data->add_resources_available_capacity(capacity.ToDouble());
+        });
+    local_resources.GetTotalResources().ForEachResource(
+        [&heartbeat_data](int64_t resource_id, FractionalResourceQuantity capacity) {
+          heartbeat_data->add_resources_total_label(
+              ResourceSet::GetResourceLabel(resource_id));
+          heartbeat_data->add_resources_total_capacity(capacity.ToDouble());
+        });
+    local_resources.GetLoadResources().ForEachResource(
+        [&heartbeat_data](int64_t resource_id, FractionalResourceQuantity capacity) {
+          heartbeat_data->add_resource_load_label(
+              ResourceSet::GetResourceLabel(resource_id));
+          heartbeat_data->add_resource_load_capacity(capacity.ToDouble());
+        });
   }
 
   ray::Status status = gcs_client_->Nodes().AsyncReportHeartbeat(heartbeat_data,
@@ -312,6 +353,8 @@ void NodeManager::Heartbeat() {
     last_debug_dump_at_ms_ = now_ms;
   }
 
+  TryStealTasks();
+
   // Reset the timer.
   heartbeat_timer_.expires_from_now(heartbeat_period_);
   heartbeat_timer_.async_wait([this](const boost::system::error_code &error) {
@@ -469,6 +512,9 @@ void NodeManager::NodeRemoved(const GcsNodeInfo &node_info) {
 
   // Remove the client from the resource map.
   cluster_resource_map_.erase(node_id);
+  heartbeat_decoders_.erase(node_id);
+  steal_exhausted_nodes_.erase(node_id);
+  scheduling_policy_.RemoveNode(node_id);
 
   // Remove the node manager client.
   const auto client_entry = remote_node_manager_clients_.find(node_id);
@@ -573,6 +619,7 @@ void NodeManager::ResourceCreateUpdated(const ClientID &client_id,
                                                       new_resource_capacity);
     }
   }
+  scheduling_policy_.UpdateNode(client_id, cluster_schedres);
   RAY_LOG(DEBUG) << "[ResourceCreateUpdated] Updated cluster_resource_map.";
 
   if (client_id == self_node_id_) {
@@ -606,6 +653,7 @@ void NodeManager::ResourceDeleted(const ClientID &client_id,
       new_resource_scheduler_->DeleteResource(client_id.Binary(), resource_label);
     }
   }
+  scheduling_policy_.UpdateNode(client_id, cluster_schedres);
   RAY_LOG(DEBUG) << "[ResourceDeleted] Updated cluster_resource_map.";
   return;
 }
@@ -642,17 +690,21 @@ void NodeManager::HeartbeatAdded(const ClientID &client_id,
   }
   SchedulingResources &remote_resources = it->second;
 
-  ResourceSet remote_total(VectorFromProtobuf(heartbeat_data.resources_total_label()),
-                           VectorFromProtobuf(heartbeat_data.resources_total_capacity()));
-  ResourceSet remote_available(
-      VectorFromProtobuf(heartbeat_data.resources_available_label()),
-      VectorFromProtobuf(heartbeat_data.resources_available_capacity()));
-  ResourceSet remote_load(VectorFromProtobuf(heartbeat_data.resource_load_label()),
-                          VectorFromProtobuf(heartbeat_data.resource_load_capacity()));
+  // Apply the heartbeat, which may only hold the resources that changed.
+  auto &decoder = heartbeat_decoders_[client_id];
+  if (!decoder.Apply(heartbeat_data)) {
+    RAY_LOG(DEBUG) << "[HeartbeatAdded]: skipping heartbeat delta from client id "
+                   << client_id << " until its next snapshot";
+    return;
+  }
+  ResourceSet remote_total(decoder.GetTotalResources());
+  ResourceSet remote_available(decoder.GetAvailableResources());
+  ResourceSet remote_load(decoder.GetLoadResources());
   // TODO(atumanov): assert that the load is a non-empty ResourceSet.
   remote_resources.SetAvailableResources(std::move(remote_available));
   // Extract the load information and save it locally.
   remote_resources.SetLoadResources(std::move(remote_load));
+  steal_exhausted_nodes_.erase(client_id);
 
   if (new_scheduler_enabled_ && client_id != self_node_id_) {
     new_resource_scheduler_->AddOrUpdateNode(client_id.Binary(),
@@ -664,6 +716,7 @@ void NodeManager::HeartbeatAdded(const ClientID &client_id,
 
   // Extract decision for this raylet.
   auto decision = scheduling_policy_.SpillOver(remote_resources);
+  scheduling_policy_.UpdateNode(client_id, remote_resources);
   std::unordered_set<TaskID> local_task_ids;
   for (const auto &task_id : decision) {
     // (See design_docs/task_states.rst for the state transition diagram.)
@@ -791,60 +844,67 @@ void NodeManager::ProcessNewClient(LocalClientConnection &client) {
   client.ProcessMessages();
 }
 
-// A helper function to create a mapping from task scheduling class to
-// tasks with that class from a given list of tasks.
-std::unordered_map<SchedulingClass, ordered_set<TaskID>> MakeTasksByClass(
-    const std::vector<Task> &tasks) {
-  std::unordered_map<SchedulingClass, ordered_set<TaskID>> result;
-  for (const auto &task : tasks) {
-    auto spec = task.GetTaskSpecification();
-    result[spec.GetSchedulingClass()].push_back(spec.TaskId());
-  }
-  return result;
-}
-
-void NodeManager::DispatchTasks(
-    const std::unordered_map<SchedulingClass, ordered_set<TaskID>> &tasks_by_class) {
-  // Dispatch tasks in priority order by class. This avoids starvation problems where
-  // one class of tasks become stuck behind others in the queue, causing Ray to start
-  // many workers. See #3644 for a more detailed description of this issue.
-  std::vector<const std::pair<const SchedulingClass, ordered_set<TaskID>> *> fair_order;
-  for (auto &it : tasks_by_class) {
-    fair_order.emplace_back(&it);
-  }
-  // Prioritize classes that have fewer currently running tasks. Note that we only
-  // sort once per round of task dispatch, which is less fair then it could be, but
-  // is simpler and faster.
-  if (fair_queueing_enabled_) {
-    std::sort(
-        std::begin(fair_order), std::end(fair_order),
-        [this](const std::pair<const SchedulingClass, ordered_set<ray::TaskID>> *a,
-               const std::pair<const SchedulingClass, ordered_set<ray::TaskID>> *b) {
-          return local_queues_.NumRunning(a->first) < local_queues_.NumRunning(b->first);
-        });
-  }
+void NodeManager::DispatchTasks() {
+  // Only visit the classes of ready tasks that may have become dispatchable since
+  // the last round: classes with newly ready tasks, classes that were blocked on
+  // resources that are now available, and classes that were blocked on workers
+  // before a worker was returned. Classes whose first task has a higher priority
+  // or an earlier deadline are dispatched first, and then classes with fewer
+  // running tasks. This avoids starvation problems where one class of tasks become
+  // stuck behind others in the queue, causing Ray to start many workers. See #3644
+  // for a more detailed description of this issue.
+  local_queues_.WakeClassesBlockedOnResources(local_available_resources_);
+  const auto &tasks_by_class = local_queues_.GetReadyTasksByClass();
   std::vector<std::function<void()>> post_assign_callbacks;
-  // Approximate fair round robin between classes.
-  for (const auto &it : fair_order) {
+  SchedulingClass scheduling_class;
+  std::vector<TaskID> new_task_ids;
+  while (local_queues_.PopDispatchableClass(&scheduling_class, &new_task_ids)) {
     const auto &task_resources =
-        TaskSpecification::GetSchedulingClassDescriptor(it->first).first;
-    // FIFO order within each class.
-    for (const auto &task_id : it->second) {
-      const auto &task = local_queues_.GetTaskOfState(task_id, TaskState::READY);
+        TaskSpecification::GetSchedulingClassDescriptor(scheduling_class).first;
+    DispatchBlocker blocker = DispatchBlocker::NONE;
+    // Try to dispatch a task. Returns false if no more tasks of the class fit.
+    auto dispatch_task = [&](const TaskID &task_id) {
       if (!local_available_resources_.Contains(task_resources)) {
-        // All the tasks in it.second have the same resource shape, so
-        // once the first task is not feasible, we can break out of this loop
-        break;
+        // All the tasks of the class have the same resource shape, so once the
+        // first task is not feasible, none of them are.
+        blocker = DispatchBlocker::RESOURCES;
+        return false;
       }
-
       // Try to get an idle worker to execute this task. If nullptr, there
       // aren't any available workers so we can't assign the task.
+      const auto &task = local_queues_.GetTaskOfState(task_id, TaskState::READY);
       std::shared_ptr<Worker> worker =
           worker_pool_.PopWorker(task.GetTaskSpecification());
       if (worker != nullptr) {
+        const auto &spec = task.GetTaskSpecification();
+        stats::TaskQueueDelay().Record(
+            current_time_ms() - local_queues_.GetTaskStateTimeMs(task_id),
+            {{stats::PriorityKey, std::to_string(spec.Priority())}});
         AssignTask(worker, task, &post_assign_callbacks);
+      } else {
+        blocker = DispatchBlocker::WORKERS;
+      }
+      return true;
+    };
+    if (new_task_ids.empty()) {
+      // Priority and deadline order within each class.
+      auto it = tasks_by_class.find(scheduling_class);
+      if (it != tasks_by_class.end()) {
+        for (const auto &task_id : it->second) {
+          if (!dispatch_task(task_id)) {
+            break;
+          }
+        }
+      }
+    } else {
+      // The older tasks of the class are still waiting for workers.
+      for (const auto &task_id : new_task_ids) {
+        if (!dispatch_task(task_id)) {
+          break;
+        }
       }
     }
+    local_queues_.FinishDispatch(scheduling_class, blocker);
   }
   // Call the callbacks from the AssignTask calls above. These need to be called
   // after the above loop, as they may alter the scheduling queues and invalidate
@@ -1081,6 +1141,7 @@ void NodeManager::HandleWorkerAvailable(const std::shared_ptr<Worker> &worker) {
   if (worker_idle) {
     // Return the worker to the idle pool.
     worker_pool_.PushWorker(worker);
+    local_queues_.WakeClassesBlockedOnWorkers();
   }
 
   if (new_scheduler_enabled_) {
@@ -1090,7 +1151,9 @@ void NodeManager::HandleWorkerAvailable(const std::shared_ptr<Worker> &worker) {
     cluster_resource_map_[self_node_id_].SetLoadResources(
         local_queues_.GetResourceLoad());
     // Call task dispatch to assign work to the new worker.
-    DispatchTasks(local_queues_.GetReadyTasksByClass());
+    DispatchTasks();
+    // If there is nothing left to run here, ask a peer for work.
+    TryStealTasks();
   }
 }
 
@@ -1186,6 +1249,8 @@ void NodeManager::ProcessDisconnectClientMessage(
 
     // Remove the dead client from the pool and stop listening for messages.
     worker_pool_.DisconnectWorker(worker);
+    // A replacement worker may be started now.
+    local_queues_.WakeClassesBlockedOnWorkers();
 
     // Return the resources that were being used by this worker.
     auto const &task_resources = worker->GetTaskResourceIds();
@@ -1204,7 +1269,7 @@ void NodeManager::ProcessDisconnectClientMessage(
                    << "job_id: " << worker->GetAssignedJobId();
 
     // Since some resources may have been released, we can try to dispatch more tasks.
-    DispatchTasks(local_queues_.GetReadyTasksByClass());
+    DispatchTasks();
   } else if (is_driver) {
     // The client is a driver.
     const auto job_id = worker->GetAssignedJobId();
@@ -1236,7 +1301,7 @@ void NodeManager::ProcessFetchOrReconstructMessage(
       // dependencies to the task dependency manager.
       if (!task_dependency_manager_.CheckObjectLocal(object_id)) {
         // Fetch the object if it's not already local.
-        RAY_CHECK_OK(object_manager_.Pull(object_id));
+        RAY_CHECK_OK(object_manager_.Pull(object_id, PullPriority::PREFETCH));
       }
     } else {
       // If reconstruction is also required, then add any requested objects to
@@ -1291,20 +1356,21 @@ void NodeManager::ProcessWaitRequestMessage(
             fbb, to_flatbuf(fbb, found), to_flatbuf(fbb, remaining));
         fbb.Finish(wait_reply);
 
-        auto status =
-            client->WriteMessage(static_cast<int64_t>(protocol::MessageType::WaitReply),
-                                 fbb.GetSize(), fbb.GetBufferPointer());
-        if (status.ok()) {
-          // The client is unblocked now because the wait call has returned.
-          if (resolve_objects) {
-            AsyncResolveObjectsFinish(client, current_task_id, was_blocked);
-          }
-        } else {
-          // We failed to write to the client, so disconnect the client.
-          RAY_LOG(WARNING)
-              << "Failed to send WaitReply to client, so disconnecting client";
-          // We failed to send the reply to the client, so disconnect the worker.
-          ProcessDisconnectClientMessage(client);
+        // The reply is written asynchronously, since the socket may be written on
+        // another thread.
+        client->WriteMessageAsync(
+            static_cast<int64_t>(protocol::MessageType::WaitReply), fbb.GetSize(),
+            fbb.GetBufferPointer(), [this, client](const ray::Status &status) {
+              if (!status.ok()) {
+                // We failed to send the reply to the client, so disconnect the worker.
+                RAY_LOG(WARNING)
+                    << "Failed to send WaitReply to client, so disconnecting client";
+                ProcessDisconnectClientMessage(client);
+              }
+            });
+        // The client is unblocked now because the wait call has returned.
+        if (resolve_objects) {
+          AsyncResolveObjectsFinish(client, current_task_id, was_blocked);
         }
       });
   RAY_CHECK_OK(status);
@@ -1437,8 +1503,11 @@ void NodeManager::DispatchScheduledTasksToWorkers() {
       return;
     }
 
+    TaskRequest task_request;
+    new_resource_scheduler_->ResourceSetToTaskRequest(spec.GetRequiredResources(),
+                                                      &task_request);
     bool schedulable = new_resource_scheduler_->SubtractNodeAvailableResources(
-        self_node_id_.Binary(), spec.GetRequiredResources().GetResourceMap());
+        new_resource_scheduler_->GetLocalNodeId(), task_request);
     if (!schedulable) {
       return;
     }
@@ -1457,36 +1526,70 @@ void NodeManager::DispatchScheduledTasksToWorkers() {
   }
 }
 
+void NodeManager::ScheduleTaskBatch(
+    ClusterResourceScheduler &scheduler,
+    std::deque<std::pair<ScheduleFn, Task>> *tasks_to_schedule,
+    const std::function<void(std::pair<ScheduleFn, Task> &, int64_t)> &place_task) {
+  // Most of the requests in a batch share a few scheduling classes, so convert the
+  // resources of each class once.
+  absl::flat_hash_map<SchedulingClass, TaskRequest> class_task_requests;
+  std::vector<TaskRequest> task_requests;
+  task_requests.reserve(tasks_to_schedule->size());
+  for (const auto &work : *tasks_to_schedule) {
+    const auto &spec = work.second.GetTaskSpecification();
+    auto inserted = class_task_requests.emplace(spec.GetSchedulingClass(), TaskRequest());
+    if (inserted.second) {
+      scheduler.ResourceSetToTaskRequest(spec.GetRequiredResources(),
+                                         &inserted.first->second);
+    }
+    task_requests.push_back(inserted.first->second);
+  }
+  std::vector<int64_t> node_ids;
+  scheduler.GetBestSchedulableNodes(task_requests, &node_ids);
+
+  // Take the placed tasks out of the queue before handing them on, so that the queue
+  // may be changed while they are placed.
+  const int64_t local_node_id = scheduler.GetLocalNodeId();
+  std::deque<std::pair<ScheduleFn, Task>> unscheduled_tasks;
+  std::vector<std::pair<std::pair<ScheduleFn, Task>, int64_t>> placed_tasks;
+  for (size_t i = 0; i < node_ids.size(); i++) {
+    auto &work = (*tasks_to_schedule)[i];
+    if (node_ids[i] == -1) {
+      /// There is no node that has available resources to run the request.
+      unscheduled_tasks.push_back(std::move(work));
+      continue;
+    }
+    if (node_ids[i] == local_node_id) {
+      // The local resources are taken when the task is dispatched to a worker.
+      scheduler.AddNodeAvailableResources(node_ids[i], task_requests[i]);
+    }
+    placed_tasks.emplace_back(std::move(work), node_ids[i]);
+  }
+  tasks_to_schedule->swap(unscheduled_tasks);
+
+  for (auto &placed_task : placed_tasks) {
+    place_task(placed_task.first, placed_task.second);
+  }
+}
+
 void NodeManager::NewSchedulerSchedulePendingTasks() {
   RAY_CHECK(new_scheduler_enabled_);
-  while (!tasks_to_schedule_.empty()) {
-    auto work = tasks_to_schedule_.front();
-    auto task = work.second;
-    auto request_resources =
-        task.GetTaskSpecification().GetRequiredResources().GetResourceMap();
-    int64_t violations = 0;
-    std::string node_id_string =
-        new_resource_scheduler_->GetBestSchedulableNode(request_resources, &violations);
-    if (node_id_string.empty()) {
-      /// There is no node that has available resources to run the request.
-      break;
-    } else {
-      if (node_id_string == self_node_id_.Binary()) {
-        WaitForTaskArgsRequests(work);
-      } else {
-        new_resource_scheduler_->SubtractNodeAvailableResources(node_id_string,
-                                                                request_resources);
-        ClientID node_id = ClientID::FromBinary(node_id_string);
+  ScheduleTaskBatch(
+      *new_resource_scheduler_, &tasks_to_schedule_,
+      [this](std::pair<ScheduleFn, Task> &work, int64_t scheduler_node_id) {
+        if (scheduler_node_id == new_resource_scheduler_->GetLocalNodeId()) {
+          WaitForTaskArgsRequests(work);
+          return;
+        }
+        ClientID node_id = ClientID::FromBinary(
+            new_resource_scheduler_->GetNodeIdString(scheduler_node_id));
         auto node_info_opt = gcs_client_->Nodes().Get(node_id);
         RAY_CHECK(node_info_opt)
             << "Spilling back to a node manager, but no GCS info found for node "
             << node_id;
         work.first(nullptr, node_id, node_info_opt->node_manager_address(),
                    node_info_opt->node_manager_port());
-      }
-      tasks_to_schedule_.pop_front();
-    }
-  }
+      });
   DispatchScheduledTasksToWorkers();
 }
 
@@ -1683,6 +1786,57 @@ void NodeManager::HandleForwardTask(const rpc::ForwardTaskRequest &request,
   send_reply_callback(Status::OK(), nullptr, nullptr);
 }
 
+void NodeManager::HandleForwardTasks(const rpc::ForwardTasksRequest &request,
+                                     rpc::ForwardTasksReply *reply,
+                                     rpc::SendReplyCallback send_reply_callback) {
+  // Get the forwarded tasks and their uncommitted lineage from the request.
+  Lineage uncommitted_lineage;
+  for (int i = 0; i < request.uncommitted_tasks_size(); i++) {
+    Task task(request.uncommitted_tasks(i));
+    RAY_CHECK(uncommitted_lineage.SetEntry(task, GcsStatus::UNCOMMITTED));
+  }
+  RAY_LOG(DEBUG) << "Received " << request.task_ids_size()
+                 << " forwarded tasks on node " << self_node_id_;
+  for (const auto &task_id_binary : request.task_ids()) {
+    const TaskID task_id = TaskID::FromBinary(task_id_binary);
+    const Task &task = uncommitted_lineage.GetEntry(task_id)->TaskData();
+    SubmitTask(task, uncommitted_lineage, /* forwarded = */ true);
+  }
+  send_reply_callback(Status::OK(), nullptr, nullptr);
+}
+
+void NodeManager::HandleStealTasks(const rpc::StealTasksRequest &request,
+                                   rpc::StealTasksReply *reply,
+                                   rpc::SendReplyCallback send_reply_callback) {
+  const ClientID node_id = ClientID::FromBinary(request.node_id());
+  std::unordered_set<TaskID> task_ids;
+  if (!new_scheduler_enabled_ && node_id != self_node_id_ &&
+      remote_node_manager_clients_.count(node_id) > 0) {
+    // Tasks that a worker is being started for will be dispatched here soon.
+    task_ids = scheduling_policy_.ChooseTasksToHandOver(
+        ResourceSet(MapFromProtobuf(request.available_resources())), request.max_tasks(),
+        [this](const TaskSpecification &spec) {
+          return !worker_pool_.HasPendingWorkerForTask(spec.GetLanguage(),
+                                                       spec.TaskId());
+        });
+  }
+
+  std::vector<Task> tasks = local_queues_.RemoveTasks(task_ids);
+  for (const auto &task : tasks) {
+    // The dependencies of ready tasks are local, so we only stop tracking them here.
+    RAY_CHECK(task_dependency_manager_.UnsubscribeGetDependencies(
+        task.GetTaskSpecification().TaskId()));
+  }
+  reply->set_num_tasks(tasks.size());
+  if (!tasks.empty()) {
+    RAY_LOG(DEBUG) << "Node " << node_id << " stole " << tasks.size()
+                   << " ready tasks from node " << self_node_id_;
+    num_tasks_given_away_ += tasks.size();
+    ForwardTasksOrResubmit(tasks, node_id);
+  }
+  send_reply_callback(Status::OK(), nullptr, nullptr);
+}
+
 void NodeManager::ProcessSetResourceRequest(
     const std::shared_ptr<LocalClientConnection> &client, const uint8_t *message_data) {
   // Read the SetResource message
@@ -1743,6 +1897,8 @@ void NodeManager::ScheduleTasks(
 
   // Extract decision for this raylet.
   std::unordered_set<TaskID> local_task_ids;
+  // The tasks to forward to each remote node.
+  std::unordered_map<ClientID, std::vector<Task>> remote_tasks;
   // Iterate over (taskid, clientid) pairs, extract tasks assigned to the local node.
   for (const auto &task_client_pair : policy_decision) {
     const TaskID &task_id = task_client_pair.first;
@@ -1754,12 +1910,22 @@ void NodeManager::ScheduleTasks(
       // (See design_docs/task_states.rst for the state transition diagram.)
       Task task;
       if (local_queues_.RemoveTask(task_id, &task)) {
-        // Attempt to forward the task. If this fails to forward the task,
-        // the task will be resubmit locally.
-        ForwardTaskOrResubmit(task, node_id);
+        remote_tasks[node_id].push_back(std::move(task));
       }
     }
   }
+  // Attempt to forward the tasks, in batches per node. If this fails to forward a
+  // task, the task will be resubmit locally.
+  const size_t max_batch_size =
+      std::max<uint64_t>(RayConfig::instance().max_tasks_per_forward_batch(), 1);
+  for (auto &node_tasks : remote_tasks) {
+    auto &tasks = node_tasks.second;
+    for (size_t start = 0; start < tasks.size(); start += max_batch_size) {
+      const size_t end = std::min(tasks.size(), start + max_batch_size);
+      std::vector<Task> batch(tasks.begin() + start, tasks.begin() + end);
+      ForwardTasksOrResubmit(batch, node_tasks.first);
+    }
+  }
 
   // Transition locally placed tasks to waiting or ready for dispatch.
   if (local_task_ids.size() > 0) {
@@ -1808,6 +1974,119 @@ void NodeManager::ScheduleTasks(
   local_queues_.MoveTasks(move_task_set, TaskState::PLACEABLE, TaskState::INFEASIBLE);
   // Check the invariant that no placeable tasks remain after a call to the policy.
   RAY_CHECK(local_queues_.GetTasks(TaskState::PLACEABLE).size() == 0);
+
+  // The locations of arguments that no held task waits for were only needed to
+  // place the tasks above.
+  for (const auto &object_id : argument_location_tracker_.PopUnusedSubscriptions()) {
+    RAY_CHECK_OK(object_directory_->UnsubscribeObjectLocations(
+        argument_locations_callback_id_, object_id));
+  }
+}
+
+void NodeManager::QueuePlaceableTask(const Task &task) {
+  const TaskSpecification &spec = task.GetTaskSpecification();
+  if (locality_aware_scheduling_enabled_) {
+    // Subscribe to the locations of the arguments that are neither local nor
+    // already known, and hold the task until they are.
+    std::unordered_set<ObjectID> pending_object_ids;
+    std::unordered_set<ClientID> node_ids;
+    uint64_t object_size = 0;
+    for (size_t i = 0; i < spec.NumArgs(); i++) {
+      if (!spec.ArgByRef(i)) {
+        continue;
+      }
+      for (size_t j = 0; j < spec.ArgIdCount(i); j++) {
+        const ObjectID object_id = spec.ArgId(i, j);
+        if (pending_object_ids.count(object_id) > 0 ||
+            object_manager_.GetLocalObjectSize(object_id, &object_size) ||
+            object_directory_->GetCachedLocations(object_id, &node_ids, &object_size)) {
+          continue;
+        }
+        pending_object_ids.insert(object_id);
+      }
+    }
+    if (!pending_object_ids.empty()) {
+      std::vector<ObjectID> new_object_ids;
+      if (!argument_location_tracker_.HoldTask(task, pending_object_ids,
+                                               &new_object_ids)) {
+        RAY_LOG(WARNING) << "Submitted task " << spec.TaskId()
+                         << " is already held until the locations of its arguments "
+                            "are known.";
+        return;
+      }
+      for (const auto &object_id : new_object_ids) {
+        RAY_CHECK_OK(object_directory_->SubscribeObjectLocations(
+            argument_locations_callback_id_, object_id,
+            [this](const ObjectID &object_id,
+                   const std::unordered_set<ClientID> &node_ids) {
+              HandleArgumentLocationsKnown(object_id);
+            }));
+      }
+      return;
+    }
+  }
+
+  // (See design_docs/task_states.rst for the state transition diagram.)
+  local_queues_.QueueTasks({task}, TaskState::PLACEABLE);
+  if (batch_placement_enabled_) {
+    // Place the task along with the other tasks submitted in this iteration of
+    // the event loop.
+    PostScheduleTasks();
+  } else {
+    ScheduleTasks(cluster_resource_map_);
+  }
+}
+
+void NodeManager::HandleArgumentLocationsKnown(const ObjectID &object_id) {
+  std::vector<Task> released_tasks =
+      argument_location_tracker_.HandleLocationsKnown(object_id);
+  if (released_tasks.empty()) {
+    return;
+  }
+  local_queues_.QueueTasks(released_tasks, TaskState::PLACEABLE);
+  if (batch_placement_enabled_) {
+    PostScheduleTasks();
+  } else {
+    ScheduleTasks(cluster_resource_map_);
+  }
+}
+
+void NodeManager::GetArgumentLocality(
+    const TaskSpecification &spec,
+    std::unordered_map<ClientID, uint64_t> *bytes_by_node) const {
+  std::unordered_set<ClientID> node_ids;
+  for (size_t i = 0; i < spec.NumArgs(); i++) {
+    if (!spec.ArgByRef(i)) {
+      continue;
+    }
+    for (size_t j = 0; j < spec.ArgIdCount(i); j++) {
+      const ObjectID object_id = spec.ArgId(i, j);
+      uint64_t object_size = 0;
+      if (object_manager_.GetLocalObjectSize(object_id, &object_size)) {
+        (*bytes_by_node)[self_node_id_] += object_size;
+      }
+      // The remote locations are only known for objects whose locations this node
+      // is subscribed to, e.g., because it is pulling them.
+      if (object_directory_->GetCachedLocations(object_id, &node_ids, &object_size)) {
+        for (const auto &node_id : node_ids) {
+          if (node_id != self_node_id_) {
+            (*bytes_by_node)[node_id] += object_size;
+          }
+        }
+      }
+    }
+  }
+}
+
+void NodeManager::PostScheduleTasks() {
+  if (schedule_tasks_posted_) {
+    return;
+  }
+  schedule_tasks_posted_ = true;
+  io_service_.post([this]() {
+    schedule_tasks_posted_ = false;
+    ScheduleTasks(cluster_resource_map_);
+  });
 }
 
 bool NodeManager::CheckDependencyManagerInvariant() const {
@@ -1923,7 +2202,7 @@ void NodeManager::SubmitTask(const Task &task, const Lineage &uncommitted_lineag
   const TaskID &task_id = spec.TaskId();
   RAY_LOG(DEBUG) << "Submitting task: " << task.DebugString();
 
-  if (local_queues_.HasTask(task_id)) {
+  if (local_queues_.HasTask(task_id) || argument_location_tracker_.HasTask(task_id)) {
     RAY_LOG(WARNING) << "Submitted task " << task_id
                      << " is already queued and will not be reconstructed. This is most "
                         "likely due to spurious reconstruction.";
@@ -2032,9 +2311,7 @@ void NodeManager::SubmitTask(const Task &task, const Lineage &uncommitted_lineag
       // Check for local dependencies and enqueue as waiting or ready for dispatch.
       EnqueuePlaceableTask(task);
     } else {
-      // (See design_docs/task_states.rst for the state transition diagram.)
-      local_queues_.QueueTasks({task}, TaskState::PLACEABLE);
-      ScheduleTasks(cluster_resource_map_);
+      QueuePlaceableTask(task);
       // TODO(atumanov): assert that !placeable.isempty() => insufficient available
       // resources locally.
     }
@@ -2065,7 +2342,7 @@ void NodeManager::HandleDirectCallTaskBlocked(const std::shared_ptr<Worker> &wor
   local_available_resources_.Release(cpu_resource_ids);
   cluster_resource_map_[self_node_id_].Release(cpu_resource_ids.ToResourceSet());
   worker->MarkBlocked();
-  DispatchTasks(local_queues_.GetReadyTasksByClass());
+  DispatchTasks();
 }
 
 void NodeManager::HandleDirectCallTaskUnblocked(const std::shared_ptr<Worker> &worker) {
@@ -2146,7 +2423,7 @@ void NodeManager::AsyncResolveObjects(
       cluster_resource_map_[self_node_id_].Release(cpu_resource_ids.ToResourceSet());
       worker->MarkBlocked();
       // Try dispatching tasks since we may have released some resources.
-      DispatchTasks(local_queues_.GetReadyTasksByClass());
+      DispatchTasks();
     }
   } else {
     // The client is a driver. Drivers do not hold resources, so we simply mark
@@ -2171,7 +2448,7 @@ void NodeManager::AsyncResolveObjects(
     // HandleDirectCallUnblocked.
     task_dependency_manager_.SubscribeGetDependencies(
         mark_worker_blocked ? current_task_id : worker->GetAssignedTaskId(),
-        required_object_ids);
+        required_object_ids, PullPriority::GET);
   } else {
     task_dependency_manager_.SubscribeWaitDependencies(worker->WorkerId(),
                                                        required_object_ids);
@@ -2251,7 +2528,7 @@ void NodeManager::EnqueuePlaceableTask(const Task &task) {
   // (See design_docs/task_states.rst for the state transition diagram.)
   if (args_ready) {
     local_queues_.QueueTasks({task}, TaskState::READY);
-    DispatchTasks(MakeTasksByClass({task}));
+    DispatchTasks();
   } else {
     local_queues_.QueueTasks({task}, TaskState::WAITING);
   }
@@ -2718,7 +2995,7 @@ void NodeManager::HandleObjectLocal(const ObjectID &object_id) {
     // Queue and dispatch the tasks that are ready to run (i.e., WAITING).
     auto ready_tasks = local_queues_.RemoveTasks(ready_task_id_set);
     local_queues_.QueueTasks(ready_tasks, TaskState::READY);
-    DispatchTasks(MakeTasksByClass(ready_tasks));
+    DispatchTasks();
   }
 }
 
@@ -2794,59 +3071,125 @@ void NodeManager::HandleObjectMissing(const ObjectID &object_id) {
 
 void NodeManager::ForwardTaskOrResubmit(const Task &task,
                                         const ClientID &node_manager_id) {
+  ForwardTasksOrResubmit({task}, node_manager_id);
+}
+
+void NodeManager::ForwardTasksOrResubmit(const std::vector<Task> &tasks,
+                                         const ClientID &node_manager_id) {
   /// TODO(rkn): Should we check that the node manager is remote and not local?
   /// TODO(rkn): Should we check if the remote node manager is known to be dead?
-  // Attempt to forward the task.
-  ForwardTask(
-      task, node_manager_id,
-      [this, node_manager_id](ray::Status error, const Task &task) {
-        const TaskID task_id = task.GetTaskSpecification().TaskId();
-        RAY_LOG(INFO) << "Failed to forward task " << task_id << " to node manager "
-                      << node_manager_id;
-
-        // Mark the failed task as pending to let other raylets know that we still
-        // have the task. TaskDependencyManager::TaskPending() is assumed to be
-        // idempotent.
-        task_dependency_manager_.TaskPending(task);
-
-        // Actor tasks can only be executed at the actor's location, so they are
-        // retried after a timeout. All other tasks that fail to be forwarded are
-        // deemed to be placeable again.
-        if (task.GetTaskSpecification().IsActorTask()) {
-          // The task is for an actor on another node.  Create a timer to resubmit
-          // the task in a little bit. TODO(rkn): Really this should be a
-          // unique_ptr instead of a shared_ptr. However, it's a little harder to
-          // move unique_ptrs into lambdas.
-          auto retry_timer = std::make_shared<boost::asio::deadline_timer>(io_service_);
-          auto retry_duration = boost::posix_time::milliseconds(
-              RayConfig::instance()
-                  .node_manager_forward_task_retry_timeout_milliseconds());
-          retry_timer->expires_from_now(retry_duration);
-          retry_timer->async_wait(
-              [this, task_id, retry_timer](const boost::system::error_code &error) {
-                // Timer killing will receive the boost::asio::error::operation_aborted,
-                // we only handle the timeout event.
-                RAY_CHECK(!error);
-                RAY_LOG(INFO) << "Resubmitting task " << task_id
-                              << " because ForwardTask failed.";
-                // Remove the RESUBMITTED task from the SWAP queue.
-                Task task;
-                TaskState state;
-                if (local_queues_.RemoveTask(task_id, &task, &state)) {
-                  RAY_CHECK(state == TaskState::SWAP);
-                  // Submit the task again.
-                  SubmitTask(task, Lineage());
-                }
-              });
-          // Temporarily move the RESUBMITTED task to the SWAP queue while the
-          // timer is active.
-          local_queues_.QueueTasks({task}, TaskState::SWAP);
-        } else {
-          // The task is not for an actor and may therefore be placed on another
-          // node immediately. Send it to the scheduling policy to be placed again.
-          local_queues_.QueueTasks({task}, TaskState::PLACEABLE);
-          ScheduleTasks(cluster_resource_map_);
+  auto on_error = [this, node_manager_id](ray::Status error, const Task &task) {
+    const TaskID task_id = task.GetTaskSpecification().TaskId();
+    RAY_LOG(INFO) << "Failed to forward task " << task_id << " to node manager "
+                  << node_manager_id;
+
+    // Mark the failed task as pending to let other raylets know that we still
+    // have the task. TaskDependencyManager::TaskPending() is assumed to be
+    // idempotent.
+    task_dependency_manager_.TaskPending(task);
+
+    // Actor tasks can only be executed at the actor's location, so they are
+    // retried after a timeout. All other tasks that fail to be forwarded are
+    // deemed to be placeable again.
+    if (task.GetTaskSpecification().IsActorTask()) {
+      // The task is for an actor on another node.  Create a timer to resubmit
+      // the task in a little bit. TODO(rkn): Really this should be a
+      // unique_ptr instead of a shared_ptr. However, it's a little harder to
+      // move unique_ptrs into lambdas.
+      auto retry_timer = std::make_shared<boost::asio::deadline_timer>(io_service_);
+      auto retry_duration = boost::posix_time::milliseconds(
+          RayConfig::instance().node_manager_forward_task_retry_timeout_milliseconds());
+      retry_timer->expires_from_now(retry_duration);
+      retry_timer->async_wait(
+          [this, task_id, retry_timer](const boost::system::error_code &error) {
+            // Timer killing will receive the boost::asio::error::operation_aborted,
+            // we only handle the timeout event.
+            RAY_CHECK(!error);
+            RAY_LOG(INFO) << "Resubmitting task " << task_id
+                          << " because ForwardTask failed.";
+            // Remove the RESUBMITTED task from the SWAP queue.
+            Task task;
+            TaskState state;
+            if (local_queues_.RemoveTask(task_id, &task, &state)) {
+              RAY_CHECK(state == TaskState::SWAP);
+              // Submit the task again.
+              SubmitTask(task, Lineage());
+            }
+          });
+      // Temporarily move the RESUBMITTED task to the SWAP queue while the
+      // timer is active.
+      local_queues_.QueueTasks({task}, TaskState::SWAP);
+    } else {
+      // The task is not for an actor and may therefore be placed on another
+      // node immediately. Send it to the scheduling policy to be placed again.
+      local_queues_.QueueTasks({task}, TaskState::PLACEABLE);
+      if (batch_placement_enabled_) {
+        PostScheduleTasks();
+      } else {
+        ScheduleTasks(cluster_resource_map_);
+      }
+    }
+  };
+  // Attempt to forward the tasks.
+  if (tasks.size() == 1) {
+    ForwardTask(tasks.front(), node_manager_id, on_error);
+  } else {
+    ForwardTasks(tasks, node_manager_id, on_error);
+  }
+}
+
+void NodeManager::TryStealTasks() {
+  if (!work_stealing_enabled_ || new_scheduler_enabled_ || steal_request_pending_) {
+    return;
+  }
+  // Only steal when there is nothing left to run or to place on this node.
+  if (!local_queues_.GetTasks(TaskState::READY).empty() ||
+      !local_queues_.GetTasks(TaskState::PLACEABLE).empty()) {
+    return;
+  }
+  const uint64_t now_ms = current_time_ms();
+  if (now_ms - last_steal_attempt_at_ms_ <
+      RayConfig::instance().work_stealing_min_interval_ms()) {
+    return;
+  }
+  const ResourceSet &available_resources =
+      cluster_resource_map_[self_node_id_].GetAvailableResources();
+  if (available_resources.IsEmpty()) {
+    return;
+  }
+
+  // Ask the remote node with the most load on the resources that are available here.
+  const ClientID victim_id = scheduling_policy_.ChooseStealVictim(
+      cluster_resource_map_, self_node_id_, [this](const ClientID &node_id) {
+        return remote_node_manager_clients_.count(node_id) > 0 &&
+               steal_exhausted_nodes_.count(node_id) == 0;
+      });
+  if (victim_id.IsNil()) {
+    return;
+  }
+
+  rpc::StealTasksRequest request;
+  request.set_node_id(self_node_id_.Binary());
+  for (const auto &resource_pair : available_resources.GetResourceMap()) {
+    (*request.mutable_available_resources())[resource_pair.first] = resource_pair.second;
+  }
+  request.set_max_tasks(RayConfig::instance().work_stealing_max_tasks());
+  last_steal_attempt_at_ms_ = now_ms;
+  steal_request_pending_ = true;
+  remote_node_manager_clients_[victim_id]->StealTasks(
+      request,
+      [this, victim_id](const Status &status, const rpc::StealTasksReply &reply) {
+        steal_request_pending_ = false;
+        if (!status.ok() || reply.num_tasks() == 0) {
+          // Don't ask the node again until its next heartbeat reports its load.
+          if (cluster_resource_map_.count(victim_id) > 0) {
+            steal_exhausted_nodes_.insert(victim_id);
+          }
+          return;
         }
+        RAY_LOG(DEBUG) << "Stole " << reply.num_tasks() << " ready tasks from node "
+                       << victim_id;
+        num_tasks_stolen_ += reply.num_tasks();
       });
 }
 
@@ -2873,80 +3216,171 @@ void NodeManager::ForwardTask(
   }
   auto &client = client_entry->second;
 
+  const TaskID task_id = task.GetTaskSpecification().TaskId();
+  Lineage uncommitted_lineage;
+  if (!PrepareForwardTask(task, node_id, &uncommitted_lineage)) {
+    return;
+  }
+
+  // Prepare the request message.
+  rpc::ForwardTaskRequest request;
+  request.set_task_id(task_id.Binary());
+  for (auto &task_entry : uncommitted_lineage.GetEntries()) {
+    auto task = request.add_uncommitted_tasks();
+    task->mutable_task_spec()->CopyFrom(
+        task_entry.second.TaskData().GetTaskSpecification().GetMessage());
+    task->mutable_task_execution_spec()->CopyFrom(
+        task_entry.second.TaskData().GetTaskExecutionSpec().GetMessage());
+  }
+
+  client->ForwardTask(request, [this, on_error, task, node_id](
+                                   Status status, const rpc::ForwardTaskReply &reply) {
+    HandleForwardTaskReply(task, node_id, status, on_error);
+  });
+}
+
+void NodeManager::ForwardTasks(
+    const std::vector<Task> &tasks, const ClientID &node_id,
+    const std::function<void(const ray::Status &, const Task &)> &on_error) {
+  std::vector<Task> forwarded_tasks;
+  for (const auto &task : tasks) {
+    // Override spillback for direct tasks.
+    if (task.OnSpillback() != nullptr) {
+      ForwardTask(task, node_id, on_error);
+    } else {
+      forwarded_tasks.push_back(task);
+    }
+  }
+
+  // Lookup node manager client for this node_id and use it to send the request.
+  auto client_entry = remote_node_manager_clients_.find(node_id);
+  if (client_entry == remote_node_manager_clients_.end()) {
+    RAY_LOG(INFO) << "No node manager client found for GCS client id " << node_id;
+    for (const auto &task : forwarded_tasks) {
+      on_error(ray::Status::IOError("Node manager client not found"), task);
+    }
+    return;
+  }
+  auto &client = client_entry->second;
+
+  // Prepare the request message. The forwarded tasks come first, so that their
+  // entries, which count the forward, are sent instead of copies from the lineage
+  // of other tasks in the batch.
+  std::vector<Lineage> uncommitted_lineages(forwarded_tasks.size());
+  std::unordered_set<TaskID> sent_task_ids;
+  rpc::ForwardTasksRequest request;
+  auto add_task = [&request](const Task &task) {
+    auto task_message = request.add_uncommitted_tasks();
+    task_message->mutable_task_spec()->CopyFrom(task.GetTaskSpecification().GetMessage());
+    task_message->mutable_task_execution_spec()->CopyFrom(
+        task.GetTaskExecutionSpec().GetMessage());
+  };
+  auto task_it = forwarded_tasks.begin();
+  auto lineage_it = uncommitted_lineages.begin();
+  while (task_it != forwarded_tasks.end()) {
+    if (!PrepareForwardTask(*task_it, node_id, &*lineage_it)) {
+      task_it = forwarded_tasks.erase(task_it);
+      lineage_it = uncommitted_lineages.erase(lineage_it);
+      continue;
+    }
+    const TaskID task_id = task_it->GetTaskSpecification().TaskId();
+    request.add_task_ids(task_id.Binary());
+    sent_task_ids.insert(task_id);
+    add_task(lineage_it->GetEntry(task_id)->TaskData());
+    ++task_it;
+    ++lineage_it;
+  }
+  if (forwarded_tasks.empty()) {
+    return;
+  }
+  for (const auto &uncommitted_lineage : uncommitted_lineages) {
+    for (const auto &task_entry : uncommitted_lineage.GetEntries()) {
+      if (sent_task_ids.insert(task_entry.first).second) {
+        add_task(task_entry.second.TaskData());
+      }
+    }
+  }
+  RAY_LOG(DEBUG) << "Forwarding " << forwarded_tasks.size() << " tasks from "
+                 << self_node_id_ << " to " << node_id << " with "
+                 << request.uncommitted_tasks_size() << " uncommitted tasks";
+
+  client->ForwardTasks(
+      request, [this, on_error, forwarded_tasks, node_id](
+                   Status status, const rpc::ForwardTasksReply &reply) {
+        for (const auto &task : forwarded_tasks) {
+          HandleForwardTaskReply(task, node_id, status, on_error);
+        }
+      });
+}
+
+bool NodeManager::PrepareForwardTask(const Task &task, const ClientID &node_id,
+                                     Lineage *uncommitted_lineage) {
   const auto &spec = task.GetTaskSpecification();
   auto task_id = spec.TaskId();
 
   if (worker_pool_.HasPendingWorkerForTask(spec.GetLanguage(), task_id)) {
     // There is a worker being starting for this task,
     // so we shouldn't forward this task to another node.
-    return;
+    return false;
   }
 
   // Get the task's unforwarded, uncommitted lineage.
-  Lineage uncommitted_lineage = lineage_cache_.GetUncommittedLineage(task_id, node_id);
-  if (uncommitted_lineage.GetEntries().empty()) {
+  *uncommitted_lineage = lineage_cache_.GetUncommittedLineage(task_id, node_id);
+  if (uncommitted_lineage->GetEntries().empty()) {
     // There is no uncommitted lineage. This can happen if the lineage was
     // already evicted before we forwarded the task.
-    uncommitted_lineage.SetEntry(task, GcsStatus::NONE);
+    uncommitted_lineage->SetEntry(task, GcsStatus::NONE);
   }
-  auto entry = uncommitted_lineage.GetEntryMutable(task_id);
+  auto entry = uncommitted_lineage->GetEntryMutable(task_id);
   Task &lineage_cache_entry_task = entry->TaskDataMutable();
   // Increment forward count for the forwarded task.
   lineage_cache_entry_task.IncrementNumForwards();
   RAY_LOG(DEBUG) << "Forwarding task " << task_id << " from " << self_node_id_ << " to "
                  << node_id << " spillback="
                  << lineage_cache_entry_task.GetTaskExecutionSpec().NumForwards();
+  return true;
+}
 
-  // Prepare the request message.
-  rpc::ForwardTaskRequest request;
-  request.set_task_id(task_id.Binary());
-  for (auto &task_entry : uncommitted_lineage.GetEntries()) {
-    auto task = request.add_uncommitted_tasks();
-    task->mutable_task_spec()->CopyFrom(
-        task_entry.second.TaskData().GetTaskSpecification().GetMessage());
-    task->mutable_task_execution_spec()->CopyFrom(
-        task_entry.second.TaskData().GetTaskExecutionSpec().GetMessage());
+void NodeManager::HandleForwardTaskReply(
+    const Task &task, const ClientID &node_id, const Status &status,
+    const std::function<void(const ray::Status &, const Task &)> &on_error) {
+  const auto &spec = task.GetTaskSpecification();
+  const TaskID task_id = spec.TaskId();
+  if (local_queues_.HasTask(task_id)) {
+    // It must have been forwarded back to us if it's in the queue again
+    // so just return here.
+    return;
   }
 
-  client->ForwardTask(request, [this, on_error, task, task_id, node_id](
-                                   Status status, const rpc::ForwardTaskReply &reply) {
-    if (local_queues_.HasTask(task_id)) {
-      // It must have been forwarded back to us if it's in the queue again
-      // so just return here.
-      return;
-    }
-
-    if (status.ok()) {
-      const auto &spec = task.GetTaskSpecification();
-      // Mark as forwarded so that the task and its lineage are not
-      // re-forwarded in the future to the receiving node.
-      lineage_cache_.MarkTaskAsForwarded(task_id, node_id);
-
-      // Notify the task dependency manager that we are no longer responsible
-      // for executing this task.
-      task_dependency_manager_.TaskCanceled(task_id);
-      // Preemptively push any local arguments to the receiving node. For now, we
-      // only do this with actor tasks, since actor tasks must be executed by a
-      // specific process and therefore have affinity to the receiving node.
-      if (spec.IsActorTask()) {
-        // Iterate through the object's arguments. NOTE(swang): We do not include
-        // the execution dependencies here since those cannot be transferred
-        // between nodes.
-        for (size_t i = 0; i < spec.NumArgs(); ++i) {
-          int count = spec.ArgIdCount(i);
-          for (int j = 0; j < count; j++) {
-            ObjectID argument_id = spec.ArgId(i, j);
-            // If the argument is local, then push it to the receiving node.
-            if (task_dependency_manager_.CheckObjectLocal(argument_id)) {
-              object_manager_.Push(argument_id, node_id);
-            }
+  if (status.ok()) {
+    // Mark as forwarded so that the task and its lineage are not
+    // re-forwarded in the future to the receiving node.
+    lineage_cache_.MarkTaskAsForwarded(task_id, node_id);
+
+    // Notify the task dependency manager that we are no longer responsible
+    // for executing this task.
+    task_dependency_manager_.TaskCanceled(task_id);
+    // Preemptively push any local arguments to the receiving node. For now, we
+    // only do this with actor tasks, since actor tasks must be executed by a
+    // specific process and therefore have affinity to the receiving node.
+    if (spec.IsActorTask()) {
+      // Iterate through the object's arguments. NOTE(swang): We do not include
+      // the execution dependencies here since those cannot be transferred
+      // between nodes.
+      for (size_t i = 0; i < spec.NumArgs(); ++i) {
+        int count = spec.ArgIdCount(i);
+        for (int j = 0; j < count; j++) {
+          ObjectID argument_id = spec.ArgId(i, j);
+          // If the argument is local, then push it to the receiving node.
+          if (task_dependency_manager_.CheckObjectLocal(argument_id)) {
+            object_manager_.Push(argument_id, node_id);
           }
         }
       }
-    } else {
-      on_error(status, task);
     }
-  });
+  } else {
+    on_error(status, task);
+  }
 }
 
 void NodeManager::FinishAssignTask(const std::shared_ptr<Worker> &worker,
@@ -2986,7 +3420,7 @@ void NodeManager::FinishAssignTask(const std::shared_ptr<Worker> &worker,
     // assigned to a worker once one becomes available.
     // (See design_docs/task_states.rst for the state transition diagram.)
     local_queues_.QueueTasks({assigned_task}, TaskState::READY);
-    DispatchTasks(MakeTasksByClass({assigned_task}));
+    DispatchTasks();
   }
 }
 
@@ -3016,6 +3450,11 @@ std::string NodeManager::DebugString() const {
   result << "\n" << reconstruction_policy_.DebugString();
   result << "\n" << task_dependency_manager_.DebugString();
   result << "\n" << lineage_cache_.DebugString();
+  if (object_spiller_ != nullptr) {
+    result << "\n" << object_spiller_->DebugString();
+    result << "\n- num pinned objects: " << pinned_objects_.size();
+    result << "\n- num objects being restored: " << restoring_objects_.size();
+  }
   result << "\nActorRegistry:";
 
   auto statistical_data = GetActorStatisticalData(actor_registry_);
@@ -3024,6 +3463,19 @@ std::string NodeManager::DebugString() const {
   result << "\n- num dead actors: " << statistical_data.dead_actors;
   result << "\n- max num handles: " << statistical_data.max_num_handles;
 
+  if (work_stealing_enabled_) {
+    result << "\nWorkStealing:";
+    result << "\n- num tasks stolen from other nodes: " << num_tasks_stolen_;
+    result << "\n- num tasks stolen by other nodes: " << num_tasks_given_away_;
+  }
+  if (locality_aware_scheduling_enabled_) {
+    result << "\nLocalityAwareScheduling:";
+    result << "\n- num tasks awaiting argument locations: "
+           << argument_location_tracker_.NumHeldTasks();
+    result << "\n- num argument location subscriptions: "
+           << argument_location_tracker_.NumSubscriptions();
+  }
+
   result << "\nRemote node manager clients: ";
   for (const auto &entry : remote_node_manager_clients_) {
     result << "\n" << entry.first;
@@ -3093,11 +3545,18 @@ void NodeManager::HandlePinObjectIDs(const rpc::PinObjectIDsRequest &request,
     ObjectID object_id = ObjectID::FromBinary(object_id_binary);
 
     RAY_LOG(DEBUG) << "Pinning object " << object_id;
-    pinned_objects_.emplace(
-        object_id, std::unique_ptr<RayObject>(new RayObject(
-                       std::make_shared<PlasmaBuffer>(plasma_results[i].data),
-                       std::make_shared<PlasmaBuffer>(plasma_results[i].metadata))));
+    auto object = std::unique_ptr<RayObject>(
+        new RayObject(std::make_shared<PlasmaBuffer>(plasma_results[i].data),
+                      std::make_shared<PlasmaBuffer>(plasma_results[i].metadata)));
     i++;
+    uint64_t object_size = object->GetSize();
+    if (pinned_objects_.emplace(object_id, std::move(object)).second) {
+      pinned_object_bytes_ += object_size;
+      if (object_spiller_ != nullptr) {
+        spill_candidates_.push_back(object_id);
+        spill_candidate_bytes_ += object_size;
+      }
+    }
 
     // Send a long-running RPC request to the owner for each object. When we get a
     // response or the RPC fails (due to the owner crashing), unpin the object.
@@ -3112,8 +3571,7 @@ void NodeManager::HandlePinObjectIDs(const rpc::PinObjectIDsRequest &request,
             RAY_LOG(WARNING) << "Worker " << worker_id << " failed. Unpinning object "
                              << object_id;
           }
-          RAY_LOG(DEBUG) << "Unpinning object " << object_id;
-          pinned_objects_.erase(object_id);
+          UnpinObject(object_id);
 
           // Remove the cached worker client if there are no more pending requests.
           if (--worker_rpc_clients_[worker_id].second == 0) {
@@ -3121,9 +3579,102 @@ void NodeManager::HandlePinObjectIDs(const rpc::PinObjectIDsRequest &request,
           }
         }));
   }
+  object_manager_.SetPinnedObjectBytes(pinned_object_bytes_);
+  if (object_spiller_ != nullptr) {
+    SpillObjectsIfNeeded();
+  }
   send_reply_callback(Status::OK(), nullptr, nullptr);
 }
 
+void NodeManager::UnpinObject(const ObjectID &object_id) {
+  RAY_LOG(DEBUG) << "Unpinning object " << object_id;
+  if (spill_candidates_.count(object_id) != 0) {
+    spill_candidates_.erase(object_id);
+    spill_candidate_bytes_ -= pinned_objects_.at(object_id)->GetSize();
+  }
+  ErasePinnedObject(object_id);
+  if (object_spiller_ != nullptr) {
+    object_spiller_->DeleteSpilledObject(object_id);
+  }
+}
+
+void NodeManager::SpillObjectsIfNeeded() {
+  while (spill_candidate_bytes_ > spill_threshold_bytes_) {
+    const ObjectID object_id = spill_candidates_.front();
+    spill_candidates_.pop_front();
+    const auto &object = pinned_objects_.at(object_id);
+    spill_candidate_bytes_ -= object->GetSize();
+    const auto data = object->GetData();
+    const auto metadata = object->GetMetadata();
+    RAY_LOG(DEBUG) << "Spilling object " << object_id;
+    // Hold references to the buffers until the object is written, in case the
+    // object is unpinned meanwhile.
+    object_spiller_->SpillObject(
+        object_id, data->Data(), data->Size(), metadata->Data(), metadata->Size(),
+        [this, object_id, data, metadata](const Status &status) {
+          if (!status.ok()) {
+            // Keep the object pinned. It isn't spilled again, so that a full disk
+            // doesn't make us retry forever.
+            return;
+          }
+          // The object can be restored from disk now, so let the object store
+          // evict it.
+          ErasePinnedObject(object_id);
+        });
+  }
+}
+
+void NodeManager::ErasePinnedObject(const ObjectID &object_id) {
+  auto it = pinned_objects_.find(object_id);
+  if (it == pinned_objects_.end()) {
+    return;
+  }
+  pinned_object_bytes_ -= it->second->GetSize();
+  pinned_objects_.erase(it);
+  object_manager_.SetPinnedObjectBytes(pinned_object_bytes_);
+}
+
+bool NodeManager::RestoreSpilledObject(const ObjectID &object_id) {
+  if (restoring_objects_.count(object_id) != 0) {
+    return true;
+  }
+  uint64_t data_size;
+  std::string metadata;
+  if (!object_spiller_->GetSpilledObject(object_id, &data_size, &metadata)) {
+    return false;
+  }
+  const auto plasma_id = object_id.ToPlasmaId();
+  std::shared_ptr<arrow::Buffer> data;
+  arrow::Status status =
+      store_client_.Create(plasma_id, data_size,
+                           reinterpret_cast<const uint8_t *>(metadata.data()),
+                           metadata.size(), &data);
+  if (!status.ok()) {
+    RAY_LOG(WARNING) << "Failed to create object " << object_id
+                     << " to restore it from disk: " << status.ToString();
+    return false;
+  }
+  RAY_LOG(DEBUG) << "Restoring object " << object_id;
+  restoring_objects_.insert(object_id);
+  object_spiller_->RestoreObject(
+      object_id, data->mutable_data(),
+      [this, object_id, plasma_id, data](const Status &status) {
+        restoring_objects_.erase(object_id);
+        if (status.ok()) {
+          // Sealing the object notifies the object manager that it is local.
+          RAY_ARROW_CHECK_OK(store_client_.Seal(plasma_id));
+          RAY_ARROW_CHECK_OK(store_client_.Release(plasma_id));
+          return;
+        }
+        RAY_ARROW_CHECK_OK(store_client_.Release(plasma_id));
+        RAY_ARROW_CHECK_OK(store_client_.Abort(plasma_id));
+        // The spiller forgot the object, so fall back to pulling it from another
+        // node, or to reconstructing it if there is no other copy.
+        RAY_CHECK_OK(object_manager_.Pull(object_id, PullPriority::GET));
+      });
+  return true;
+}
+
 void NodeManager::HandleGetNodeStats(const rpc::GetNodeStatsRequest &request,
                                      rpc::GetNodeStatsReply *reply,
                                      rpc::SendReplyCallback send_reply_callback) {
@@ -3232,9 +3783,13 @@ void NodeManager::RecordMetrics() {
   object_manager_.RecordMetrics();
   worker_pool_.RecordMetrics();
   local_queues_.RecordMetrics();
+  scheduling_policy_.RecordMetrics();
   reconstruction_policy_.RecordMetrics();
   task_dependency_manager_.RecordMetrics();
   lineage_cache_.RecordMetrics();
+  if (object_spiller_ != nullptr) {
+    object_spiller_->RecordMetrics();
+  }
 
   auto statistical_data = GetActorStatisticalData(actor_registry_);
   stats::ActorStats().Record(statistical_data.live_actors,
@@ -16,7 +16,10 @@
 #include "ray/common/scheduling/cluster_resource_scheduler.h"
 #include "ray/object_manager/object_manager.h"
 #include "ray/raylet/actor_registration.h"
+#include "ray/raylet/argument_location_tracker.h"
+#include "ray/raylet/heartbeat_delta.h"
 #include "ray/raylet/lineage_cache.h"
+#include "ray/raylet/local_object_spiller.h"
 #include "ray/raylet/scheduling_policy.h"
 #include "ray/raylet/scheduling_queue.h"
 #include "ray/raylet/reconstruction_policy.h"
@@ -59,6 +62,12 @@ struct NodeManagerConfig {
   bool fair_queueing_enabled;
   /// Whether to enable pinning for plasma objects.
   bool object_pinning_enabled;
+  /// Whether to spill pinned objects to local disk when the object store fills up.
+  bool object_spilling_enabled = false;
+  /// The directory to spill objects to.
+  std::string object_spilling_directory;
+  /// The capacity of the object store in bytes, or 0 if unknown.
+  int64_t object_store_memory = 0;
   /// the maximum lineage size.
   uint64_t max_lineage_size;
   /// The store socket name.
@@ -71,6 +80,12 @@ struct NodeManagerConfig {
 
 class NodeManager : public rpc::NodeManagerServiceHandler {
  public:
+  /// Replies to a worker lease request, with either a worker of this node or the node
+  /// to retry the request at.
+  typedef std::function<void(std::shared_ptr<Worker>, ClientID spillback_to,
+                             std::string address, int port)>
+      ScheduleFn;
+
   /// Create a node manager.
   ///
   /// \param resource_config The initial set of node resources.
@@ -116,6 +131,23 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   /// Get the port of the node manager rpc server.
   int GetServerPort() const { return node_manager_server_.GetPort(); }
 
+  /// Place a batch of pending lease requests in one pass over the cluster. Requests
+  /// that no node can run stay queued in order, without blocking the requests behind
+  /// them. The resources of the requests placed on the local node are given back
+  /// after the batch, since they are taken when a request is dispatched to a worker.
+  /// The resource requests are converted once per scheduling class, and the nodes
+  /// are passed on by their integer IDs in the scheduler.
+  ///
+  /// \param scheduler The cluster resource scheduler.
+  /// \param tasks_to_schedule The pending requests. The placed requests are removed.
+  /// \param place_task Called with each placed request and the integer ID of its
+  /// node. The local node is the scheduler's `GetLocalNodeId`.
+  /// \return Void.
+  static void ScheduleTaskBatch(
+      ClusterResourceScheduler &scheduler,
+      std::deque<std::pair<ScheduleFn, Task>> *tasks_to_schedule,
+      const std::function<void(std::pair<ScheduleFn, Task> &, int64_t)> &place_task);
+
  private:
   /// Methods for handling clients.
 
@@ -271,6 +303,33 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   /// resource_map argument.
   /// \return Void.
   void ScheduleTasks(std::unordered_map<ClientID, SchedulingResources> &resource_map);
+  /// Make a placement decision for the placeable tasks on the next iteration of the
+  /// event loop, so that the tasks submitted until then are placed together.
+  ///
+  /// \return Void.
+  void PostScheduleTasks();
+  /// Queue a submitted task for a placement decision. If tasks are placed by the
+  /// locality of their arguments, the task is held until the object directory knows
+  /// the locations of its arguments that aren't local. A task that is already held
+  /// is ignored.
+  ///
+  /// \param task The task to place.
+  /// \return Void.
+  void QueuePlaceableTask(const Task &task);
+  /// Handle a notification of the locations of an argument of tasks that are placed
+  /// by locality. Queues the held tasks that no longer wait for any locations.
+  ///
+  /// \param object_id The ID of the argument.
+  /// \return Void.
+  void HandleArgumentLocationsKnown(const ObjectID &object_id);
+  /// Compute the bytes of a task's arguments that are resident on each node, from
+  /// the local object store and the object locations cached by the object directory.
+  ///
+  /// \param spec The specification of the task.
+  /// \param bytes_by_node The bytes on each node are added here.
+  /// \return Void.
+  void GetArgumentLocality(const TaskSpecification &spec,
+                           std::unordered_map<ClientID, uint64_t> *bytes_by_node) const;
   /// Handle a task whose return value(s) must be reconstructed.
   ///
   /// \param task_id The relevant task ID.
@@ -292,6 +351,14 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   /// \param node_manager_id The ID of the remote node manager.
   /// \return Void.
   void ForwardTaskOrResubmit(const Task &task, const ClientID &node_manager_id);
+  /// Attempt to forward a batch of tasks to a remote node manager in a single
+  /// request. The tasks that fail to be forwarded will be resubmit locally.
+  ///
+  /// \param tasks The tasks in question.
+  /// \param node_manager_id The ID of the remote node manager.
+  /// \return Void.
+  void ForwardTasksOrResubmit(const std::vector<Task> &tasks,
+                              const ClientID &node_manager_id);
   /// Forward a task to another node to execute. The task is assumed to not be
   /// queued in local_queues_.
   ///
@@ -301,6 +368,39 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   void ForwardTask(
       const Task &task, const ClientID &node_id,
       const std::function<void(const ray::Status &, const Task &)> &on_error);
+  /// Forward a batch of tasks to another node to execute in a single request. The
+  /// tasks are assumed to not be queued in local_queues_.
+  ///
+  /// \param tasks The tasks to forward.
+  /// \param node_id The ID of the node to forward the tasks to.
+  /// \param on_error Callback on run on non-ok status, once for each task.
+  void ForwardTasks(
+      const std::vector<Task> &tasks, const ClientID &node_id,
+      const std::function<void(const ray::Status &, const Task &)> &on_error);
+  /// If this node has no ready or placeable tasks, ask the remote node with the
+  /// most load on the resources available here to hand over some of its ready
+  /// tasks. At most one such request is in flight at a time.
+  ///
+  /// \return Void.
+  void TryStealTasks();
+  /// Get the uncommitted lineage of a task that is about to be forwarded, and count
+  /// the forward in it.
+  ///
+  /// \param task The task to forward.
+  /// \param node_id The ID of the node to forward the task to.
+  /// \param[out] uncommitted_lineage The lineage to send along with the task.
+  /// \return False if the task should not be forwarded.
+  bool PrepareForwardTask(const Task &task, const ClientID &node_id,
+                          Lineage *uncommitted_lineage);
+  /// Handle the reply of a remote node manager to a forwarded task.
+  ///
+  /// \param task The forwarded task.
+  /// \param node_id The ID of the node that the task was forwarded to.
+  /// \param status The status of the request.
+  /// \param on_error Callback on run on non-ok status.
+  void HandleForwardTaskReply(
+      const Task &task, const ClientID &node_id, const Status &status,
+      const std::function<void(const ray::Status &, const Task &)> &on_error);
 
   /// Dispatch locally scheduled tasks. This attempts the transition from "scheduled" to
   /// "running" task state.
@@ -309,16 +409,11 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   ///   (1) A set of new tasks is added to the ready queue.
   ///   (2) New resources are becoming available on the local node.
   ///   (3) A new worker becomes available.
-  /// Note in case (1) we only need to look at the new tasks added to the
-  /// ready queue, as we know that the old tasks in the ready queue cannot
-  /// be scheduled (We checked those tasks last time new resources or
-  /// workers became available, and nothing changed since then.) In this case,
-  /// tasks_with_resources contains only the newly added tasks to the
-  /// ready queue. Otherwise, tasks_with_resources points to entire ready queue.
-  /// \param tasks_with_resources Mapping from resource shapes to tasks with
-  /// that resource shape.
-  void DispatchTasks(
-      const std::unordered_map<SchedulingClass, ordered_set<TaskID>> &tasks_by_class);
+  /// The scheduling queue tracks which classes of ready tasks were affected by
+  /// these events since the last call, so only those classes are visited. In
+  /// case (1), only the new tasks of a class are tried if the older ones are
+  /// still waiting for workers.
+  void DispatchTasks();
 
   /// Handle blocking gets of objects. This could be a task assigned to a worker,
   /// an out-of-band task (e.g., a thread created by the application), or a
@@ -402,6 +497,28 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   /// \return Void.
   void HandleObjectMissing(const ObjectID &object_id);
 
+  /// Unpin an object because its owner no longer needs it, and remove the object
+  /// from local disk if it was spilled.
+  ///
+  /// \param object_id The object to unpin.
+  /// \return Void.
+  void UnpinObject(const ObjectID &object_id);
+
+  /// Spill the least recently pinned objects to local disk until the pinned objects
+  /// that aren't spilled fit under the spilling threshold. Once an object is on
+  /// disk, it is unpinned so that the object store can evict it.
+  ///
+  /// \return Void.
+  void SpillObjectsIfNeeded();
+
+  /// Restore an object that was spilled to local disk into the object store.
+  /// Restored objects aren't pinned again, since they can be restored again if
+  /// they are evicted.
+  ///
+  /// \param object_id The object to restore.
+  /// \return Whether the object is being restored.
+  bool RestoreSpilledObject(const ObjectID &object_id);
+
   /// Handles the event that a job is finished.
   ///
   /// \param job_id ID of the finished job.
@@ -546,6 +663,16 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
                          rpc::ForwardTaskReply *reply,
                          rpc::SendReplyCallback send_reply_callback) override;
 
+  /// Handle a `ForwardTasks` request.
+  void HandleForwardTasks(const rpc::ForwardTasksRequest &request,
+                          rpc::ForwardTasksReply *reply,
+                          rpc::SendReplyCallback send_reply_callback) override;
+
+  /// Handle a `StealTasks` request.
+  void HandleStealTasks(const rpc::StealTasksRequest &request,
+                        rpc::StealTasksReply *reply,
+                        rpc::SendReplyCallback send_reply_callback) override;
+
   /// Handle a `PinObjectIDs` request.
   void HandlePinObjectIDs(const rpc::PinObjectIDsRequest &request,
                           rpc::PinObjectIDsReply *reply,
@@ -563,10 +690,9 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   /// Dispatch tasks to available workers.
   void DispatchScheduledTasksToWorkers();
 
-  /// For the pending task at the head of tasks_to_schedule_, return a node
-  /// in the system (local or remote) that has enough resources available to
-  /// run the task, if any such node exist.
-  /// Repeat the process as long as we can schedule a task.
+  /// Place the pending tasks in tasks_to_schedule_ on nodes (local or remote) that
+  /// have enough resources available to run them, and dispatch the tasks placed on
+  /// this node to workers. Tasks that no node can run stay pending.
   void NewSchedulerSchedulePendingTasks();
 
   /// Whether a task is an direct actor creation task.
@@ -590,8 +716,6 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   std::chrono::milliseconds heartbeat_period_;
   /// The period between debug state dumps.
   int64_t debug_dump_period_;
-  /// Whether to enable fair queueing between task classes in raylet.
-  bool fair_queueing_enabled_;
   /// Whether to enable pinning for plasma objects.
   bool object_pinning_enabled_;
   /// Whether we have printed out a resource deadlock warning.
@@ -613,6 +737,10 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   /// The resources (and specific resource IDs) that are currently available.
   ResourceIdSet local_available_resources_;
   std::unordered_map<ClientID, SchedulingResources> cluster_resource_map_;
+  /// Encodes the local resources into delta heartbeats, if they are enabled.
+  std::unique_ptr<HeartbeatEncoder> heartbeat_encoder_;
+  /// The resources of the remote nodes, as reported by their heartbeats.
+  std::unordered_map<ClientID, HeartbeatDecoder> heartbeat_decoders_;
   /// A pool of workers.
   WorkerPool worker_pool_;
   /// A set of queues to maintain tasks.
@@ -657,16 +785,42 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
   /// Whether new schedule is enabled.
   const bool new_scheduler_enabled_;
 
+  /// Whether submitted tasks are placed in batches.
+  const bool batch_placement_enabled_;
+  /// Whether a placement decision is posted to the event loop.
+  bool schedule_tasks_posted_ = false;
+
+  /// Whether tasks are placed by the locality of their arguments.
+  const bool locality_aware_scheduling_enabled_;
+  /// The ID that the locations of the arguments of tasks placed by locality are
+  /// subscribed to with.
+  const UniqueID argument_locations_callback_id_ = UniqueID::FromRandom();
+  /// The tasks held until the locations of their arguments are known, and the
+  /// arguments whose locations are subscribed to for placement. The arguments are
+  /// unsubscribed from once no held task waits for them and the placeable tasks have
+  /// been placed.
+  ArgumentLocationTracker argument_location_tracker_;
+
+  /// Whether this node asks its peers for ready tasks when it is idle.
+  const bool work_stealing_enabled_;
+  /// Whether a request to steal tasks is in flight.
+  bool steal_request_pending_ = false;
+  /// The time that the last request to steal tasks was sent.
+  uint64_t last_steal_attempt_at_ms_ = 0;
+  /// Remote nodes that had no tasks to hand over, or failed to answer. They are not
+  /// asked again until their next heartbeat reports their load.
+  std::unordered_set<ClientID> steal_exhausted_nodes_;
+  /// The number of tasks that this node stole from its peers.
+  uint64_t num_tasks_stolen_ = 0;
+  /// The number of tasks that peers stole from this node.
+  uint64_t num_tasks_given_away_ = 0;
+
   /// The new resource scheduler for direct task calls.
   std::shared_ptr<ClusterResourceScheduler> new_resource_scheduler_;
   /// Map of leased workers to their current resource usage.
   /// TODO(ion): Check whether we can track these resources in the worker.
   std::unordered_map<WorkerID, ResourceSet> leased_worker_resources_;
 
-  typedef std::function<void(std::shared_ptr<Worker>, ClientID spillback_to,
-                             std::string address, int port)>
-      ScheduleFn;
-
   /// Queue of lease requests that are waiting for resources to become available.
   /// TODO this should be a queue for each SchedulingClass
   std::deque<std::pair<ScheduleFn, Task>> tasks_to_schedule_;
@@ -682,6 +836,22 @@ class NodeManager : public rpc::NodeManagerServiceHandler {
 
   absl::flat_hash_map<ObjectID, std::unique_ptr<RayObject>> pinned_objects_;
 
+  /// Spills pinned objects to local disk, or nullptr if spilling is disabled.
+  std::unique_ptr<LocalObjectSpiller> object_spiller_;
+  /// The pinned objects that aren't being spilled, least recently pinned first.
+  ordered_set<ObjectID> spill_candidates_;
+  /// The total size of the objects in `spill_candidates_`.
+  uint64_t spill_candidate_bytes_ = 0;
+  /// The total size of the objects in `pinned_objects_`.
+  int64_t pinned_object_bytes_ = 0;
+  /// Objects are spilled while the candidates take up more than this many bytes.
+  uint64_t spill_threshold_bytes_ = 0;
+  /// The objects being restored from local disk.
+  absl::flat_hash_set<ObjectID> restoring_objects_;
+
+  /// Remove an object from the pinned objects, if it's pinned.
+  void ErasePinnedObject(const ObjectID &object_id);
+
   /// Wait for a task's arguments to become ready.
   void WaitForTaskArgsRequests(std::pair<ScheduleFn, Task> &work);
 
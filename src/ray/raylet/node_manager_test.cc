@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+
+#include "ray/common/task/task_util.h"
+#include "ray/raylet/node_manager.h"
+
+namespace ray {
+
+namespace raylet {
+
+using ResourceMap = std::unordered_map<std::string, double>;
+
+static inline Task ExampleTask(const ResourceMap &required_resources) {
+  TaskSpecBuilder builder;
+  rpc::Address address;
+  builder.SetCommonTaskSpec(TaskID::ForFakeTask(), Language::PYTHON, {"", "", ""},
+                            JobID::Nil(), TaskID::ForFakeTask(), 0, TaskID::ForFakeTask(),
+                            address, 0, false, required_resources, {});
+  rpc::TaskExecutionSpec execution_spec_message;
+  return Task(builder.Build(), TaskExecutionSpecification(execution_spec_message));
+}
+
+TEST(NodeManagerTest, TestScheduleTaskBatch) {
+  const std::string local_node_id = ClientID::FromRandom().Binary();
+  const std::string remote_node_id = ClientID::FromRandom().Binary();
+  ClusterResourceScheduler scheduler(local_node_id, ResourceMap{{"CPU", 4}});
+  scheduler.AddOrUpdateNode(remote_node_id, ResourceMap{{"CPU", 4}},
+                            ResourceMap{{"CPU", 4}});
+
+  // The first task doesn't fit on any node, and the others fit on one node each.
+  std::deque<std::pair<NodeManager::ScheduleFn, Task>> tasks_to_schedule;
+  std::vector<TaskID> task_ids;
+  for (double num_cpus : {100, 3, 3}) {
+    tasks_to_schedule.emplace_back(nullptr, ExampleTask({{"CPU", num_cpus}}));
+    task_ids.push_back(tasks_to_schedule.back().second.GetTaskSpecification().TaskId());
+  }
+  std::unordered_map<TaskID, std::string> placed_tasks;
+  auto place_task = [&scheduler, &placed_tasks](
+                        std::pair<NodeManager::ScheduleFn, Task> &work, int64_t node_id) {
+    placed_tasks[work.second.GetTaskSpecification().TaskId()] =
+        scheduler.GetNodeIdString(node_id);
+  };
+  NodeManager::ScheduleTaskBatch(scheduler, &tasks_to_schedule, place_task);
+
+  // The unschedulable task stays queued and doesn't block the tasks behind it.
+  ASSERT_EQ(tasks_to_schedule.size(), 1);
+  ASSERT_EQ(tasks_to_schedule.front().second.GetTaskSpecification().TaskId(),
+            task_ids[0]);
+  ASSERT_EQ(placed_tasks.size(), 2);
+  ASSERT_EQ(placed_tasks[task_ids[1]], local_node_id);
+  ASSERT_EQ(placed_tasks[task_ids[2]], remote_node_id);
+
+  // The local resources are given back, since they are taken when the task is
+  // dispatched to a worker. The remote resources stay taken until the next heartbeat.
+  ASSERT_TRUE(scheduler.SubtractNodeAvailableResources(local_node_id, {{"CPU", 4}}));
+  ASSERT_FALSE(scheduler.SubtractNodeAvailableResources(remote_node_id, {{"CPU", 2}}));
+  ASSERT_TRUE(scheduler.SubtractNodeAvailableResources(remote_node_id, {{"CPU", 1}}));
+
+  // The queued task is placed once a node has room for it.
+  scheduler.AddOrUpdateNode(remote_node_id, ResourceMap{{"CPU", 100}},
+                            ResourceMap{{"CPU", 100}});
+  NodeManager::ScheduleTaskBatch(scheduler, &tasks_to_schedule, place_task);
+  ASSERT_TRUE(tasks_to_schedule.empty());
+  ASSERT_EQ(placed_tasks[task_ids[0]], remote_node_id);
+}
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
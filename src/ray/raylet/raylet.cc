@@ -47,6 +47,7 @@ Raylet::Raylet(boost::asio::io_service &main_service, const std::string &socket_
                const ObjectManagerConfig &object_manager_config,
                std::shared_ptr<gcs::GcsClient> gcs_client)
     : self_node_id_(ClientID::FromRandom()),
+      main_service_(main_service),
       gcs_client_(gcs_client),
       object_directory_(std::make_shared<ObjectDirectory>(main_service, gcs_client_)),
       object_manager_(main_service, self_node_id_, object_manager_config,
@@ -60,8 +61,14 @@ Raylet::Raylet(boost::asio::io_service &main_service, const std::string &socket_
 #else
                 parse_ip_tcp_endpoint(socket_name)
 #endif
-                    ),
-      socket_(main_service) {
+                    ) {
+  for (uint64_t i = 0; i < RayConfig::instance().raylet_client_io_threads(); i++) {
+    client_services_.emplace_back(new boost::asio::io_service());
+    client_service_works_.emplace_back(
+        new boost::asio::io_service::work(*client_services_.back()));
+    boost::asio::io_service *client_service = client_services_.back().get();
+    client_threads_.emplace_back([client_service]() { client_service->run(); });
+  }
   self_node_info_.set_node_id(self_node_id_.Binary());
   self_node_info_.set_state(GcsNodeInfo::ALIVE);
   self_node_info_.set_node_manager_address(node_ip_address);
@@ -72,7 +79,7 @@ Raylet::Raylet(boost::asio::io_service &main_service, const std::string &socket_
   self_node_info_.set_node_manager_hostname(boost::asio::ip::host_name());
 }
 
-Raylet::~Raylet() {}
+Raylet::~Raylet() { StopClientThreads(); }
 
 void Raylet::Start() {
   RAY_CHECK_OK(RegisterGcs());
@@ -84,6 +91,27 @@ void Raylet::Start() {
 void Raylet::Stop() {
   RAY_CHECK_OK(gcs_client_->Nodes().UnregisterSelf());
   acceptor_.close();
+  StopClientThreads();
+}
+
+void Raylet::StopClientThreads() {
+  client_service_works_.clear();
+  for (auto &client_service : client_services_) {
+    client_service->stop();
+  }
+  for (auto &client_thread : client_threads_) {
+    client_thread.join();
+  }
+  client_threads_.clear();
+}
+
+boost::asio::io_service &Raylet::NextClientService() {
+  if (client_services_.empty()) {
+    return main_service_;
+  }
+  auto &client_service = *client_services_[next_client_service_];
+  next_client_service_ = (next_client_service_ + 1) % client_services_.size();
+  return client_service;
 }
 
 ray::Status Raylet::RegisterGcs() {
@@ -113,8 +141,10 @@ ray::Status Raylet::RegisterGcs() {
 }
 
 void Raylet::DoAccept() {
-  acceptor_.async_accept(socket_, boost::bind(&Raylet::HandleAccept, this,
-                                              boost::asio::placeholders::error));
+  // Accept the client on the event loop that will read and write its connection.
+  socket_.reset(new local_stream_protocol::socket(NextClientService()));
+  acceptor_.async_accept(*socket_, boost::bind(&Raylet::HandleAccept, this,
+                                               boost::asio::placeholders::error));
 }
 
 void Raylet::HandleAccept(const boost::system::error_code &error) {
@@ -128,10 +158,13 @@ void Raylet::HandleAccept(const boost::system::error_code &error) {
           node_manager_.ProcessClientMessage(client, message_type, message);
         };
     // Accept a new local client and dispatch it to the node manager.
+    // If the connection is read and written on another thread, its messages are
+    // still handled on the main event loop.
     auto new_connection = LocalClientConnection::Create(
-        client_handler, message_handler, std::move(socket_), "worker",
+        client_handler, message_handler, std::move(*socket_), "worker",
         node_manager_message_enum,
-        static_cast<int64_t>(protocol::MessageType::DisconnectClient));
+        static_cast<int64_t>(protocol::MessageType::DisconnectClient),
+        client_services_.empty() ? nullptr : &main_service_);
   }
   // We're ready to accept another client.
   DoAccept();
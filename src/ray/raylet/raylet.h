@@ -2,6 +2,7 @@
 #define RAY_RAYLET_RAYLET_H
 
 #include <list>
+#include <thread>
 
 #include <boost/asio.hpp>
 #include <boost/asio/error.hpp>
@@ -60,6 +61,10 @@ class Raylet {
   void DoAccept();
   /// Handle an accepted client connection.
   void HandleAccept(const boost::system::error_code &error);
+  /// Get the event loop to read and write the next client connection on.
+  boost::asio::io_service &NextClientService();
+  /// Stop the threads that read and write client connections.
+  void StopClientThreads();
 
   friend class TestObjectManagerIntegration;
 
@@ -68,8 +73,21 @@ class Raylet {
   /// Information of this node.
   GcsNodeInfo self_node_info_;
 
+  /// The event loop that the node manager runs on. All scheduling state is only
+  /// accessed from this event loop.
+  boost::asio::io_service &main_service_;
   /// A client connection to the GCS.
   std::shared_ptr<gcs::GcsClient> gcs_client_;
+  /// The event loops that read and write the connections of local clients, if
+  /// raylet_client_io_threads is positive. They are declared before the node
+  /// manager, which owns the connections.
+  std::vector<std::unique_ptr<boost::asio::io_service>> client_services_;
+  /// Keep the client event loops running while they have no connections.
+  std::vector<std::unique_ptr<boost::asio::io_service::work>> client_service_works_;
+  /// The threads that run the client event loops.
+  std::vector<std::thread> client_threads_;
+  /// The index of the client event loop for the next connection.
+  size_t next_client_service_ = 0;
   /// The object table. This is shared between the object manager and node
   /// manager.
   std::shared_ptr<ObjectDirectoryInterface> object_directory_;
@@ -82,8 +100,8 @@ class Raylet {
 
   /// An acceptor for new clients.
   boost::asio::basic_socket_acceptor<local_stream_protocol> acceptor_;
-  /// The socket to listen on for new clients.
-  local_stream_protocol::socket socket_;
+  /// The socket to accept the next client on.
+  std::unique_ptr<local_stream_protocol::socket> socket_;
 };
 
 }  // namespace raylet
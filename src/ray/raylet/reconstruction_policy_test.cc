@@ -79,6 +79,8 @@ class MockObjectDirectory : public ObjectDirectoryInterface {
   MOCK_METHOD3(ReportObjectRemoved,
                ray::Status(const ObjectID &, const ClientID &,
                            const object_manager::protocol::ObjectInfoT &));
+  MOCK_CONST_METHOD3(GetCachedLocations,
+                     bool(const ObjectID &, std::unordered_set<ClientID> *, uint64_t *));
 
  private:
   std::vector<std::pair<ObjectID, OnLocationsFound>> callbacks_;
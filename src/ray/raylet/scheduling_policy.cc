@@ -4,15 +4,69 @@
 
 #include "scheduling_policy.h"
 
+#include "ray/common/ray_config.h"
+#include "ray/stats/stats.h"
 #include "ray/util/logging.h"
 
 namespace ray {
 
 namespace raylet {
 
-SchedulingPolicy::SchedulingPolicy(const SchedulingQueue &scheduling_queue)
+SchedulingPolicy::SchedulingPolicy(const SchedulingQueue &scheduling_queue,
+                                   ArgumentLocalityFunction argument_locality)
     : scheduling_queue_(scheduling_queue),
-      gen_(std::chrono::high_resolution_clock::now().time_since_epoch().count()) {}
+      gen_(std::chrono::high_resolution_clock::now().time_since_epoch().count()),
+      feasibility_index_(RayConfig::instance().max_indexed_resource_shapes()),
+      argument_locality_(std::move(argument_locality)),
+      locality_min_bytes_(
+          std::max<uint64_t>(RayConfig::instance().locality_aware_scheduling_min_bytes(),
+                             1)) {}
+
+void SchedulingPolicy::UpdateNode(const ClientID &client_id,
+                                  const SchedulingResources &resources) {
+  feasibility_index_.UpdateNode(client_id, resources);
+}
+
+void SchedulingPolicy::RemoveNode(const ClientID &client_id) {
+  feasibility_index_.RemoveNode(client_id);
+}
+
+ClientID SchedulingPolicy::PickNode(
+    const ResourceSet &resource_demand, bool available,
+    const std::unordered_map<ClientID, SchedulingResources> &cluster_resources) {
+  while (true) {
+    const ClientID client_id =
+        available ? feasibility_index_.PickAvailableNode(resource_demand, gen_)
+                  : feasibility_index_.PickFeasibleNode(resource_demand, gen_);
+    if (client_id.IsNil() || cluster_resources.count(client_id) > 0) {
+      return client_id;
+    }
+    // The node was removed from the cluster without updating the index.
+    RAY_LOG(DEBUG) << "Removing node " << client_id << " from the feasibility index";
+    feasibility_index_.RemoveNode(client_id);
+  }
+}
+
+ClientID SchedulingPolicy::PickNodeByLocality(
+    const TaskSpecification &spec, const ResourceSet &resource_demand,
+    const std::unordered_map<ClientID, SchedulingResources> &cluster_resources) {
+  std::unordered_map<ClientID, uint64_t> bytes_by_node;
+  argument_locality_(spec, &bytes_by_node);
+  ClientID best_client_id = ClientID::Nil();
+  uint64_t best_bytes = locality_min_bytes_ - 1;
+  for (const auto &node_bytes : bytes_by_node) {
+    if (node_bytes.second > best_bytes && cluster_resources.count(node_bytes.first) > 0 &&
+        feasibility_index_.IsAvailable(node_bytes.first, resource_demand)) {
+      best_client_id = node_bytes.first;
+      best_bytes = node_bytes.second;
+    }
+  }
+  if (!best_client_id.IsNil()) {
+    num_locality_placements_++;
+    locality_bytes_on_node_ += best_bytes;
+  }
+  return best_client_id;
+}
 
 std::unordered_map<TaskID, ClientID> SchedulingPolicy::Schedule(
     std::unordered_map<ClientID, SchedulingResources> &cluster_resources,
@@ -30,89 +84,85 @@ std::unordered_map<TaskID, ClientID> SchedulingPolicy::Schedule(
   }
 #endif
 
-  // We expect all placeable tasks to be placed on exit from this policy method.
-  RAY_CHECK(scheduling_queue_.GetTasks(TaskState::PLACEABLE).size() <= 1);
-  // Iterate over running tasks, get their resource demand and try to schedule.
-  for (const auto &t : scheduling_queue_.GetTasks(TaskState::PLACEABLE)) {
-    // Get task's resource demand
-    const auto &spec = t.GetTaskSpecification();
-    const auto &resource_demand = spec.GetRequiredPlacementResources();
-    const TaskID &task_id = spec.TaskId();
+  const auto &placeable_tasks = scheduling_queue_.GetTasks(TaskState::PLACEABLE);
+  if (placeable_tasks.empty()) {
+    return decision;
+  }
 
-    // TODO(atumanov): try to place tasks locally first.
-    // Construct a set of viable node candidates and randomly pick between them.
-    // Get all the client id keys and randomly pick.
-    std::vector<ClientID> client_keys;
+  // The load of the local node changes with every task, so update it here instead of
+  // on every change. Add the nodes that the index doesn't know yet, which only
+  // requires a scan of the cluster when its membership changed.
+  auto local_it = cluster_resources.find(local_client_id);
+  if (local_it != cluster_resources.end()) {
+    feasibility_index_.UpdateNode(local_client_id, local_it->second);
+  }
+  if (feasibility_index_.NumNodes() != cluster_resources.size()) {
     for (const auto &client_resource_pair : cluster_resources) {
-      // pair = ClientID, SchedulingResources
-      ClientID node_client_id = client_resource_pair.first;
-      const auto &node_resources = client_resource_pair.second;
-      ResourceSet available_node_resources =
-          ResourceSet(node_resources.GetAvailableResources());
-      // We have to subtract the current "load" because we set the current "load"
-      // to be the resources used by tasks that are in the
-      // `SchedulingQueue::ready_queue_` in NodeManager::HandleWorkerAvailable's
-      // call to SchedulingQueue::GetResourceLoad.
-      available_node_resources.SubtractResources(node_resources.GetLoadResources());
-      RAY_LOG(DEBUG) << "client_id " << node_client_id
-                     << " avail: " << node_resources.GetAvailableResources().ToString()
-                     << " load: " << node_resources.GetLoadResources().ToString();
-
-      if (resource_demand.IsSubset(available_node_resources)) {
-        // This node is a feasible candidate.
-        client_keys.push_back(node_client_id);
+      if (!feasibility_index_.HasNode(client_resource_pair.first)) {
+        feasibility_index_.UpdateNode(client_resource_pair.first,
+                                      client_resource_pair.second);
       }
     }
+  }
 
-    if (!client_keys.empty()) {
-      // Choose index at random.
-      // Initialize a uniform integer distribution over the key space.
-      // TODO(atumanov): change uniform random to discrete, weighted by resource capacity.
-      std::uniform_int_distribution<int> distribution(0, client_keys.size() - 1);
-      int client_key_index = distribution(gen_);
-      const ClientID &dst_client_id = client_keys[client_key_index];
-      decision[task_id] = dst_client_id;
-      // Update dst_client_id's load to keep track of remote task load until
-      // the next heartbeat.
-      ResourceSet new_load(cluster_resources[dst_client_id].GetLoadResources());
-      new_load.AddResources(resource_demand);
-      cluster_resources[dst_client_id].SetLoadResources(std::move(new_load));
-    } else {
-      // If the task doesn't fit, place randomly subject to hard constraints.
-      for (const auto &client_resource_pair2 : cluster_resources) {
-        // pair = ClientID, SchedulingResources
-        ClientID node_client_id = client_resource_pair2.first;
-        const auto &node_resources = client_resource_pair2.second;
-        if (resource_demand.IsSubset(node_resources.GetTotalResources())) {
-          // This node is a feasible candidate.
-          client_keys.push_back(node_client_id);
-        }
+  // Group the tasks by their placement resources, so that they are placed against the
+  // same resource shape, and the remaining tasks of a shape that no node fits are
+  // skipped.
+  std::unordered_map<ResourceSet, std::vector<const TaskSpecification *>> tasks_by_shape;
+  for (const auto &t : placeable_tasks) {
+    const auto &spec = t.GetTaskSpecification();
+    tasks_by_shape[spec.GetRequiredPlacementResources()].push_back(&spec);
+  }
+
+  for (const auto &shape_tasks : tasks_by_shape) {
+    const ResourceSet &resource_demand = shape_tasks.first;
+    const auto &specs = shape_tasks.second;
+    // The number of tasks placed on each node.
+    std::unordered_map<ClientID, int64_t> num_tasks_placed;
+    for (size_t i = 0; i < specs.size(); i++) {
+      const TaskSpecification *spec = specs[i];
+      // Pick the node that holds the task's arguments, or else a node whose free
+      // resources fit the task. If the task doesn't fit, place randomly subject to
+      // hard constraints.
+      ClientID dst_client_id = ClientID::Nil();
+      if (argument_locality_ != nullptr) {
+        dst_client_id = PickNodeByLocality(*spec, resource_demand, cluster_resources);
       }
-      // client candidate list constructed, pick randomly.
-      if (!client_keys.empty()) {
-        // Choose index at random.
-        // Initialize a uniform integer distribution over the key space.
-        // TODO(atumanov): change uniform random to discrete, weighted by resource
-        // capacity.
-        std::uniform_int_distribution<int> distribution(0, client_keys.size() - 1);
-        int client_key_index = distribution(gen_);
-        const ClientID &dst_client_id = client_keys[client_key_index];
-        decision[task_id] = dst_client_id;
-        // Update dst_client_id's load to keep track of remote task load until
-        // the next heartbeat.
-        ResourceSet new_load(cluster_resources[dst_client_id].GetLoadResources());
-        new_load.AddResources(resource_demand);
-        cluster_resources[dst_client_id].SetLoadResources(std::move(new_load));
-      } else {
-        // There are no nodes that can feasibly execute this task. The task remains
+      if (dst_client_id.IsNil()) {
+        dst_client_id = PickNode(resource_demand, /*available=*/true, cluster_resources);
+      }
+      if (dst_client_id.IsNil()) {
+        dst_client_id = PickNode(resource_demand, /*available=*/false, cluster_resources);
+      }
+      if (dst_client_id.IsNil()) {
+        // There are no nodes that can feasibly execute these tasks. The tasks remain
         // placeable until cluster capacity becomes available.
         // TODO(rkn): Propagate a warning to the user.
-        RAY_LOG(INFO) << "The task with ID " << task_id << " requires "
-                      << spec.GetRequiredResources().ToString() << " for execution and "
-                      << spec.GetRequiredPlacementResources().ToString()
+        RAY_LOG(INFO) << "The task with ID " << spec->TaskId() << " requires "
+                      << spec->GetRequiredResources().ToString() << " for execution and "
+                      << resource_demand.ToString()
                       << " for placement, but no nodes have the necessary resources. "
                       << "Check the client table to view node resources.";
+        if (specs.size() - i > 1) {
+          RAY_LOG(INFO) << specs.size() - i
+                        << " tasks with the same placement resources remain placeable.";
+        }
+        break;
+      }
+      decision[spec->TaskId()] = dst_client_id;
+      num_tasks_placed[dst_client_id]++;
+      feasibility_index_.AddLoad(dst_client_id, resource_demand);
+    }
+
+    // Update the load of the nodes that tasks were placed on to keep track of remote
+    // task load until the next heartbeat.
+    for (const auto &node_tasks : num_tasks_placed) {
+      SchedulingResources &dst_resources = cluster_resources[node_tasks.first];
+      ResourceSet new_load(dst_resources.GetLoadResources());
+      for (int64_t i = 0; i < node_tasks.second; i++) {
+        new_load.AddResources(resource_demand);
       }
+      dst_resources.SetLoadResources(std::move(new_load));
     }
   }
 
@@ -154,6 +204,70 @@ std::vector<TaskID> SchedulingPolicy::SpillOver(
   return decision;
 }
 
+ClientID SchedulingPolicy::ChooseStealVictim(
+    const std::unordered_map<ClientID, SchedulingResources> &cluster_resources,
+    const ClientID &local_client_id,
+    const std::function<bool(const ClientID &)> &is_candidate) const {
+  auto local_it = cluster_resources.find(local_client_id);
+  if (local_it == cluster_resources.end()) {
+    return ClientID::Nil();
+  }
+  const ResourceSet &available_resources = local_it->second.GetAvailableResources();
+  ClientID victim_id = ClientID::Nil();
+  double max_load = 0;
+  for (const auto &node_resources : cluster_resources) {
+    const ClientID &node_id = node_resources.first;
+    if (node_id == local_client_id || !is_candidate(node_id)) {
+      continue;
+    }
+    double load = 0;
+    for (const auto &resource_pair :
+         node_resources.second.GetLoadResources().GetResourceMap()) {
+      if (available_resources.GetResource(resource_pair.first).ToDouble() > 0) {
+        load += resource_pair.second;
+      }
+    }
+    if (load > max_load) {
+      max_load = load;
+      victim_id = node_id;
+    }
+  }
+  return victim_id;
+}
+
+std::unordered_set<TaskID> SchedulingPolicy::ChooseTasksToHandOver(
+    ResourceSet available_resources, uint64_t max_tasks,
+    const std::function<bool(const TaskSpecification &)> &can_hand_over) const {
+  std::unordered_set<TaskID> task_ids;
+  for (const auto &class_tasks : scheduling_queue_.GetReadyTasksByClass()) {
+    for (const auto &task_id : class_tasks.second) {
+      if (task_ids.size() >= max_tasks) {
+        return task_ids;
+      }
+      const auto &task = scheduling_queue_.GetTaskOfState(task_id, TaskState::READY);
+      const auto &spec = task.GetTaskSpecification();
+      // Actor tasks must run where their actor is.
+      if (spec.IsActorTask() || !can_hand_over(spec)) {
+        continue;
+      }
+      // All tasks of a scheduling class require the same resources.
+      if (!spec.GetRequiredPlacementResources().IsSubset(available_resources)) {
+        break;
+      }
+      task_ids.insert(task_id);
+      available_resources.SubtractResources(spec.GetRequiredResources());
+    }
+  }
+  return task_ids;
+}
+
+void SchedulingPolicy::RecordMetrics() const {
+  stats::SchedulingPolicyStats().Record(
+      num_locality_placements_, {{stats::ValueTypeKey, "num_locality_placements"}});
+  stats::SchedulingPolicyStats().Record(
+      locality_bytes_on_node_, {{stats::ValueTypeKey, "locality_bytes_on_node"}});
+}
+
 SchedulingPolicy::~SchedulingPolicy() {}
 
 }  // namespace raylet
@@ -1,16 +1,24 @@
 #ifndef RAY_RAYLET_SCHEDULING_POLICY_H
 #define RAY_RAYLET_SCHEDULING_POLICY_H
 
+#include <functional>
 #include <random>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "ray/common/task/scheduling_resources.h"
+#include "ray/raylet/feasibility_index.h"
 #include "ray/raylet/scheduling_queue.h"
 
 namespace ray {
 
 namespace raylet {
 
+/// Computes the bytes of a task's arguments that are already resident on each node.
+/// The first argument is the task, and the second is the map to add the bytes to.
+using ArgumentLocalityFunction = std::function<void(
+    const TaskSpecification &, std::unordered_map<ClientID, uint64_t> *)>;
+
 /// \class SchedulingPolicy
 /// \brief Implements a scheduling policy for the node manager.
 class SchedulingPolicy {
@@ -19,11 +27,35 @@ class SchedulingPolicy {
   ///
   /// \param scheduling_queue: reference to a scheduler queues object for access to
   /// tasks.
+  /// \param argument_locality: if not nullptr, tasks are placed on the node that
+  /// holds the most bytes of their arguments, if it has the free resources for them.
   /// \return Void.
-  SchedulingPolicy(const SchedulingQueue &scheduling_queue);
+  SchedulingPolicy(const SchedulingQueue &scheduling_queue,
+                   ArgumentLocalityFunction argument_locality = nullptr);
+
+  /// \brief Update the resources of a node in the index of nodes that tasks are
+  /// placed from. This must be called whenever the resources of a remote node
+  /// change. The resources of the local node are updated by Schedule.
+  ///
+  /// \param client_id The ID of the node.
+  /// \param resources The resources of the node.
+  /// \return Void.
+  void UpdateNode(const ClientID &client_id, const SchedulingResources &resources);
+
+  /// \brief Remove a node from the index of nodes that tasks are placed from.
+  ///
+  /// \param client_id The ID of the node.
+  /// \return Void.
+  void RemoveNode(const ClientID &client_id);
 
   /// \brief Perform a scheduling operation, given a set of cluster resources and
-  /// producing a mapping of tasks to raylets.
+  /// producing a mapping of tasks to raylets. All placeable tasks are placed in one
+  /// call, grouped by their placement resources. If argument locality is enabled, a
+  /// task is placed on the node that holds the most bytes of its arguments, if it
+  /// holds enough of them and its free resources fit the task. Otherwise, it's
+  /// placed on a node whose free resources fit it, picked at random weighted by how
+  /// many copies of the task fit. If no node has enough free resources, it's placed
+  /// on a random node whose total resources fit it.
   ///
   /// \param cluster_resources: a set of cluster resources containing resource and load
   /// information for some subset of the cluster. For all client IDs in the returned
@@ -45,14 +77,85 @@ class SchedulingPolicy {
   /// \return Scheduling decision, mapping tasks to raylets for placement.
   std::vector<TaskID> SpillOver(SchedulingResources &remote_scheduling_resources) const;
 
+  /// \brief Pick the remote node to ask for ready tasks when this node is idle: the
+  /// one with the most load on the resources that are available on this node.
+  ///
+  /// \param cluster_resources The resources of the cluster, including this node.
+  /// \param local_client_id The ID of this node.
+  /// \param is_candidate Whether a remote node may be asked.
+  /// \return The ID of the node, or nil if no candidate has load on the resources
+  /// that are available on this node.
+  ClientID ChooseStealVictim(
+      const std::unordered_map<ClientID, SchedulingResources> &cluster_resources,
+      const ClientID &local_client_id,
+      const std::function<bool(const ClientID &)> &is_candidate) const;
+
+  /// \brief Pick ready tasks to hand over to a node that asked for them. The oldest
+  /// ready tasks of each scheduling class are picked while they fit in the resources
+  /// that are available on that node. Actor tasks are never picked.
+  ///
+  /// \param available_resources The resources available on the requesting node.
+  /// \param max_tasks The maximum number of tasks to pick.
+  /// \param can_hand_over Whether a ready task may be handed over.
+  /// \return The IDs of the picked tasks.
+  std::unordered_set<TaskID> ChooseTasksToHandOver(
+      ResourceSet available_resources, uint64_t max_tasks,
+      const std::function<bool(const TaskSpecification &)> &can_hand_over) const;
+
+  /// Return the number of tasks that were placed by the locality of their arguments.
+  uint64_t NumLocalityPlacements() const { return num_locality_placements_; }
+
+  /// Return the bytes of arguments that tasks placed by locality found on the node
+  /// they were placed on. Other nodes may have held some of these bytes too.
+  uint64_t LocalityBytesOnNode() const { return locality_bytes_on_node_; }
+
+  /// Record metrics.
+  void RecordMetrics() const;
+
   /// \brief SchedulingPolicy destructor.
   virtual ~SchedulingPolicy();
 
  private:
+  /// Pick a node for a task from the feasibility index.
+  ///
+  /// \param resource_demand The placement resources of the task.
+  /// \param available Whether to pick a node whose free resources fit the task, or
+  /// one whose total resources do.
+  /// \param cluster_resources The resources of the cluster, to check the picked node
+  /// against.
+  /// \return The ID of the node, or nil if no node fits the task.
+  ClientID PickNode(const ResourceSet &resource_demand, bool available,
+                    const std::unordered_map<ClientID, SchedulingResources>
+                        &cluster_resources);
+
+  /// Pick the node that holds the most bytes of a task's arguments, if it holds at
+  /// least the minimum bytes and its free resources fit the task.
+  ///
+  /// \param spec The specification of the task.
+  /// \param resource_demand The placement resources of the task.
+  /// \param cluster_resources The resources of the cluster, to check the picked node
+  /// against.
+  /// \return The ID of the node, or nil if no node qualifies.
+  ClientID PickNodeByLocality(const TaskSpecification &spec,
+                              const ResourceSet &resource_demand,
+                              const std::unordered_map<ClientID, SchedulingResources>
+                                  &cluster_resources);
+
   /// An immutable reference to the scheduling task queues.
   const SchedulingQueue &scheduling_queue_;
   /// Internally maintained random number generator.
   std::mt19937_64 gen_;
+  /// The index of nodes by the resource shapes of tasks.
+  FeasibilityIndex feasibility_index_;
+  /// Computes the bytes of a task's arguments on each node, or nullptr if tasks are
+  /// not placed by locality.
+  const ArgumentLocalityFunction argument_locality_;
+  /// The minimum bytes of arguments on a node to place a task there by locality.
+  const uint64_t locality_min_bytes_;
+  /// The number of tasks placed by locality.
+  uint64_t num_locality_placements_ = 0;
+  /// The bytes of arguments that tasks placed by locality found on their node.
+  uint64_t locality_bytes_on_node_ = 0;
 };
 
 }  // namespace raylet
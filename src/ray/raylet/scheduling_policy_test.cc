@@ -0,0 +1,194 @@
+#include "gtest/gtest.h"
+
+#include "ray/common/task/task_util.h"
+#include "ray/raylet/scheduling_policy.h"
+
+namespace ray {
+
+namespace raylet {
+
+using ResourceMap = std::unordered_map<std::string, double>;
+
+static inline Task ExampleTask(const ResourceMap &required_resources) {
+  TaskSpecBuilder builder;
+  rpc::Address address;
+  builder.SetCommonTaskSpec(TaskID::ForFakeTask(), Language::PYTHON, {"", "", ""},
+                            JobID::Nil(), TaskID::ForFakeTask(), 0, TaskID::ForFakeTask(),
+                            address, 0, false, required_resources, {});
+  rpc::TaskExecutionSpec execution_spec_message;
+  return Task(builder.Build(), TaskExecutionSpecification(execution_spec_message));
+}
+
+class SchedulingPolicyTest : public ::testing::Test {
+ public:
+  SchedulingPolicyTest() : scheduling_policy_(scheduling_queue_) {}
+
+  /// Queue tasks with the given resources, placeable unless another state is given.
+  std::vector<TaskID> QueueTasks(const ResourceMap &required_resources, int num_tasks,
+                                 TaskState state = TaskState::PLACEABLE) {
+    std::vector<Task> tasks;
+    std::vector<TaskID> task_ids;
+    for (int i = 0; i < num_tasks; i++) {
+      tasks.push_back(ExampleTask(required_resources));
+      task_ids.push_back(tasks.back().GetTaskSpecification().TaskId());
+    }
+    scheduling_queue_.QueueTasks(tasks, state);
+    return task_ids;
+  }
+
+ protected:
+  SchedulingQueue scheduling_queue_;
+  SchedulingPolicy scheduling_policy_;
+};
+
+TEST_F(SchedulingPolicyTest, TestScheduleBatch) {
+  const ClientID local_node = ClientID::FromRandom();
+  const ClientID cpu_node = ClientID::FromRandom();
+  const ClientID gpu_node = ClientID::FromRandom();
+  std::unordered_map<ClientID, SchedulingResources> cluster_resources;
+  cluster_resources[local_node] =
+      SchedulingResources(ResourceSet(ResourceMap{{"CPU", 8}}));
+  cluster_resources[cpu_node] =
+      SchedulingResources(ResourceSet(ResourceMap{{"CPU", 12}}));
+  cluster_resources[gpu_node] =
+      SchedulingResources(ResourceSet(ResourceMap{{"GPU", 2}}));
+
+  auto cpu_task_ids = QueueTasks({{"CPU", 1}}, 25);
+  auto gpu_task_ids = QueueTasks({{"GPU", 1}}, 2);
+  auto infeasible_task_ids = QueueTasks({{"custom", 1}}, 3);
+  auto decision = scheduling_policy_.Schedule(cluster_resources, local_node);
+
+  // All feasible tasks are placed in a single call, on nodes that fit them.
+  ASSERT_EQ(decision.size(), cpu_task_ids.size() + gpu_task_ids.size());
+  for (const auto &task_id : cpu_task_ids) {
+    ASSERT_TRUE(decision[task_id] == local_node || decision[task_id] == cpu_node);
+  }
+  for (const auto &task_id : gpu_task_ids) {
+    ASSERT_EQ(decision[task_id], gpu_node);
+  }
+  for (const auto &task_id : infeasible_task_ids) {
+    ASSERT_EQ(decision.count(task_id), 0);
+  }
+
+  // The load of the nodes accounts for all of the placed tasks. The first 20 CPU
+  // tasks fit in the free resources of the nodes.
+  const double local_load =
+      cluster_resources[local_node].GetLoadResources().GetResource("CPU").ToDouble();
+  const double cpu_node_load =
+      cluster_resources[cpu_node].GetLoadResources().GetResource("CPU").ToDouble();
+  ASSERT_EQ(local_load + cpu_node_load, 25);
+  ASSERT_GE(local_load, 8);
+  ASSERT_GE(cpu_node_load, 12);
+  ASSERT_EQ(cluster_resources[gpu_node].GetLoadResources().GetResource("GPU").ToDouble(),
+            2);
+}
+
+TEST_F(SchedulingPolicyTest, TestScheduleByArgumentLocality) {
+  const ClientID local_node = ClientID::FromRandom();
+  const ClientID data_node = ClientID::FromRandom();
+  const ClientID other_node = ClientID::FromRandom();
+  std::unordered_map<ClientID, SchedulingResources> cluster_resources;
+  for (const auto &node_id : {local_node, data_node, other_node}) {
+    cluster_resources[node_id] =
+        SchedulingResources(ResourceSet(ResourceMap{{"CPU", 4}}));
+  }
+
+  // Six tasks have 10 MB of arguments on the data node, and one has too few bytes
+  // there to be placed by locality.
+  const uint64_t large_bytes = 10 * 1024 * 1024;
+  auto large_task_ids = QueueTasks({{"CPU", 1}}, 6);
+  auto small_task_ids = QueueTasks({{"CPU", 1}}, 1);
+  std::unordered_map<TaskID, std::unordered_map<ClientID, uint64_t>> argument_bytes;
+  for (const auto &task_id : large_task_ids) {
+    argument_bytes[task_id] = {{data_node, large_bytes}, {other_node, 1024}};
+  }
+  argument_bytes[small_task_ids[0]] = {{data_node, 1024}};
+  SchedulingPolicy scheduling_policy(
+      scheduling_queue_,
+      [&argument_bytes](const TaskSpecification &spec,
+                        std::unordered_map<ClientID, uint64_t> *bytes_by_node) {
+        for (const auto &node_bytes : argument_bytes[spec.TaskId()]) {
+          (*bytes_by_node)[node_bytes.first] += node_bytes.second;
+        }
+      });
+  auto decision = scheduling_policy.Schedule(cluster_resources, local_node);
+  ASSERT_EQ(decision.size(), 7);
+
+  // The tasks go to the data node until its resources are used up.
+  int num_on_data_node = 0;
+  for (const auto &task_id : large_task_ids) {
+    num_on_data_node += decision[task_id] == data_node;
+  }
+  ASSERT_EQ(num_on_data_node, 4);
+  ASSERT_EQ(scheduling_policy.NumLocalityPlacements(), 4);
+  ASSERT_EQ(scheduling_policy.LocalityBytesOnNode(), 4 * large_bytes);
+}
+
+TEST_F(SchedulingPolicyTest, TestChooseStealVictim) {
+  const ClientID local_node = ClientID::FromRandom();
+  const ClientID gpu_node = ClientID::FromRandom();
+  const ClientID cpu_node = ClientID::FromRandom();
+  const ClientID exhausted_node = ClientID::FromRandom();
+  std::unordered_map<ClientID, SchedulingResources> cluster_resources;
+  for (const auto &node_id : {local_node, gpu_node, cpu_node, exhausted_node}) {
+    cluster_resources[node_id] =
+        SchedulingResources(ResourceSet(ResourceMap{{"CPU", 4}, {"GPU", 1}}));
+  }
+  cluster_resources[local_node].Acquire(ResourceSet(ResourceMap{{"GPU", 1}}));
+  cluster_resources[gpu_node].SetLoadResources(ResourceSet(ResourceMap{{"GPU", 10}}));
+  cluster_resources[cpu_node].SetLoadResources(ResourceSet(ResourceMap{{"CPU", 3}}));
+  cluster_resources[exhausted_node].SetLoadResources(
+      ResourceSet(ResourceMap{{"CPU", 5}}));
+
+  // Only the load on resources that are free here counts, and nodes that aren't
+  // candidates are skipped even if they have the most load.
+  std::unordered_set<ClientID> excluded = {exhausted_node};
+  auto is_candidate = [&excluded](const ClientID &node_id) {
+    return excluded.count(node_id) == 0;
+  };
+  ASSERT_EQ(scheduling_policy_.ChooseStealVictim(cluster_resources, local_node,
+                                                 is_candidate),
+            cpu_node);
+  excluded.clear();
+  ASSERT_EQ(scheduling_policy_.ChooseStealVictim(cluster_resources, local_node,
+                                                 is_candidate),
+            exhausted_node);
+  excluded = {cpu_node, exhausted_node};
+  ASSERT_TRUE(scheduling_policy_
+                  .ChooseStealVictim(cluster_resources, local_node, is_candidate)
+                  .IsNil());
+}
+
+TEST_F(SchedulingPolicyTest, TestChooseTasksToHandOver) {
+  auto cpu_task_ids = QueueTasks({{"CPU", 1}}, 4, TaskState::READY);
+  auto gpu_task_ids = QueueTasks({{"GPU", 1}}, 2, TaskState::READY);
+  const ResourceSet available(ResourceMap{{"CPU", 3}, {"GPU", 1}});
+  // The first CPU task can't be handed over, e.g. because a worker is being started
+  // for it.
+  auto can_hand_over = [&cpu_task_ids](const TaskSpecification &spec) {
+    return spec.TaskId() != cpu_task_ids[0];
+  };
+
+  // The tasks of each class are picked while they fit in the available resources.
+  auto task_ids = scheduling_policy_.ChooseTasksToHandOver(available, 10, can_hand_over);
+  ASSERT_EQ(task_ids.size(), 4);
+  ASSERT_EQ(task_ids.count(cpu_task_ids[0]), 0);
+  for (size_t i = 1; i < cpu_task_ids.size(); i++) {
+    ASSERT_EQ(task_ids.count(cpu_task_ids[i]), 1);
+  }
+  ASSERT_EQ(task_ids.count(gpu_task_ids[0]), 1);
+
+  // No more tasks than requested are picked.
+  task_ids = scheduling_policy_.ChooseTasksToHandOver(available, 2, can_hand_over);
+  ASSERT_EQ(task_ids.size(), 2);
+  ASSERT_EQ(task_ids.count(cpu_task_ids[0]), 0);
+}
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,9 +1,12 @@
 #include "scheduling_queue.h"
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 #include "ray/common/status.h"
 #include "ray/stats/stats.h"
+#include "ray/util/util.h"
 
 namespace {
 
@@ -19,6 +22,21 @@ inline const char *GetTaskStateString(ray::raylet::TaskState task_state) {
   return task_state_strings[static_cast<int>(task_state)];
 }
 
+/// Get the deadline of a task, where tasks without a deadline come last.
+inline int64_t EffectiveDeadlineMs(const ray::TaskSpecification &spec) {
+  return spec.DeadlineMs() > 0 ? spec.DeadlineMs() : std::numeric_limits<int64_t>::max();
+}
+
+/// Whether a task should be dispatched before another task: higher priorities
+/// come first, then earlier deadlines.
+inline bool HasPrecedence(const ray::TaskSpecification &spec,
+                          const ray::TaskSpecification &other) {
+  if (spec.Priority() != other.Priority()) {
+    return spec.Priority() > other.Priority();
+  }
+  return EffectiveDeadlineMs(spec) < EffectiveDeadlineMs(other);
+}
+
 // Helper function to get tasks for a job from a given state.
 template <typename TaskQueue>
 inline void GetTasksForJobFromQueue(const TaskQueue &queue, const ray::JobID &job_id,
@@ -51,62 +69,148 @@ namespace ray {
 
 namespace raylet {
 
-bool TaskQueue::AppendTask(const TaskID &task_id, const Task &task) {
-  RAY_CHECK(task_map_.find(task_id) == task_map_.end());
-  auto list_iterator = task_list_.insert(task_list_.end(), task);
-  task_map_[task_id] = list_iterator;
-  // Resource bookkeeping
-  current_resource_load_.AddResources(task.GetTaskSpecification().GetRequiredResources());
-  return true;
+constexpr TaskStore::Handle TaskStore::kNilHandle;
+constexpr size_t TaskStore::kSlabSize;
+
+TaskStore::~TaskStore() {
+  for (const auto &task_pair : index_) {
+    GetEntry(task_pair.second).TaskPtr()->~Task();
+  }
 }
 
-bool TaskQueue::RemoveTask(const TaskID &task_id, std::vector<Task> *removed_tasks) {
-  auto task_found_iterator = task_map_.find(task_id);
-  if (task_found_iterator == task_map_.end()) {
-    return false;
+TaskStore::Handle TaskStore::AddTask(const Task &task, TaskState state) {
+  const TaskID task_id = task.GetTaskSpecification().TaskId();
+  RAY_CHECK(index_.find(task_id) == index_.end())
+      << "Task " << task_id << " is already queued";
+  if (free_handles_.empty()) {
+    // Allocate a new slab.
+    const size_t first_handle = slabs_.size() * kSlabSize;
+    RAY_CHECK(first_handle + kSlabSize < kNilHandle);
+    slabs_.emplace_back(new Entry[kSlabSize]);
+    for (size_t i = kSlabSize; i > 0; i--) {
+      free_handles_.push_back(first_handle + i - 1);
+    }
+  }
+  const Handle handle = free_handles_.back();
+  free_handles_.pop_back();
+  Entry &entry = GetEntry(handle);
+  new (&entry.task_storage) Task(task);
+  entry.state = state;
+  entry.state_time_ms = current_time_ms();
+  entry.prev = kNilHandle;
+  entry.next = kNilHandle;
+  index_.emplace(task_id, handle);
+  return handle;
+}
+
+Task TaskStore::RemoveTask(Handle handle) {
+  Entry &entry = GetEntry(handle);
+  Task *task = entry.TaskPtr();
+  index_.erase(task->GetTaskSpecification().TaskId());
+  Task removed_task(std::move(*task));
+  task->~Task();
+  free_handles_.push_back(handle);
+  return removed_task;
+}
+
+TaskStore::Handle TaskStore::Find(const TaskID &task_id) const {
+  auto it = index_.find(task_id);
+  return it == index_.end() ? kNilHandle : it->second;
+}
+
+void TaskStore::LinkBack(Handle handle, Handle *head, Handle *tail) {
+  Entry &entry = GetEntry(handle);
+  entry.prev = *tail;
+  entry.next = kNilHandle;
+  if (*tail == kNilHandle) {
+    *head = handle;
+  } else {
+    GetEntry(*tail).next = handle;
+  }
+  *tail = handle;
+}
+
+void TaskStore::Unlink(Handle handle, Handle *head, Handle *tail) {
+  Entry &entry = GetEntry(handle);
+  if (entry.prev == kNilHandle) {
+    *head = entry.next;
+  } else {
+    GetEntry(entry.prev).next = entry.next;
   }
+  if (entry.next == kNilHandle) {
+    *tail = entry.prev;
+  } else {
+    GetEntry(entry.next).prev = entry.prev;
+  }
+  entry.prev = kNilHandle;
+  entry.next = kNilHandle;
+}
+
+void TaskStore::SetState(Handle handle, TaskState state) {
+  Entry &entry = GetEntry(handle);
+  entry.state = state;
+  entry.state_time_ms = current_time_ms();
+}
 
-  auto list_iterator = task_found_iterator->second;
+void TaskQueue::AppendTask(TaskStore::Handle handle) {
+  RAY_CHECK(store_.GetState(handle) == state_);
+  store_.LinkBack(handle, &head_, &tail_);
+  size_++;
+  // Resource bookkeeping
+  current_resource_load_.AddResources(
+      store_.GetTask(handle).GetTaskSpecification().GetRequiredResources());
+}
+
+void TaskQueue::RemoveTask(TaskStore::Handle handle) {
+  RAY_CHECK(store_.GetState(handle) == state_);
   // Resource bookkeeping
   current_resource_load_.SubtractResourcesStrict(
-      list_iterator->GetTaskSpecification().GetRequiredResources());
-  if (removed_tasks) {
-    removed_tasks->push_back(std::move(*list_iterator));
-  }
-  task_map_.erase(task_found_iterator);
-  task_list_.erase(list_iterator);
-  return true;
+      store_.GetTask(handle).GetTaskSpecification().GetRequiredResources());
+  store_.Unlink(handle, &head_, &tail_);
+  size_--;
 }
 
 bool TaskQueue::HasTask(const TaskID &task_id) const {
-  return task_map_.find(task_id) != task_map_.end();
+  const TaskStore::Handle handle = store_.Find(task_id);
+  return handle != TaskStore::kNilHandle && store_.GetState(handle) == state_;
 }
 
-const std::list<Task> &TaskQueue::GetTasks() const { return task_list_; }
+TaskQueue::TaskList TaskQueue::GetTasks() const {
+  return TaskList(&store_, head_, size_);
+}
 
 const Task &TaskQueue::GetTask(const TaskID &task_id) const {
-  auto it = task_map_.find(task_id);
-  RAY_CHECK(it != task_map_.end());
-  return *it->second;
+  const TaskStore::Handle handle = store_.Find(task_id);
+  RAY_CHECK(handle != TaskStore::kNilHandle && store_.GetState(handle) == state_);
+  return store_.GetTask(handle);
 }
 
 const ResourceSet &TaskQueue::GetCurrentResourceLoad() const {
   return current_resource_load_;
 }
 
-bool ReadyQueue::AppendTask(const TaskID &task_id, const Task &task) {
-  const auto &scheduling_class = task.GetTaskSpecification().GetSchedulingClass();
-  tasks_by_class_[scheduling_class].push_back(task_id);
-  return TaskQueue::AppendTask(task_id, task);
+void ReadyQueue::AppendTask(TaskStore::Handle handle) {
+  const auto &spec = store_.GetTask(handle).GetTaskSpecification();
+  auto &class_tasks = tasks_by_class_[spec.GetSchedulingClass()];
+  // Tasks are usually queued with the default priority and no deadline, so search
+  // for the position from the back.
+  auto position = class_tasks.end();
+  while (position != class_tasks.begin()) {
+    const auto &other =
+        store_.GetTask(store_.Find(*std::prev(position))).GetTaskSpecification();
+    if (!HasPrecedence(spec, other)) {
+      break;
+    }
+    position--;
+  }
+  class_tasks.insert(position, spec.TaskId());
+  TaskQueue::AppendTask(handle);
 }
 
-bool ReadyQueue::RemoveTask(const TaskID &task_id, std::vector<Task> *removed_tasks) {
-  if (task_map_.find(task_id) != task_map_.end()) {
-    const auto &scheduling_class =
-        task_map_[task_id]->GetTaskSpecification().GetSchedulingClass();
-    tasks_by_class_[scheduling_class].erase(task_id);
-  }
-  return TaskQueue::RemoveTask(task_id, removed_tasks);
+void ReadyQueue::RemoveTask(TaskStore::Handle handle) {
+  const auto &spec = store_.GetTask(handle).GetTaskSpecification();
+  tasks_by_class_[spec.GetSchedulingClass()].erase(spec.TaskId());
+  TaskQueue::RemoveTask(handle);
 }
 
 const std::unordered_map<SchedulingClass, ordered_set<TaskID>>
@@ -114,7 +218,7 @@ const std::unordered_map<SchedulingClass, ordered_set<TaskID>>
   return tasks_by_class_;
 }
 
-const std::list<Task> &SchedulingQueue::GetTasks(TaskState task_state) const {
+TaskQueue::TaskList SchedulingQueue::GetTasks(TaskState task_state) const {
   const auto &queue = GetTaskQueue(task_state);
   return queue->GetTasks();
 }
@@ -130,6 +234,12 @@ const Task &SchedulingQueue::GetTaskOfState(const TaskID &task_id,
   return queue->GetTask(task_id);
 }
 
+int64_t SchedulingQueue::GetTaskStateTimeMs(const TaskID &task_id) const {
+  const TaskStore::Handle handle = task_store_.Find(task_id);
+  RAY_CHECK(handle != TaskStore::kNilHandle) << "Task " << task_id << " is not queued";
+  return task_store_.GetStateTimeMs(handle);
+}
+
 ResourceSet SchedulingQueue::GetResourceLoad() const {
   auto load = ready_queue_->GetCurrentResourceLoad();
   // Also take into account infeasible tasks so they show up for autoscaling.
@@ -212,42 +322,30 @@ const std::shared_ptr<TaskQueue> &SchedulingQueue::GetTaskQueue(
   return task_queues_[static_cast<int>(task_state)];
 }
 
-// Helper function to remove tasks in the given set of task_ids from a
-// queue, and append them to the given vector removed_tasks.
-void SchedulingQueue::RemoveTasksFromQueue(ray::raylet::TaskState task_state,
-                                           std::unordered_set<ray::TaskID> &task_ids,
-                                           std::vector<ray::Task> *removed_tasks) {
-  auto &queue = GetTaskQueue(task_state);
-  for (auto it = task_ids.begin(); it != task_ids.end();) {
-    const auto &task_id = *it;
-    if (queue->RemoveTask(task_id, removed_tasks)) {
-      RAY_LOG(DEBUG) << "Removed task " << task_id << " from "
-                     << GetTaskStateString(task_state) << " queue";
-      if (task_state == TaskState::RUNNING) {
-        num_running_tasks_
-            [removed_tasks->back().GetTaskSpecification().GetSchedulingClass()] -= 1;
-      }
-      it = task_ids.erase(it);
-    } else {
-      it++;
-    }
+Task SchedulingQueue::RemoveTaskFromQueue(TaskStore::Handle handle) {
+  const TaskState task_state = task_store_.GetState(handle);
+  GetTaskQueue(task_state)->RemoveTask(handle);
+  Task task = task_store_.RemoveTask(handle);
+  RAY_LOG(DEBUG) << "Removed task " << task.GetTaskSpecification().TaskId() << " from "
+                 << GetTaskStateString(task_state) << " queue";
+  if (task_state == TaskState::RUNNING) {
+    AddNumRunning(task.GetTaskSpecification().GetSchedulingClass(), -1);
   }
+  return task;
 }
 
 std::vector<Task> SchedulingQueue::RemoveTasks(std::unordered_set<TaskID> &task_ids) {
   // List of removed tasks to be returned.
   std::vector<Task> removed_tasks;
   // Try to find the tasks to remove from the queues.
-  for (const auto &task_state : {
-           TaskState::PLACEABLE,
-           TaskState::WAITING,
-           TaskState::READY,
-           TaskState::RUNNING,
-           TaskState::INFEASIBLE,
-           TaskState::WAITING_FOR_ACTOR_CREATION,
-           TaskState::SWAP,
-       }) {
-    RemoveTasksFromQueue(task_state, task_ids, &removed_tasks);
+  for (auto it = task_ids.begin(); it != task_ids.end();) {
+    const TaskStore::Handle handle = task_store_.Find(*it);
+    if (handle != TaskStore::kNilHandle) {
+      removed_tasks.push_back(RemoveTaskFromQueue(handle));
+      it = task_ids.erase(it);
+    } else {
+      it++;
+    }
   }
 
   RAY_CHECK(task_ids.size() == 0);
@@ -256,98 +354,63 @@ std::vector<Task> SchedulingQueue::RemoveTasks(std::unordered_set<TaskID> &task_
 
 bool SchedulingQueue::RemoveTask(const TaskID &task_id, Task *removed_task,
                                  TaskState *removed_task_state) {
-  std::vector<Task> removed_tasks;
-  std::unordered_set<TaskID> task_id_set = {task_id};
-  // Try to find the task to remove in the queues.
-  for (const auto &task_state : {
-           TaskState::PLACEABLE,
-           TaskState::WAITING,
-           TaskState::READY,
-           TaskState::RUNNING,
-           TaskState::INFEASIBLE,
-           TaskState::WAITING_FOR_ACTOR_CREATION,
-           TaskState::SWAP,
-       }) {
-    RemoveTasksFromQueue(task_state, task_id_set, &removed_tasks);
-    if (task_id_set.empty()) {
-      // The task was removed from the current queue.
-      if (removed_task_state != nullptr) {
-        // If the state of the removed task was requested, then set it with the
-        // current queue's state.
-        *removed_task_state = task_state;
-      }
-      break;
-    }
+  const TaskStore::Handle handle = task_store_.Find(task_id);
+  if (handle == TaskStore::kNilHandle) {
+    RAY_LOG(DEBUG) << "Task " << task_id
+                   << " that is to be removed could not be found any more."
+                   << " Probably its driver was removed.";
+    return false;
   }
-
-  // Make sure we got the removed task.
-  if (removed_tasks.size() == 1) {
-    *removed_task = removed_tasks.front();
-    RAY_CHECK(removed_task->GetTaskSpecification().TaskId() == task_id);
-    return true;
+  if (removed_task_state != nullptr) {
+    // If the state of the removed task was requested, then set it with the
+    // current queue's state.
+    *removed_task_state = task_store_.GetState(handle);
   }
-  RAY_LOG(DEBUG) << "Task " << task_id
-                 << " that is to be removed could not be found any more."
-                 << " Probably its driver was removed.";
-  return false;
+  *removed_task = RemoveTaskFromQueue(handle);
+  return true;
 }
 
 void SchedulingQueue::MoveTasks(std::unordered_set<TaskID> &task_ids, TaskState src_state,
                                 TaskState dst_state) {
-  std::vector<Task> removed_tasks;
-
-  // Remove the tasks from the specified source queue.
-  switch (src_state) {
-  case TaskState::PLACEABLE:
-    RemoveTasksFromQueue(TaskState::PLACEABLE, task_ids, &removed_tasks);
-    break;
-  case TaskState::WAITING:
-    RemoveTasksFromQueue(TaskState::WAITING, task_ids, &removed_tasks);
-    break;
-  case TaskState::READY:
-    RemoveTasksFromQueue(TaskState::READY, task_ids, &removed_tasks);
-    break;
-  case TaskState::RUNNING:
-    RemoveTasksFromQueue(TaskState::RUNNING, task_ids, &removed_tasks);
-    break;
-  case TaskState::INFEASIBLE:
-    RemoveTasksFromQueue(TaskState::INFEASIBLE, task_ids, &removed_tasks);
-    break;
-  case TaskState::SWAP:
-    RemoveTasksFromQueue(TaskState::SWAP, task_ids, &removed_tasks);
-    break;
-  default:
+  // Tasks waiting for actor creation are never moved, only removed and resubmitted.
+  if (src_state >= TaskState::kNumTaskQueues ||
+      src_state == TaskState::WAITING_FOR_ACTOR_CREATION) {
     RAY_LOG(FATAL) << "Attempting to move tasks from unrecognized state "
                    << static_cast<std::underlying_type<TaskState>::type>(src_state);
   }
-
-  // Make sure that all tasks were able to be moved.
-  RAY_CHECK(task_ids.empty());
-
-  // Add the tasks to the specified destination queue.
-  switch (dst_state) {
-  case TaskState::PLACEABLE:
-    QueueTasks(removed_tasks, TaskState::PLACEABLE);
-    break;
-  case TaskState::WAITING:
-    QueueTasks(removed_tasks, TaskState::WAITING);
-    break;
-  case TaskState::READY:
-    QueueTasks(removed_tasks, TaskState::READY);
-    break;
-  case TaskState::RUNNING:
-    QueueTasks(removed_tasks, TaskState::RUNNING);
-    break;
-  case TaskState::INFEASIBLE:
-    QueueTasks(removed_tasks, TaskState::INFEASIBLE);
-    break;
-  case TaskState::SWAP:
-    QueueTasks(removed_tasks, TaskState::SWAP);
-    break;
-  default:
+  if (dst_state >= TaskState::kNumTaskQueues ||
+      dst_state == TaskState::WAITING_FOR_ACTOR_CREATION) {
     RAY_LOG(FATAL) << "Attempting to move tasks to unrecognized state "
                    << static_cast<std::underlying_type<TaskState>::type>(dst_state);
   }
+  auto &src_queue = GetTaskQueue(src_state);
+  auto &dst_queue = GetTaskQueue(dst_state);
+
+  // Relink the tasks from the source queue to the destination queue.
+  for (auto it = task_ids.begin(); it != task_ids.end();) {
+    const TaskStore::Handle handle = task_store_.Find(*it);
+    if (handle == TaskStore::kNilHandle || task_store_.GetState(handle) != src_state) {
+      it++;
+      continue;
+    }
+    src_queue->RemoveTask(handle);
+    task_store_.SetState(handle, dst_state);
+    dst_queue->AppendTask(handle);
+    const auto &spec = task_store_.GetTask(handle).GetTaskSpecification();
+    if (src_state == TaskState::RUNNING || dst_state == TaskState::RUNNING) {
+      AddNumRunning(spec.GetSchedulingClass(), (dst_state == TaskState::RUNNING) -
+                                                   (src_state == TaskState::RUNNING));
+    }
+    if (dst_state == TaskState::READY) {
+      MarkTaskReady(spec);
+    }
+    RAY_LOG(DEBUG) << "Moved task " << *it << " from " << GetTaskStateString(src_state)
+                   << " to " << GetTaskStateString(dst_state) << " queue";
+    it = task_ids.erase(it);
+  }
+
+  // Make sure that all tasks were able to be moved.
+  RAY_CHECK(task_ids.empty());
 }
 
 void SchedulingQueue::QueueTasks(const std::vector<Task> &tasks, TaskState task_state) {
@@ -356,19 +419,17 @@ void SchedulingQueue::QueueTasks(const std::vector<Task> &tasks, TaskState task_
     RAY_LOG(DEBUG) << "Added task " << task.GetTaskSpecification().TaskId() << " to "
                    << GetTaskStateString(task_state) << " queue";
     if (task_state == TaskState::RUNNING) {
-      num_running_tasks_[task.GetTaskSpecification().GetSchedulingClass()] += 1;
+      AddNumRunning(task.GetTaskSpecification().GetSchedulingClass(), 1);
+    }
+    queue->AppendTask(task_store_.AddTask(task, task_state));
+    if (task_state == TaskState::READY) {
+      MarkTaskReady(task.GetTaskSpecification());
     }
-    queue->AppendTask(task.GetTaskSpecification().TaskId(), task);
   }
 }
 
 bool SchedulingQueue::HasTask(const TaskID &task_id) const {
-  for (const auto &task_queue : task_queues_) {
-    if (task_queue->HasTask(task_id)) {
-      return true;
-    }
-  }
-  return false;
+  return task_store_.Find(task_id) != TaskStore::kNilHandle;
 }
 
 std::unordered_set<TaskID> SchedulingQueue::GetTaskIdsForJob(const JobID &job_id) const {
@@ -433,6 +494,154 @@ int SchedulingQueue::NumRunning(const SchedulingClass &cls) const {
   }
 }
 
+SchedulingQueue::DispatchKey SchedulingQueue::GetDispatchKey(
+    const SchedulingClass &scheduling_class) const {
+  int32_t priority = 0;
+  int64_t deadline_ms = std::numeric_limits<int64_t>::max();
+  const auto &tasks_by_class = ready_queue_->GetTasksByClass();
+  auto it = tasks_by_class.find(scheduling_class);
+  if (it != tasks_by_class.end() && it->second.size() > 0) {
+    // The first task of the class has the highest precedence.
+    const auto &spec = ready_queue_->GetTask(it->second.front()).GetTaskSpecification();
+    priority = spec.Priority();
+    deadline_ms = EffectiveDeadlineMs(spec);
+  }
+  return DispatchKey(-priority, deadline_ms,
+                     fair_queueing_enabled_ ? NumRunning(scheduling_class) : 0,
+                     scheduling_class);
+}
+
+void SchedulingQueue::UpdateDispatchKey(const SchedulingClass &scheduling_class,
+                                        ClassDispatchState &state) {
+  if (state.dispatch_all || !state.new_task_ids.empty()) {
+    dispatchable_classes_.erase(state.key);
+  }
+  state.key = GetDispatchKey(scheduling_class);
+  dispatchable_classes_.insert(state.key);
+}
+
+void SchedulingQueue::AddNumRunning(const SchedulingClass &scheduling_class,
+                                    int32_t delta) {
+  num_running_tasks_[scheduling_class] += delta;
+  // Reinsert the class among the dispatchable classes under its new key.
+  auto it = class_dispatch_states_.find(scheduling_class);
+  if (it != class_dispatch_states_.end() &&
+      (it->second.dispatch_all || !it->second.new_task_ids.empty())) {
+    UpdateDispatchKey(scheduling_class, it->second);
+  }
+}
+
+void SchedulingQueue::MarkTaskReady(const TaskSpecification &spec) {
+  const SchedulingClass scheduling_class = spec.GetSchedulingClass();
+  auto &state = class_dispatch_states_[scheduling_class];
+  if (state.blocker == DispatchBlocker::WORKERS && !state.dispatch_all) {
+    // The older tasks of the class are still waiting for workers, so only the
+    // new task needs to be tried.
+    UpdateDispatchKey(scheduling_class, state);
+    state.new_task_ids.push_back(spec.TaskId());
+  } else if (state.blocker == DispatchBlocker::NONE) {
+    MarkClassDispatchable(scheduling_class, state);
+  }
+  // A class that is blocked on resources can't run the new task either.
+}
+
+void SchedulingQueue::MarkClassDispatchable(const SchedulingClass &scheduling_class,
+                                            ClassDispatchState &state) {
+  // The new task may have moved the class ahead.
+  UpdateDispatchKey(scheduling_class, state);
+  state.dispatch_all = true;
+  state.new_task_ids.clear();
+}
+
+bool SchedulingQueue::PopDispatchableClass(SchedulingClass *scheduling_class,
+                                           std::vector<TaskID> *task_ids) {
+  while (!dispatchable_classes_.empty()) {
+    *scheduling_class = std::get<3>(*dispatchable_classes_.begin());
+    dispatchable_classes_.erase(dispatchable_classes_.begin());
+    auto &state = class_dispatch_states_[*scheduling_class];
+    task_ids->clear();
+    if (state.dispatch_all) {
+      // All of the tasks are tried, so the class is no longer blocked.
+      if (state.blocker == DispatchBlocker::RESOURCES) {
+        classes_blocked_on_resources_.erase(*scheduling_class);
+      } else if (state.blocker == DispatchBlocker::WORKERS) {
+        classes_blocked_on_workers_.erase(*scheduling_class);
+      }
+      state.blocker = DispatchBlocker::NONE;
+      state.dispatch_all = false;
+      return true;
+    }
+    // Skip the new tasks that are no longer ready.
+    for (const auto &task_id : state.new_task_ids) {
+      if (ready_queue_->HasTask(task_id)) {
+        task_ids->push_back(task_id);
+      }
+    }
+    state.new_task_ids.clear();
+    if (!task_ids->empty()) {
+      std::stable_sort(task_ids->begin(), task_ids->end(),
+                       [this](const TaskID &task_id, const TaskID &other_id) {
+                         return HasPrecedence(
+                             ready_queue_->GetTask(task_id).GetTaskSpecification(),
+                             ready_queue_->GetTask(other_id).GetTaskSpecification());
+                       });
+      return true;
+    }
+  }
+  return false;
+}
+
+void SchedulingQueue::FinishDispatch(const SchedulingClass &scheduling_class,
+                                     DispatchBlocker blocker) {
+  auto it = class_dispatch_states_.find(scheduling_class);
+  RAY_CHECK(it != class_dispatch_states_.end());
+  auto &state = it->second;
+  if (blocker == DispatchBlocker::NONE) {
+    // If only the new tasks of a class that is blocked on workers were tried, the
+    // older tasks are still blocked.
+    if (state.blocker == DispatchBlocker::NONE && !state.dispatch_all &&
+        state.new_task_ids.empty()) {
+      class_dispatch_states_.erase(it);
+    }
+    return;
+  }
+  if (state.blocker == DispatchBlocker::WORKERS) {
+    classes_blocked_on_workers_.erase(scheduling_class);
+  }
+  state.blocker = blocker;
+  if (blocker == DispatchBlocker::RESOURCES) {
+    classes_blocked_on_resources_.insert(scheduling_class);
+  } else {
+    classes_blocked_on_workers_.insert(scheduling_class);
+  }
+}
+
+void SchedulingQueue::WakeClassesBlockedOnResources(
+    const ResourceIdSet &available_resources) {
+  for (auto it = classes_blocked_on_resources_.begin();
+       it != classes_blocked_on_resources_.end();) {
+    const auto &task_resources =
+        TaskSpecification::GetSchedulingClassDescriptor(*it).first;
+    if (!available_resources.Contains(task_resources)) {
+      it++;
+      continue;
+    }
+    auto &state = class_dispatch_states_[*it];
+    state.blocker = DispatchBlocker::NONE;
+    MarkClassDispatchable(*it, state);
+    it = classes_blocked_on_resources_.erase(it);
+  }
+}
+
+void SchedulingQueue::WakeClassesBlockedOnWorkers() {
+  for (const auto &scheduling_class : classes_blocked_on_workers_) {
+    auto &state = class_dispatch_states_[scheduling_class];
+    state.blocker = DispatchBlocker::NONE;
+    MarkClassDispatchable(scheduling_class, state);
+  }
+  classes_blocked_on_workers_.clear();
+}
+
 std::string SchedulingQueue::DebugString() const {
   std::stringstream result;
   result << "SchedulingQueue:";
@@ -442,6 +651,10 @@ std::string SchedulingQueue::DebugString() const {
            << " tasks: " << GetTaskQueue(task_state)->GetTasks().size();
   }
   result << "\n- num tasks blocked: " << blocked_task_ids_.size();
+  result << "\n- num classes to dispatch: " << dispatchable_classes_.size();
+  result << "\n- num classes waiting for resources: "
+         << classes_blocked_on_resources_.size();
+  result << "\n- num classes waiting for workers: " << classes_blocked_on_workers_.size();
   result << "\nScheduledTaskCounts:";
   size_t total = 0;
   for (const auto &pair : num_running_tasks_) {
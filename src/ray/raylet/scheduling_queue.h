@@ -2,7 +2,11 @@
 #define RAY_RAYLET_SCHEDULING_QUEUE_H
 
 #include <array>
-#include <list>
+#include <limits>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -54,27 +58,196 @@ enum class TaskState {
   DRIVER,
 };
 
+/// What kept the ready tasks of a scheduling class from being dispatched.
+enum class DispatchBlocker {
+  // All of the ready tasks that were tried were dispatched.
+  NONE,
+  // The local node does not have the resources that the class requires.
+  RESOURCES,
+  // There was no idle worker for some of the ready tasks of the class.
+  WORKERS,
+};
+
+/// \class TaskStore
+///
+/// Stores the tasks of a scheduling queue. Each task lives in an entry of a
+/// fixed-size slab from the time it is queued until it is removed, and the task
+/// queues link the entries of their tasks into intrusive lists. Moving a task
+/// between queues relinks its entry instead of copying the task. The entries of
+/// removed tasks are reused.
+class TaskStore {
+ public:
+  /// The handle of a task in the store.
+  typedef uint32_t Handle;
+
+  /// The handle that refers to no task.
+  static constexpr Handle kNilHandle = std::numeric_limits<Handle>::max();
+
+  TaskStore() {}
+
+  TaskStore(const TaskStore &other) = delete;
+
+  /// TaskStore destructor. Destroys the tasks that are still stored.
+  ~TaskStore();
+
+  /// Add a task to the store. The task must not be in the store already.
+  ///
+  /// \param task The task to add.
+  /// \param state The state of the task.
+  /// \return The handle of the task.
+  Handle AddTask(const Task &task, TaskState state);
+
+  /// Remove a task from the store. The task must not be linked into a queue.
+  ///
+  /// \param handle The handle of the task.
+  /// \return The removed task.
+  Task RemoveTask(Handle handle);
+
+  /// Find a task by its ID.
+  ///
+  /// \param task_id The ID of the task.
+  /// \return The handle of the task, or kNilHandle if it's not in the store.
+  Handle Find(const TaskID &task_id) const;
+
+  /// Get a stored task. The reference is valid until the task is removed.
+  const Task &GetTask(Handle handle) const { return *GetEntry(handle).TaskPtr(); }
+
+  /// Get the state of a stored task.
+  TaskState GetState(Handle handle) const { return GetEntry(handle).state; }
+
+  /// Set the state of a stored task.
+  void SetState(Handle handle, TaskState state);
+
+  /// Get the time at which a stored task entered its current state.
+  int64_t GetStateTimeMs(Handle handle) const { return GetEntry(handle).state_time_ms; }
+
+  /// Get the handle of the next task in the queue of a task.
+  Handle Next(Handle handle) const { return GetEntry(handle).next; }
+
+  /// Link a task to the back of an intrusive list.
+  ///
+  /// \param handle The handle of the task.
+  /// \param head The handle of the first task in the list.
+  /// \param tail The handle of the last task in the list.
+  void LinkBack(Handle handle, Handle *head, Handle *tail);
+
+  /// Unlink a task from an intrusive list.
+  ///
+  /// \param handle The handle of the task.
+  /// \param head The handle of the first task in the list.
+  /// \param tail The handle of the last task in the list.
+  void Unlink(Handle handle, Handle *head, Handle *tail);
+
+  /// Return the number of stored tasks.
+  size_t Size() const { return index_.size(); }
+
+ private:
+  /// The number of entries in a slab.
+  static constexpr size_t kSlabSize = 1024;
+
+  /// The entry of a task. The task is only constructed while the entry is used.
+  struct Entry {
+    /// The storage of the task.
+    std::aligned_storage<sizeof(Task), alignof(Task)>::type task_storage;
+    /// The state of the task.
+    TaskState state;
+    /// The time at which the task entered its state, in milliseconds.
+    int64_t state_time_ms;
+    /// The previous task in the queue of the task.
+    Handle prev;
+    /// The next task in the queue of the task.
+    Handle next;
+
+    Task *TaskPtr() { return reinterpret_cast<Task *>(&task_storage); }
+    const Task *TaskPtr() const { return reinterpret_cast<const Task *>(&task_storage); }
+  };
+
+  Entry &GetEntry(Handle handle) {
+    return slabs_[handle / kSlabSize][handle % kSlabSize];
+  }
+
+  const Entry &GetEntry(Handle handle) const {
+    return slabs_[handle / kSlabSize][handle % kSlabSize];
+  }
+
+  /// The slabs of entries. Entries never move, so stored tasks keep their address.
+  std::vector<std::unique_ptr<Entry[]>> slabs_;
+  /// The handles of the unused entries.
+  std::vector<Handle> free_handles_;
+  /// The handle of each stored task.
+  std::unordered_map<TaskID, Handle> index_;
+};
+
 class TaskQueue {
  public:
+  /// A view of the tasks in a queue, in the order they were appended.
+  class TaskList {
+   public:
+    class const_iterator {
+     public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef Task value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const Task *pointer;
+      typedef const Task &reference;
+
+      const_iterator(const TaskStore *store, TaskStore::Handle handle)
+          : store_(store), handle_(handle) {}
+
+      const Task &operator*() const { return store_->GetTask(handle_); }
+      const Task *operator->() const { return &store_->GetTask(handle_); }
+
+      const_iterator &operator++() {
+        handle_ = store_->Next(handle_);
+        return *this;
+      }
+
+      bool operator==(const const_iterator &other) const {
+        return handle_ == other.handle_;
+      }
+      bool operator!=(const const_iterator &other) const {
+        return handle_ != other.handle_;
+      }
+
+     private:
+      const TaskStore *store_;
+      TaskStore::Handle handle_;
+    };
+
+    TaskList(const TaskStore *store, TaskStore::Handle head, size_t size)
+        : store_(store), head_(head), size_(size) {}
+
+    const_iterator begin() const { return const_iterator(store_, head_); }
+    const_iterator end() const { return const_iterator(store_, TaskStore::kNilHandle); }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+   private:
+    const TaskStore *store_;
+    TaskStore::Handle head_;
+    size_t size_;
+  };
+
+  /// Create a task queue.
+  ///
+  /// \param store The store of the tasks.
+  /// \param state The state of the tasks in the queue.
+  TaskQueue(TaskStore &store, TaskState state) : store_(store), state_(state) {}
+
   /// TaskQueue destructor.
   virtual ~TaskQueue() {}
 
   /// \brief Append a task to queue.
   ///
-  /// \param task_id The task ID for the task to append.
-  /// \param task The task to append to the queue.
-  /// \return Whether the append operation succeeds.
-  virtual bool AppendTask(const TaskID &task_id, const Task &task);
+  /// \param handle The handle of the task in the store. The task must have the
+  /// state of the queue and must not be in another queue.
+  virtual void AppendTask(TaskStore::Handle handle);
 
   /// \brief Remove a task from queue.
   ///
-  /// \param task_id The task ID for the task to remove from the queue.
-  /// \param removed_tasks If the task specified by task_id is successfully
-  ///  removed from the queue, the task data is appended to the vector. Can
-  ///  be a nullptr, in which case nothing is appended.
-  /// \return Whether the removal succeeds.
-  virtual bool RemoveTask(const TaskID &task_id,
-                          std::vector<Task> *removed_tasks = nullptr);
+  /// \param handle The handle of the task in the store. The task must be in the
+  /// queue.
+  virtual void RemoveTask(TaskStore::Handle handle);
 
   /// \brief Check if the queue contains a specific task id.
   ///
@@ -85,7 +258,7 @@ class TaskQueue {
   /// \brief Return the task list of the queue.
   ///
   /// \return A list of tasks contained in this queue.
-  const std::list<Task> &GetTasks() const;
+  TaskList GetTasks() const;
 
   /// Get a task from the queue. The caller must ensure that the task is in
   /// the queue.
@@ -99,35 +272,40 @@ class TaskQueue {
   const ResourceSet &GetCurrentResourceLoad() const;
 
  protected:
-  /// A list of tasks.
-  std::list<Task> task_list_;
-  /// A hash to speed up looking up a task.
-  std::unordered_map<TaskID, std::list<Task>::iterator> task_map_;
+  /// The store of the tasks.
+  TaskStore &store_;
+  /// The state of the tasks in the queue.
+  const TaskState state_;
+  /// The first task in the queue.
+  TaskStore::Handle head_ = TaskStore::kNilHandle;
+  /// The last task in the queue.
+  TaskStore::Handle tail_ = TaskStore::kNilHandle;
+  /// The number of tasks in the queue.
+  size_t size_ = 0;
   /// Aggregate resources of all the tasks in this queue.
   ResourceSet current_resource_load_;
 };
 
 class ReadyQueue : public TaskQueue {
  public:
-  ReadyQueue(){};
+  explicit ReadyQueue(TaskStore &store) : TaskQueue(store, TaskState::READY) {}
 
   ReadyQueue(const ReadyQueue &other) = delete;
 
   /// ReadyQueue destructor.
   virtual ~ReadyQueue() {}
 
-  /// \brief Append a task to queue.
+  /// \brief Append a task to queue. Within its class, the task is placed behind
+  /// the tasks with a higher priority or an earlier deadline, and behind the
+  /// tasks that were queued before it with the same priority and deadline.
   ///
-  /// \param task_id The task ID for the task to append.
-  /// \param task The task to append to the queue.
-  /// \return Whether the append operation succeeds.
-  bool AppendTask(const TaskID &task_id, const Task &task) override;
+  /// \param handle The handle of the task in the store.
+  void AppendTask(TaskStore::Handle handle) override;
 
   /// \brief Remove a task from queue.
   ///
-  /// \param task_id The task ID for the task to remove from the queue.
-  /// \return Whether the removal succeeds.
-  bool RemoveTask(const TaskID &task_id, std::vector<Task> *removed_tasks) override;
+  /// \param handle The handle of the task in the store.
+  void RemoveTask(TaskStore::Handle handle) override;
 
   /// \brief Get a mapping from resource shape to tasks.
   ///
@@ -146,7 +324,12 @@ class ReadyQueue : public TaskQueue {
 class SchedulingQueue {
  public:
   /// Create a scheduling queue.
-  SchedulingQueue() : ready_queue_(std::make_shared<ReadyQueue>()) {
+  ///
+  /// \param fair_queueing_enabled Whether classes of ready tasks with fewer running
+  /// tasks are dispatched first.
+  explicit SchedulingQueue(bool fair_queueing_enabled = true)
+      : ready_queue_(std::make_shared<ReadyQueue>(task_store_)),
+        fair_queueing_enabled_(fair_queueing_enabled) {
     for (const auto &task_state : {
              TaskState::PLACEABLE,
              TaskState::WAITING,
@@ -159,7 +342,8 @@ class SchedulingQueue {
       if (task_state == TaskState::READY) {
         task_queues_[static_cast<int>(task_state)] = ready_queue_;
       } else {
-        task_queues_[static_cast<int>(task_state)] = std::make_shared<TaskQueue>();
+        task_queues_[static_cast<int>(task_state)] =
+            std::make_shared<TaskQueue>(task_store_, task_state);
       }
     }
   }
@@ -177,7 +361,8 @@ class SchedulingQueue {
   ///
   /// \param task_state The requested task state. This must correspond to one
   /// of the task queues (has value < TaskState::kNumTaskQueues).
-  const std::list<Task> &GetTasks(TaskState task_state) const;
+  /// \return A view of the tasks, which is valid until tasks are removed.
+  TaskQueue::TaskList GetTasks(TaskState task_state) const;
 
   /// Get a reference to the queue of ready tasks.
   ///
@@ -193,6 +378,12 @@ class SchedulingQueue {
   /// \return The task.
   const Task &GetTaskOfState(const TaskID &task_id, TaskState task_state) const;
 
+  /// Get the time at which a queued task entered its current state.
+  ///
+  /// \param task_id The task, which must be queued.
+  /// \return The time in milliseconds.
+  int64_t GetTaskStateTimeMs(const TaskID &task_id) const;
+
   /// \brief Return an aggregate resource set for all tasks exerting load on this raylet.
   ///
   /// \return A resource set with aggregate resource information about resource load on
@@ -274,6 +465,8 @@ class SchedulingQueue {
   /// task queues.
   /// \param dst_state Destination state, corresponding to one of the internal
   /// task queues.
+  ///
+  /// The tasks stay where they are stored, so moving a task doesn't copy it.
   void MoveTasks(std::unordered_set<TaskID> &tasks, TaskState src_state,
                  TaskState dst_state);
 
@@ -306,6 +499,38 @@ class SchedulingQueue {
   /// \return int.
   int NumRunning(const SchedulingClass &cls) const;
 
+  /// \brief Pop the next scheduling class whose ready tasks may be dispatchable.
+  /// A class is dispatchable when tasks of the class became ready, or when what
+  /// blocked the class the last time it was dispatched was lifted. If fair
+  /// queueing is enabled, classes with fewer running tasks are popped first. The
+  /// caller must report the outcome with FinishDispatch.
+  ///
+  /// \param scheduling_class The popped class will be written here.
+  /// \param task_ids The ready tasks of the class to try will be written here. If
+  /// this is empty, all of the ready tasks of the class should be tried.
+  /// \return Whether a class was popped.
+  bool PopDispatchableClass(SchedulingClass *scheduling_class,
+                            std::vector<TaskID> *task_ids);
+
+  /// \brief Record what kept the ready tasks of a popped class from being
+  /// dispatched. A class that is blocked on resources is not popped again until
+  /// the resources are available. A class that is blocked on workers is only
+  /// popped for its newly ready tasks until a worker is returned.
+  ///
+  /// \param scheduling_class The class that was popped.
+  /// \param blocker What kept the tasks of the class from being dispatched.
+  void FinishDispatch(const SchedulingClass &scheduling_class, DispatchBlocker blocker);
+
+  /// \brief Make the classes that are blocked on resources dispatchable if the
+  /// given resources fit them.
+  ///
+  /// \param available_resources The resources that are available locally.
+  void WakeClassesBlockedOnResources(const ResourceIdSet &available_resources);
+
+  /// \brief Make the classes that are blocked on workers dispatchable. This
+  /// should be called when a worker is returned to the pool or disconnects.
+  void WakeClassesBlockedOnWorkers();
+
   /// Returns debug string for class.
   ///
   /// \return string.
@@ -320,12 +545,11 @@ class SchedulingQueue {
   /// TaskState::kNumTaskQueues).
   const std::shared_ptr<TaskQueue> &GetTaskQueue(TaskState task_state) const;
 
-  /// A helper function to remove tasks from a given queue. The requested task
-  /// state must correspond to one of the task queues (has value <
-  /// TaskState::kNumTaskQueues).
-  void RemoveTasksFromQueue(ray::raylet::TaskState task_state,
-                            std::unordered_set<ray::TaskID> &task_ids,
-                            std::vector<ray::Task> *removed_tasks);
+  /// A helper function to remove a task from its queue and from the store.
+  ///
+  /// \param handle The handle of the task in the store.
+  /// \return The removed task.
+  Task RemoveTaskFromQueue(TaskStore::Handle handle);
 
   /// A helper function to filter out tasks of a given state from the set of
   /// task IDs. The requested task state must correspond to one of the task
@@ -333,6 +557,60 @@ class SchedulingQueue {
   void FilterStateFromQueue(std::unordered_set<ray::TaskID> &task_ids,
                             TaskState task_state) const;
 
+  /// The key that orders the dispatchable classes: the negated priority and the
+  /// deadline of the first ready task of the class, then the number of running
+  /// tasks of the class if fair queueing is enabled.
+  using DispatchKey = std::tuple<int32_t, int64_t, int32_t, SchedulingClass>;
+
+  /// The dispatch state of a scheduling class that has ready tasks.
+  struct ClassDispatchState {
+    /// Whether all of the ready tasks of the class should be tried.
+    bool dispatch_all = false;
+    /// The newly ready tasks to try, if not all of the tasks should be tried.
+    std::vector<TaskID> new_task_ids;
+    /// What kept the tasks of the class from being dispatched the last time.
+    DispatchBlocker blocker = DispatchBlocker::NONE;
+    /// The key under which the class is in the dispatchable classes, if it has
+    /// tasks to try.
+    DispatchKey key;
+  };
+
+  /// Record that a task became ready, so that its class is dispatched.
+  ///
+  /// \param spec The task that became ready.
+  void MarkTaskReady(const TaskSpecification &spec);
+
+  /// Make all of the ready tasks of a class be tried in the next dispatch.
+  ///
+  /// \param scheduling_class The class to dispatch.
+  /// \param state The dispatch state of the class.
+  void MarkClassDispatchable(const SchedulingClass &scheduling_class,
+                             ClassDispatchState &state);
+
+  /// Get the key that orders a class among the dispatchable classes.
+  ///
+  /// \param scheduling_class The class.
+  /// \return The key of the class.
+  DispatchKey GetDispatchKey(const SchedulingClass &scheduling_class) const;
+
+  /// Add a class to the dispatchable classes, or move it to its current key if
+  /// it is already there.
+  ///
+  /// \param scheduling_class The class.
+  /// \param state The dispatch state of the class.
+  void UpdateDispatchKey(const SchedulingClass &scheduling_class,
+                         ClassDispatchState &state);
+
+  /// Change the number of running tasks of a class, and reorder the class among
+  /// the dispatchable classes.
+  ///
+  /// \param scheduling_class The class.
+  /// \param delta The change in the number of running tasks.
+  void AddNumRunning(const SchedulingClass &scheduling_class, int32_t delta);
+
+  /// The store of the tasks in all task queues. This must be declared before the
+  /// queues, which refer to it.
+  TaskStore task_store_;
   // A pointer to the ready queue.
   const std::shared_ptr<ReadyQueue> ready_queue_;
   /// Track the breakdown of tasks by class in the RUNNING queue.
@@ -347,6 +625,16 @@ class SchedulingQueue {
   /// The set of currently running driver tasks. These are empty tasks that are
   /// started by a driver process on initialization.
   std::unordered_set<TaskID> driver_task_ids_;
+  /// Whether classes with fewer running tasks are dispatched first.
+  const bool fair_queueing_enabled_;
+  /// The dispatch state of the classes that have ready tasks.
+  std::unordered_map<SchedulingClass, ClassDispatchState> class_dispatch_states_;
+  /// The classes that have ready tasks to try, in the order to dispatch them.
+  std::set<DispatchKey> dispatchable_classes_;
+  /// The classes that are waiting for resources to be released.
+  std::unordered_set<SchedulingClass> classes_blocked_on_resources_;
+  /// The classes that are waiting for a worker to be returned.
+  std::unordered_set<SchedulingClass> classes_blocked_on_workers_;
 };
 
 }  // namespace raylet
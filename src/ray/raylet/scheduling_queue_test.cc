@@ -0,0 +1,292 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <list>
+
+#include "ray/common/task/task_util.h"
+#include "ray/raylet/scheduling_queue.h"
+
+namespace ray {
+
+namespace raylet {
+
+using ResourceMap = std::unordered_map<std::string, double>;
+
+static inline Task ExampleTask(const ResourceMap &required_resources,
+                               int32_t priority = 0, int64_t deadline_ms = 0) {
+  TaskSpecBuilder builder;
+  rpc::Address address;
+  builder.SetCommonTaskSpec(TaskID::ForFakeTask(), Language::PYTHON, {"", "", ""},
+                            JobID::Nil(), TaskID::ForFakeTask(), 0, TaskID::ForFakeTask(),
+                            address, 0, false, required_resources, {});
+  builder.SetSchedulingPriority(priority, deadline_ms);
+  rpc::TaskExecutionSpec execution_spec_message;
+  return Task(builder.Build(), TaskExecutionSpecification(execution_spec_message));
+}
+
+static inline std::vector<TaskID> GetTaskIds(const TaskQueue::TaskList &tasks) {
+  std::vector<TaskID> task_ids;
+  for (const auto &task : tasks) {
+    task_ids.push_back(task.GetTaskSpecification().TaskId());
+  }
+  return task_ids;
+}
+
+/// Move tasks through the states of a task that is placed locally, as the node manager
+/// does, and compare with copying the tasks between lists as the queues did before
+/// they shared a task store.
+static inline void MoveTasksThroughStates(size_t num_tasks, bool log_timing) {
+  const std::vector<TaskState> states = {TaskState::PLACEABLE, TaskState::WAITING,
+                                         TaskState::READY, TaskState::SWAP,
+                                         TaskState::RUNNING};
+  std::vector<Task> tasks;
+  std::unordered_set<TaskID> all_task_ids;
+  for (size_t i = 0; i < num_tasks; i++) {
+    tasks.push_back(ExampleTask({{"CPU", 1}}));
+    all_task_ids.insert(tasks.back().GetTaskSpecification().TaskId());
+  }
+
+  SchedulingQueue queue;
+  queue.QueueTasks(tasks, states.front());
+  std::vector<std::unordered_set<TaskID>> move_ids(states.size(), all_task_ids);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 1; i < states.size(); i++) {
+    queue.MoveTasks(move_ids[i], states[i - 1], states[i]);
+  }
+  auto store_time = std::chrono::steady_clock::now() - start;
+  for (size_t i = 0; i + 1 < states.size(); i++) {
+    ASSERT_TRUE(queue.GetTasks(states[i]).empty());
+  }
+  const auto moved_ids = GetTaskIds(queue.GetTasks(states.back()));
+  ASSERT_EQ(std::unordered_set<TaskID>(moved_ids.begin(), moved_ids.end()),
+            all_task_ids);
+
+  std::vector<std::list<Task>> lists(states.size());
+  std::vector<std::unordered_map<TaskID, std::list<Task>::iterator>> maps(states.size());
+  for (const auto &task : tasks) {
+    auto it = lists[0].insert(lists[0].end(), task);
+    maps[0][task.GetTaskSpecification().TaskId()] = it;
+  }
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 1; i < states.size(); i++) {
+    std::vector<Task> removed_tasks;
+    for (const auto &task_id : all_task_ids) {
+      auto map_it = maps[i - 1].find(task_id);
+      removed_tasks.push_back(std::move(*map_it->second));
+      lists[i - 1].erase(map_it->second);
+      maps[i - 1].erase(map_it);
+    }
+    for (const auto &task : removed_tasks) {
+      auto it = lists[i].insert(lists[i].end(), task);
+      maps[i][task.GetTaskSpecification().TaskId()] = it;
+    }
+  }
+  auto baseline_time = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(lists.back().size(), num_tasks);
+  if (!log_timing) {
+    return;
+  }
+
+  const double num_moves = static_cast<double>(num_tasks) * (states.size() - 1);
+  RAY_LOG(INFO) << "MoveTasks: "
+                << num_moves / std::chrono::duration<double>(store_time).count()
+                << " tasks/s, copying between lists: "
+                << num_moves / std::chrono::duration<double>(baseline_time).count()
+                << " tasks/s.";
+}
+
+TEST(SchedulingQueueTest, TestMoveAndRemoveTasks) {
+  SchedulingQueue queue;
+  std::vector<Task> tasks;
+  std::vector<TaskID> task_ids;
+  for (int i = 0; i < 4; i++) {
+    tasks.push_back(ExampleTask({{"CPU", 1}}));
+    task_ids.push_back(tasks.back().GetTaskSpecification().TaskId());
+  }
+  queue.QueueTasks(tasks, TaskState::PLACEABLE);
+  ASSERT_EQ(GetTaskIds(queue.GetTasks(TaskState::PLACEABLE)), task_ids);
+
+  // Moved tasks keep their address and are appended in the destination queue.
+  const Task *stored_task = &queue.GetTaskOfState(task_ids[1], TaskState::PLACEABLE);
+  std::unordered_set<TaskID> move_ids = {task_ids[1], task_ids[2]};
+  queue.MoveTasks(move_ids, TaskState::PLACEABLE, TaskState::READY);
+  ASSERT_TRUE(move_ids.empty());
+  ASSERT_EQ(&queue.GetTaskOfState(task_ids[1], TaskState::READY), stored_task);
+  ASSERT_EQ(GetTaskIds(queue.GetTasks(TaskState::PLACEABLE)),
+            std::vector<TaskID>({task_ids[0], task_ids[3]}));
+  ASSERT_EQ(queue.GetTasks(TaskState::READY).size(), 2);
+  ASSERT_EQ(queue.GetResourceLoad(), ResourceSet(ResourceMap{{"CPU", 2}}));
+  const auto &scheduling_class = tasks[1].GetTaskSpecification().GetSchedulingClass();
+  ASSERT_EQ(queue.GetReadyTasksByClass().at(scheduling_class).size(), 2);
+
+  move_ids = {task_ids[1]};
+  queue.MoveTasks(move_ids, TaskState::READY, TaskState::RUNNING);
+  ASSERT_EQ(queue.NumRunning(scheduling_class), 1);
+  ASSERT_EQ(queue.GetResourceLoad(), ResourceSet(ResourceMap{{"CPU", 1}}));
+  ASSERT_EQ(queue.GetReadyTasksByClass().at(scheduling_class).size(), 1);
+
+  // Removed tasks leave the queues, and their entries are reused.
+  Task removed_task;
+  TaskState removed_state;
+  ASSERT_TRUE(queue.RemoveTask(task_ids[1], &removed_task, &removed_state));
+  ASSERT_EQ(removed_task.GetTaskSpecification().TaskId(), task_ids[1]);
+  ASSERT_EQ(removed_state, TaskState::RUNNING);
+  ASSERT_EQ(queue.NumRunning(scheduling_class), 0);
+  ASSERT_FALSE(queue.HasTask(task_ids[1]));
+  ASSERT_FALSE(queue.RemoveTask(task_ids[1], &removed_task));
+  std::unordered_set<TaskID> remove_ids = {task_ids[0], task_ids[2]};
+  ASSERT_EQ(queue.RemoveTasks(remove_ids).size(), 2);
+  ASSERT_EQ(GetTaskIds(queue.GetTasks(TaskState::PLACEABLE)),
+            std::vector<TaskID>({task_ids[3]}));
+  ASSERT_TRUE(queue.GetTasks(TaskState::READY).empty());
+  queue.QueueTasks({tasks[0]}, TaskState::SWAP);
+  ASSERT_TRUE(queue.HasTask(task_ids[0]));
+  ASSERT_EQ(GetTaskIds(queue.GetTasks(TaskState::SWAP)),
+            std::vector<TaskID>({task_ids[0]}));
+}
+
+TEST(SchedulingQueueTest, TestDispatchableClasses) {
+  SchedulingQueue queue;
+  std::vector<Task> cpu_tasks;
+  for (int i = 0; i < 4; i++) {
+    cpu_tasks.push_back(ExampleTask({{"CPU", 1}}));
+  }
+  const Task gpu_task = ExampleTask({{"GPU", 1}});
+  const auto &cpu_class = cpu_tasks[0].GetTaskSpecification().GetSchedulingClass();
+  const auto &gpu_class = gpu_task.GetTaskSpecification().GetSchedulingClass();
+  queue.QueueTasks({cpu_tasks[0]}, TaskState::RUNNING);
+  queue.QueueTasks({cpu_tasks[1], cpu_tasks[2]}, TaskState::READY);
+  queue.QueueTasks({gpu_task}, TaskState::READY);
+
+  // Classes with fewer running tasks are popped first, and all of their ready
+  // tasks are tried.
+  SchedulingClass scheduling_class;
+  std::vector<TaskID> task_ids;
+  ASSERT_TRUE(queue.PopDispatchableClass(&scheduling_class, &task_ids));
+  ASSERT_EQ(scheduling_class, gpu_class);
+  ASSERT_TRUE(task_ids.empty());
+  queue.FinishDispatch(gpu_class, DispatchBlocker::RESOURCES);
+  ASSERT_TRUE(queue.PopDispatchableClass(&scheduling_class, &task_ids));
+  ASSERT_EQ(scheduling_class, cpu_class);
+  ASSERT_TRUE(task_ids.empty());
+  queue.FinishDispatch(cpu_class, DispatchBlocker::WORKERS);
+  ASSERT_FALSE(queue.PopDispatchableClass(&scheduling_class, &task_ids));
+
+  // Only the new task of a class that is blocked on workers is tried, and a class
+  // that is blocked on resources is not tried.
+  queue.QueueTasks({cpu_tasks[3]}, TaskState::READY);
+  queue.QueueTasks({ExampleTask({{"GPU", 1}})}, TaskState::READY);
+  ASSERT_TRUE(queue.PopDispatchableClass(&scheduling_class, &task_ids));
+  ASSERT_EQ(scheduling_class, cpu_class);
+  ASSERT_EQ(task_ids,
+            std::vector<TaskID>({cpu_tasks[3].GetTaskSpecification().TaskId()}));
+  queue.FinishDispatch(cpu_class, DispatchBlocker::NONE);
+  ASSERT_FALSE(queue.PopDispatchableClass(&scheduling_class, &task_ids));
+
+  // Classes are woken up when what blocked them is lifted.
+  queue.WakeClassesBlockedOnResources(ResourceSet(ResourceMap{{"CPU", 4}}));
+  ASSERT_FALSE(queue.PopDispatchableClass(&scheduling_class, &task_ids));
+  queue.WakeClassesBlockedOnResources(ResourceSet(ResourceMap{{"GPU", 1}}));
+  ASSERT_TRUE(queue.PopDispatchableClass(&scheduling_class, &task_ids));
+  ASSERT_EQ(scheduling_class, gpu_class);
+  queue.FinishDispatch(gpu_class, DispatchBlocker::NONE);
+  queue.WakeClassesBlockedOnWorkers();
+  ASSERT_TRUE(queue.PopDispatchableClass(&scheduling_class, &task_ids));
+  ASSERT_EQ(scheduling_class, cpu_class);
+  ASSERT_TRUE(task_ids.empty());
+  queue.FinishDispatch(cpu_class, DispatchBlocker::NONE);
+  ASSERT_FALSE(queue.PopDispatchableClass(&scheduling_class, &task_ids));
+}
+
+TEST(SchedulingQueueTest, TestPriorityAndDeadlineOrdering) {
+  SchedulingQueue queue;
+  std::vector<Task> tasks = {
+      ExampleTask({{"CPU", 1}}, 0), ExampleTask({{"CPU", 1}}, 1, 2000),
+      ExampleTask({{"CPU", 1}}, 1), ExampleTask({{"CPU", 1}}, 1, 1000),
+      ExampleTask({{"CPU", 1}}, 0)};
+  queue.QueueTasks(tasks, TaskState::READY);
+
+  // Higher priorities come first, then earlier deadlines, then queueing order.
+  const auto &cpu_class = tasks[0].GetTaskSpecification().GetSchedulingClass();
+  std::vector<TaskID> class_task_ids;
+  for (const auto &task_id : queue.GetReadyTasksByClass().at(cpu_class)) {
+    class_task_ids.push_back(task_id);
+  }
+  ASSERT_EQ(class_task_ids, std::vector<TaskID>({
+                                tasks[3].GetTaskSpecification().TaskId(),
+                                tasks[1].GetTaskSpecification().TaskId(),
+                                tasks[2].GetTaskSpecification().TaskId(),
+                                tasks[0].GetTaskSpecification().TaskId(),
+                                tasks[4].GetTaskSpecification().TaskId(),
+                            }));
+
+  // Classes are dispatched by the priority and then the deadline of their first
+  // task.
+  queue.QueueTasks({ExampleTask({{"GPU", 1}}, 0)}, TaskState::READY);
+  const Task urgent_task = ExampleTask({{"custom", 1}}, 0, 500);
+  queue.QueueTasks({urgent_task}, TaskState::READY);
+  const auto &urgent_class = urgent_task.GetTaskSpecification().GetSchedulingClass();
+  std::vector<SchedulingClass> classes;
+  SchedulingClass scheduling_class;
+  std::vector<TaskID> task_ids;
+  while (queue.PopDispatchableClass(&scheduling_class, &task_ids)) {
+    classes.push_back(scheduling_class);
+    queue.FinishDispatch(scheduling_class, DispatchBlocker::NONE);
+  }
+  ASSERT_EQ(classes.size(), 3);
+  ASSERT_EQ(classes[0], cpu_class);
+  ASSERT_EQ(classes[1], urgent_class);
+  ASSERT_GT(queue.GetTaskStateTimeMs(urgent_task.GetTaskSpecification().TaskId()), 0);
+}
+
+TEST(SchedulingQueueTest, TestConcurrentLeaseRequestsForOneClass) {
+  // A core worker keeps several lease requests in flight for one scheduling class,
+  // each sent with a different queued task. The node manager drops a request whose
+  // task is already queued, so all of them must be queued side by side.
+  SchedulingQueue queue;
+  std::vector<Task> tasks;
+  for (int i = 0; i < 3; i++) {
+    tasks.push_back(ExampleTask({{"CPU", 1}}));
+  }
+  const auto &scheduling_class = tasks[0].GetTaskSpecification().GetSchedulingClass();
+  for (const auto &task : tasks) {
+    const auto &task_id = task.GetTaskSpecification().TaskId();
+    ASSERT_FALSE(queue.HasTask(task_id));
+    queue.QueueTasks({task}, TaskState::READY);
+  }
+  ASSERT_EQ(queue.GetReadyTasksByClass().at(scheduling_class).size(), 3);
+  ASSERT_EQ(queue.GetResourceLoad(), ResourceSet(ResourceMap{{"CPU", 3}}));
+
+  // The task of a granted lease stays queued until the worker is returned, so a
+  // request sent with it again in the meantime would be dropped.
+  const auto &granted_id = tasks[1].GetTaskSpecification().TaskId();
+  std::unordered_set<TaskID> move_ids = {granted_id};
+  queue.MoveTasks(move_ids, TaskState::READY, TaskState::RUNNING);
+  ASSERT_TRUE(queue.HasTask(granted_id));
+  ASSERT_EQ(queue.NumRunning(scheduling_class), 1);
+  ASSERT_EQ(queue.GetReadyTasksByClass().at(scheduling_class).size(), 2);
+  Task removed_task;
+  ASSERT_TRUE(queue.RemoveTask(granted_id, &removed_task));
+  ASSERT_FALSE(queue.HasTask(granted_id));
+}
+
+TEST(SchedulingQueueTest, TestMoveTasksThroughStates) {
+  MoveTasksThroughStates(/*num_tasks=*/100, /*log_timing=*/false);
+}
+
+// Built with RAY_BENCHMARKS by the benchmark target, which runs only this test:
+// bazel run //:raylet_scheduling_queue_benchmark
+#ifdef RAY_BENCHMARKS
+TEST(SchedulingQueueTest, TestMoveTasksBenchmark) {
+  MoveTasksThroughStates(/*num_tasks=*/100000, /*log_timing=*/true);
+}
+#endif  // RAY_BENCHMARKS
+
+}  // namespace raylet
+
+}  // namespace ray
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,5 +1,7 @@
 #include "task_dependency_manager.h"
 
+#include <algorithm>
+
 #include "absl/time/clock.h"
 
 #include "ray/stats/stats.h"
@@ -48,16 +50,43 @@ bool TaskDependencyManager::CheckObjectRequired(const ObjectID &object_id) const
   return true;
 }
 
+PullPriority TaskDependencyManager::GetPullPriority(const ObjectID &object_id) const {
+  PullPriority priority = PullPriority::PREFETCH;
+  auto creating_task_entry = required_tasks_.find(object_id.TaskId());
+  if (creating_task_entry == required_tasks_.end()) {
+    return priority;
+  }
+  auto object_entry = creating_task_entry->second.find(object_id);
+  if (object_entry == creating_task_entry->second.end()) {
+    return priority;
+  }
+  if (!object_entry->second.dependent_workers.empty()) {
+    priority = PullPriority::WAIT;
+  }
+  for (const auto &task_id : object_entry->second.dependent_tasks) {
+    auto task_entry = task_dependencies_.find(task_id);
+    if (task_entry != task_dependencies_.end()) {
+      priority = std::min(priority, task_entry->second.priority);
+    }
+  }
+  return priority;
+}
+
 void TaskDependencyManager::HandleRemoteDependencyRequired(const ObjectID &object_id) {
   bool required = CheckObjectRequired(object_id);
   // If the object is required, then try to make the object available locally.
   if (required) {
-    auto inserted = required_objects_.insert(object_id);
+    PullPriority priority = GetPullPriority(object_id);
+    auto inserted = required_objects_.emplace(object_id, priority);
     if (inserted.second) {
       // If we haven't already, request the object manager to pull it from a
       // remote node.
-      RAY_CHECK_OK(object_manager_.Pull(object_id));
+      RAY_CHECK_OK(object_manager_.Pull(object_id, priority));
       reconstruction_policy_.ListenAndMaybeReconstruct(object_id);
+    } else if (priority < inserted.first->second) {
+      // A more urgent dependent subscribed to the object.
+      inserted.first->second = priority;
+      RAY_CHECK_OK(object_manager_.Pull(object_id, priority));
     }
   }
 }
@@ -160,8 +189,10 @@ std::vector<TaskID> TaskDependencyManager::HandleObjectMissing(
 }
 
 bool TaskDependencyManager::SubscribeGetDependencies(
-    const TaskID &task_id, const std::vector<ObjectID> &required_objects) {
+    const TaskID &task_id, const std::vector<ObjectID> &required_objects,
+    PullPriority priority) {
   auto &task_entry = task_dependencies_[task_id];
+  task_entry.priority = std::min(task_entry.priority, priority);
 
   // Record the task's dependencies.
   for (const auto &object_id : required_objects) {
@@ -56,10 +56,13 @@ class TaskDependencyManager {
   ///
   /// \param task_id The ID of the task whose dependencies to subscribe to.
   /// \param required_objects The objects required by the task.
+  /// \param priority The priority with which to pull the objects: TASK_ARGUMENT for
+  /// task arguments and GET for `ray.get` calls.
   /// \return Whether all of the given dependencies for the given task are
   /// local.
   bool SubscribeGetDependencies(const TaskID &task_id,
-                                const std::vector<ObjectID> &required_objects);
+                                const std::vector<ObjectID> &required_objects,
+                                PullPriority priority = PullPriority::TASK_ARGUMENT);
 
   /// Subscribe to object depedencies required by the worker. This should be called for
   /// ray.wait calls during task execution.
@@ -172,6 +175,8 @@ class TaskDependencyManager {
     /// The number of object arguments that are not available locally. This
     /// must be zero before the task is ready to execute.
     int64_t num_missing_get_dependencies;
+    /// The highest priority with which the task subscribed to its dependencies.
+    PullPriority priority = PullPriority::PREFETCH;
   };
 
   /// The objects that the worker is fetching. These are objects that a task that executed
@@ -199,8 +204,13 @@ class TaskDependencyManager {
   /// subscribed task dependent on it, (2) the object is not local, and (3) the
   /// task that creates the object is not pending execution locally.
   bool CheckObjectRequired(const ObjectID &object_id) const;
+  /// Return the priority with which to pull an object, which is the highest priority
+  /// of the tasks and workers that depend on it.
+  PullPriority GetPullPriority(const ObjectID &object_id) const;
   /// If the given object is required, then request that the object be made
-  /// available through object transfer or reconstruction.
+  /// available through object transfer or reconstruction. If the object is already
+  /// requested, but the priority of its dependents rose, then request it again with
+  /// the higher priority.
   void HandleRemoteDependencyRequired(const ObjectID &object_id);
   /// If the given object is no longer required, then cancel any in-progress
   /// operations to make the object available through object transfer or
@@ -242,8 +252,9 @@ class TaskDependencyManager {
       required_tasks_;
   /// Objects that are required by a subscribed task, are not local, and are
   /// not created by a pending task. For these objects, there are pending
-  /// operations to make the object available.
-  std::unordered_set<ray::ObjectID> required_objects_;
+  /// operations to make the object available. This maps each object to the
+  /// priority with which it was requested from the object manager.
+  std::unordered_map<ray::ObjectID, PullPriority> required_objects_;
   /// The set of locally available objects.
   std::unordered_set<ray::ObjectID> local_objects_;
   /// The set of tasks that are pending execution. Any objects created by these
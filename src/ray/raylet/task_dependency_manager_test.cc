@@ -23,7 +23,7 @@ const static TaskID kDefaultDriverTaskId = TaskID::ForDriverTask(kDefaultJobId);
 
 class MockObjectManager : public ObjectManagerInterface {
  public:
-  MOCK_METHOD1(Pull, ray::Status(const ObjectID &object_id));
+  MOCK_METHOD2(Pull, ray::Status(const ObjectID &object_id, PullPriority priority));
   MOCK_METHOD1(CancelPull, void(const ObjectID &object_id));
 };
 
@@ -132,7 +132,7 @@ TEST_F(TaskDependencyManagerTest, TestSimpleTask) {
   // No objects have been registered in the task dependency manager, so all
   // arguments should be remote.
   for (const auto &argument_id : arguments) {
-    EXPECT_CALL(object_manager_mock_, Pull(argument_id));
+    EXPECT_CALL(object_manager_mock_, Pull(argument_id, _));
     EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_id));
   }
   // Subscribe to the task's dependencies.
@@ -170,7 +170,7 @@ TEST_F(TaskDependencyManagerTest, TestDuplicateSubscribeGetDependencies) {
     // Subscribe to the task's dependencies. All arguments except the last are
     // duplicates of previous subscription calls. Each argument should only be
     // requested from the node manager once.
-    EXPECT_CALL(object_manager_mock_, Pull(argument_id));
+    EXPECT_CALL(object_manager_mock_, Pull(argument_id, _));
     EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_id));
     bool ready = task_dependency_manager_.SubscribeGetDependencies(task_id, arguments);
     ASSERT_FALSE(ready);
@@ -202,7 +202,7 @@ TEST_F(TaskDependencyManagerTest, TestMultipleTasks) {
   int num_dependent_tasks = 3;
   // The object should only be requested from the object manager once for all
   // three tasks.
-  EXPECT_CALL(object_manager_mock_, Pull(argument_id));
+  EXPECT_CALL(object_manager_mock_, Pull(argument_id, _));
   EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_id));
   for (int i = 0; i < num_dependent_tasks; i++) {
     TaskID task_id = RandomTaskId();
@@ -234,7 +234,7 @@ TEST_F(TaskDependencyManagerTest, TestTaskChain) {
   int i = 0;
   // No objects should be remote or canceled since each task depends on a
   // locally queued task.
-  EXPECT_CALL(object_manager_mock_, Pull(_)).Times(0);
+  EXPECT_CALL(object_manager_mock_, Pull(_, _)).Times(0);
   EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(_)).Times(0);
   EXPECT_CALL(object_manager_mock_, CancelPull(_)).Times(0);
   EXPECT_CALL(reconstruction_policy_mock_, Cancel(_)).Times(0);
@@ -294,7 +294,7 @@ TEST_F(TaskDependencyManagerTest, TestDependentPut) {
 
   // No objects have been registered in the task dependency manager, so the put
   // object should be remote.
-  EXPECT_CALL(object_manager_mock_, Pull(put_id));
+  EXPECT_CALL(object_manager_mock_, Pull(put_id, _));
   EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(put_id));
   // Subscribe to the task's dependencies.
   bool ready = task_dependency_manager_.SubscribeGetDependencies(
@@ -330,7 +330,7 @@ TEST_F(TaskDependencyManagerTest, TestTaskForwarding) {
   task_dependency_manager_.UnsubscribeGetDependencies(task_id);
   // The object returned by the first task should be considered remote once we
   // cancel the forwarded task, since the second task depends on it.
-  EXPECT_CALL(object_manager_mock_, Pull(return_id));
+  EXPECT_CALL(object_manager_mock_, Pull(return_id, _));
   EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(return_id));
   task_dependency_manager_.TaskCanceled(task_id);
 
@@ -355,7 +355,7 @@ TEST_F(TaskDependencyManagerTest, TestEviction) {
   // No objects have been registered in the task dependency manager, so all
   // arguments should be remote.
   for (const auto &argument_id : arguments) {
-    EXPECT_CALL(object_manager_mock_, Pull(argument_id));
+    EXPECT_CALL(object_manager_mock_, Pull(argument_id, _));
     EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_id));
   }
   // Subscribe to the task's dependencies.
@@ -382,7 +382,7 @@ TEST_F(TaskDependencyManagerTest, TestEviction) {
   // Simulate each of the arguments getting evicted. Each object should now be
   // considered remote.
   for (const auto &argument_id : arguments) {
-    EXPECT_CALL(object_manager_mock_, Pull(argument_id));
+    EXPECT_CALL(object_manager_mock_, Pull(argument_id, _));
     EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(argument_id));
   }
   for (size_t i = 0; i < arguments.size(); i++) {
@@ -445,7 +445,7 @@ TEST_F(TaskDependencyManagerTest, TestRemoveTasksAndRelatedObjects) {
   auto tasks = MakeTaskChain(num_tasks, {}, 1);
   // No objects should be remote or canceled since each task depends on a
   // locally queued task.
-  EXPECT_CALL(object_manager_mock_, Pull(_)).Times(0);
+  EXPECT_CALL(object_manager_mock_, Pull(_, _)).Times(0);
   EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(_)).Times(0);
   EXPECT_CALL(object_manager_mock_, CancelPull(_)).Times(0);
   EXPECT_CALL(reconstruction_policy_mock_, Cancel(_)).Times(0);
@@ -506,7 +506,7 @@ TEST_F(TaskDependencyManagerTest, TestWaitDependencies) {
     wait_object_ids.push_back(ObjectID::FromRandom());
   }
   // Simulate a worker calling `ray.wait` on some objects.
-  EXPECT_CALL(object_manager_mock_, Pull(_)).Times(num_objects);
+  EXPECT_CALL(object_manager_mock_, Pull(_, _)).Times(num_objects);
   EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(_))
       .Times(num_objects);
   task_dependency_manager_.SubscribeWaitDependencies(worker_id, wait_object_ids);
@@ -540,7 +540,7 @@ TEST_F(TaskDependencyManagerTest, TestWaitDependenciesObjectLocal) {
   // requests for the objects that are not local.
   for (const auto &object_id : wait_object_ids) {
     if (object_id != local_object_id) {
-      EXPECT_CALL(object_manager_mock_, Pull(object_id));
+      EXPECT_CALL(object_manager_mock_, Pull(object_id, _));
       EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(object_id));
     }
   }
@@ -571,7 +571,7 @@ TEST_F(TaskDependencyManagerTest, TestWaitDependenciesHandleObjectLocal) {
     wait_object_ids.push_back(ObjectID::FromRandom());
   }
   // Simulate a worker calling `ray.wait` on some objects.
-  EXPECT_CALL(object_manager_mock_, Pull(_)).Times(num_objects);
+  EXPECT_CALL(object_manager_mock_, Pull(_, _)).Times(num_objects);
   EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(_))
       .Times(num_objects);
   task_dependency_manager_.SubscribeWaitDependencies(worker_id, wait_object_ids);
@@ -596,6 +596,33 @@ TEST_F(TaskDependencyManagerTest, TestWaitDependenciesHandleObjectLocal) {
   task_dependency_manager_.UnsubscribeWaitDependencies(worker_id);
 }
 
+/// Test that objects are pulled with the priority of their most urgent dependent,
+/// and requested again when a more urgent dependent subscribes.
+TEST_F(TaskDependencyManagerTest, TestPullPriority) {
+  WorkerID worker_id = WorkerID::FromRandom();
+  TaskID get_task_id = RandomTaskId();
+  TaskID task_id = RandomTaskId();
+  ObjectID object_id = ObjectID::FromRandom();
+  EXPECT_CALL(reconstruction_policy_mock_, ListenAndMaybeReconstruct(object_id));
+  // A `ray.wait` call requests the object with the lowest priority.
+  EXPECT_CALL(object_manager_mock_, Pull(object_id, PullPriority::WAIT));
+  task_dependency_manager_.SubscribeWaitDependencies(worker_id, {object_id});
+  // A `ray.get` call raises the priority.
+  EXPECT_CALL(object_manager_mock_, Pull(object_id, PullPriority::GET));
+  task_dependency_manager_.SubscribeGetDependencies(get_task_id, {object_id},
+                                                    PullPriority::GET);
+  // A task argument raises it further.
+  EXPECT_CALL(object_manager_mock_, Pull(object_id, PullPriority::TASK_ARGUMENT));
+  task_dependency_manager_.SubscribeGetDependencies(task_id, {object_id});
+  // Another `ray.wait` call doesn't lower it.
+  task_dependency_manager_.SubscribeWaitDependencies(WorkerID::FromRandom(), {object_id});
+
+  EXPECT_CALL(object_manager_mock_, CancelPull(object_id));
+  EXPECT_CALL(reconstruction_policy_mock_, Cancel(object_id));
+  auto ready_task_ids = task_dependency_manager_.HandleObjectLocal(object_id);
+  ASSERT_EQ(ready_task_ids.size(), 2);
+}
+
 }  // namespace raylet
 
 }  // namespace ray
@@ -35,6 +35,18 @@ class NodeManagerClient {
   /// \param[in] callback The callback function that handles reply.
   VOID_RPC_CLIENT_METHOD(NodeManagerService, ForwardTask, grpc_client_, )
 
+  /// Forward a batch of tasks and their uncommitted lineage.
+  ///
+  /// \param[in] request The request message.
+  /// \param[in] callback The callback function that handles reply.
+  VOID_RPC_CLIENT_METHOD(NodeManagerService, ForwardTasks, grpc_client_, )
+
+  /// Ask the node to hand over ready tasks that fit the requesting node.
+  ///
+  /// \param[in] request The request message.
+  /// \param[in] callback The callback function that handles reply.
+  VOID_RPC_CLIENT_METHOD(NodeManagerService, StealTasks, grpc_client_, )
+
   /// Get current node stats.
   VOID_RPC_CLIENT_METHOD(NodeManagerService, GetNodeStats, grpc_client_, )
 
@@ -14,6 +14,8 @@ namespace rpc {
   RPC_SERVICE_HANDLER(NodeManagerService, RequestWorkerLease, 100) \
   RPC_SERVICE_HANDLER(NodeManagerService, ReturnWorker, 100)       \
   RPC_SERVICE_HANDLER(NodeManagerService, ForwardTask, 100)        \
+  RPC_SERVICE_HANDLER(NodeManagerService, ForwardTasks, 100)       \
+  RPC_SERVICE_HANDLER(NodeManagerService, StealTasks, 100)         \
   RPC_SERVICE_HANDLER(NodeManagerService, PinObjectIDs, 100)       \
   RPC_SERVICE_HANDLER(NodeManagerService, GetNodeStats, 1)
 
@@ -43,6 +45,14 @@ class NodeManagerServiceHandler {
                                  ForwardTaskReply *reply,
                                  SendReplyCallback send_reply_callback) = 0;
 
+  virtual void HandleForwardTasks(const ForwardTasksRequest &request,
+                                  ForwardTasksReply *reply,
+                                  SendReplyCallback send_reply_callback) = 0;
+
+  virtual void HandleStealTasks(const StealTasksRequest &request,
+                                StealTasksReply *reply,
+                                SendReplyCallback send_reply_callback) = 0;
+
   virtual void HandlePinObjectIDs(const PinObjectIDsRequest &request,
                                   PinObjectIDsReply *reply,
                                   SendReplyCallback send_reply_callback) = 0;
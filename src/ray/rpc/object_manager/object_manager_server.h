@@ -6,15 +6,25 @@
 
 #include "src/ray/protobuf/object_manager.grpc.pb.h"
 #include "src/ray/protobuf/object_manager.pb.h"
+#include "src/ray/rpc/object_manager/push_request_reader.h"
 
 namespace ray {
 namespace rpc {
 
+/// NOTE: `Push` is registered separately as a raw method, see
+/// `ObjectManagerGrpcService::InitServerCallFactories`.
 #define RAY_OBJECT_MANAGER_RPC_HANDLERS              \
-  RPC_SERVICE_HANDLER(ObjectManagerService, Push, 5) \
   RPC_SERVICE_HANDLER(ObjectManagerService, Pull, 5) \
   RPC_SERVICE_HANDLER(ObjectManagerService, FreeObjects, 2)
 
+/// The gRPC service with `Push` registered as a raw method. The request of a raw method
+/// is delivered as the serialized bytes instead of a parsed message, which lets the
+/// handler copy chunk payloads directly out of the gRPC buffer.
+struct ObjectManagerRawPushService {
+  using AsyncService =
+      ObjectManagerService::WithRawMethod_Push<ObjectManagerService::AsyncService>;
+};
+
 /// Implementations of the `ObjectManagerGrpcService`, check interface in
 /// `src/ray/protobuf/object_manager.proto`.
 class ObjectManagerServiceHandler {
@@ -23,10 +33,11 @@ class ObjectManagerServiceHandler {
   /// The implementation can handle this request asynchronously. When handling is done,
   /// the `send_reply_callback` should be called.
   ///
-  /// \param[in] request The request message.
-  /// \param[out] reply The reply message.
+  /// \param[in] request The serialized `PushRequest`, to be read with
+  /// `PushRequestReader`.
+  /// \param[out] reply The serialized reply, see `PushRequestReader::SetEmptyReply`.
   /// \param[in] send_reply_callback The callback to be called when the request is done.
-  virtual void HandlePush(const PushRequest &request, PushReply *reply,
+  virtual void HandlePush(const grpc::ByteBuffer &request, grpc::ByteBuffer *reply,
                           SendReplyCallback send_reply_callback) = 0;
   /// Handle a `Pull` request
   virtual void HandlePull(const PullRequest &request, PullReply *reply,
@@ -55,12 +66,21 @@ class ObjectManagerGrpcService : public GrpcService {
       const std::unique_ptr<grpc::ServerCompletionQueue> &cq,
       std::vector<std::pair<std::unique_ptr<ServerCallFactory>, int>>
           *server_call_factories_and_concurrencies) override {
+    std::unique_ptr<ServerCallFactory> Push_call_factory(
+        new ServerCallFactoryImpl<ObjectManagerRawPushService,
+                                  ObjectManagerServiceHandler, grpc::ByteBuffer,
+                                  grpc::ByteBuffer>(
+            service_, &ObjectManagerRawPushService::AsyncService::RequestPush,
+            service_handler_, &ObjectManagerServiceHandler::HandlePush, cq,
+            main_service_));
+    server_call_factories_and_concurrencies->emplace_back(std::move(Push_call_factory),
+                                                          5);
     RAY_OBJECT_MANAGER_RPC_HANDLERS
   }
 
  private:
   /// The grpc async service object.
-  ObjectManagerService::AsyncService service_;
+  ObjectManagerRawPushService::AsyncService service_;
   /// The service handler that actually handle the requests.
   ObjectManagerServiceHandler &service_handler_;
 };
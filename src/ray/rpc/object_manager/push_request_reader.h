@@ -0,0 +1,174 @@
+#ifndef RAY_RPC_PUSH_REQUEST_READER_H
+#define RAY_RPC_PUSH_REQUEST_READER_H
+
+#include <algorithm>
+#include <cstring>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/impl/codegen/proto_buffer_reader.h>
+
+#include "ray/common/status.h"
+#include "src/ray/protobuf/object_manager.pb.h"
+
+namespace ray {
+namespace rpc {
+
+/// Reads a serialized `PushRequest` directly out of a gRPC receive buffer.
+///
+/// Deserializing a `PushRequest` as a protobuf message copies the chunk payload into a
+/// `std::string`, which the receiver then has to copy again into its destination
+/// buffer. This reader parses the header fields first and leaves the payload in the
+/// gRPC slices, so that `ReadPayload` can copy it straight into its destination (e.g.,
+/// a plasma buffer). The payload is then copied exactly once on the receive side.
+///
+/// Header fields that follow the payload (e.g., `codec`) are parsed too: `ReadHeader`
+/// skips over the payload, which only advances over the gRPC slices, and
+/// `ReadPayload` later reads it from its recorded offset.
+class PushRequestReader {
+ public:
+  using WireFormatLite = google::protobuf::internal::WireFormatLite;
+
+  /// Constructor. Copying a `grpc::ByteBuffer` only takes references on its slices.
+  ///
+  /// \param buffer The serialized `PushRequest`.
+  explicit PushRequestReader(const grpc::ByteBuffer &buffer) : buffer_(buffer) {}
+
+  /// Parse all the header fields of the request, skipping the payload.
+  ///
+  /// \param[out] header The request header. The `data` field is never set.
+  /// \return Status::Invalid if the request is malformed.
+  Status ReadHeader(PushRequest *header) {
+    grpc::ProtoBufferReader stream(&buffer_);
+    google::protobuf::io::CodedInputStream input(&stream);
+    // No payload field means that the chunk is empty.
+    payload_size_ = 0;
+    uint32_t tag;
+    while ((tag = input.ReadTag()) != 0) {
+      const int field_number = WireFormatLite::GetTagFieldNumber(tag);
+      const auto wire_type = WireFormatLite::GetTagWireType(tag);
+      bool ok = true;
+      if (wire_type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+        switch (field_number) {
+        case PushRequest::kPushIdFieldNumber:
+          ok = ReadBytes(input, header->mutable_push_id());
+          break;
+        case PushRequest::kObjectIdFieldNumber:
+          ok = ReadBytes(input, header->mutable_object_id());
+          break;
+        case PushRequest::kClientIdFieldNumber:
+          ok = ReadBytes(input, header->mutable_client_id());
+          break;
+        case PushRequest::kDataFieldNumber: {
+          uint32_t size;
+          ok = input.ReadVarint32(&size);
+          payload_offset_ = input.CurrentPosition();
+          payload_size_ = size;
+          ok = ok && input.Skip(static_cast<int>(size));
+          break;
+        }
+        default:
+          ok = WireFormatLite::SkipField(&input, tag);
+        }
+      } else if (wire_type == WireFormatLite::WIRETYPE_VARINT) {
+        uint64_t value;
+        switch (field_number) {
+        case PushRequest::kChunkIndexFieldNumber:
+          ok = input.ReadVarint64(&value);
+          header->set_chunk_index(static_cast<uint32_t>(value));
+          break;
+        case PushRequest::kDataSizeFieldNumber:
+          ok = input.ReadVarint64(&value);
+          header->set_data_size(value);
+          break;
+        case PushRequest::kMetadataSizeFieldNumber:
+          ok = input.ReadVarint64(&value);
+          header->set_metadata_size(value);
+          break;
+        case PushRequest::kCodecFieldNumber:
+          ok = input.ReadVarint64(&value);
+          header->set_codec(static_cast<CompressionCodec>(value));
+          break;
+        case PushRequest::kChunkSizeFieldNumber:
+          ok = input.ReadVarint64(&value);
+          header->set_chunk_size(value);
+          break;
+        default:
+          ok = WireFormatLite::SkipField(&input, tag);
+        }
+      } else {
+        ok = WireFormatLite::SkipField(&input, tag);
+      }
+      if (!ok) {
+        return Status::Invalid("Malformed push request header.");
+      }
+    }
+    return Status::OK();
+  }
+
+  /// The size of the payload. Only valid after a successful `ReadHeader`.
+  uint64_t PayloadSize() const { return payload_size_; }
+
+  /// Copy the payload into the given buffer. This must be called at most once, after
+  /// `ReadHeader`.
+  ///
+  /// \param[out] dest The destination buffer.
+  /// \param size The size of the destination buffer, which must match `PayloadSize`.
+  /// \return Status::Invalid if the size doesn't match, or the payload is truncated.
+  Status ReadPayload(uint8_t *dest, uint64_t size) {
+    if (size != payload_size_) {
+      return Status::Invalid("Push request payload size " +
+                             std::to_string(payload_size_) + " doesn't match " +
+                             std::to_string(size) + ".");
+    }
+    if (size == 0) {
+      return Status::OK();
+    }
+    grpc::ProtoBufferReader stream(&buffer_);
+    google::protobuf::io::CodedInputStream input(&stream);
+    input.Skip(payload_offset_);
+    uint64_t remaining = size;
+    while (remaining > 0) {
+      const void *data;
+      int available;
+      if (!input.GetDirectBufferPointer(&data, &available)) {
+        return Status::Invalid("Push request payload is truncated.");
+      }
+      const uint64_t num_bytes = std::min<uint64_t>(available, remaining);
+      std::memcpy(dest, data, num_bytes);
+      input.Skip(static_cast<int>(num_bytes));
+      dest += num_bytes;
+      remaining -= num_bytes;
+    }
+    return Status::OK();
+  }
+
+  /// Fill in the reply to a raw `Push` call. `PushReply` has no fields, so this is
+  /// an empty message.
+  ///
+  /// \param[out] reply The raw reply buffer.
+  static void SetEmptyReply(grpc::ByteBuffer *reply) {
+    grpc::Slice empty_slice;
+    *reply = grpc::ByteBuffer(&empty_slice, 1);
+  }
+
+ private:
+  static bool ReadBytes(google::protobuf::io::CodedInputStream &input,
+                        std::string *value) {
+    uint32_t size;
+    return input.ReadVarint32(&size) && input.ReadString(value, size);
+  }
+
+  /// The request buffer. This keeps the underlying slices alive while reading.
+  grpc::ByteBuffer buffer_;
+  /// The offset of the payload in the request, set by `ReadHeader`.
+  int payload_offset_ = 0;
+  /// The size of the payload, set by `ReadHeader`.
+  uint64_t payload_size_ = 0;
+};
+
+}  // namespace rpc
+}  // namespace ray
+
+#endif  // RAY_RPC_PUSH_REQUEST_READER_H
@@ -42,6 +42,15 @@ static Gauge ObjectManagerStats("object_manager_stats",
                                 "Stat the metric values of object in raylet", "pcs",
                                 {ValueTypeKey});
 
+static Gauge ObjectTransferCompressionStats(
+    "object_transfer_compression_stats",
+    "Stats the compression of object chunks transferred between nodes.", "pcs",
+    {CodecKey, ValueTypeKey});
+
+static Gauge ObjectSpillingStats("object_spilling_stats",
+                                 "Stats the objects spilled to local disk by raylet.",
+                                 "pcs", {ValueTypeKey});
+
 static Gauge LineageCacheStats("lineage_cache_stats",
                                "Stats the metric values of lineage cache.", "pcs",
                                {ValueTypeKey});
@@ -54,6 +63,15 @@ static Gauge SchedulingQueueStats("scheduling_queue_stats",
                                   "Stats the metric values of scheduling queue.", "pcs",
                                   {ValueTypeKey});
 
+static Histogram TaskQueueDelay(
+    "task_queue_delay",
+    "The time that tasks wait in the ready queue of the raylet, by task priority.", "ms",
+    {1, 5, 10, 50, 100, 500, 1000, 5000, 10000, 60000}, {PriorityKey});
+
+static Gauge SchedulingPolicyStats("scheduling_policy_stats",
+                                   "Stats the metric values of scheduling policy.", "pcs",
+                                   {ValueTypeKey});
+
 static Gauge ReconstructionPolicyStats(
     "reconstruction_policy_stats", "Stats the metric values of reconstruction policy.",
     "pcs", {ValueTypeKey});
@@ -25,4 +25,8 @@ static const TagKeyType ResourceNameKey = TagKeyType::Register("ResourceName");
 
 static const TagKeyType ValueTypeKey = TagKeyType::Register("ValueType");
 
+static const TagKeyType CodecKey = TagKeyType::Register("Codec");
+
+static const TagKeyType PriorityKey = TagKeyType::Register("Priority");
+
 #endif  // RAY_STATS_TAG_DEFS_H
@@ -6,7 +6,8 @@
 set -e
 set -x
 
-bazel build "//:object_manager_stress_test" "//:object_manager_test" "@plasma//:plasma_store_server"
+bazel build "//:object_manager_stress_test" "//:object_manager_test" \
+  "//:object_manager_transfer_test" "@plasma//:plasma_store_server"
 
 # Get the directory in which this script is executing.
 SCRIPT_DIR="`dirname \"$0\"`"
@@ -36,6 +37,8 @@ sleep 1s
 sleep 1s
 # Use timeout=1000ms for the Wait tests.
 ./bazel-bin/object_manager_test $STORE_EXEC 1000
+sleep 1s
+./bazel-bin/object_manager_transfer_test $STORE_EXEC
 bazel run //:redis-cli -- -p 6379 shutdown
 sleep 1s
 
@@ -32,6 +32,13 @@ class ordered_set {
     positions_[value] = list_iterator;
   }
 
+  iterator insert(const_iterator position, const T &value) {
+    RAY_CHECK(positions_.find(value) == positions_.end());
+    auto list_iterator = elements_.insert(position, value);
+    positions_[value] = list_iterator;
+    return list_iterator;
+  }
+
   size_t count(const T &k) const { return positions_.count(k); }
 
   void pop_front() {